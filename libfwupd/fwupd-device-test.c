@@ -224,11 +224,51 @@ fwupd_device_func(void)
 	g_assert_false(fwupd_device_has_flag(dev2, FWUPD_DEVICE_FLAG_LOCKED));
 }
 
+static void
+fwupd_device_variant_func(void)
+{
+	gboolean ret;
+	g_autoptr(FwupdDevice) dev = fwupd_device_new();
+	g_autoptr(FwupdDevice) dev2 = fwupd_device_new();
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GVariant) val1 = NULL;
+	g_autoptr(GVariant) val2 = NULL;
+	g_autoptr(GVariant) val3 = NULL;
+	g_autoptr(GVariant) val4 = NULL;
+
+	fwupd_device_set_id(dev, "0000000000000000000000000000000000000000");
+	fwupd_device_set_name(dev, "ColorHug");
+	fwupd_device_set_serial(dev, "12345");
+	fwupd_device_add_instance_id(dev, "USB\\VID_1234&PID_0001");
+
+	/* the serialized data is reused when nothing changed */
+	val1 = g_variant_ref_sink(fwupd_codec_to_variant(FWUPD_CODEC(dev), FWUPD_CODEC_FLAG_NONE));
+	val2 = g_variant_ref_sink(fwupd_codec_to_variant(FWUPD_CODEC(dev), FWUPD_CODEC_FLAG_NONE));
+	g_assert_true(g_variant_equal(val1, val2));
+	g_assert_true(g_variant_get_data(val1) == g_variant_get_data(val2));
+
+	/* different flags */
+	val3 =
+	    g_variant_ref_sink(fwupd_codec_to_variant(FWUPD_CODEC(dev), FWUPD_CODEC_FLAG_TRUSTED));
+	g_assert_false(g_variant_equal(val1, val3));
+
+	/* changed */
+	fwupd_device_set_name(dev, "ColorHug2");
+	val4 = g_variant_ref_sink(fwupd_codec_to_variant(FWUPD_CODEC(dev), FWUPD_CODEC_FLAG_NONE));
+	g_assert_false(g_variant_equal(val1, val4));
+	ret = fwupd_codec_from_variant(FWUPD_CODEC(dev2), val4, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	g_assert_cmpstr(fwupd_device_get_name(dev2), ==, "ColorHug2");
+	g_assert_null(fwupd_device_get_serial(dev2));
+}
+
 int
 main(int argc, char **argv)
 {
 	g_test_init(&argc, &argv, NULL);
 	g_test_add_func("/fwupd/device", fwupd_device_func);
 	g_test_add_func("/fwupd/device/filter", fwupd_device_filter_func);
+	g_test_add_func("/fwupd/device/variant", fwupd_device_variant_func);
 	return g_test_run();
 }
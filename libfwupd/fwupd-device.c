@@ -73,6 +73,10 @@ typedef struct {
 	guint percentage;
 	GPtrArray *releases; /* (nullable) (element-type FwupdRelease) */
 	FwupdDevice *parent; /* noref */
+	guint generation;
+	GVariant *variant; /* (nullable) */
+	FwupdCodecFlags variant_flags;
+	guint variant_generation;
 } FwupdDevicePrivate;
 
 enum {
@@ -108,6 +112,25 @@ G_DEFINE_TYPE_EXTENDED(FwupdDevice,
 
 #define FWUPD_BATTERY_THRESHOLD_DEFAULT 10 /* % */
 
+/**
+ * fwupd_device_invalidate:
+ * @self: a #FwupdDevice
+ *
+ * Marks the device as changed, so that any cached serialized data is regenerated.
+ *
+ * NOTE: You should never call this function from user code, it is for daemon
+ * use only.
+ *
+ * Since: 2.1.6
+ **/
+void
+fwupd_device_invalidate(FwupdDevice *self)
+{
+	FwupdDevicePrivate *priv = GET_PRIVATE(self);
+	g_return_if_fail(FWUPD_IS_DEVICE(self));
+	priv->generation++;
+}
+
 static void
 fwupd_device_ensure_checksums(FwupdDevice *self)
 {
@@ -183,6 +206,7 @@ fwupd_device_add_checksum(FwupdDevice *self, const gchar *checksum)
 	if (fwupd_device_has_checksum(self, checksum))
 		return;
 	fwupd_device_ensure_checksums(self);
+	fwupd_device_invalidate(self);
 	g_ptr_array_add(priv->checksums, g_strdup(checksum));
 }
 
@@ -235,6 +259,7 @@ fwupd_device_add_issue(FwupdDevice *self, const gchar *issue)
 		if (g_strcmp0(issue_tmp, issue) == 0)
 			return;
 	}
+	fwupd_device_invalidate(self);
 	g_ptr_array_add(priv->issues, g_strdup(issue));
 }
 
@@ -302,6 +327,7 @@ fwupd_device_set_summary(FwupdDevice *self, const gchar *summary)
 	if (g_strcmp0(priv->summary, summary) == 0)
 		return;
 
+	fwupd_device_invalidate(self);
 	g_free(priv->summary);
 	priv->summary = g_strdup(summary);
 }
@@ -343,6 +369,7 @@ fwupd_device_set_details_url(FwupdDevice *self, const gchar *details_url)
 	if (g_strcmp0(priv->details_url, details_url) == 0)
 		return;
 
+	fwupd_device_invalidate(self);
 	g_free(priv->details_url);
 	priv->details_url = g_strdup(details_url);
 }
@@ -384,6 +411,7 @@ fwupd_device_set_branch(FwupdDevice *self, const gchar *branch)
 	if (g_strcmp0(priv->branch, branch) == 0)
 		return;
 
+	fwupd_device_invalidate(self);
 	g_free(priv->branch);
 	priv->branch = g_strdup(branch);
 }
@@ -425,6 +453,7 @@ fwupd_device_set_serial(FwupdDevice *self, const gchar *serial)
 	if (g_strcmp0(priv->serial, serial) == 0)
 		return;
 
+	fwupd_device_invalidate(self);
 	g_free(priv->serial);
 	priv->serial = g_strdup(serial);
 }
@@ -472,6 +501,7 @@ fwupd_device_set_id(FwupdDevice *self, const gchar *id)
 		return;
 	}
 
+	fwupd_device_invalidate(self);
 	g_free(priv->id);
 	priv->id = g_strdup(id);
 	g_object_notify(G_OBJECT(self), "id");
@@ -520,6 +550,7 @@ fwupd_device_set_parent_id(FwupdDevice *self, const gchar *parent_id)
 		return;
 	}
 
+	fwupd_device_invalidate(self);
 	g_free(priv->parent_id);
 	priv->parent_id = g_strdup(parent_id);
 }
@@ -573,6 +604,7 @@ fwupd_device_set_composite_id(FwupdDevice *self, const gchar *composite_id)
 		return;
 	}
 
+	fwupd_device_invalidate(self);
 	g_free(priv->composite_id);
 	priv->composite_id = g_strdup(composite_id);
 }
@@ -817,6 +849,7 @@ fwupd_device_add_guid(FwupdDevice *self, const gchar *guid)
 	if (fwupd_device_has_guid(self, guid))
 		return;
 	fwupd_device_ensure_guids(self);
+	fwupd_device_invalidate(self);
 	g_ptr_array_add(priv->guids, g_strdup(guid));
 }
 
@@ -914,6 +947,7 @@ fwupd_device_add_instance_id(FwupdDevice *self, const gchar *instance_id)
 	if (fwupd_device_has_instance_id(self, instance_id))
 		return;
 	fwupd_device_ensure_instance_ids(self);
+	fwupd_device_invalidate(self);
 	g_ptr_array_add(priv->instance_ids, g_strdup(instance_id));
 }
 
@@ -990,6 +1024,7 @@ fwupd_device_add_icon(FwupdDevice *self, const gchar *icon)
 	if (fwupd_device_has_icon(self, icon))
 		return;
 	fwupd_device_ensure_icons(self);
+	fwupd_device_invalidate(self);
 	g_ptr_array_add(priv->icons, g_strdup(icon));
 }
 
@@ -1030,6 +1065,7 @@ fwupd_device_set_name(FwupdDevice *self, const gchar *name)
 	if (g_strcmp0(priv->name, name) == 0)
 		return;
 
+	fwupd_device_invalidate(self);
 	g_free(priv->name);
 	priv->name = g_strdup(name);
 }
@@ -1071,6 +1107,7 @@ fwupd_device_set_vendor(FwupdDevice *self, const gchar *vendor)
 	if (g_strcmp0(priv->vendor, vendor) == 0)
 		return;
 
+	fwupd_device_invalidate(self);
 	g_free(priv->vendor);
 	priv->vendor = g_strdup(vendor);
 	g_object_notify(G_OBJECT(self), "vendor");
@@ -1152,6 +1189,7 @@ fwupd_device_add_vendor_id(FwupdDevice *self, const gchar *vendor_id)
 	if (fwupd_device_has_vendor_id(self, vendor_id))
 		return;
 	fwupd_device_ensure_vendor_ids(self);
+	fwupd_device_invalidate(self);
 	g_ptr_array_add(priv->vendor_ids, g_strdup(vendor_id));
 }
 
@@ -1192,6 +1230,7 @@ fwupd_device_set_version(FwupdDevice *self, const gchar *version)
 	if (g_strcmp0(priv->version, version) == 0)
 		return;
 
+	fwupd_device_invalidate(self);
 	g_free(priv->version);
 	priv->version = g_strdup(version);
 	g_object_notify(G_OBJECT(self), "version");
@@ -1234,6 +1273,7 @@ fwupd_device_set_version_lowest(FwupdDevice *self, const gchar *version_lowest)
 	if (g_strcmp0(priv->version_lowest, version_lowest) == 0)
 		return;
 
+	fwupd_device_invalidate(self);
 	g_free(priv->version_lowest);
 	priv->version_lowest = g_strdup(version_lowest);
 }
@@ -1270,6 +1310,7 @@ fwupd_device_set_version_lowest_raw(FwupdDevice *self, guint64 version_lowest_ra
 {
 	FwupdDevicePrivate *priv = GET_PRIVATE(self);
 	g_return_if_fail(FWUPD_IS_DEVICE(self));
+	fwupd_device_invalidate(self);
 	priv->version_lowest_raw = version_lowest_raw;
 }
 
@@ -1310,6 +1351,7 @@ fwupd_device_set_version_highest(FwupdDevice *self, const gchar *version_highest
 	if (g_strcmp0(priv->version_highest, version_highest) == 0)
 		return;
 
+	fwupd_device_invalidate(self);
 	g_free(priv->version_highest);
 	priv->version_highest = g_strdup(version_highest);
 }
@@ -1346,6 +1388,7 @@ fwupd_device_set_version_highest_raw(FwupdDevice *self, guint64 version_highest_
 {
 	FwupdDevicePrivate *priv = GET_PRIVATE(self);
 	g_return_if_fail(FWUPD_IS_DEVICE(self));
+	fwupd_device_invalidate(self);
 	priv->version_highest_raw = version_highest_raw;
 }
 
@@ -1386,6 +1429,7 @@ fwupd_device_set_version_bootloader(FwupdDevice *self, const gchar *version_boot
 	if (g_strcmp0(priv->version_bootloader, version_bootloader) == 0)
 		return;
 
+	fwupd_device_invalidate(self);
 	g_free(priv->version_bootloader);
 	priv->version_bootloader = g_strdup(version_bootloader);
 }
@@ -1422,6 +1466,7 @@ fwupd_device_set_version_bootloader_raw(FwupdDevice *self, guint64 version_bootl
 {
 	FwupdDevicePrivate *priv = GET_PRIVATE(self);
 	g_return_if_fail(FWUPD_IS_DEVICE(self));
+	fwupd_device_invalidate(self);
 	priv->version_bootloader_raw = version_bootloader_raw;
 }
 
@@ -1457,6 +1502,7 @@ fwupd_device_set_flashes_left(FwupdDevice *self, guint32 flashes_left)
 {
 	FwupdDevicePrivate *priv = GET_PRIVATE(self);
 	g_return_if_fail(FWUPD_IS_DEVICE(self));
+	fwupd_device_invalidate(self);
 	priv->flashes_left = flashes_left;
 }
 
@@ -1500,6 +1546,7 @@ fwupd_device_set_battery_level(FwupdDevice *self, guint32 battery_level)
 
 	if (priv->battery_level == battery_level)
 		return;
+	fwupd_device_invalidate(self);
 	priv->battery_level = battery_level;
 	g_object_notify(G_OBJECT(self), "battery-level");
 }
@@ -1554,6 +1601,7 @@ fwupd_device_set_battery_threshold(FwupdDevice *self, guint32 battery_threshold)
 
 	if (priv->battery_threshold == battery_threshold)
 		return;
+	fwupd_device_invalidate(self);
 	priv->battery_threshold = battery_threshold;
 	g_object_notify(G_OBJECT(self), "battery-threshold");
 }
@@ -1590,6 +1638,7 @@ fwupd_device_set_install_duration(FwupdDevice *self, guint32 duration)
 {
 	FwupdDevicePrivate *priv = GET_PRIVATE(self);
 	g_return_if_fail(FWUPD_IS_DEVICE(self));
+	fwupd_device_invalidate(self);
 	priv->install_duration = duration;
 }
 
@@ -1630,6 +1679,7 @@ fwupd_device_set_plugin(FwupdDevice *self, const gchar *plugin)
 	if (g_strcmp0(priv->plugin, plugin) == 0)
 		return;
 
+	fwupd_device_invalidate(self);
 	g_free(priv->plugin);
 	priv->plugin = g_strdup(plugin);
 }
@@ -1710,6 +1760,7 @@ fwupd_device_add_protocol(FwupdDevice *self, const gchar *protocol)
 	if (fwupd_device_has_protocol(self, protocol))
 		return;
 	fwupd_device_ensure_protocols(self);
+	fwupd_device_invalidate(self);
 	g_ptr_array_add(priv->protocols, g_strdup(protocol));
 }
 
@@ -1747,6 +1798,7 @@ fwupd_device_set_flags(FwupdDevice *self, guint64 flags)
 	g_return_if_fail(FWUPD_IS_DEVICE(self));
 	if (priv->flags == flags)
 		return;
+	fwupd_device_invalidate(self);
 	priv->flags = flags;
 	g_object_notify(G_OBJECT(self), "flags");
 }
@@ -1769,6 +1821,7 @@ fwupd_device_add_flag(FwupdDevice *self, FwupdDeviceFlags flag)
 		return;
 	if ((priv->flags | flag) == priv->flags)
 		return;
+	fwupd_device_invalidate(self);
 	priv->flags |= flag;
 	g_object_notify(G_OBJECT(self), "flags");
 }
@@ -1791,6 +1844,7 @@ fwupd_device_remove_flag(FwupdDevice *self, FwupdDeviceFlags flag)
 		return;
 	if ((priv->flags & flag) == 0)
 		return;
+	fwupd_device_invalidate(self);
 	priv->flags &= ~flag;
 	g_object_notify(G_OBJECT(self), "flags");
 }
@@ -1848,6 +1902,7 @@ fwupd_device_set_problems(FwupdDevice *self, guint64 problems)
 	g_return_if_fail(FWUPD_IS_DEVICE(self));
 	if (priv->problems == problems)
 		return;
+	fwupd_device_invalidate(self);
 	priv->problems = problems;
 	g_object_notify(G_OBJECT(self), "problems");
 }
@@ -1870,6 +1925,7 @@ fwupd_device_add_problem(FwupdDevice *self, FwupdDeviceProblem problem)
 		return;
 	if (fwupd_device_has_problem(self, problem))
 		return;
+	fwupd_device_invalidate(self);
 	priv->problems |= problem;
 	g_object_notify(G_OBJECT(self), "problems");
 }
@@ -1892,6 +1948,7 @@ fwupd_device_remove_problem(FwupdDevice *self, FwupdDeviceProblem problem)
 		return;
 	if (!fwupd_device_has_problem(self, problem))
 		return;
+	fwupd_device_invalidate(self);
 	priv->problems &= ~problem;
 	g_object_notify(G_OBJECT(self), "problems");
 }
@@ -1949,6 +2006,7 @@ fwupd_device_set_request_flags(FwupdDevice *self, guint64 request_flags)
 	g_return_if_fail(FWUPD_IS_DEVICE(self));
 	if (priv->request_flags == request_flags)
 		return;
+	fwupd_device_invalidate(self);
 	priv->request_flags = request_flags;
 	g_object_notify(G_OBJECT(self), "request-flags");
 }
@@ -1971,6 +2029,7 @@ fwupd_device_add_request_flag(FwupdDevice *self, FwupdRequestFlags request_flag)
 		return;
 	if ((priv->request_flags | request_flag) == priv->request_flags)
 		return;
+	fwupd_device_invalidate(self);
 	priv->request_flags |= request_flag;
 	g_object_notify(G_OBJECT(self), "request-flags");
 }
@@ -1993,6 +2052,7 @@ fwupd_device_remove_request_flag(FwupdDevice *self, FwupdRequestFlags request_fl
 		return;
 	if ((priv->request_flags & request_flag) == 0)
 		return;
+	fwupd_device_invalidate(self);
 	priv->request_flags &= ~request_flag;
 	g_object_notify(G_OBJECT(self), "request-flags");
 }
@@ -2048,6 +2108,7 @@ fwupd_device_set_created(FwupdDevice *self, guint64 created)
 {
 	FwupdDevicePrivate *priv = GET_PRIVATE(self);
 	g_return_if_fail(FWUPD_IS_DEVICE(self));
+	fwupd_device_invalidate(self);
 	priv->created = created;
 }
 
@@ -2083,6 +2144,7 @@ fwupd_device_set_modified(FwupdDevice *self, guint64 modified)
 {
 	FwupdDevicePrivate *priv = GET_PRIVATE(self);
 	g_return_if_fail(FWUPD_IS_DEVICE(self));
+	fwupd_device_invalidate(self);
 	priv->modified = modified;
 }
 
@@ -2501,6 +2563,38 @@ fwupd_device_add_variant(FwupdCodec *codec, GVariantBuilder *builder, FwupdCodec
 	}
 }
 
+static GVariant *
+fwupd_device_to_variant(FwupdCodec *codec, FwupdCodecFlags flags)
+{
+	FwupdDevice *self = FWUPD_DEVICE(codec);
+	FwupdDevicePrivate *priv = GET_PRIVATE(self);
+	g_autoptr(GBytes) blob = NULL;
+
+	/* releases can be changed without the device knowing */
+	if (priv->releases != NULL && priv->releases->len > 0) {
+		GVariantBuilder builder;
+		g_variant_builder_init(&builder, G_VARIANT_TYPE_VARDICT);
+		fwupd_device_add_variant(codec, &builder, flags);
+		return g_variant_new("a{sv}", &builder);
+	}
+
+	/* regenerate if anything was changed since the last time */
+	if (priv->variant == NULL || priv->variant_generation != priv->generation ||
+	    priv->variant_flags != flags) {
+		GVariantBuilder builder;
+		g_variant_builder_init(&builder, G_VARIANT_TYPE_VARDICT);
+		fwupd_device_add_variant(codec, &builder, flags);
+		g_clear_pointer(&priv->variant, g_variant_unref);
+		priv->variant = g_variant_ref_sink(g_variant_new("a{sv}", &builder));
+		priv->variant_flags = flags;
+		priv->variant_generation = priv->generation;
+	}
+
+	/* the caller gets a new floating reference sharing the serialized data */
+	blob = g_variant_get_data_as_bytes(priv->variant);
+	return g_variant_new_from_bytes(G_VARIANT_TYPE_VARDICT, blob, TRUE);
+}
+
 static void
 fwupd_device_from_key_value(FwupdDevice *self, const gchar *key, GVariant *value)
 {
@@ -2792,6 +2886,7 @@ fwupd_device_set_update_state(FwupdDevice *self, FwupdUpdateState update_state)
 	g_return_if_fail(FWUPD_IS_DEVICE(self));
 	if (priv->update_state == update_state)
 		return;
+	fwupd_device_invalidate(self);
 	priv->update_state = update_state;
 	g_object_notify(G_OBJECT(self), "update-state");
 }
@@ -2828,6 +2923,7 @@ fwupd_device_set_version_format(FwupdDevice *self, FwupdVersionFormat version_fo
 {
 	FwupdDevicePrivate *priv = GET_PRIVATE(self);
 	g_return_if_fail(FWUPD_IS_DEVICE(self));
+	fwupd_device_invalidate(self);
 	priv->version_format = version_format;
 }
 
@@ -2863,6 +2959,7 @@ fwupd_device_set_version_raw(FwupdDevice *self, guint64 version_raw)
 {
 	FwupdDevicePrivate *priv = GET_PRIVATE(self);
 	g_return_if_fail(FWUPD_IS_DEVICE(self));
+	fwupd_device_invalidate(self);
 	priv->version_raw = version_raw;
 }
 
@@ -2898,6 +2995,7 @@ fwupd_device_set_version_build_date(FwupdDevice *self, guint64 version_build_dat
 {
 	FwupdDevicePrivate *priv = GET_PRIVATE(self);
 	g_return_if_fail(FWUPD_IS_DEVICE(self));
+	fwupd_device_invalidate(self);
 	priv->version_build_date = version_build_date;
 }
 
@@ -2938,6 +3036,7 @@ fwupd_device_set_update_error(FwupdDevice *self, const gchar *update_error)
 	if (g_strcmp0(priv->update_error, update_error) == 0)
 		return;
 
+	fwupd_device_invalidate(self);
 	g_free(priv->update_error);
 	priv->update_error = g_strdup(update_error);
 	g_object_notify(G_OBJECT(self), "update-error");
@@ -3006,6 +3105,7 @@ fwupd_device_add_release(FwupdDevice *self, FwupdRelease *release)
 	g_return_if_fail(FWUPD_IS_DEVICE(self));
 	g_return_if_fail(FWUPD_IS_RELEASE(release));
 	fwupd_device_ensure_releases(self);
+	fwupd_device_invalidate(self);
 	g_ptr_array_add(priv->releases, g_object_ref(release));
 }
 
@@ -3043,6 +3143,7 @@ fwupd_device_set_status(FwupdDevice *self, FwupdStatus status)
 	g_return_if_fail(FWUPD_IS_DEVICE(self));
 	if (priv->status == status)
 		return;
+	fwupd_device_invalidate(self);
 	priv->status = status;
 	g_object_notify(G_OBJECT(self), "status");
 }
@@ -3081,6 +3182,7 @@ fwupd_device_set_percentage(FwupdDevice *self, guint percentage)
 	g_return_if_fail(FWUPD_IS_DEVICE(self));
 	if (priv->percentage == percentage)
 		return;
+	fwupd_device_invalidate(self);
 	priv->percentage = percentage;
 	g_object_notify(G_OBJECT(self), "percentage");
 }
@@ -4174,6 +4276,8 @@ fwupd_device_finalize(GObject *object)
 		g_ptr_array_unref(priv->releases);
 	if (priv->issues != NULL)
 		g_ptr_array_unref(priv->issues);
+	if (priv->variant != NULL)
+		g_variant_unref(priv->variant);
 
 	G_OBJECT_CLASS(fwupd_device_parent_class)->finalize(object);
 }
@@ -4197,6 +4301,7 @@ fwupd_device_codec_iface_init(FwupdCodecInterface *iface)
 	iface->add_json = fwupd_device_add_json;
 	iface->from_json = fwupd_device_from_json;
 	iface->add_variant = fwupd_device_add_variant;
+	iface->to_variant = fwupd_device_to_variant;
 	iface->from_variant_iter = fwupd_device_from_variant_iter;
 }
 
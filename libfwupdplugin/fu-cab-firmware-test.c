@@ -9,6 +9,7 @@
 #include <fwupdplugin.h>
 
 #include "fu-cab-firmware-private.h"
+#include "fu-cab-struct.h"
 
 static void
 fu_cab_firmware_checksum_func(void)
@@ -38,6 +39,9 @@ fu_cab_firmware_checksum_func(void)
 	}
 }
 
+static const gchar *fu_cab_firmware_multiblock_ids[] = {"foo.bin", "bar.bin"};
+static const gsize fu_cab_firmware_multiblock_sizes[] = {0x8000 * 10 + 0x123, 0x8000 * 2 + 0x456};
+
 static void
 fu_cab_firmware_compressed_size_func(void)
 {
@@ -84,6 +88,156 @@ fu_cab_firmware_compressed_size_func(void)
 	g_assert_false(ret);
 }
 
+static FuFirmware *
+fu_cab_firmware_multiblock_new(void)
+{
+	g_autoptr(FuCabFirmware) cab = fu_cab_firmware_new();
+
+	/* images spanning CFDATA blocks */
+	fu_cab_firmware_set_compressed(cab, TRUE);
+	for (guint i = 0; i < G_N_ELEMENTS(fu_cab_firmware_multiblock_ids); i++) {
+		gboolean ret;
+		g_autoptr(FuCabImage) img = fu_cab_image_new();
+		g_autoptr(GByteArray) buf = g_byte_array_new();
+		g_autoptr(GBytes) blob_img = NULL;
+		g_autoptr(GError) error = NULL;
+
+		for (gsize j = 0; j < fu_cab_firmware_multiblock_sizes[i]; j++)
+			fu_byte_array_append_uint8(buf, (guint8)((j * (i + 1)) % 0xFB));
+		blob_img = g_byte_array_free_to_bytes(g_steal_pointer(&buf));
+		fu_firmware_set_bytes(FU_FIRMWARE(img), blob_img);
+		fu_firmware_set_id(FU_FIRMWARE(img), fu_cab_firmware_multiblock_ids[i]);
+		ret = fu_firmware_add_image(FU_FIRMWARE(cab), FU_FIRMWARE(img), &error);
+		g_assert_no_error(error);
+		g_assert_true(ret);
+	}
+	return FU_FIRMWARE(g_steal_pointer(&cab));
+}
+
+static void
+fu_cab_firmware_multiblock_check(FuFirmware *cab1, FuFirmware *cab2, const gchar *id)
+{
+	g_autoptr(FuFirmware) img1 = NULL;
+	g_autoptr(FuFirmware) img2 = NULL;
+	g_autoptr(GBytes) blob1 = NULL;
+	g_autoptr(GBytes) blob2 = NULL;
+	g_autoptr(GError) error = NULL;
+
+	img1 = fu_firmware_get_image_by_id(cab1, id, &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(img1);
+	img2 = fu_firmware_get_image_by_id(cab2, id, &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(img2);
+	blob1 = fu_firmware_get_bytes(img1, &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(blob1);
+	blob2 = fu_firmware_get_bytes(img2, &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(blob2);
+	g_assert_true(g_bytes_equal(blob1, blob2));
+}
+
+static void
+fu_cab_firmware_multiblock_func(void)
+{
+	gboolean ret;
+	g_autoptr(FuFirmware) cab = fu_cab_firmware_multiblock_new();
+	g_autoptr(FuFirmware) cab2 = fu_cab_firmware_new();
+	g_autoptr(GBytes) blob = NULL;
+	g_autoptr(GError) error = NULL;
+
+	blob = fu_firmware_write(cab, &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(blob);
+
+	/* parse it back */
+	ret = fu_firmware_parse_bytes(cab2, blob, 0x0, FU_FIRMWARE_PARSE_FLAG_CACHE_BLOB, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	for (guint i = 0; i < G_N_ELEMENTS(fu_cab_firmware_multiblock_ids); i++)
+		fu_cab_firmware_multiblock_check(cab, cab2, fu_cab_firmware_multiblock_ids[i]);
+}
+
+static void
+fu_cab_firmware_lazy_func(void)
+{
+	gboolean ret;
+	gsize offset;
+	g_autoptr(FuFirmware) cab = fu_cab_firmware_multiblock_new();
+	g_autoptr(FuFirmware) cab2 = fu_cab_firmware_new();
+	g_autoptr(FuFirmware) cab3 = fu_cab_firmware_new();
+	g_autoptr(FuFirmware) cab4 = fu_cab_firmware_new();
+	g_autoptr(FuFirmware) img = NULL;
+	g_autoptr(FuStructCabFolder) st_folder = NULL;
+	g_autoptr(GByteArray) buf = NULL;
+	g_autoptr(GBytes) blob = NULL;
+	g_autoptr(GBytes) blob2 = NULL;
+	g_autoptr(GBytes) blob_img = NULL;
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GInputStream) stream = NULL;
+
+	blob = fu_firmware_write(cab, &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(blob);
+
+	/* read the images out of order so the blocks are inflated again */
+	ret = fu_firmware_parse_bytes(cab2,
+				      blob,
+				      0x0,
+				      FU_FIRMWARE_PARSE_FLAG_CACHE_STREAM |
+					  FU_FIRMWARE_PARSE_FLAG_LAZY,
+				      &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	fu_cab_firmware_multiblock_check(cab, cab2, "bar.bin");
+	fu_cab_firmware_multiblock_check(cab, cab2, "foo.bin");
+	fu_cab_firmware_multiblock_check(cab, cab2, "bar.bin");
+
+	/* make the last CFDATA block declare one byte too many */
+	stream = g_memory_input_stream_new_from_bytes(blob);
+	st_folder = fu_struct_cab_folder_parse_stream(stream, FU_STRUCT_CAB_HEADER_SIZE, &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(st_folder);
+	buf = g_bytes_unref_to_array(g_steal_pointer(&blob));
+	offset = fu_struct_cab_folder_get_offset(st_folder);
+	for (guint i = 0; i + 1 < fu_struct_cab_folder_get_ndatab(st_folder); i++) {
+		guint16 comp = fu_memread_uint16(buf->data + offset + 4, G_LITTLE_ENDIAN);
+		offset += FU_STRUCT_CAB_DATA_SIZE + comp;
+	}
+	buf->data[offset + 6]++;
+	blob2 = g_bytes_new(buf->data, buf->len);
+
+	/* this is only detected when parsing eagerly */
+	ret = fu_firmware_parse_bytes(cab3,
+				      blob2,
+				      0x0,
+				      FU_FIRMWARE_PARSE_FLAG_CACHE_BLOB |
+					  FU_FIRMWARE_PARSE_FLAG_IGNORE_CHECKSUM,
+				      &error);
+	g_assert_error(error, FWUPD_ERROR, FWUPD_ERROR_INVALID_DATA);
+	g_assert_false(ret);
+	g_clear_error(&error);
+
+	/* ...or when reading the affected image */
+	ret = fu_firmware_parse_bytes(cab4,
+				      blob2,
+				      0x0,
+				      FU_FIRMWARE_PARSE_FLAG_CACHE_STREAM |
+					  FU_FIRMWARE_PARSE_FLAG_LAZY |
+					  FU_FIRMWARE_PARSE_FLAG_IGNORE_CHECKSUM,
+				      &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	fu_cab_firmware_multiblock_check(cab, cab4, "foo.bin");
+	img = fu_firmware_get_image_by_id(cab4, "bar.bin", &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(img);
+	blob_img = fu_firmware_get_bytes(img, &error);
+	g_assert_error(error, FWUPD_ERROR, FWUPD_ERROR_INVALID_DATA);
+	g_assert_null(blob_img);
+}
+
 int
 main(int argc, char **argv)
 {
@@ -91,5 +245,7 @@ main(int argc, char **argv)
 	g_test_add_func("/fwupd/cab-firmware/checksum", fu_cab_firmware_checksum_func);
 	g_test_add_func("/fwupd/cab-firmware/compressed-size",
 			fu_cab_firmware_compressed_size_func);
+	g_test_add_func("/fwupd/cab-firmware/multiblock", fu_cab_firmware_multiblock_func);
+	g_test_add_func("/fwupd/cab-firmware/lazy", fu_cab_firmware_lazy_func);
 	return g_test_run();
 }
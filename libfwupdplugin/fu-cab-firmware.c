@@ -12,11 +12,13 @@
 
 #include "fu-byte-array.h"
 #include "fu-cab-firmware-private.h"
+#include "fu-cab-folder-input-stream.h"
 #include "fu-cab-image.h"
 #include "fu-cab-struct.h"
 #include "fu-chunk-array.h"
 #include "fu-common.h"
 #include "fu-composite-input-stream.h"
+#include "fu-firmware-private.h"
 #include "fu-input-stream.h"
 #include "fu-mem-private.h"
 #include "fu-partial-input-stream.h"
@@ -35,6 +37,8 @@ G_DEFINE_TYPE_WITH_PRIVATE(FuCabFirmware, fu_cab_firmware, FU_TYPE_FIRMWARE)
 #define FU_CAB_FIRMWARE_MAX_FILENAME 1000
 
 #define FU_CAB_FIRMWARE_DECOMPRESS_BUFSZ 0x4000 /* bytes */
+#define FU_CAB_FIRMWARE_BLOCK_SIZE	 0x8000 /* bytes */
+#define FU_CAB_FIRMWARE_WRITE_BATCH	 64	/* blocks */
 
 /**
  * fu_cab_firmware_get_compressed:
@@ -162,6 +166,25 @@ fu_cab_firmware_zstream_deflater_free(z_stream_deflater *zstrm)
 
 G_DEFINE_AUTOPTR_CLEANUP_FUNC(z_stream_deflater, fu_cab_firmware_zstream_deflater_free)
 
+static gboolean
+fu_cab_firmware_check_mszip_signature(const guint8 *buf, gsize bufsz, GError **error)
+{
+	g_autofree gchar *kind = NULL;
+
+	kind = fu_memstrsafe(buf, bufsz, 0x0, 2, error);
+	if (kind == NULL)
+		return FALSE;
+	if (g_strcmp0(kind, "CK") != 0) {
+		g_set_error(error,
+			    FWUPD_ERROR,
+			    FWUPD_ERROR_NOT_SUPPORTED,
+			    "compressed header invalid: %s",
+			    kind);
+		return FALSE;
+	}
+	return TRUE;
+}
+
 static gboolean
 fu_cab_firmware_parse_data(FuCabFirmware *self,
 			   FuCabFirmwareParseHelper *helper,
@@ -263,10 +286,28 @@ fu_cab_firmware_parse_data(FuCabFirmware *self,
 		}
 	}
 
-	/* decompress Zlib data after removing *another *header... */
-	if (helper->compression == FU_CAB_COMPRESSION_MSZIP) {
+	/* only check the signature, and inflate when the folder data is read */
+	if (FU_IS_CAB_FOLDER_INPUT_STREAM(folder_data)) {
+		guint8 sig[2] = {0x0};
+		if (!fu_input_stream_read_safe(helper->stream,
+					       sig,
+					       sizeof(sig),
+					       0x0,
+					       payload_offset,
+					       sizeof(sig),
+					       error))
+			return FALSE;
+		if (!fu_cab_firmware_check_mszip_signature(sig, sizeof(sig), error))
+			return FALSE;
+		if (!fu_cab_folder_input_stream_add_block(FU_CAB_FOLDER_INPUT_STREAM(folder_data),
+							  payload_offset,
+							  blob_comp,
+							  blob_uncomp,
+							  error))
+			return FALSE;
+	} else if (helper->compression == FU_CAB_COMPRESSION_MSZIP) {
+		/* decompress Zlib data after removing *another *header... */
 		int zret;
-		g_autofree gchar *kind = NULL;
 		g_autoptr(GByteArray) buf = g_byte_array_new();
 		g_autoptr(GBytes) bytes_comp = NULL;
 		g_autoptr(GBytes) bytes_uncomp = NULL;
@@ -279,21 +320,10 @@ fu_cab_firmware_parse_data(FuCabFirmware *self,
 							error);
 		if (bytes_comp == NULL)
 			return FALSE;
-		kind = fu_memstrsafe(g_bytes_get_data(bytes_comp, NULL),
-				     g_bytes_get_size(bytes_comp),
-				     0x0,
-				     2,
-				     error);
-		if (kind == NULL)
-			return FALSE;
-		if (g_strcmp0(kind, "CK") != 0) {
-			g_set_error(error,
-				    FWUPD_ERROR,
-				    FWUPD_ERROR_NOT_SUPPORTED,
-				    "compressed header invalid: %s",
-				    kind);
+		if (!fu_cab_firmware_check_mszip_signature(g_bytes_get_data(bytes_comp, NULL),
+							   g_bytes_get_size(bytes_comp),
+							   error))
 			return FALSE;
-		}
 		if (helper->decompress_buf == NULL) {
 			/* sanity check decompress buffer size */
 			if (helper->decompress_bufsz == 0 ||
@@ -408,21 +438,21 @@ fu_cab_firmware_parse_data(FuCabFirmware *self,
 	return fu_size_checked_inc(offset, hdr_sz, error);
 }
 
-static gboolean
+static GInputStream *
 fu_cab_firmware_parse_folder(FuCabFirmware *self,
 			     FuCabFirmwareParseHelper *helper,
 			     guint idx,
 			     gsize offset,
-			     GInputStream *folder_data,
 			     GError **error)
 {
 	FuCabFirmwarePrivate *priv = GET_PRIVATE(self);
 	g_autoptr(FuStructCabFolder) st = NULL;
+	g_autoptr(GInputStream) folder_data = NULL;
 
 	/* parse header */
 	st = fu_struct_cab_folder_parse_stream(helper->stream, offset, error);
 	if (st == NULL)
-		return FALSE;
+		return NULL;
 
 	/* sanity check */
 	if (fu_struct_cab_folder_get_ndatab(st) == 0) {
@@ -430,7 +460,7 @@ fu_cab_firmware_parse_folder(FuCabFirmware *self,
 				    FWUPD_ERROR,
 				    FWUPD_ERROR_NOT_SUPPORTED,
 				    "no CFDATA blocks");
-		return FALSE;
+		return NULL;
 	}
 	helper->compression = fu_struct_cab_folder_get_compression(st);
 	if (helper->compression != FU_CAB_COMPRESSION_NONE)
@@ -442,25 +472,35 @@ fu_cab_firmware_parse_folder(FuCabFirmware *self,
 			    FWUPD_ERROR_NOT_SUPPORTED,
 			    "compression %s not supported",
 			    fu_cab_compression_to_string(helper->compression));
-		return FALSE;
+		return NULL;
+	}
+
+	/* the MSZIP blocks are inflated when read if lazy */
+	if (helper->compression == FU_CAB_COMPRESSION_MSZIP &&
+	    (helper->parse_flags & FU_FIRMWARE_PARSE_FLAG_LAZY)) {
+		folder_data = fu_cab_folder_input_stream_new(helper->stream, error);
+		if (folder_data == NULL)
+			return NULL;
+	} else {
+		folder_data = fu_composite_input_stream_new();
 	}
 
 	/* parse CDATA, either using the stream offset or the per-spec FuStructCabFolder.ndatab */
 	if (helper->ndatabsz > 0) {
 		for (gsize off = fu_struct_cab_folder_get_offset(st); off < helper->ndatabsz;) {
 			if (!fu_cab_firmware_parse_data(self, helper, &off, folder_data, error))
-				return FALSE;
+				return NULL;
 		}
 	} else {
 		gsize off = fu_struct_cab_folder_get_offset(st);
 		for (guint16 i = 0; i < fu_struct_cab_folder_get_ndatab(st); i++) {
 			if (!fu_cab_firmware_parse_data(self, helper, &off, folder_data, error))
-				return FALSE;
+				return NULL;
 		}
 	}
 
 	/* success */
-	return TRUE;
+	return g_steal_pointer(&folder_data);
 }
 
 static gboolean
@@ -729,8 +769,10 @@ fu_cab_firmware_parse(FuFirmware *firmware,
 
 	/* parse CFFOLDER */
 	for (guint i = 0; i < fu_struct_cab_header_get_nr_folders(st); i++) {
-		g_autoptr(GInputStream) folder_data = fu_composite_input_stream_new();
-		if (!fu_cab_firmware_parse_folder(self, helper, i, offset, folder_data, error))
+		g_autoptr(GInputStream) folder_data = NULL;
+
+		folder_data = fu_cab_firmware_parse_folder(self, helper, i, offset, error);
+		if (folder_data == NULL)
 			return FALSE;
 		if (!fu_input_stream_size(folder_data, &streamsz, error))
 			return FALSE;
@@ -758,6 +800,108 @@ fu_cab_firmware_parse(FuFirmware *firmware,
 	return TRUE;
 }
 
+typedef struct {
+	GBytes *blob;	 /* uncompressed */
+	GByteArray *buf; /* CFDATA payload */
+	gboolean compressed;
+} FuCabFirmwareWriteJob;
+
+static void
+fu_cab_firmware_write_job_free(FuCabFirmwareWriteJob *job)
+{
+	if (job->blob != NULL)
+		g_bytes_unref(job->blob);
+	if (job->buf != NULL)
+		g_byte_array_unref(job->buf);
+	g_free(job);
+}
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC(FuCabFirmwareWriteJob, fu_cab_firmware_write_job_free)
+
+static gboolean
+fu_cab_firmware_write_job_deflate(FuCabFirmwareWriteJob *job, GError **error)
+{
+	int zret;
+	gsize bufsz = 0;
+	const guint8 *buf = g_bytes_get_data(job->blob, &bufsz);
+	z_stream zstrm = {
+	    .zalloc = fu_cab_firmware_zalloc,
+	    .zfree = fu_cab_firmware_zfree,
+	    .opaque = Z_NULL,
+	    .next_in = (guint8 *)buf,
+	    .avail_in = bufsz,
+	};
+	g_autoptr(z_stream_deflater) zstrm_deflater = &zstrm;
+
+	zret = deflateInit2(zstrm_deflater,
+			    Z_DEFAULT_COMPRESSION,
+			    Z_DEFLATED,
+			    -15,
+			    8,
+			    Z_DEFAULT_STRATEGY);
+	if (zret != Z_OK) {
+		g_set_error(error,
+			    FWUPD_ERROR,
+			    FWUPD_ERROR_NOT_SUPPORTED,
+			    "failed to initialize deflate: %s",
+			    zError(zret));
+		return FALSE;
+	}
+
+	/* MSZIP signature, then enough space for the worst case */
+	fu_byte_array_append_uint8(job->buf, (guint8)'C');
+	fu_byte_array_append_uint8(job->buf, (guint8)'K');
+	fu_byte_array_set_size(job->buf, 2 + deflateBound(zstrm_deflater, bufsz), 0x0);
+	zstrm.next_out = job->buf->data + 2;
+	zstrm.avail_out = job->buf->len - 2;
+	zret = deflate(zstrm_deflater, Z_FINISH);
+	if (zret != Z_OK && zret != Z_STREAM_END) {
+		g_set_error(error,
+			    FWUPD_ERROR,
+			    FWUPD_ERROR_NOT_SUPPORTED,
+			    "zlib deflate failed: %s",
+			    zError(zret));
+		return FALSE;
+	}
+	g_byte_array_set_size(job->buf, 2 + zstrm.total_out);
+	return TRUE;
+}
+
+/* this runs in a worker thread when compressed, so must only use the job */
+static gboolean
+fu_cab_firmware_write_job_cb(gpointer item, gpointer user_data, GError **error)
+{
+	FuCabFirmwareWriteJob *job = (FuCabFirmwareWriteJob *)item;
+	job->buf = g_byte_array_new();
+	if (job->compressed)
+		return fu_cab_firmware_write_job_deflate(job, error);
+	fu_byte_array_append_bytes(job->buf, job->blob);
+	return TRUE;
+}
+
+static gboolean
+fu_cab_firmware_write_cfdata(GByteArray *buf, FuCabFirmwareWriteJob *job, GError **error)
+{
+	guint32 checksum = 0;
+	g_autoptr(GByteArray) hdr = g_byte_array_new();
+	g_autoptr(FuStructCabData) st_data = fu_struct_cab_data_new();
+
+	/* first do the 'checksum' on the data, then the partial header -- slightly crazy */
+	if (!fu_cab_firmware_compute_checksum(job->buf->data, job->buf->len, &checksum, error))
+		return FALSE;
+	fu_byte_array_append_uint16(hdr, job->buf->len, G_LITTLE_ENDIAN);
+	fu_byte_array_append_uint16(hdr, g_bytes_get_size(job->blob), G_LITTLE_ENDIAN);
+	if (!fu_cab_firmware_compute_checksum(hdr->data, hdr->len, &checksum, error))
+		return FALSE;
+
+	fu_struct_cab_data_set_checksum(st_data, checksum);
+	fu_struct_cab_data_set_comp(st_data, job->buf->len);
+	fu_struct_cab_data_set_uncomp(st_data, g_bytes_get_size(job->blob));
+	fu_byte_array_append_array(buf, st_data->buf);
+	g_byte_array_append(buf, job->buf->data, job->buf->len);
+	return TRUE;
+}
+
 static GByteArray *
 fu_cab_firmware_write(FuFirmware *firmware, GError **error)
 {
@@ -766,20 +910,20 @@ fu_cab_firmware_write(FuFirmware *firmware, GError **error)
 	gsize archive_size;
 	gsize offset;
 	gsize index_into = 0;
+	gsize cfdata_size = 0;
 	g_autoptr(FuStructCabHeader) st_hdr = fu_struct_cab_header_new();
 	g_autoptr(FuStructCabFolder) st_folder = fu_struct_cab_folder_new();
 	g_autoptr(GPtrArray) imgs = fu_firmware_get_images(firmware);
-	g_autoptr(GByteArray) cfdata_linear = g_byte_array_new();
-	g_autoptr(GBytes) cfdata_linear_blob = NULL;
+	g_autoptr(GArray) img_sizes = g_array_new(FALSE, FALSE, sizeof(gsize));
+	g_autoptr(GInputStream) cfdata_stream = fu_composite_input_stream_new();
 	g_autoptr(FuChunkArray) chunks = NULL;
-	g_autoptr(GPtrArray) chunks_zlib =
-	    g_ptr_array_new_with_free_func((GDestroyNotify)g_byte_array_unref);
 
-	/* create linear CFDATA block */
+	/* concatenate the image streams without copying the data */
 	for (guint i = 0; i < imgs->len; i++) {
 		FuFirmware *img = g_ptr_array_index(imgs, i);
 		const gchar *filename_win32 = fu_cab_image_get_win32_filename(FU_CAB_IMAGE(img));
-		g_autoptr(GBytes) img_blob = NULL;
+		gsize img_size = 0;
+		g_autoptr(GInputStream) img_stream = NULL;
 
 		if (filename_win32 == NULL) {
 			g_set_error_literal(error,
@@ -788,11 +932,13 @@ fu_cab_firmware_write(FuFirmware *firmware, GError **error)
 					    "no image filename");
 			return NULL;
 		}
-		img_blob = fu_firmware_get_bytes(img, error);
-		if (img_blob == NULL)
+		img_stream = fu_firmware_get_stream(img, error);
+		if (img_stream == NULL)
+			return NULL;
+		if (!fu_input_stream_size(img_stream, &img_size, error))
 			return NULL;
-		if (g_bytes_get_size(img_blob) > G_MAXUINT32) {
-			g_autofree gchar *sz_val = g_format_size(g_bytes_get_size(img_blob));
+		if (img_size > G_MAXUINT32) {
+			g_autofree gchar *sz_val = g_format_size(img_size);
 			g_set_error(error,
 				    FWUPD_ERROR,
 				    FWUPD_ERROR_INVALID_DATA,
@@ -800,22 +946,33 @@ fu_cab_firmware_write(FuFirmware *firmware, GError **error)
 				    sz_val);
 			return NULL;
 		}
-		fu_byte_array_append_bytes(cfdata_linear, img_blob);
+		if (img_size > 0) {
+			if (!fu_composite_input_stream_add_stream(
+				FU_COMPOSITE_INPUT_STREAM(cfdata_stream),
+				img_stream,
+				error))
+				return NULL;
+		}
+		g_array_append_val(img_sizes, img_size);
 	}
 
-	/* chunkify and compress with a fixed size */
-	if (cfdata_linear->len == 0) {
+	/* chunkify with a fixed size */
+	if (!fu_input_stream_size(cfdata_stream, &cfdata_size, error))
+		return NULL;
+	if (cfdata_size == 0) {
 		g_set_error_literal(error,
 				    FWUPD_ERROR,
 				    FWUPD_ERROR_NOT_SUPPORTED,
 				    "no data to compress");
 		return NULL;
 	}
-	cfdata_linear_blob = g_byte_array_free_to_bytes(g_steal_pointer(&cfdata_linear));
-	chunks = fu_chunk_array_new_from_bytes(cfdata_linear_blob,
-					       FU_CHUNK_ADDR_OFFSET_NONE,
-					       FU_CHUNK_PAGESZ_NONE,
-					       0x8000);
+	chunks = fu_chunk_array_new_from_stream(cfdata_stream,
+						FU_CHUNK_ADDR_OFFSET_NONE,
+						FU_CHUNK_PAGESZ_NONE,
+						FU_CAB_FIRMWARE_BLOCK_SIZE,
+						error);
+	if (chunks == NULL)
+		return NULL;
 	if (fu_chunk_array_length(chunks) > G_MAXUINT16) {
 		g_set_error(error,
 			    FWUPD_ERROR,
@@ -824,58 +981,6 @@ fu_cab_firmware_write(FuFirmware *firmware, GError **error)
 			    fu_chunk_array_length(chunks));
 		return NULL;
 	}
-	for (guint i = 0; i < fu_chunk_array_length(chunks); i++) {
-		g_autoptr(FuChunk) chk = NULL;
-		g_autoptr(GByteArray) chunk_zlib = g_byte_array_new();
-		g_autoptr(GByteArray) buf = g_byte_array_new();
-
-		chk = fu_chunk_array_index(chunks, i, error);
-		if (chk == NULL)
-			return NULL;
-		fu_byte_array_set_size(chunk_zlib, fu_chunk_get_data_sz(chk) * 2, 0x0);
-		if (priv->compressed) {
-			int zret;
-			z_stream zstrm = {
-			    .zalloc = fu_cab_firmware_zalloc,
-			    .zfree = fu_cab_firmware_zfree,
-			    .opaque = Z_NULL,
-			    .next_in = (guint8 *)fu_chunk_get_data(chk),
-			    .avail_in = fu_chunk_get_data_sz(chk),
-			    .next_out = chunk_zlib->data,
-			    .avail_out = chunk_zlib->len,
-			};
-			g_autoptr(z_stream_deflater) zstrm_deflater = &zstrm;
-			zret = deflateInit2(zstrm_deflater,
-					    Z_DEFAULT_COMPRESSION,
-					    Z_DEFLATED,
-					    -15,
-					    8,
-					    Z_DEFAULT_STRATEGY);
-			if (zret != Z_OK) {
-				g_set_error(error,
-					    FWUPD_ERROR,
-					    FWUPD_ERROR_NOT_SUPPORTED,
-					    "failed to initialize deflate: %s",
-					    zError(zret));
-				return NULL;
-			}
-			zret = deflate(zstrm_deflater, Z_FINISH);
-			if (zret != Z_OK && zret != Z_STREAM_END) {
-				g_set_error(error,
-					    FWUPD_ERROR,
-					    FWUPD_ERROR_NOT_SUPPORTED,
-					    "zlib deflate failed: %s",
-					    zError(zret));
-				return NULL;
-			}
-			fu_byte_array_append_uint8(buf, (guint8)'C');
-			fu_byte_array_append_uint8(buf, (guint8)'K');
-			g_byte_array_append(buf, chunk_zlib->data, zstrm.total_out);
-		} else {
-			g_byte_array_append(buf, fu_chunk_get_data(chk), fu_chunk_get_data_sz(chk));
-		}
-		g_ptr_array_add(chunks_zlib, g_steal_pointer(&buf));
-	}
 
 	/* create header */
 	archive_size = FU_STRUCT_CAB_HEADER_SIZE;
@@ -901,26 +1006,9 @@ fu_cab_firmware_write(FuFirmware *firmware, GError **error)
 		if (!fu_size_checked_inc(&archive_size, 1, error))
 			return NULL;
 	}
-	for (guint i = 0; i < chunks_zlib->len; i++) {
-		GByteArray *chunk = g_ptr_array_index(chunks_zlib, i);
-		if (!fu_size_checked_inc(&archive_size, FU_STRUCT_CAB_DATA_SIZE, error))
-			return NULL;
-		if (!fu_size_checked_inc(&archive_size, chunk->len, error))
-			return NULL;
-	}
 	offset = FU_STRUCT_CAB_HEADER_SIZE;
 	if (!fu_size_checked_inc(&offset, FU_STRUCT_CAB_FOLDER_SIZE, error))
 		return NULL;
-	if (archive_size > G_MAXUINT32) {
-		g_autofree gchar *sz_val = g_format_size(archive_size);
-		g_set_error(error,
-			    FWUPD_ERROR,
-			    FWUPD_ERROR_INVALID_DATA,
-			    "archive size %s exceeds CAB format limit",
-			    sz_val);
-		return NULL;
-	}
-	fu_struct_cab_header_set_size(st_hdr, (guint32)archive_size);
 	fu_struct_cab_header_set_off_cffile(st_hdr, offset);
 	fu_struct_cab_header_set_nr_files(st_hdr, imgs->len);
 
@@ -948,13 +1036,13 @@ fu_cab_firmware_write(FuFirmware *firmware, GError **error)
 		FuCabFileAttribute fattr = FU_CAB_FILE_ATTRIBUTE_NONE;
 		GDateTime *created = fu_cab_image_get_created(FU_CAB_IMAGE(img));
 		const gchar *filename_win32 = fu_cab_image_get_win32_filename(FU_CAB_IMAGE(img));
+		gsize img_size = g_array_index(img_sizes, gsize, i);
 		g_autoptr(FuStructCabFile) st_file = fu_struct_cab_file_new();
-		g_autoptr(GBytes) img_blob = fu_firmware_get_bytes(img, NULL);
 
 		if (!g_str_is_ascii(filename_win32))
 			fattr |= FU_CAB_FILE_ATTRIBUTE_NAME_UTF8;
 		fu_struct_cab_file_set_fattr(st_file, fattr);
-		fu_struct_cab_file_set_usize(st_file, (guint32)g_bytes_get_size(img_blob));
+		fu_struct_cab_file_set_usize(st_file, (guint32)img_size);
 
 		/* validate offset fits */
 		if (index_into > G_MAXUINT32) {
@@ -984,42 +1072,59 @@ fu_cab_firmware_write(FuFirmware *firmware, GError **error)
 				    strlen(filename_win32));
 		fu_byte_array_append_uint8(st_hdr->buf, 0x0);
 
-		if (!fu_size_checked_inc(&index_into, g_bytes_get_size(img_blob), error)) {
+		if (!fu_size_checked_inc(&index_into, img_size, error)) {
 			g_prefix_error_literal(error, "file offset overflow: ");
 			return NULL;
 		}
 	}
 
-	/* create each CFDATA */
-	for (guint i = 0; i < fu_chunk_array_length(chunks); i++) {
-		guint32 checksum = 0;
-		GByteArray *chunk_zlib = g_ptr_array_index(chunks_zlib, i);
-		g_autoptr(FuChunk) chk = NULL;
-		g_autoptr(GByteArray) hdr = g_byte_array_new();
-		g_autoptr(FuStructCabData) st_data = fu_struct_cab_data_new();
-
-		/* prepare chunk */
-		chk = fu_chunk_array_index(chunks, i, error);
-		if (chk == NULL)
-			return NULL;
+	/* create each CFDATA, compressing a batch of blocks at the same time */
+	for (guint i = 0; i < fu_chunk_array_length(chunks); i += FU_CAB_FIRMWARE_WRITE_BATCH) {
+		guint batch_end =
+		    MIN(i + FU_CAB_FIRMWARE_WRITE_BATCH, fu_chunk_array_length(chunks));
+		g_autoptr(GPtrArray) jobs =
+		    g_ptr_array_new_with_free_func((GDestroyNotify)fu_cab_firmware_write_job_free);
 
-		/* first do the 'checksum' on the data, then the partial header -- slightly crazy */
-		if (!fu_cab_firmware_compute_checksum(chunk_zlib->data,
-						      chunk_zlib->len,
-						      &checksum,
-						      error))
-			return NULL;
-		fu_byte_array_append_uint16(hdr, chunk_zlib->len, G_LITTLE_ENDIAN);
-		fu_byte_array_append_uint16(hdr, fu_chunk_get_data_sz(chk), G_LITTLE_ENDIAN);
-		if (!fu_cab_firmware_compute_checksum(hdr->data, hdr->len, &checksum, error))
+		for (guint j = i; j < batch_end; j++) {
+			g_autoptr(FuChunk) chk = NULL;
+			g_autoptr(FuCabFirmwareWriteJob) job = g_new0(FuCabFirmwareWriteJob, 1);
+
+			chk = fu_chunk_array_index(chunks, j, error);
+			if (chk == NULL)
+				return NULL;
+			job->blob = fu_chunk_get_bytes(chk);
+			job->compressed = priv->compressed;
+			g_ptr_array_add(jobs, g_steal_pointer(&job));
+		}
+		if (!fu_firmware_parallel_foreach(jobs,
+						  priv->compressed ? FU_FIRMWARE_PARSE_FLAG_PARALLEL
+								   : FU_FIRMWARE_PARSE_FLAG_NONE,
+						  fu_cab_firmware_write_job_cb,
+						  NULL,
+						  error))
 			return NULL;
 
-		fu_struct_cab_data_set_checksum(st_data, checksum);
-		fu_struct_cab_data_set_comp(st_data, chunk_zlib->len);
-		fu_struct_cab_data_set_uncomp(st_data, fu_chunk_get_data_sz(chk));
-		fu_byte_array_append_array(st_hdr->buf, st_data->buf);
-		g_byte_array_append(st_hdr->buf, chunk_zlib->data, chunk_zlib->len);
+		/* add in order */
+		for (guint j = 0; j < jobs->len; j++) {
+			FuCabFirmwareWriteJob *job = g_ptr_array_index(jobs, j);
+			if (!fu_size_checked_inc(&archive_size, FU_STRUCT_CAB_DATA_SIZE, error))
+				return NULL;
+			if (!fu_size_checked_inc(&archive_size, job->buf->len, error))
+				return NULL;
+			if (archive_size > G_MAXUINT32) {
+				g_autofree gchar *sz_val = g_format_size(archive_size);
+				g_set_error(error,
+					    FWUPD_ERROR,
+					    FWUPD_ERROR_INVALID_DATA,
+					    "archive size %s exceeds CAB format limit",
+					    sz_val);
+				return NULL;
+			}
+			if (!fu_cab_firmware_write_cfdata(st_hdr->buf, job, error))
+				return NULL;
+		}
 	}
+	fu_struct_cab_header_set_size(st_hdr, (guint32)archive_size);
 
 	/* success */
 	return g_steal_pointer(&st_hdr->buf);
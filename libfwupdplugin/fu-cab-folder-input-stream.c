@@ -0,0 +1,464 @@
+/*
+ * Copyright 2026 Richard Hughes <richard@hughsie.com>
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ */
+
+#define G_LOG_DOMAIN "FuCabFirmware"
+
+#include "config.h"
+
+#include <zlib.h>
+
+#include "fu-byte-array.h"
+#include "fu-cab-folder-input-stream.h"
+#include "fu-common.h"
+#include "fu-input-stream.h"
+
+/**
+ * FuCabFolderInputStream:
+ *
+ * A seekable input stream of the uncompressed data in a MSZIP cabinet folder, where each CFDATA
+ * block is only inflated when it is read.
+ *
+ * Each block uses the uncompressed data of the previous block as the deflate dictionary, so a
+ * copy of the previous block is kept at regular intervals to avoid inflating from the start of
+ * the folder when seeking backwards.
+ */
+
+typedef struct {
+	gsize offset_comp; /* of base_stream, including the CK signature */
+	gsize size_comp;
+	gsize offset; /* uncompressed */
+	gsize size;
+	GBytes *dictionary; /* nullable */
+} FuCabFolderInputStreamBlock;
+
+struct _FuCabFolderInputStream {
+	GInputStream parent_instance;
+	GInputStream *base_stream;
+	GArray *blocks; /* of FuCabFolderInputStreamBlock */
+	gsize size;
+	goffset pos;
+	z_stream zstrm;
+	GBytes *buf; /* uncompressed data of @buf_idx */
+	guint buf_idx;
+};
+
+static void
+fu_cab_folder_input_stream_seekable_iface_init(GSeekableIface *iface);
+
+G_DEFINE_TYPE_WITH_CODE(FuCabFolderInputStream,
+			fu_cab_folder_input_stream,
+			G_TYPE_INPUT_STREAM,
+			G_IMPLEMENT_INTERFACE(G_TYPE_SEEKABLE,
+					      fu_cab_folder_input_stream_seekable_iface_init))
+
+#define FU_CAB_FOLDER_INPUT_STREAM_CHECKPOINT_INTERVAL 8 /* blocks */
+
+static voidpf
+fu_cab_folder_input_stream_zalloc(voidpf opaque, uInt items, uInt size)
+{
+	return g_malloc0_n(items, size);
+}
+
+static void
+fu_cab_folder_input_stream_zfree(voidpf opaque, voidpf address)
+{
+	g_free(address);
+}
+
+/**
+ * fu_cab_folder_input_stream_add_block:
+ * @self: a #FuCabFolderInputStream
+ * @offset: offset of the compressed data in the base stream, including the `CK` signature
+ * @size_comp: size of the compressed data, including the `CK` signature
+ * @size: size of the uncompressed data
+ * @error: (nullable): optional return location for an error
+ *
+ * Adds the next CFDATA block of the folder. The block is not inflated until read.
+ *
+ * Returns: %TRUE for success
+ *
+ * Since: 2.1.6
+ **/
+gboolean
+fu_cab_folder_input_stream_add_block(FuCabFolderInputStream *self,
+				     gsize offset,
+				     gsize size_comp,
+				     gsize size,
+				     GError **error)
+{
+	FuCabFolderInputStreamBlock block = {
+	    .offset_comp = offset,
+	    .size_comp = size_comp,
+	    .offset = self->size,
+	    .size = size,
+	};
+
+	g_return_val_if_fail(FU_IS_CAB_FOLDER_INPUT_STREAM(self), FALSE);
+	g_return_val_if_fail(error == NULL || *error == NULL, FALSE);
+
+	if (size_comp <= 2 || size == 0) {
+		g_set_error(error,
+			    FWUPD_ERROR,
+			    FWUPD_ERROR_INVALID_DATA,
+			    "block sizes invalid (0x%x, 0x%x)",
+			    (guint)size_comp,
+			    (guint)size);
+		return FALSE;
+	}
+	if (size > 32 * FU_KB) {
+		g_set_error(error,
+			    FWUPD_ERROR,
+			    FWUPD_ERROR_INVALID_DATA,
+			    "dictionary size 0x%x exceeds zlib maximum",
+			    (guint)size);
+		return FALSE;
+	}
+	if (!fu_size_checked_inc(&self->size, size, error))
+		return FALSE;
+	g_array_append_val(self->blocks, block);
+	return TRUE;
+}
+
+static FuCabFolderInputStreamBlock *
+fu_cab_folder_input_stream_get_block(FuCabFolderInputStream *self, guint idx)
+{
+	return &g_array_index(self->blocks, FuCabFolderInputStreamBlock, idx);
+}
+
+/* binary search, as the blocks are sorted by offset */
+static guint
+fu_cab_folder_input_stream_find_block(FuCabFolderInputStream *self, gsize pos)
+{
+	guint lo = 0;
+	guint hi = self->blocks->len;
+	while (hi - lo > 1) {
+		guint mid = lo + (hi - lo) / 2;
+		if (fu_cab_folder_input_stream_get_block(self, mid)->offset <= pos)
+			lo = mid;
+		else
+			hi = mid;
+	}
+	return lo;
+}
+
+static GBytes *
+fu_cab_folder_input_stream_inflate_block(FuCabFolderInputStream *self,
+					 FuCabFolderInputStreamBlock *block,
+					 GBytes *dictionary,
+					 GError **error)
+{
+	int zret;
+	g_autoptr(GByteArray) buf = g_byte_array_new();
+	g_autoptr(GBytes) blob_comp = NULL;
+
+	/* skip the CK signature, which was verified when the block was added */
+	blob_comp = fu_input_stream_read_bytes(self->base_stream,
+					       block->offset_comp + 2,
+					       block->size_comp - 2,
+					       NULL,
+					       error);
+	if (blob_comp == NULL)
+		return NULL;
+
+	zret = inflateReset(&self->zstrm);
+	if (zret != Z_OK) {
+		g_set_error(error,
+			    FWUPD_ERROR,
+			    FWUPD_ERROR_NOT_SUPPORTED,
+			    "failed to reset inflate: %s",
+			    zError(zret));
+		return NULL;
+	}
+	if (dictionary != NULL) {
+		zret = inflateSetDictionary(&self->zstrm,
+					    g_bytes_get_data(dictionary, NULL),
+					    g_bytes_get_size(dictionary));
+		if (zret != Z_OK) {
+			g_set_error(error,
+				    FWUPD_ERROR,
+				    FWUPD_ERROR_NOT_SUPPORTED,
+				    "failed to set inflate dictionary: %s",
+				    zError(zret));
+			return NULL;
+		}
+	}
+
+	/* one extra byte so that too much data can be detected */
+	fu_byte_array_set_size(buf, block->size + 1, 0x0);
+	self->zstrm.next_in = (z_const Bytef *)g_bytes_get_data(blob_comp, NULL);
+	self->zstrm.avail_in = g_bytes_get_size(blob_comp);
+	self->zstrm.next_out = buf->data;
+	self->zstrm.avail_out = buf->len;
+	while (1) {
+		zret = inflate(&self->zstrm, Z_BLOCK);
+		if (self->zstrm.total_out > block->size) {
+			g_set_error(error,
+				    FWUPD_ERROR,
+				    FWUPD_ERROR_INVALID_DATA,
+				    "decompressed size mismatch (0x%x, specified 0x%x)",
+				    (guint)self->zstrm.total_out,
+				    (guint)block->size);
+			return NULL;
+		}
+		if (zret == Z_STREAM_END)
+			break;
+		if (zret != Z_OK) {
+			g_set_error(error,
+				    FWUPD_ERROR,
+				    FWUPD_ERROR_NOT_SUPPORTED,
+				    "inflate error @0x%x: %s",
+				    (guint)block->offset_comp,
+				    zError(zret));
+			return NULL;
+		}
+	}
+	if (self->zstrm.total_out != block->size) {
+		g_set_error(error,
+			    FWUPD_ERROR,
+			    FWUPD_ERROR_INVALID_DATA,
+			    "decompressed size mismatch (0x%x, specified 0x%x)",
+			    (guint)self->zstrm.total_out,
+			    (guint)block->size);
+		return NULL;
+	}
+	g_byte_array_set_size(buf, block->size);
+	return g_byte_array_free_to_bytes(g_steal_pointer(&buf));
+}
+
+/* inflate from the closest block where the dictionary is known */
+static gboolean
+fu_cab_folder_input_stream_ensure_block(FuCabFolderInputStream *self, guint idx, GError **error)
+{
+	guint idx_start = idx;
+
+	if (self->buf != NULL && self->buf_idx == idx)
+		return TRUE;
+	for (; idx_start > 0; idx_start--) {
+		FuCabFolderInputStreamBlock *block =
+		    fu_cab_folder_input_stream_get_block(self, idx_start);
+		if (self->buf != NULL && self->buf_idx == idx_start - 1)
+			break;
+		if (block->dictionary != NULL)
+			break;
+	}
+	for (guint i = idx_start; i <= idx; i++) {
+		FuCabFolderInputStreamBlock *block = fu_cab_folder_input_stream_get_block(self, i);
+		GBytes *dictionary = NULL;
+		g_autoptr(GBytes) buf = NULL;
+
+		if (i > 0) {
+			if (self->buf != NULL && self->buf_idx == i - 1)
+				dictionary = self->buf;
+			else
+				dictionary = block->dictionary;
+		}
+		buf = fu_cab_folder_input_stream_inflate_block(self, block, dictionary, error);
+		if (buf == NULL)
+			return FALSE;
+
+		/* save a checkpoint for the next block */
+		if ((i + 1) % FU_CAB_FOLDER_INPUT_STREAM_CHECKPOINT_INTERVAL == 0 &&
+		    i + 1 < self->blocks->len) {
+			FuCabFolderInputStreamBlock *block_next =
+			    fu_cab_folder_input_stream_get_block(self, i + 1);
+			if (block_next->dictionary == NULL)
+				block_next->dictionary = g_bytes_ref(buf);
+		}
+		if (self->buf != NULL)
+			g_bytes_unref(self->buf);
+		self->buf = g_steal_pointer(&buf);
+		self->buf_idx = i;
+	}
+	return TRUE;
+}
+
+static gssize
+fu_cab_folder_input_stream_read(GInputStream *stream,
+				void *buffer,
+				gsize count,
+				GCancellable *cancellable,
+				GError **error)
+{
+	FuCabFolderInputStream *self = FU_CAB_FOLDER_INPUT_STREAM(stream);
+	FuCabFolderInputStreamBlock *block;
+	const guint8 *buf;
+	guint idx;
+	gsize offset;
+	gsize done;
+
+	g_return_val_if_fail(FU_IS_CAB_FOLDER_INPUT_STREAM(self), -1);
+	g_return_val_if_fail(error == NULL || *error == NULL, -1);
+
+	if (count == 0 || (gsize)self->pos >= self->size)
+		return 0;
+	idx = fu_cab_folder_input_stream_find_block(self, self->pos);
+	if (!fu_cab_folder_input_stream_ensure_block(self, idx, error))
+		return -1;
+
+	/* only ever return data from one block */
+	block = fu_cab_folder_input_stream_get_block(self, idx);
+	offset = self->pos - block->offset;
+	done = MIN(count, block->size - offset);
+	buf = g_bytes_get_data(self->buf, NULL);
+	memcpy(buffer, buf + offset, done); /* nocheck:blocked */
+	self->pos += done;
+	return done;
+}
+
+static goffset
+fu_cab_folder_input_stream_tell(GSeekable *seekable)
+{
+	FuCabFolderInputStream *self = FU_CAB_FOLDER_INPUT_STREAM(seekable);
+	return self->pos;
+}
+
+static gboolean
+fu_cab_folder_input_stream_can_seek(GSeekable *seekable)
+{
+	return TRUE;
+}
+
+static gboolean
+fu_cab_folder_input_stream_seek(GSeekable *seekable,
+				goffset offset,
+				GSeekType type,
+				GCancellable *cancellable,
+				GError **error)
+{
+	FuCabFolderInputStream *self = FU_CAB_FOLDER_INPUT_STREAM(seekable);
+	goffset pos = offset;
+
+	g_return_val_if_fail(FU_IS_CAB_FOLDER_INPUT_STREAM(self), FALSE);
+	g_return_val_if_fail(error == NULL || *error == NULL, FALSE);
+
+	/* the data is only inflated when read */
+	if (type == G_SEEK_CUR)
+		pos = self->pos + offset;
+	if (type == G_SEEK_END)
+		pos = self->size + offset;
+	if (pos < 0 || (gsize)pos > self->size) {
+		g_set_error(error,
+			    FWUPD_ERROR,
+			    FWUPD_ERROR_INVALID_DATA,
+			    "cannot seek to 0x%x in folder of size 0x%x",
+			    (guint)pos,
+			    (guint)self->size);
+		return FALSE;
+	}
+	self->pos = pos;
+	return TRUE;
+}
+
+static gboolean
+fu_cab_folder_input_stream_can_truncate(GSeekable *seekable)
+{
+	return FALSE;
+}
+
+static gboolean
+fu_cab_folder_input_stream_truncate(GSeekable *seekable,
+				    goffset offset,
+				    GCancellable *cancellable,
+				    GError **error)
+{
+	g_set_error_literal(error,
+			    FWUPD_ERROR,
+			    FWUPD_ERROR_NOT_SUPPORTED,
+			    "cannot truncate FuCabFolderInputStream");
+	return FALSE;
+}
+
+static void
+fu_cab_folder_input_stream_seekable_iface_init(GSeekableIface *iface)
+{
+	iface->tell = fu_cab_folder_input_stream_tell;
+	iface->can_seek = fu_cab_folder_input_stream_can_seek;
+	iface->seek = fu_cab_folder_input_stream_seek;
+	iface->can_truncate = fu_cab_folder_input_stream_can_truncate;
+	iface->truncate_fn = fu_cab_folder_input_stream_truncate;
+}
+
+/**
+ * fu_cab_folder_input_stream_new:
+ * @stream: a base #GInputStream of the cabinet archive
+ * @error: (nullable): optional return location for an error
+ *
+ * Creates an input stream where the MSZIP folder data is inflated from the donor stream as it is
+ * read. The CFDATA blocks are added using fu_cab_folder_input_stream_add_block().
+ *
+ * Returns: (transfer full): a #FuCabFolderInputStream, or %NULL on error
+ *
+ * Since: 2.1.6
+ **/
+GInputStream *
+fu_cab_folder_input_stream_new(GInputStream *stream, GError **error)
+{
+	int zret;
+	g_autoptr(FuCabFolderInputStream) self =
+	    g_object_new(FU_TYPE_CAB_FOLDER_INPUT_STREAM, NULL);
+
+	g_return_val_if_fail(G_IS_INPUT_STREAM(stream), NULL);
+	g_return_val_if_fail(error == NULL || *error == NULL, NULL);
+
+	if (!G_IS_SEEKABLE(stream) || !g_seekable_can_seek(G_SEEKABLE(stream))) {
+		g_set_error_literal(error,
+				    FWUPD_ERROR,
+				    FWUPD_ERROR_NOT_SUPPORTED,
+				    "base stream is not seekable");
+		return NULL;
+	}
+	self->zstrm.zalloc = fu_cab_folder_input_stream_zalloc;
+	self->zstrm.zfree = fu_cab_folder_input_stream_zfree;
+	zret = inflateInit2(&self->zstrm, -MAX_WBITS);
+	if (zret != Z_OK) {
+		g_set_error(error,
+			    FWUPD_ERROR,
+			    FWUPD_ERROR_NOT_SUPPORTED,
+			    "failed to initialize inflate: %s",
+			    zError(zret));
+		return NULL;
+	}
+	self->base_stream = g_object_ref(stream);
+	return G_INPUT_STREAM(g_steal_pointer(&self));
+}
+
+static void
+fu_cab_folder_input_stream_block_clear(FuCabFolderInputStreamBlock *block)
+{
+	if (block->dictionary != NULL)
+		g_bytes_unref(block->dictionary);
+}
+
+static void
+fu_cab_folder_input_stream_finalize(GObject *object)
+{
+	FuCabFolderInputStream *self = FU_CAB_FOLDER_INPUT_STREAM(object);
+	if (self->base_stream != NULL) {
+		inflateEnd(&self->zstrm);
+		g_object_unref(self->base_stream);
+	}
+	if (self->buf != NULL)
+		g_bytes_unref(self->buf);
+	g_array_unref(self->blocks);
+	G_OBJECT_CLASS(fu_cab_folder_input_stream_parent_class)->finalize(object);
+}
+
+static void
+fu_cab_folder_input_stream_class_init(FuCabFolderInputStreamClass *klass)
+{
+	GObjectClass *object_class = G_OBJECT_CLASS(klass);
+	GInputStreamClass *istream_class = G_INPUT_STREAM_CLASS(klass);
+	istream_class->read_fn = fu_cab_folder_input_stream_read;
+	object_class->finalize = fu_cab_folder_input_stream_finalize;
+}
+
+static void
+fu_cab_folder_input_stream_init(FuCabFolderInputStream *self)
+{
+	self->blocks = g_array_new(FALSE, FALSE, sizeof(FuCabFolderInputStreamBlock));
+	g_array_set_clear_func(self->blocks,
+			       (GDestroyNotify)fu_cab_folder_input_stream_block_clear);
+}
@@ -0,0 +1,14 @@
+/*
+ * Copyright 2026 Richard Hughes <richard@hughsie.com>
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ */
+
+#pragma once
+
+#include "fu-decompress-input-stream.h"
+
+guint
+fu_decompress_input_stream_get_decoder_resets(FuDecompressInputStream *self) G_GNUC_NON_NULL(1);
+gboolean
+fu_decompress_input_stream_has_size(FuDecompressInputStream *self) G_GNUC_NON_NULL(1);
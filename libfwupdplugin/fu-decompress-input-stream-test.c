@@ -0,0 +1,469 @@
+/*
+ * Copyright 2026 Richard Hughes <richard@hughsie.com>
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ */
+
+#include "config.h"
+
+#include <fwupdplugin.h>
+#include <lzma.h>
+#ifdef HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+#include "fu-decompress-input-stream-private.h"
+
+/* larger than the history window, so that seeking backwards restarts the decoder */
+#define FU_DECOMPRESS_INPUT_STREAM_TEST_SIZE (3 * FU_MB)
+
+static GBytes *
+fu_decompress_input_stream_test_blob(void)
+{
+	g_autoptr(GByteArray) buf = g_byte_array_new();
+	for (guint i = 0; i < FU_DECOMPRESS_INPUT_STREAM_TEST_SIZE; i++)
+		fu_byte_array_append_uint8(buf, (i * 7) ^ (i >> 12));
+	return g_bytes_new(buf->data, buf->len);
+}
+
+static void
+fu_decompress_input_stream_check(GInputStream *stream, GBytes *blob)
+{
+	gboolean ret;
+	gsize streamsz = 0;
+	guint8 buf[4] = {0x0};
+	const guint8 *data = g_bytes_get_data(blob, NULL);
+	g_autofree gchar *str = NULL;
+	g_autoptr(GBytes) blob2 = NULL;
+	g_autoptr(GError) error = NULL;
+
+	/* seek forward without reading everything */
+	ret = fu_input_stream_read_safe(stream,
+					buf,
+					sizeof(buf),
+					0x0,	  /* offset */
+					0x200000, /* seek */
+					sizeof(buf),
+					&error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	g_assert_cmpint(memcmp(buf, data + 0x200000, sizeof(buf)), ==, 0);
+
+	/* inside the history window */
+	ret = fu_input_stream_read_safe(stream,
+					buf,
+					sizeof(buf),
+					0x0,	  /* offset */
+					0x1FF000, /* seek */
+					sizeof(buf),
+					&error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	g_assert_cmpint(memcmp(buf, data + 0x1FF000, sizeof(buf)), ==, 0);
+
+	/* size */
+	ret = fu_input_stream_size(stream, &streamsz, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	g_assert_cmpint(streamsz, ==, g_bytes_get_size(blob));
+
+	/* seek backwards to before the history window */
+	blob2 = fu_input_stream_read_bytes(stream, 0x0, streamsz, NULL, &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(blob2);
+	ret = fu_bytes_compare(blob2, blob, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+
+	/* past the end */
+	ret = fu_input_stream_read_safe(stream,
+					buf,
+					sizeof(buf),
+					0x0,	      /* offset */
+					streamsz - 2, /* seek */
+					sizeof(buf),
+					&error);
+	g_assert_error(error, FWUPD_ERROR, FWUPD_ERROR_READ);
+	g_assert_false(ret);
+	g_clear_error(&error);
+
+	str = fwupd_codec_to_string(FWUPD_CODEC(stream));
+	g_debug("%s", str);
+}
+
+static void
+fu_decompress_input_stream_lzma_func(void)
+{
+	g_autoptr(GBytes) blob = fu_decompress_input_stream_test_blob();
+	g_autoptr(GBytes) blob_xz = NULL;
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GInputStream) stream_xz = NULL;
+	g_autoptr(GInputStream) stream = NULL;
+
+	blob_xz = fu_lzma_compress_bytes(blob, &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(blob_xz);
+	stream_xz = g_memory_input_stream_new_from_bytes(blob_xz);
+	stream = fu_decompress_input_stream_new_lzma(stream_xz, G_MAXUINT64, &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(stream);
+	fu_decompress_input_stream_check_size(stream, blob);
+	fu_decompress_input_stream_check(stream, blob);
+}
+
+/* each block can be decoded without the blocks before it */
+static GBytes *
+fu_decompress_input_stream_test_xz_blocks(GBytes *blob, gsize blocksz)
+{
+	gsize blobsz = g_bytes_get_size(blob);
+	gsize bufsz = blobsz + 0x10000;
+	const guint8 *data = g_bytes_get_data(blob, NULL);
+	lzma_ret rc;
+	lzma_stream strm = LZMA_STREAM_INIT;
+	g_autofree guint8 *buf = g_malloc0(bufsz);
+	g_autoptr(GBytes) blob_xz = NULL;
+
+	rc = lzma_easy_encoder(&strm, 6, LZMA_CHECK_CRC64);
+	g_assert_cmpint(rc, ==, LZMA_OK);
+	strm.next_out = buf;
+	strm.avail_out = bufsz;
+	for (gsize offset = 0; offset < blobsz; offset += blocksz) {
+		strm.next_in = data + offset;
+		strm.avail_in = MIN(blocksz, blobsz - offset);
+		do {
+			rc = lzma_code(&strm, LZMA_FULL_FLUSH);
+		} while (rc == LZMA_OK);
+		g_assert_cmpint(rc, ==, LZMA_STREAM_END);
+	}
+	do {
+		rc = lzma_code(&strm, LZMA_FINISH);
+	} while (rc == LZMA_OK);
+	g_assert_cmpint(rc, ==, LZMA_STREAM_END);
+	blob_xz = g_bytes_new(buf, strm.total_out);
+	lzma_end(&strm);
+	return g_steal_pointer(&blob_xz);
+}
+
+/* the header used by EFI sections, where the size is optional */
+static GBytes *
+fu_decompress_input_stream_test_lzma_legacy(GBytes *blob, gboolean with_size)
+{
+	gsize bufsz = g_bytes_get_size(blob) + 0x10000;
+	lzma_options_lzma opts = {0};
+	lzma_ret rc;
+	lzma_stream strm = LZMA_STREAM_INIT;
+	g_autofree guint8 *buf = g_malloc0(bufsz);
+	g_autoptr(GBytes) blob_lzma = NULL;
+
+	g_assert_false(lzma_lzma_preset(&opts, 6));
+	rc = lzma_alone_encoder(&strm, &opts);
+	g_assert_cmpint(rc, ==, LZMA_OK);
+	strm.next_in = g_bytes_get_data(blob, NULL);
+	strm.avail_in = g_bytes_get_size(blob);
+	strm.next_out = buf;
+	strm.avail_out = bufsz;
+	do {
+		rc = lzma_code(&strm, LZMA_FINISH);
+	} while (rc == LZMA_OK);
+	g_assert_cmpint(rc, ==, LZMA_STREAM_END);
+
+	/* the encoder always writes an unknown size */
+	g_assert_cmpint(fu_memread_uint64(buf + 5, G_LITTLE_ENDIAN), ==, G_MAXUINT64);
+	if (with_size)
+		fu_memwrite_uint64(buf + 5, g_bytes_get_size(blob), G_LITTLE_ENDIAN);
+	blob_lzma = g_bytes_new(buf, strm.total_out);
+	lzma_end(&strm);
+	return g_steal_pointer(&blob_lzma);
+}
+
+/* the size is known without decoding, or is found without losing the decoder position */
+static void
+fu_decompress_input_stream_check_size(GInputStream *stream, GBytes *blob)
+{
+	gboolean ret;
+	gsize streamsz = 0;
+	guint8 buf[4] = {0x0};
+	const guint8 *data = g_bytes_get_data(blob, NULL);
+	g_autoptr(GError) error = NULL;
+
+	ret = fu_input_stream_read_safe(stream,
+					buf,
+					sizeof(buf),
+					0x0, /* offset */
+					0x0, /* seek */
+					sizeof(buf),
+					&error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	ret = fu_input_stream_size(stream, &streamsz, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	g_assert_cmpint(streamsz, ==, g_bytes_get_size(blob));
+	ret = fu_input_stream_read_safe(stream,
+					buf,
+					sizeof(buf),
+					0x0, /* offset */
+					0x4, /* seek */
+					sizeof(buf),
+					&error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	g_assert_cmpint(memcmp(buf, data + 0x4, sizeof(buf)), ==, 0);
+	g_assert_cmpint(
+	    fu_decompress_input_stream_get_decoder_resets(FU_DECOMPRESS_INPUT_STREAM(stream)),
+	    ==,
+	    0);
+}
+
+static void
+fu_decompress_input_stream_lzma_blocks_func(void)
+{
+	gboolean ret;
+	guint8 buf[4] = {0x0};
+	g_autoptr(GBytes) blob = fu_decompress_input_stream_test_blob();
+	g_autoptr(GBytes) blob_xz = NULL;
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GInputStream) stream_xz = NULL;
+	g_autoptr(GInputStream) stream = NULL;
+	const guint8 *data = g_bytes_get_data(blob, NULL);
+
+	blob_xz = fu_decompress_input_stream_test_xz_blocks(blob, 0x80000);
+	stream_xz = g_memory_input_stream_new_from_bytes(blob_xz);
+	stream = fu_decompress_input_stream_new_lzma(stream_xz, G_MAXUINT64, &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(stream);
+	fu_decompress_input_stream_check_size(stream, blob);
+
+	/* seek backwards to before the history window, which restarts from the block */
+	ret = fu_input_stream_read_safe(stream,
+					buf,
+					sizeof(buf),
+					0x0,	  /* offset */
+					0x2F0000, /* seek */
+					sizeof(buf),
+					&error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	g_assert_cmpint(memcmp(buf, data + 0x2F0000, sizeof(buf)), ==, 0);
+	ret = fu_input_stream_read_safe(stream,
+					buf,
+					sizeof(buf),
+					0x0,	 /* offset */
+					0x90000, /* seek */
+					sizeof(buf),
+					&error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	g_assert_cmpint(memcmp(buf, data + 0x90000, sizeof(buf)), ==, 0);
+	g_assert_cmpint(
+	    fu_decompress_input_stream_get_decoder_resets(FU_DECOMPRESS_INPUT_STREAM(stream)),
+	    ==,
+	    0);
+
+	/* decoding continues into the next block */
+	fu_decompress_input_stream_check(stream, blob);
+}
+
+static void
+fu_decompress_input_stream_lzma_legacy_func(void)
+{
+	g_autoptr(GBytes) blob = fu_decompress_input_stream_test_blob();
+	g_autoptr(GBytes) blob_lzma = fu_decompress_input_stream_test_lzma_legacy(blob, TRUE);
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GInputStream) stream_lzma = NULL;
+	g_autoptr(GInputStream) stream = NULL;
+
+	stream_lzma = g_memory_input_stream_new_from_bytes(blob_lzma);
+	stream = fu_decompress_input_stream_new_lzma(stream_lzma, G_MAXUINT64, &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(stream);
+	fu_decompress_input_stream_check_size(stream, blob);
+	fu_decompress_input_stream_check(stream, blob);
+}
+
+static void
+fu_decompress_input_stream_lzma_legacy_no_size_func(void)
+{
+	g_autoptr(GBytes) blob = fu_decompress_input_stream_test_blob();
+	g_autoptr(GBytes) blob_lzma = fu_decompress_input_stream_test_lzma_legacy(blob, FALSE);
+	g_autoptr(GBytes) blob2 = NULL;
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GInputStream) stream_lzma = NULL;
+	g_autoptr(GInputStream) stream = NULL;
+
+	stream_lzma = g_memory_input_stream_new_from_bytes(blob_lzma);
+	stream = fu_decompress_input_stream_new_lzma(stream_lzma, G_MAXUINT64, &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(stream);
+	g_assert_false(fu_decompress_input_stream_has_size(FU_DECOMPRESS_INPUT_STREAM(stream)));
+	fu_decompress_input_stream_check_size(stream, blob);
+	fu_decompress_input_stream_check(stream, blob);
+
+	/* reading everything also finds the size, without decoding it twice */
+	g_clear_object(&stream);
+	stream = fu_decompress_input_stream_new_lzma(stream_lzma, G_MAXUINT64, &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(stream);
+	blob2 = fu_input_stream_read_bytes(stream, 0x0, G_MAXSIZE, NULL, &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(blob2);
+	g_assert_cmpint(g_bytes_compare(blob2, blob), ==, 0);
+	g_assert_true(fu_decompress_input_stream_has_size(FU_DECOMPRESS_INPUT_STREAM(stream)));
+	g_assert_cmpint(
+	    fu_decompress_input_stream_get_decoder_resets(FU_DECOMPRESS_INPUT_STREAM(stream)),
+	    ==,
+	    0);
+}
+
+static void
+fu_decompress_input_stream_lzma_invalid_func(void)
+{
+	gboolean ret;
+	guint8 buf[4] = {0x0};
+	g_autoptr(GBytes) blob = g_bytes_new_static("\xFD" "7zXZ\0hello world", 16);
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GInputStream) stream_xz = g_memory_input_stream_new_from_bytes(blob);
+	g_autoptr(GInputStream) stream = NULL;
+
+	stream = fu_decompress_input_stream_new_lzma(stream_xz, G_MAXUINT64, &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(stream);
+	ret = fu_input_stream_read_safe(stream,
+					buf,
+					sizeof(buf),
+					0x0, /* offset */
+					0x0, /* seek */
+					sizeof(buf),
+					&error);
+	g_assert_error(error, FWUPD_ERROR, FWUPD_ERROR_INVALID_DATA);
+	g_assert_false(ret);
+}
+
+static void
+fu_decompress_input_stream_zstd_func(void)
+{
+#ifdef HAVE_ZSTD
+	gsize rc;
+	gsize bufsz;
+	g_autofree guint8 *buf = NULL;
+	g_autoptr(GBytes) blob = fu_decompress_input_stream_test_blob();
+	g_autoptr(GBytes) blob_zst = NULL;
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GInputStream) stream_zst = NULL;
+	g_autoptr(GInputStream) stream = NULL;
+
+	bufsz = ZSTD_compressBound(g_bytes_get_size(blob));
+	buf = g_malloc0(bufsz);
+	rc = ZSTD_compress(buf,
+			   bufsz,
+			   g_bytes_get_data(blob, NULL),
+			   g_bytes_get_size(blob),
+			   ZSTD_CLEVEL_DEFAULT);
+	g_assert_false(ZSTD_isError(rc));
+	blob_zst = g_bytes_new(buf, rc);
+	stream_zst = g_memory_input_stream_new_from_bytes(blob_zst);
+	stream = fu_decompress_input_stream_new_zstd(stream_zst, &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(stream);
+	fu_decompress_input_stream_check(stream, blob);
+#else
+	g_test_skip("no zstd support");
+#endif
+}
+
+
+static GBytes *
+fu_decompress_input_stream_test_deflate(GBytes *blob)
+{
+	g_autoptr(GBytes) blob_deflate = NULL;
+	g_autoptr(GConverter) conv = NULL;
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GInputStream) stream_conv = NULL;
+	g_autoptr(GInputStream) stream_raw = NULL;
+
+	conv = G_CONVERTER(g_zlib_compressor_new(G_ZLIB_COMPRESSOR_FORMAT_RAW, -1));
+	stream_raw = g_memory_input_stream_new_from_bytes(blob);
+	stream_conv = g_converter_input_stream_new(stream_raw, conv);
+	blob_deflate = fu_input_stream_read_bytes(stream_conv, 0, G_MAXSIZE, NULL, &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(blob_deflate);
+	return g_steal_pointer(&blob_deflate);
+}
+
+static void
+fu_decompress_input_stream_deflate_func(void)
+{
+	g_autoptr(GBytes) blob = fu_decompress_input_stream_test_blob();
+	g_autoptr(GBytes) blob_deflate = fu_decompress_input_stream_test_deflate(blob);
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GInputStream) stream_deflate = NULL;
+	g_autoptr(GInputStream) stream = NULL;
+
+	stream_deflate = g_memory_input_stream_new_from_bytes(blob_deflate);
+	stream = fu_decompress_input_stream_new_deflate(stream_deflate,
+							g_bytes_get_size(blob),
+							&error);
+	g_assert_no_error(error);
+	g_assert_nonnull(stream);
+	fu_decompress_input_stream_set_crc32(FU_DECOMPRESS_INPUT_STREAM(stream),
+					     fu_crc32_bytes(FU_CRC_KIND_B32_STANDARD, blob));
+	fu_decompress_input_stream_check(stream, blob);
+}
+
+static void
+fu_decompress_input_stream_deflate_crc_func(void)
+{
+	gboolean ret;
+	guint8 buf[4] = {0x0};
+	g_autoptr(GBytes) blob = fu_decompress_input_stream_test_blob();
+	g_autoptr(GBytes) blob_deflate = fu_decompress_input_stream_test_deflate(blob);
+	g_autoptr(GBytes) blob2 = NULL;
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GInputStream) stream_deflate = NULL;
+	g_autoptr(GInputStream) stream = NULL;
+
+	stream_deflate = g_memory_input_stream_new_from_bytes(blob_deflate);
+	stream = fu_decompress_input_stream_new_deflate(stream_deflate,
+							g_bytes_get_size(blob),
+							&error);
+	g_assert_no_error(error);
+	g_assert_nonnull(stream);
+	fu_decompress_input_stream_set_crc32(FU_DECOMPRESS_INPUT_STREAM(stream), 0xDEADBEEF);
+
+	/* the CRC is not known until the end */
+	ret = fu_input_stream_read_safe(stream,
+					buf,
+					sizeof(buf),
+					0x0, /* offset */
+					0x0, /* seek */
+					sizeof(buf),
+					&error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	blob2 = fu_input_stream_read_bytes(stream, 0x0, G_MAXSIZE, NULL, &error);
+	g_assert_error(error, FWUPD_ERROR, FWUPD_ERROR_INVALID_DATA);
+	g_assert_null(blob2);
+}
+
+int
+main(int argc, char **argv)
+{
+	g_test_init(&argc, &argv, NULL);
+	g_test_add_func("/fwupd/decompress-input-stream/lzma",
+			fu_decompress_input_stream_lzma_func);
+	g_test_add_func("/fwupd/decompress-input-stream/lzma/invalid",
+			fu_decompress_input_stream_lzma_invalid_func);
+	g_test_add_func("/fwupd/decompress-input-stream/lzma/blocks",
+			fu_decompress_input_stream_lzma_blocks_func);
+	g_test_add_func("/fwupd/decompress-input-stream/lzma/legacy",
+			fu_decompress_input_stream_lzma_legacy_func);
+	g_test_add_func("/fwupd/decompress-input-stream/lzma/legacy-no-size",
+			fu_decompress_input_stream_lzma_legacy_no_size_func);
+	g_test_add_func("/fwupd/decompress-input-stream/zstd",
+			fu_decompress_input_stream_zstd_func);
+	g_test_add_func("/fwupd/decompress-input-stream/deflate",
+			fu_decompress_input_stream_deflate_func);
+	g_test_add_func("/fwupd/decompress-input-stream/deflate/crc",
+			fu_decompress_input_stream_deflate_crc_func);
+	return g_test_run();
+}
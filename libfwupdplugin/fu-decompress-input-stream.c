@@ -0,0 +1,1040 @@
+/*
+ * Copyright 2026 Richard Hughes <richard@hughsie.com>
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ */
+
+#define G_LOG_DOMAIN "FuDecompressInputStream"
+
+#include "config.h"
+
+#include <lzma.h>
+#include <stdlib.h>
+#include <zlib.h>
+#ifdef HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+#include "fwupd-codec.h"
+
+#include "fu-common.h"
+#include "fu-crc-private.h"
+#include "fu-decompress-input-stream-private.h"
+#include "fu-firmware-profiler.h"
+#include "fu-input-stream.h"
+#include "fu-mem.h"
+
+/**
+ * FuDecompressInputStream:
+ *
+ * A seekable input stream that decompresses another input stream on demand.
+ *
+ * Only a window of the most recently decompressed data is kept in memory, so seeking forwards
+ * or a short distance backwards is cheap, but seeking further backwards restarts the decoder.
+ *
+ * For `.xz` files the index at the end of the stream is used for the decompressed size, and to
+ * restart the decoder from the start of the block containing the new position rather than from
+ * the start of the compressed stream.
+ */
+
+typedef enum {
+	FU_DECOMPRESS_INPUT_STREAM_FORMAT_LZMA,
+	FU_DECOMPRESS_INPUT_STREAM_FORMAT_ZSTD,
+	FU_DECOMPRESS_INPUT_STREAM_FORMAT_DEFLATE,
+} FuDecompressInputStreamFormat;
+
+struct _FuDecompressInputStream {
+	GInputStream parent_instance;
+	GInputStream *base_stream;
+	FuDecompressInputStreamFormat format;
+	guint64 memlimit;
+	lzma_stream lzma;
+	lzma_index *xz_index;	 /* of a single-stream .xz file, or NULL */
+	lzma_index_iter xz_iter; /* the block being decoded */
+	lzma_block xz_block;	 /* referenced by the block decoder */
+	gboolean xz_block_mode;	 /* decoding a block at a time using @xz_iter */
+#ifdef HAVE_ZSTD
+	ZSTD_DStream *zstd;
+	gboolean zstd_frame_done;
+#endif
+	z_stream zlib;
+	gboolean zlib_init;
+	guint8 *buf_in;
+	gsize buf_in_pos;
+	gsize buf_in_len;
+	goffset offset_in; /* of base_stream */
+	gboolean eof;
+	gboolean profiled;
+	goffset pos;	      /* where the next read is from */
+	goffset decoded;      /* total number of bytes output by the decoder */
+	GByteArray *history;  /* the data that ends at @decoded */
+	gsize size;	      /* or G_MAXSIZE if not known */
+	gboolean verify;      /* the size is declared, so check it at the end */
+	gboolean verified;
+	gboolean has_crc;
+	guint32 crc_expected;
+	guint32 crc;	      /* of the data decoded so far */
+	guint decoder_resets; /* for debugging */
+};
+
+static void
+fu_decompress_input_stream_seekable_iface_init(GSeekableIface *iface);
+static void
+fu_decompress_input_stream_codec_iface_init(FwupdCodecInterface *iface);
+
+G_DEFINE_TYPE_WITH_CODE(FuDecompressInputStream,
+			fu_decompress_input_stream,
+			G_TYPE_INPUT_STREAM,
+			G_IMPLEMENT_INTERFACE(G_TYPE_SEEKABLE,
+					      fu_decompress_input_stream_seekable_iface_init)
+			    G_IMPLEMENT_INTERFACE(FWUPD_TYPE_CODEC,
+						  fu_decompress_input_stream_codec_iface_init))
+
+#define FU_DECOMPRESS_INPUT_STREAM_BUFSZ      0x8000
+#define FU_DECOMPRESS_INPUT_STREAM_HISTORY_SZ (1 * FU_MB)
+
+static const gchar *
+fu_decompress_input_stream_format_to_string(FuDecompressInputStreamFormat format)
+{
+	if (format == FU_DECOMPRESS_INPUT_STREAM_FORMAT_LZMA)
+		return "lzma";
+	if (format == FU_DECOMPRESS_INPUT_STREAM_FORMAT_ZSTD)
+		return "zstd";
+	if (format == FU_DECOMPRESS_INPUT_STREAM_FORMAT_DEFLATE)
+		return "deflate";
+	return NULL;
+}
+
+static void
+fu_decompress_input_stream_add_string(FwupdCodec *codec, guint idt, GString *str)
+{
+	FuDecompressInputStream *self = FU_DECOMPRESS_INPUT_STREAM(codec);
+	fwupd_codec_string_append(str,
+				  idt,
+				  "Format",
+				  fu_decompress_input_stream_format_to_string(self->format));
+	fwupd_codec_string_append_hex(str, idt, "Position", self->pos);
+	fwupd_codec_string_append_hex(str, idt, "Decoded", self->decoded);
+	if (self->size != G_MAXSIZE)
+		fwupd_codec_string_append_hex(str, idt, "Size", self->size);
+	if (self->has_crc)
+		fwupd_codec_string_append_hex(str, idt, "Crc", self->crc_expected);
+	if (self->xz_index != NULL) {
+		fwupd_codec_string_append_int(str,
+					      idt,
+					      "XzBlocks",
+					      lzma_index_block_count(self->xz_index));
+	}
+	fwupd_codec_string_append_int(str, idt, "DecoderResets", self->decoder_resets);
+}
+
+static void
+fu_decompress_input_stream_codec_iface_init(FwupdCodecInterface *iface)
+{
+	iface->add_string = fu_decompress_input_stream_add_string;
+}
+
+static gboolean
+fu_decompress_input_stream_reset(FuDecompressInputStream *self, GError **error)
+{
+	self->buf_in_pos = 0;
+	self->buf_in_len = 0;
+	self->offset_in = 0;
+	self->eof = FALSE;
+	self->decoded = 0;
+	self->verified = FALSE;
+	self->crc = 0;
+	self->xz_block_mode = FALSE;
+	g_byte_array_set_size(self->history, 0);
+
+	if (self->format == FU_DECOMPRESS_INPUT_STREAM_FORMAT_LZMA) {
+		lzma_ret rc;
+		lzma_end(&self->lzma);
+		memset(&self->lzma, 0, sizeof(self->lzma));
+		rc = lzma_auto_decoder(&self->lzma, self->memlimit, LZMA_TELL_UNSUPPORTED_CHECK);
+		if (rc != LZMA_OK) {
+			g_set_error(error,
+				    FWUPD_ERROR,
+				    FWUPD_ERROR_NOT_SUPPORTED,
+				    "failed to set up LZMA decoder rc=%u",
+				    rc);
+			return FALSE;
+		}
+		return TRUE;
+	}
+#ifdef HAVE_ZSTD
+	if (self->format == FU_DECOMPRESS_INPUT_STREAM_FORMAT_ZSTD) {
+		gsize rc;
+		if (self->zstd == NULL)
+			self->zstd = ZSTD_createDStream();
+		rc = ZSTD_DCtx_reset(self->zstd, ZSTD_reset_session_only);
+		if (ZSTD_isError(rc)) {
+			g_set_error(error,
+				    FWUPD_ERROR,
+				    FWUPD_ERROR_NOT_SUPPORTED,
+				    "failed to set up zstd decoder: %s",
+				    ZSTD_getErrorName(rc));
+			return FALSE;
+		}
+		self->zstd_frame_done = FALSE;
+		return TRUE;
+	}
+#endif
+	if (self->format == FU_DECOMPRESS_INPUT_STREAM_FORMAT_DEFLATE) {
+		int zret;
+		if (self->zlib_init) {
+			zret = inflateReset(&self->zlib);
+		} else {
+			zret = inflateInit2(&self->zlib, -MAX_WBITS);
+			self->zlib_init = zret == Z_OK;
+		}
+		if (zret != Z_OK) {
+			g_set_error(error,
+				    FWUPD_ERROR,
+				    FWUPD_ERROR_NOT_SUPPORTED,
+				    "failed to set up deflate decoder: %s",
+				    zError(zret));
+			return FALSE;
+		}
+		return TRUE;
+	}
+	g_set_error_literal(error,
+			    FWUPD_ERROR,
+			    FWUPD_ERROR_NOT_SUPPORTED,
+			    "decompression format not supported");
+	return FALSE;
+}
+
+/* returns the number of bytes read, or 0 at the end of the compressed stream */
+static gssize
+fu_decompress_input_stream_fill(FuDecompressInputStream *self,
+				GCancellable *cancellable,
+				GError **error)
+{
+	gssize rc;
+
+	/* the base stream may be shared, so always seek */
+	if (!g_seekable_seek(G_SEEKABLE(self->base_stream),
+			     self->offset_in,
+			     G_SEEK_SET,
+			     cancellable,
+			     error))
+		return -1;
+	rc = g_input_stream_read(self->base_stream,
+				 self->buf_in,
+				 FU_DECOMPRESS_INPUT_STREAM_BUFSZ,
+				 cancellable,
+				 error);
+	if (rc < 0)
+		return -1;
+	self->buf_in_pos = 0;
+	self->buf_in_len = rc;
+	self->offset_in += rc;
+	return rc;
+}
+
+/* set up the block decoder for the block at @xz_iter, skipping the block header */
+static gboolean
+fu_decompress_input_stream_xz_block_start(FuDecompressInputStream *self, GError **error)
+{
+	guint8 hdr[LZMA_BLOCK_HEADER_SIZE_MAX] = {0x0};
+	guint8 hdr_size_raw = 0;
+	guint64 memusage;
+	lzma_block block = {.version = 1, .check = self->xz_iter.stream.flags->check};
+	lzma_filter filters[LZMA_FILTERS_MAX + 1] = {{.id = LZMA_VLI_UNKNOWN}};
+	lzma_ret rc;
+
+	/* the header size is encoded in the first byte */
+	if (!fu_input_stream_read_u8(self->base_stream,
+				     self->xz_iter.block.compressed_file_offset,
+				     &hdr_size_raw,
+				     error))
+		return FALSE;
+	block.header_size = lzma_block_header_size_decode(hdr_size_raw);
+	if (!fu_input_stream_read_safe(self->base_stream,
+				       hdr,
+				       sizeof(hdr),
+				       0x0,
+				       self->xz_iter.block.compressed_file_offset,
+				       block.header_size,
+				       error))
+		return FALSE;
+	block.filters = filters;
+	rc = lzma_block_header_decode(&block, NULL, hdr);
+	if (rc != LZMA_OK) {
+		g_set_error(error,
+			    FWUPD_ERROR,
+			    FWUPD_ERROR_INVALID_DATA,
+			    "failed to parse XZ block header rc=%u",
+			    rc);
+		return FALSE;
+	}
+
+	/* the block decoder has no memory limit of its own, and copies the filter options */
+	memusage = lzma_raw_decoder_memusage(filters);
+	rc = lzma_block_compressed_size(&block, self->xz_iter.block.unpadded_size);
+	if (rc == LZMA_OK && memusage <= self->memlimit) {
+		lzma_end(&self->lzma);
+		memset(&self->lzma, 0, sizeof(self->lzma));
+		self->xz_block = block;
+		rc = lzma_block_decoder(&self->lzma, &self->xz_block);
+		self->xz_block.filters = NULL;
+	}
+	for (guint i = 0; filters[i].id != LZMA_VLI_UNKNOWN; i++)
+		free(filters[i].options);
+	if (memusage > self->memlimit) {
+		g_set_error(error,
+			    FWUPD_ERROR,
+			    FWUPD_ERROR_INVALID_DATA,
+			    "XZ block requires 0x%x bytes of memory",
+			    (guint)MIN(memusage, G_MAXUINT));
+		return FALSE;
+	}
+	if (rc != LZMA_OK) {
+		g_set_error(error,
+			    FWUPD_ERROR,
+			    FWUPD_ERROR_INVALID_DATA,
+			    "failed to set up XZ block decoder rc=%u",
+			    rc);
+		return FALSE;
+	}
+	self->buf_in_pos = 0;
+	self->buf_in_len = 0;
+	self->offset_in = self->xz_iter.block.compressed_file_offset + block.header_size;
+	self->xz_block_mode = TRUE;
+	return TRUE;
+}
+
+/* restart the decoder from the start of the .xz block that contains @pos */
+static gboolean
+fu_decompress_input_stream_xz_block_seek(FuDecompressInputStream *self,
+					 goffset pos,
+					 gboolean *found,
+					 GError **error)
+{
+	lzma_index_iter_init(&self->xz_iter, self->xz_index);
+	if (lzma_index_iter_locate(&self->xz_iter, pos))
+		return TRUE;
+	if (self->xz_iter.block.uncompressed_file_offset == 0)
+		return TRUE;
+	if (!fu_decompress_input_stream_xz_block_start(self, error))
+		return FALSE;
+	self->eof = FALSE;
+	self->verified = FALSE;
+	self->decoded = self->xz_iter.block.uncompressed_file_offset;
+	g_byte_array_set_size(self->history, 0);
+	*found = TRUE;
+	return TRUE;
+}
+
+static gssize
+fu_decompress_input_stream_decode_lzma(FuDecompressInputStream *self,
+				       guint8 *buf,
+				       gsize bufsz,
+				       GCancellable *cancellable,
+				       GError **error)
+{
+	lzma_action action = LZMA_RUN;
+
+	self->lzma.next_out = buf;
+	self->lzma.avail_out = bufsz;
+	while (self->lzma.avail_out == bufsz) {
+		lzma_ret rc;
+
+		/* get more input */
+		if (self->buf_in_pos == self->buf_in_len) {
+			gssize sz = fu_decompress_input_stream_fill(self, cancellable, error);
+			if (sz < 0)
+				return -1;
+			if (sz == 0)
+				action = LZMA_FINISH;
+		}
+		self->lzma.next_in = self->buf_in + self->buf_in_pos;
+		self->lzma.avail_in = self->buf_in_len - self->buf_in_pos;
+		rc = lzma_code(&self->lzma, action);
+		self->buf_in_pos = self->buf_in_len - self->lzma.avail_in;
+		if (rc == LZMA_STREAM_END && self->xz_block_mode &&
+		    !lzma_index_iter_next(&self->xz_iter, LZMA_INDEX_ITER_BLOCK)) {
+			guint8 *next_out = self->lzma.next_out;
+			gsize avail_out = self->lzma.avail_out;
+			if (!fu_decompress_input_stream_xz_block_start(self, error))
+				return -1;
+			self->lzma.next_out = next_out;
+			self->lzma.avail_out = avail_out;
+			action = LZMA_RUN;
+			continue;
+		}
+		if (rc == LZMA_STREAM_END) {
+			self->eof = TRUE;
+			break;
+		}
+		if (rc != LZMA_OK) {
+			g_set_error(error,
+				    FWUPD_ERROR,
+				    FWUPD_ERROR_INVALID_DATA,
+				    "failed to decode LZMA data rc=%u",
+				    rc);
+			return -1;
+		}
+	}
+	return bufsz - self->lzma.avail_out;
+}
+
+#ifdef HAVE_ZSTD
+static gssize
+fu_decompress_input_stream_decode_zstd(FuDecompressInputStream *self,
+				       guint8 *buf,
+				       gsize bufsz,
+				       GCancellable *cancellable,
+				       GError **error)
+{
+	ZSTD_outBuffer out = {.dst = buf, .size = bufsz, .pos = 0};
+
+	while (out.pos == 0) {
+		gsize rc;
+		ZSTD_inBuffer in = {0};
+
+		/* get more input */
+		if (self->buf_in_pos == self->buf_in_len) {
+			gssize sz = fu_decompress_input_stream_fill(self, cancellable, error);
+			if (sz < 0)
+				return -1;
+			if (sz == 0) {
+				if (!self->zstd_frame_done) {
+					g_set_error_literal(error,
+							    FWUPD_ERROR,
+							    FWUPD_ERROR_INVALID_DATA,
+							    "zstd data is truncated");
+					return -1;
+				}
+				self->eof = TRUE;
+				break;
+			}
+		}
+		in.src = self->buf_in;
+		in.size = self->buf_in_len;
+		in.pos = self->buf_in_pos;
+		rc = ZSTD_decompressStream(self->zstd, &out, &in);
+		self->buf_in_pos = in.pos;
+		if (ZSTD_isError(rc)) {
+			g_set_error(error,
+				    FWUPD_ERROR,
+				    FWUPD_ERROR_INVALID_DATA,
+				    "failed to decode zstd data: %s",
+				    ZSTD_getErrorName(rc));
+			return -1;
+		}
+		self->zstd_frame_done = rc == 0;
+	}
+	return out.pos;
+}
+#endif
+
+static gssize
+fu_decompress_input_stream_decode_deflate(FuDecompressInputStream *self,
+					  guint8 *buf,
+					  gsize bufsz,
+					  GCancellable *cancellable,
+					  GError **error)
+{
+	self->zlib.next_out = buf;
+	self->zlib.avail_out = bufsz;
+	while (self->zlib.avail_out == bufsz) {
+		int zret;
+
+		/* get more input */
+		if (self->buf_in_pos == self->buf_in_len) {
+			gssize sz = fu_decompress_input_stream_fill(self, cancellable, error);
+			if (sz < 0)
+				return -1;
+			if (sz == 0) {
+				g_set_error_literal(error,
+						    FWUPD_ERROR,
+						    FWUPD_ERROR_INVALID_DATA,
+						    "deflate data is truncated");
+				return -1;
+			}
+		}
+		self->zlib.next_in = self->buf_in + self->buf_in_pos;
+		self->zlib.avail_in = self->buf_in_len - self->buf_in_pos;
+		zret = inflate(&self->zlib, Z_NO_FLUSH);
+		self->buf_in_pos = self->buf_in_len - self->zlib.avail_in;
+		if (zret == Z_STREAM_END) {
+			self->eof = TRUE;
+			break;
+		}
+		if (zret != Z_OK) {
+			g_set_error(error,
+				    FWUPD_ERROR,
+				    FWUPD_ERROR_INVALID_DATA,
+				    "failed to decode deflate data: %s",
+				    zError(zret));
+			return -1;
+		}
+	}
+	return bufsz - self->zlib.avail_out;
+}
+
+/* check the declared size and CRC once all the data has been decoded */
+static gboolean
+fu_decompress_input_stream_verify(FuDecompressInputStream *self, GError **error)
+{
+	if (!self->verify || self->verified)
+		return TRUE;
+	if (!self->eof && self->decoded < (goffset)self->size)
+		return TRUE;
+	if (self->decoded != (goffset)self->size) {
+		g_set_error(error,
+			    FWUPD_ERROR,
+			    FWUPD_ERROR_INVALID_DATA,
+			    "invalid decompression, got 0x%x bytes but expected 0x%x",
+			    (guint)self->decoded,
+			    (guint)self->size);
+		return FALSE;
+	}
+	if (self->has_crc && self->crc != self->crc_expected) {
+		g_set_error(error,
+			    FWUPD_ERROR,
+			    FWUPD_ERROR_INVALID_DATA,
+			    "CRC 0x%08x invalid, expected 0x%08x",
+			    self->crc,
+			    self->crc_expected);
+		return FALSE;
+	}
+	self->verified = TRUE;
+	return TRUE;
+}
+
+/* decompress the next chunk, adding it to the history window */
+static gssize
+fu_decompress_input_stream_decode(FuDecompressInputStream *self,
+				  guint8 *buf,
+				  gsize bufsz,
+				  GCancellable *cancellable,
+				  GError **error)
+{
+	gssize rc = 0;
+
+	if (self->eof)
+		return 0;
+	if (self->format == FU_DECOMPRESS_INPUT_STREAM_FORMAT_LZMA)
+		rc = fu_decompress_input_stream_decode_lzma(self, buf, bufsz, cancellable, error);
+#ifdef HAVE_ZSTD
+	if (self->format == FU_DECOMPRESS_INPUT_STREAM_FORMAT_ZSTD)
+		rc = fu_decompress_input_stream_decode_zstd(self, buf, bufsz, cancellable, error);
+#endif
+	if (self->format == FU_DECOMPRESS_INPUT_STREAM_FORMAT_DEFLATE) {
+		rc = fu_decompress_input_stream_decode_deflate(self,
+							       buf,
+							       bufsz,
+							       cancellable,
+							       error);
+	}
+	if (rc < 0)
+		return rc;
+	if (self->eof && !self->profiled) {
+		fu_firmware_profiler_add_decompressed(self->offset_in, self->decoded + rc);
+		self->profiled = TRUE;
+	}
+	if (rc > 0) {
+		self->decoded += rc;
+		if (self->has_crc)
+			self->crc = fu_crc32_fast(buf, rc, self->crc);
+	}
+	if (!fu_decompress_input_stream_verify(self, error))
+		return -1;
+	if (rc == 0)
+		return rc;
+
+	/* only trim occasionally so the memmove is amortized */
+	g_byte_array_append(self->history, buf, rc);
+	if (self->history->len > 2 * FU_DECOMPRESS_INPUT_STREAM_HISTORY_SZ) {
+		g_byte_array_remove_range(self->history,
+					  0,
+					  self->history->len -
+					      FU_DECOMPRESS_INPUT_STREAM_HISTORY_SZ);
+	}
+	return rc;
+}
+
+/* decompress up to @pos, discarding the data */
+static gboolean
+fu_decompress_input_stream_skip_to(FuDecompressInputStream *self,
+				   goffset pos,
+				   GCancellable *cancellable,
+				   GError **error)
+{
+	g_autofree guint8 *buf = NULL;
+
+	/* the start of the history has been discarded */
+	if (pos < self->decoded - (goffset)self->history->len) {
+		gboolean found = FALSE;
+		if (self->xz_index != NULL &&
+		    !fu_decompress_input_stream_xz_block_seek(self, pos, &found, error))
+			return FALSE;
+		if (!found) {
+			self->decoder_resets++;
+			if (!fu_decompress_input_stream_reset(self, error))
+				return FALSE;
+		}
+	}
+	while (self->decoded < pos) {
+		gssize rc;
+		if (buf == NULL)
+			buf = g_malloc(FU_DECOMPRESS_INPUT_STREAM_BUFSZ);
+		rc = fu_decompress_input_stream_decode(
+		    self,
+		    buf,
+		    MIN(FU_DECOMPRESS_INPUT_STREAM_BUFSZ, pos - self->decoded),
+		    cancellable,
+		    error);
+		if (rc < 0)
+			return FALSE;
+		if (rc == 0)
+			break;
+	}
+	return TRUE;
+}
+
+static GInputStream *
+fu_decompress_input_stream_new(GInputStream *stream,
+			       FuDecompressInputStreamFormat format,
+			       guint64 memlimit,
+			       GError **error);
+
+static gboolean
+fu_decompress_input_stream_ensure_size(FuDecompressInputStream *self,
+				       GCancellable *cancellable,
+				       GError **error)
+{
+	FuDecompressInputStream *helper;
+	g_autoptr(GInputStream) stream_tmp = NULL;
+
+	if (self->size != G_MAXSIZE)
+		return TRUE;
+	if (self->eof) {
+		self->size = self->decoded;
+		return TRUE;
+	}
+
+	/* decode to the end using another decoder so that this one keeps its position */
+	stream_tmp = fu_decompress_input_stream_new(self->base_stream,
+						    self->format,
+						    self->memlimit,
+						    error);
+	if (stream_tmp == NULL)
+		return FALSE;
+	helper = FU_DECOMPRESS_INPUT_STREAM(stream_tmp);
+	helper->profiled = TRUE;
+	if (!fu_decompress_input_stream_skip_to(helper, G_MAXINT64, cancellable, error))
+		return FALSE;
+	self->size = helper->decoded;
+	return TRUE;
+}
+
+static gssize
+fu_decompress_input_stream_read(GInputStream *stream,
+				void *buffer,
+				gsize count,
+				GCancellable *cancellable,
+				GError **error)
+{
+	FuDecompressInputStream *self = FU_DECOMPRESS_INPUT_STREAM(stream);
+	gsize done = 0;
+
+	g_return_val_if_fail(FU_IS_DECOMPRESS_INPUT_STREAM(self), -1);
+	g_return_val_if_fail(error == NULL || *error == NULL, -1);
+
+	if (count == 0)
+		return 0;
+
+	/* never return more than the declared size */
+	if (self->size != G_MAXSIZE) {
+		if ((gsize)self->pos >= self->size)
+			return 0;
+		count = MIN(count, self->size - self->pos);
+	}
+	if (!fu_decompress_input_stream_skip_to(self, self->pos, cancellable, error))
+		return -1;
+
+	/* in the history window */
+	if (self->pos < self->decoded) {
+		gsize offset = self->history->len - (self->decoded - self->pos);
+		done = MIN(count, (gsize)(self->decoded - self->pos));
+		memcpy(buffer, self->history->data + offset, done); /* nocheck:blocked */
+		self->pos += done;
+	}
+
+	/* decompress straight into the caller buffer */
+	while (done < count && self->pos == self->decoded) {
+		gssize rc = fu_decompress_input_stream_decode(self,
+							      (guint8 *)buffer + done,
+							      count - done,
+							      cancellable,
+							      error);
+		if (rc < 0)
+			return -1;
+		if (rc == 0) {
+			if (self->size == G_MAXSIZE)
+				self->size = self->decoded;
+			break;
+		}
+		self->pos += rc;
+		done += rc;
+	}
+	return done;
+}
+
+static goffset
+fu_decompress_input_stream_tell(GSeekable *seekable)
+{
+	FuDecompressInputStream *self = FU_DECOMPRESS_INPUT_STREAM(seekable);
+	return self->pos;
+}
+
+static gboolean
+fu_decompress_input_stream_can_seek(GSeekable *seekable)
+{
+	return TRUE;
+}
+
+static gboolean
+fu_decompress_input_stream_seek(GSeekable *seekable,
+				goffset offset,
+				GSeekType type,
+				GCancellable *cancellable,
+				GError **error)
+{
+	FuDecompressInputStream *self = FU_DECOMPRESS_INPUT_STREAM(seekable);
+	goffset pos = offset;
+
+	g_return_val_if_fail(FU_IS_DECOMPRESS_INPUT_STREAM(self), FALSE);
+	g_return_val_if_fail(error == NULL || *error == NULL, FALSE);
+
+	/* the data is only decompressed when read */
+	if (type == G_SEEK_CUR)
+		pos = self->pos + offset;
+	if (type == G_SEEK_END) {
+		if (!fu_decompress_input_stream_ensure_size(self, cancellable, error))
+			return FALSE;
+		pos = self->size + offset;
+	}
+	if (pos < 0) {
+		g_set_error_literal(error,
+				    FWUPD_ERROR,
+				    FWUPD_ERROR_INVALID_DATA,
+				    "cannot seek before the start");
+		return FALSE;
+	}
+	self->pos = pos;
+	return TRUE;
+}
+
+static gboolean
+fu_decompress_input_stream_can_truncate(GSeekable *seekable)
+{
+	return FALSE;
+}
+
+static gboolean
+fu_decompress_input_stream_truncate(GSeekable *seekable,
+				    goffset offset,
+				    GCancellable *cancellable,
+				    GError **error)
+{
+	g_set_error_literal(error,
+			    FWUPD_ERROR,
+			    FWUPD_ERROR_NOT_SUPPORTED,
+			    "cannot truncate FuDecompressInputStream");
+	return FALSE;
+}
+
+static void
+fu_decompress_input_stream_seekable_iface_init(GSeekableIface *iface)
+{
+	iface->tell = fu_decompress_input_stream_tell;
+	iface->can_seek = fu_decompress_input_stream_can_seek;
+	iface->seek = fu_decompress_input_stream_seek;
+	iface->can_truncate = fu_decompress_input_stream_can_truncate;
+	iface->truncate_fn = fu_decompress_input_stream_truncate;
+}
+
+static GInputStream *
+fu_decompress_input_stream_new(GInputStream *stream,
+			       FuDecompressInputStreamFormat format,
+			       guint64 memlimit,
+			       GError **error)
+{
+	g_autoptr(FuDecompressInputStream) self =
+	    g_object_new(FU_TYPE_DECOMPRESS_INPUT_STREAM, NULL);
+
+	if (!G_IS_SEEKABLE(stream) || !g_seekable_can_seek(G_SEEKABLE(stream))) {
+		g_set_error_literal(error,
+				    FWUPD_ERROR,
+				    FWUPD_ERROR_NOT_SUPPORTED,
+				    "base stream is not seekable");
+		return NULL;
+	}
+	self->base_stream = g_object_ref(stream);
+	self->format = format;
+	self->memlimit = memlimit;
+	if (!fu_decompress_input_stream_reset(self, error))
+		return NULL;
+	return G_INPUT_STREAM(g_steal_pointer(&self));
+}
+
+/* the index at the end of a single-stream .xz file has the size and offset of each block */
+static gboolean
+fu_decompress_input_stream_xz_load_index(FuDecompressInputStream *self, GError **error)
+{
+	gsize in_pos = 0;
+	gsize streamsz = 0;
+	guint64 memlimit = self->memlimit;
+	guint8 footer[LZMA_STREAM_HEADER_SIZE] = {0x0};
+	lzma_index *idx = NULL;
+	lzma_stream_flags flags = {0x0};
+	lzma_ret rc;
+	g_autoptr(GBytes) blob = NULL;
+
+	if (!fu_input_stream_size(self->base_stream, &streamsz, error))
+		return FALSE;
+	if (streamsz < 2 * LZMA_STREAM_HEADER_SIZE) {
+		g_set_error_literal(error, FWUPD_ERROR, FWUPD_ERROR_INVALID_DATA, "too small");
+		return FALSE;
+	}
+	if (!fu_input_stream_read_safe(self->base_stream,
+				       footer,
+				       sizeof(footer),
+				       0x0,
+				       streamsz - sizeof(footer),
+				       sizeof(footer),
+				       error))
+		return FALSE;
+	rc = lzma_stream_footer_decode(&flags, footer);
+	if (rc != LZMA_OK) {
+		g_set_error(error,
+			    FWUPD_ERROR,
+			    FWUPD_ERROR_INVALID_DATA,
+			    "failed to parse XZ stream footer rc=%u",
+			    rc);
+		return FALSE;
+	}
+	if (flags.backward_size > streamsz - 2 * LZMA_STREAM_HEADER_SIZE) {
+		g_set_error_literal(error,
+				    FWUPD_ERROR,
+				    FWUPD_ERROR_INVALID_DATA,
+				    "XZ index size invalid");
+		return FALSE;
+	}
+	blob = fu_input_stream_read_bytes(self->base_stream,
+					  streamsz - sizeof(footer) - flags.backward_size,
+					  flags.backward_size,
+					  NULL,
+					  error);
+	if (blob == NULL)
+		return FALSE;
+	rc = lzma_index_buffer_decode(&idx,
+				      &memlimit,
+				      NULL,
+				      g_bytes_get_data(blob, NULL),
+				      &in_pos,
+				      g_bytes_get_size(blob));
+	if (rc != LZMA_OK) {
+		g_set_error(error,
+			    FWUPD_ERROR,
+			    FWUPD_ERROR_INVALID_DATA,
+			    "failed to parse XZ index rc=%u",
+			    rc);
+		return FALSE;
+	}
+
+	/* concatenated streams or trailing padding would need the index of each stream */
+	if (lzma_index_stream_flags(idx, &flags) != LZMA_OK ||
+	    lzma_index_stream_size(idx) != streamsz) {
+		lzma_index_end(idx, NULL);
+		g_set_error_literal(error,
+				    FWUPD_ERROR,
+				    FWUPD_ERROR_NOT_SUPPORTED,
+				    "only single-stream XZ files are supported");
+		return FALSE;
+	}
+	self->xz_index = idx;
+	self->size = lzma_index_uncompressed_size(idx);
+	return TRUE;
+}
+
+/**
+ * fu_decompress_input_stream_new_lzma:
+ * @stream: a base #GInputStream of LZMA or XZ compressed data
+ * @memlimit: decompression memory limit, in bytes
+ * @error: (nullable): optional return location for an error
+ *
+ * Creates an input stream where content is decompressed from the donor stream as it is read.
+ *
+ * Returns: (transfer full): a #FuDecompressInputStream, or %NULL on error
+ *
+ * Since: 2.1.6
+ **/
+GInputStream *
+fu_decompress_input_stream_new_lzma(GInputStream *stream, guint64 memlimit, GError **error)
+{
+	guint8 hdr[13] = {0};
+	g_autoptr(GInputStream) self = NULL;
+
+	g_return_val_if_fail(G_IS_INPUT_STREAM(stream), NULL);
+	g_return_val_if_fail(error == NULL || *error == NULL, NULL);
+
+	self = fu_decompress_input_stream_new(stream,
+					      FU_DECOMPRESS_INPUT_STREAM_FORMAT_LZMA,
+					      memlimit,
+					      error);
+	if (self == NULL)
+		return NULL;
+
+	if (!fu_input_stream_read_safe(stream, hdr, sizeof(hdr), 0x0, 0x0, sizeof(hdr), NULL))
+		return g_steal_pointer(&self);
+
+	/* the .xz index has the decompressed size, and the legacy .lzma header optionally does */
+	if (memcmp(hdr, "\xFD" "7zXZ", 5) == 0) {
+		g_autoptr(GError) error_local = NULL;
+		if (!fu_decompress_input_stream_xz_load_index(FU_DECOMPRESS_INPUT_STREAM(self),
+							      &error_local))
+			g_debug("ignoring XZ index: %s", error_local->message);
+	} else {
+		guint64 size = fu_memread_uint64(hdr + 5, G_LITTLE_ENDIAN);
+		if (size < G_MAXSIZE)
+			FU_DECOMPRESS_INPUT_STREAM(self)->size = size;
+	}
+	return g_steal_pointer(&self);
+}
+
+/**
+ * fu_decompress_input_stream_new_zstd:
+ * @stream: a base #GInputStream of zstd compressed data
+ * @error: (nullable): optional return location for an error
+ *
+ * Creates an input stream where content is decompressed from the donor stream as it is read.
+ *
+ * Returns: (transfer full): a #FuDecompressInputStream, or %NULL on error
+ *
+ * Since: 2.1.6
+ **/
+GInputStream *
+fu_decompress_input_stream_new_zstd(GInputStream *stream, GError **error)
+{
+	g_return_val_if_fail(G_IS_INPUT_STREAM(stream), NULL);
+	g_return_val_if_fail(error == NULL || *error == NULL, NULL);
+	return fu_decompress_input_stream_new(stream,
+					      FU_DECOMPRESS_INPUT_STREAM_FORMAT_ZSTD,
+					      0,
+					      error);
+}
+
+/**
+ * fu_decompress_input_stream_new_deflate:
+ * @stream: a base #GInputStream of raw deflate compressed data
+ * @size: size of the decompressed data, in bytes
+ * @error: (nullable): optional return location for an error
+ *
+ * Creates an input stream where content is decompressed from the donor stream as it is read.
+ *
+ * Reading the stream fails if the decompressed data is not exactly @size bytes long.
+ *
+ * Returns: (transfer full): a #FuDecompressInputStream, or %NULL on error
+ *
+ * Since: 2.1.6
+ **/
+GInputStream *
+fu_decompress_input_stream_new_deflate(GInputStream *stream, gsize size, GError **error)
+{
+	g_autoptr(GInputStream) self = NULL;
+
+	g_return_val_if_fail(G_IS_INPUT_STREAM(stream), NULL);
+	g_return_val_if_fail(error == NULL || *error == NULL, NULL);
+
+	self = fu_decompress_input_stream_new(stream,
+					      FU_DECOMPRESS_INPUT_STREAM_FORMAT_DEFLATE,
+					      0,
+					      error);
+	if (self == NULL)
+		return NULL;
+	FU_DECOMPRESS_INPUT_STREAM(self)->size = size;
+	FU_DECOMPRESS_INPUT_STREAM(self)->verify = TRUE;
+	return g_steal_pointer(&self);
+}
+
+/**
+ * fu_decompress_input_stream_set_crc32:
+ * @self: a #FuDecompressInputStream
+ * @crc: the expected %FU_CRC_KIND_B32_STANDARD CRC of the decompressed data
+ *
+ * Sets the CRC to check once all of the data has been decompressed, which is calculated as the
+ * data is read. Reading the last byte of the stream fails if the CRC does not match.
+ *
+ * This is only supported for streams created with fu_decompress_input_stream_new_deflate().
+ *
+ * Since: 2.1.6
+ **/
+void
+fu_decompress_input_stream_set_crc32(FuDecompressInputStream *self, guint32 crc)
+{
+	g_return_if_fail(FU_IS_DECOMPRESS_INPUT_STREAM(self));
+	g_return_if_fail(self->verify);
+	self->has_crc = TRUE;
+	self->crc_expected = crc;
+}
+
+/* private: the number of times the decoder restarted from the start of the compressed data */
+guint
+fu_decompress_input_stream_get_decoder_resets(FuDecompressInputStream *self)
+{
+	g_return_val_if_fail(FU_IS_DECOMPRESS_INPUT_STREAM(self), G_MAXUINT);
+	return self->decoder_resets;
+}
+
+/* private: whether the decompressed size is known without decoding to the end */
+gboolean
+fu_decompress_input_stream_has_size(FuDecompressInputStream *self)
+{
+	g_return_val_if_fail(FU_IS_DECOMPRESS_INPUT_STREAM(self), FALSE);
+	return self->size != G_MAXSIZE;
+}
+
+static void
+fu_decompress_input_stream_finalize(GObject *object)
+{
+	FuDecompressInputStream *self = FU_DECOMPRESS_INPUT_STREAM(object);
+	lzma_end(&self->lzma);
+	if (self->xz_index != NULL)
+		lzma_index_end(self->xz_index, NULL);
+#ifdef HAVE_ZSTD
+	if (self->zstd != NULL)
+		ZSTD_freeDStream(self->zstd);
+#endif
+	if (self->zlib_init)
+		inflateEnd(&self->zlib);
+	if (self->base_stream != NULL)
+		g_object_unref(self->base_stream);
+	g_byte_array_unref(self->history);
+	g_free(self->buf_in);
+	G_OBJECT_CLASS(fu_decompress_input_stream_parent_class)->finalize(object);
+}
+
+static void
+fu_decompress_input_stream_class_init(FuDecompressInputStreamClass *klass)
+{
+	GObjectClass *object_class = G_OBJECT_CLASS(klass);
+	GInputStreamClass *istream_class = G_INPUT_STREAM_CLASS(klass);
+	istream_class->read_fn = fu_decompress_input_stream_read;
+	object_class->finalize = fu_decompress_input_stream_finalize;
+}
+
+static void
+fu_decompress_input_stream_init(FuDecompressInputStream *self)
+{
+	lzma_stream strm = LZMA_STREAM_INIT;
+	self->lzma = strm;
+	self->size = G_MAXSIZE;
+	self->history = g_byte_array_new();
+	self->buf_in = g_malloc(FU_DECOMPRESS_INPUT_STREAM_BUFSZ);
+}
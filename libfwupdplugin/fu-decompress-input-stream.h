@@ -0,0 +1,29 @@
+/*
+ * Copyright 2026 Richard Hughes <richard@hughsie.com>
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ */
+
+#pragma once
+
+#include <fwupd.h>
+
+#define FU_TYPE_DECOMPRESS_INPUT_STREAM (fu_decompress_input_stream_get_type())
+
+G_DECLARE_FINAL_TYPE(FuDecompressInputStream,
+		     fu_decompress_input_stream,
+		     FU,
+		     DECOMPRESS_INPUT_STREAM,
+		     GInputStream)
+
+GInputStream *
+fu_decompress_input_stream_new_lzma(GInputStream *stream, guint64 memlimit, GError **error)
+    G_GNUC_NON_NULL(1);
+GInputStream *
+fu_decompress_input_stream_new_zstd(GInputStream *stream, GError **error) G_GNUC_NON_NULL(1);
+GInputStream *
+fu_decompress_input_stream_new_deflate(GInputStream *stream, gsize size, GError **error)
+    G_GNUC_NON_NULL(1);
+void
+fu_decompress_input_stream_set_crc32(FuDecompressInputStream *self, guint32 crc)
+    G_GNUC_NON_NULL(1);
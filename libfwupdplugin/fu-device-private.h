@@ -75,6 +75,8 @@ GPtrArray *
 fu_device_get_counterpart_guids(FuDevice *self) G_GNUC_NON_NULL(1);
 gboolean
 fu_device_is_updatable(FuDevice *self) G_GNUC_NON_NULL(1);
+gboolean
+fu_device_get_done_probe(FuDevice *self) G_GNUC_NON_NULL(1);
 const gchar *
 fu_device_get_custom_flags(FuDevice *self) G_GNUC_NON_NULL(1);
 void
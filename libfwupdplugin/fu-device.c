@@ -323,6 +323,7 @@ fu_device_register_private_flags(FuDevice *self)
 	    FU_DEVICE_PRIVATE_FLAG_NO_VERSION_EXPECTED,
 	    FU_DEVICE_PRIVATE_FLAG_NO_GENERIC_VERSION,
 	    FU_DEVICE_PRIVATE_FLAG_STRICT_EMULATION_ORDER,
+	    FU_DEVICE_PRIVATE_FLAG_COLDPLUG_CACHE,
 	};
 	GQuark quarks_tmp[G_N_ELEMENTS(flags)] = {0};
 	if (G_LIKELY(priv->private_flags_registered->len > 0))
@@ -6388,6 +6389,15 @@ fu_device_probe(FuDevice *self, GError **error)
 	return TRUE;
 }
 
+/* private: used to scope data that is only valid during ->probe */
+gboolean
+fu_device_get_done_probe(FuDevice *self)
+{
+	FuDevicePrivate *priv = GET_PRIVATE(self);
+	g_return_val_if_fail(FU_IS_DEVICE(self), FALSE);
+	return priv->done_probe;
+}
+
 /**
  * fu_device_probe_complete:
  * @self: a #FuDevice
@@ -6433,6 +6443,7 @@ fu_device_rescan(FuDevice *self, GError **error)
 		g_ptr_array_set_size(priv->instance_ids, 0);
 	g_ptr_array_set_size(fu_device_get_instance_ids(self), 0);
 	g_ptr_array_set_size(fu_device_get_guids(self), 0);
+	fwupd_device_invalidate(FWUPD_DEVICE(self));
 
 	/* subclassed */
 	if (device_class->rescan != NULL) {
@@ -722,6 +722,16 @@ fu_device_new(FuContext *ctx);
  */
 #define FU_DEVICE_PRIVATE_FLAG_HAS_DS20 "has-ds20"
 
+/**
+ * FU_DEVICE_PRIVATE_FLAG_COLDPLUG_CACHE:
+ *
+ * The device version is read from sysfs or the USB descriptor without opening the device, so
+ * the device can be restored from the coldplug cache when the daemon is restarted.
+ *
+ * Since: 2.1.6
+ */
+#define FU_DEVICE_PRIVATE_FLAG_COLDPLUG_CACHE "coldplug-cache"
+
 /* standard icons */
 
 /**
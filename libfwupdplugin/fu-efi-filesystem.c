@@ -10,6 +10,8 @@
 #include "fu-common.h"
 #include "fu-efi-file.h"
 #include "fu-efi-filesystem.h"
+#include "fu-efi-struct.h"
+#include "fu-firmware-private.h"
 #include "fu-input-stream.h"
 #include "fu-partial-input-stream.h"
 
@@ -26,6 +28,172 @@ G_DEFINE_TYPE(FuEfiFilesystem, fu_efi_filesystem, FU_TYPE_FIRMWARE)
 #define FU_EFI_FILESYSTEM_FILES_MAX 10000
 #define FU_EFI_FILESYSTEM_SIZE_MAX  (256 * FU_MB)
 
+static gboolean
+fu_efi_filesystem_is_freespace(GInputStream *stream,
+			       gsize offset,
+			       gboolean *is_freespace,
+			       GError **error)
+{
+	for (guint i = 0; i < 0x18; i++) {
+		guint8 tmp = 0;
+		if (!fu_input_stream_read_u8(stream, offset + i, &tmp, error))
+			return FALSE;
+		if (tmp != 0xff) {
+			*is_freespace = FALSE;
+			return TRUE;
+		}
+	}
+	*is_freespace = TRUE;
+	return TRUE;
+}
+
+/* only read the header so that the offset of the next file is known without parsing sections */
+static gboolean
+fu_efi_filesystem_read_file_header(FuFirmware *img,
+				   GInputStream *stream,
+				   gsize offset,
+				   gsize *size,
+				   GError **error)
+{
+	guint64 size_tmp;
+	g_autofree gchar *guid_str = NULL;
+	g_autoptr(FuStructEfiFile) st = NULL;
+
+	st = fu_struct_efi_file_parse_stream(stream, offset, error);
+	if (st == NULL)
+		return FALSE;
+	if (fu_struct_efi_file_get_attrs(st) & FU_EFI_FILE_ATTRIB_LARGE_FILE) {
+		g_autoptr(FuStructEfiFile2) st2 = NULL;
+		st2 = fu_struct_efi_file2_parse_stream(stream, offset, error);
+		if (st2 == NULL)
+			return FALSE;
+		size_tmp = fu_struct_efi_file2_get_extended_size(st2);
+	} else {
+		size_tmp = fu_struct_efi_file_get_size(st);
+	}
+	if (size_tmp == 0) {
+		g_set_error_literal(error,
+				    FWUPD_ERROR,
+				    FWUPD_ERROR_INVALID_FILE,
+				    "EFI file has invalid size of 0");
+		return FALSE;
+	}
+	*size = fu_common_align_up(size_tmp, fu_firmware_get_alignment(img));
+
+	/* so the file can be found by ID without parsing */
+	guid_str =
+	    fwupd_guid_to_string(fu_struct_efi_file_get_name(st), FWUPD_GUID_FLAG_MIXED_ENDIAN);
+	fu_firmware_set_id(img, guid_str);
+	return TRUE;
+}
+
+/* find where each file starts, then either parse them all at the same time or only when
+ * each is looked up */
+static gboolean
+fu_efi_filesystem_parse_deferred(FuEfiFilesystem *self,
+				 GInputStream *stream,
+				 FuFirmwareParseFlags flags,
+				 GError **error)
+{
+	FuFirmware *firmware = FU_FIRMWARE(self);
+	gsize offset = 0;
+	gsize streamsz = 0;
+	guint idx_failed = 0;
+	g_autoptr(GPtrArray) imgs = g_ptr_array_new_with_free_func((GDestroyNotify)g_object_unref);
+	g_autoptr(GPtrArray) streams =
+	    g_ptr_array_new_with_free_func((GDestroyNotify)g_object_unref);
+	g_autoptr(GArray) offsets = g_array_new(FALSE, FALSE, sizeof(gsize));
+	g_autoptr(GArray) sizes = g_array_new(FALSE, FALSE, sizeof(gsize));
+
+	/* find where each file starts */
+	if (!fu_input_stream_size(stream, &streamsz, error))
+		return FALSE;
+	while (offset < streamsz) {
+		gboolean is_freespace = TRUE;
+		gsize size = 0;
+		g_autoptr(FuFirmware) img = fu_efi_file_new();
+		g_autoptr(GInputStream) stream_tmp = NULL;
+
+		if (!fu_efi_filesystem_is_freespace(stream, offset, &is_freespace, error))
+			return FALSE;
+		if (is_freespace) {
+			g_debug("ignoring free space @0x%x of 0x%x",
+				(guint)offset,
+				(guint)streamsz);
+			break;
+		}
+		if (imgs->len >= FU_EFI_FILESYSTEM_FILES_MAX) {
+			g_set_error(error,
+				    FWUPD_ERROR,
+				    FWUPD_ERROR_INVALID_DATA,
+				    "too many EFI files, limit is %u",
+				    (guint)FU_EFI_FILESYSTEM_FILES_MAX);
+			return FALSE;
+		}
+		if (!fu_efi_filesystem_read_file_header(img, stream, offset, &size, error)) {
+			g_prefix_error(error, "failed to parse EFI file at 0x%x: ", (guint)offset);
+			return FALSE;
+		}
+		stream_tmp = fu_partial_input_stream_new(stream,
+							 offset,
+							 MIN(size, streamsz - offset),
+							 error);
+		if (stream_tmp == NULL) {
+			g_prefix_error_literal(error, "failed to cut EFI file: ");
+			return FALSE;
+		}
+		g_ptr_array_add(imgs, g_steal_pointer(&img));
+		g_ptr_array_add(streams, g_steal_pointer(&stream_tmp));
+		g_array_append_val(offsets, offset);
+		g_array_append_val(sizes, size);
+
+		/* next! */
+		if (!fu_size_checked_inc(&offset, size, error))
+			return FALSE;
+	}
+
+	/* only parse the sections of each file when required */
+	if (flags & FU_FIRMWARE_PARSE_FLAG_LAZY) {
+		for (guint i = 0; i < imgs->len; i++) {
+			FuFirmware *img = g_ptr_array_index(imgs, i);
+			GInputStream *stream_tmp = g_ptr_array_index(streams, i);
+			fu_firmware_set_offset(img, g_array_index(offsets, gsize, i));
+			fu_firmware_set_size(img, g_array_index(sizes, gsize, i));
+			if (!fu_firmware_add_image_lazy(firmware,
+							img,
+							stream_tmp,
+							0x0,
+							flags | FU_FIRMWARE_PARSE_FLAG_NO_SEARCH,
+							error))
+				return FALSE;
+		}
+		return TRUE;
+	}
+
+	/* parse all the files at the same time */
+	if (!fu_firmware_parse_images(imgs,
+				      streams,
+				      flags | FU_FIRMWARE_PARSE_FLAG_NO_SEARCH,
+				      &idx_failed,
+				      error)) {
+		g_prefix_error(error,
+			       "failed to parse EFI file at 0x%x: ",
+			       (guint)g_array_index(offsets, gsize, idx_failed));
+		return FALSE;
+	}
+
+	/* add in the same order as the serial parser */
+	for (guint i = 0; i < imgs->len; i++) {
+		FuFirmware *img = g_ptr_array_index(imgs, i);
+		fu_firmware_set_offset(img, g_array_index(offsets, gsize, i));
+		if (!fu_firmware_add_image(firmware, img, error))
+			return FALSE;
+	}
+
+	/* success */
+	return TRUE;
+}
+
 static gboolean
 fu_efi_filesystem_parse(FuFirmware *firmware,
 			GInputStream *stream,
@@ -34,6 +202,14 @@ fu_efi_filesystem_parse(FuFirmware *firmware,
 {
 	gsize offset = 0;
 	gsize streamsz = 0;
+
+	/* optional */
+	if (flags & (FU_FIRMWARE_PARSE_FLAG_PARALLEL | FU_FIRMWARE_PARSE_FLAG_LAZY))
+		return fu_efi_filesystem_parse_deferred(FU_EFI_FILESYSTEM(firmware),
+							stream,
+							flags,
+							error);
+
 	if (!fu_input_stream_size(stream, &streamsz, error))
 		return FALSE;
 	while (offset < streamsz) {
@@ -42,15 +218,8 @@ fu_efi_filesystem_parse(FuFirmware *firmware,
 		gboolean is_freespace = TRUE;
 
 		/* ignore free space */
-		for (guint i = 0; i < 0x18; i++) {
-			guint8 tmp = 0;
-			if (!fu_input_stream_read_u8(stream, offset + i, &tmp, error))
-				return FALSE;
-			if (tmp != 0xff) {
-				is_freespace = FALSE;
-				break;
-			}
-		}
+		if (!fu_efi_filesystem_is_freespace(stream, offset, &is_freespace, error))
+			return FALSE;
 		if (is_freespace) {
 			g_debug("ignoring free space @0x%x of 0x%x",
 				(guint)offset,
@@ -77,7 +246,7 @@ fu_efi_filesystem_parse(FuFirmware *firmware,
 					    "EFI file has invalid size of 0");
 			return FALSE;
 		}
-		fu_firmware_set_offset(firmware, offset);
+		fu_firmware_set_offset(img, offset);
 		if (!fu_firmware_add_image(firmware, img, error))
 			return FALSE;
 
@@ -14,7 +14,9 @@
 #include "fu-byte-array.h"
 #include "fu-common.h"
 #include "fu-efi-lz77-decompressor.h"
+#include "fu-firmware-profiler.h"
 #include "fu-input-stream.h"
+#include "fu-mem.h"
 
 struct _FuEfiLz77Decompressor {
 	FuFirmware parent_instance;
@@ -52,12 +54,14 @@ G_DEFINE_TYPE(FuEfiLz77Decompressor, fu_efi_lz77_decompressor, FU_TYPE_FIRMWARE)
 #endif
 
 typedef struct {
-	GInputStream *stream; /* no-ref */
-	GByteArray *dst;      /* no-ref */
+	const guint8 *src; /* no-ref */
+	gsize srcsz;
+	gsize src_offset;
+	GByteArray *dst; /* no-ref */
 
-	guint16 bit_count;
+	guint64 bit_reservoir; /* MSB-aligned, bit_buf is the top BITBUFSIZ bits */
+	guint8 bit_reservoir_cnt;
 	guint32 bit_buf;
-	guint32 sub_bit_buf;
 	guint16 block_size;
 
 	guint16 left[(2 * NC) - 1];
@@ -79,58 +83,48 @@ fu_efi_lz77_decompressor_memset16(guint16 *buf, gsize length, guint16 value)
 		buf[i] = value;
 }
 
-static gboolean
-fu_efi_lz77_decompressor_read_source_bits(FuEfiLz77DecompressHelper *helper,
-					  guint16 number_of_bits,
-					  GError **error)
+/* top up the reservoir a byte at a time, or 8 bytes at a time when far from the end of the
+ * source -- zero bits are used once the source has been consumed */
+static inline void
+fu_efi_lz77_decompressor_refill(FuEfiLz77DecompressHelper *helper)
 {
-	/* left shift number_of_bits of bits in advance */
-	helper->bit_buf = (guint32)(((guint64)helper->bit_buf) << number_of_bits);
-
-	/* copy data needed in bytes into sub_bit_buf */
-	while (number_of_bits > helper->bit_count) {
-		gssize rc;
-		guint8 sub_bit_buf = 0;
-
-		number_of_bits = (guint16)(number_of_bits - helper->bit_count);
-		helper->bit_buf |= (guint32)(((guint64)helper->sub_bit_buf) << number_of_bits);
-
-		/* get 1 byte into sub_bit_buf */
-		rc = g_input_stream_read(helper->stream,
-					 &sub_bit_buf,
-					 sizeof(sub_bit_buf),
-					 NULL,
-					 error);
-		if (rc < 0)
-			return FALSE;
-		if (rc == 0) {
-			/* no more bits from the source, just pad zero bit */
-			helper->sub_bit_buf = 0;
-		} else {
-			helper->sub_bit_buf = sub_bit_buf;
-		}
-		helper->bit_count = 8;
+	if (helper->bit_reservoir_cnt <= 56 && helper->src_offset + 8 <= helper->srcsz) {
+		guint8 nbits = ((64 - helper->bit_reservoir_cnt) / 8) * 8;
+		guint64 tmp = fu_memread_uint64(helper->src + helper->src_offset, G_BIG_ENDIAN);
+		tmp >>= 64 - nbits;
+		helper->bit_reservoir |= tmp << (64 - helper->bit_reservoir_cnt - nbits);
+		helper->bit_reservoir_cnt += nbits;
+		helper->src_offset += nbits / 8;
 	}
+	while (helper->bit_reservoir_cnt <= 56) {
+		guint64 tmp = 0;
+		if (helper->src_offset < helper->srcsz)
+			tmp = helper->src[helper->src_offset++];
+		helper->bit_reservoir |= tmp << (56 - helper->bit_reservoir_cnt);
+		helper->bit_reservoir_cnt += 8;
+	}
+	helper->bit_buf = (guint32)(helper->bit_reservoir >> (64 - BITBUFSIZ));
+}
 
-	/* calculate additional bit count read to update bit_count */
-	helper->bit_count = (guint16)(helper->bit_count - number_of_bits);
-
-	/* copy number_of_bits of bits from sub_bit_buf into bit_buf */
-	helper->bit_buf |= helper->sub_bit_buf >> helper->bit_count;
-	return TRUE;
+/* drop number_of_bits of bits from the left of bit_buf, and fill up from the source */
+static inline void
+fu_efi_lz77_decompressor_read_source_bits(FuEfiLz77DecompressHelper *helper,
+					  guint16 number_of_bits)
+{
+	helper->bit_reservoir <<= number_of_bits;
+	helper->bit_reservoir_cnt -= number_of_bits;
+	fu_efi_lz77_decompressor_refill(helper);
 }
 
-static gboolean
-fu_efi_lz77_decompressor_get_bits(FuEfiLz77DecompressHelper *helper,
-				  guint16 number_of_bits,
-				  guint16 *value,
-				  GError **error)
+static inline guint16
+fu_efi_lz77_decompressor_get_bits(FuEfiLz77DecompressHelper *helper, guint16 number_of_bits)
 {
 	/* pop number_of_bits of bits from left */
-	*value = (guint16)(helper->bit_buf >> (BITBUFSIZ - number_of_bits));
+	guint16 value = (guint16)(helper->bit_buf >> (BITBUFSIZ - number_of_bits));
 
 	/* fill up bit_buf from source */
-	return fu_efi_lz77_decompressor_read_source_bits(helper, number_of_bits, error);
+	fu_efi_lz77_decompressor_read_source_bits(helper, number_of_bits);
+	return value;
 }
 
 /* creates huffman code mapping table for extra set, char&len set and position set according to
@@ -257,8 +251,8 @@ fu_efi_lz77_decompressor_make_huffman_table(FuEfiLz77DecompressHelper *helper,
 }
 
 /* get a position value according to Position Huffman table */
-static gboolean
-fu_efi_lz77_decompressor_decode_p(FuEfiLz77DecompressHelper *helper, guint32 *value, GError **error)
+static guint32
+fu_efi_lz77_decompressor_decode_p(FuEfiLz77DecompressHelper *helper)
 {
 	guint16 val;
 
@@ -276,18 +270,13 @@ fu_efi_lz77_decompressor_decode_p(FuEfiLz77DecompressHelper *helper, guint32 *va
 	}
 
 	/* advance what we have read */
-	if (!fu_efi_lz77_decompressor_read_source_bits(helper, helper->pt_len[val], error))
-		return FALSE;
+	fu_efi_lz77_decompressor_read_source_bits(helper, helper->pt_len[val]);
 
 	if (val > 1) {
-		guint16 char_c = 0;
-		if (!fu_efi_lz77_decompressor_get_bits(helper, (guint16)(val - 1), &char_c, error))
-			return FALSE;
-		*value = (guint32)((1U << (val - 1)) + char_c);
-		return TRUE;
+		guint16 char_c = fu_efi_lz77_decompressor_get_bits(helper, (guint16)(val - 1));
+		return (guint32)((1U << (val - 1)) + char_c);
 	}
-	*value = val;
-	return TRUE;
+	return val;
 }
 
 /* read in the extra set or position set length array, then generate the code mapping for them */
@@ -302,8 +291,7 @@ fu_efi_lz77_decompressor_read_pt_len(FuEfiLz77DecompressHelper *helper,
 	guint16 index = 0;
 
 	/* read Extra Set Code Length Array size */
-	if (!fu_efi_lz77_decompressor_get_bits(helper, number_of_bits, &number, error))
-		return FALSE;
+	number = fu_efi_lz77_decompressor_get_bits(helper, number_of_bits);
 
 	/* fail if number or number_of_symbols is greater than array element count */
 	if ((number > G_N_ELEMENTS(helper->pt_len)) ||
@@ -313,9 +301,7 @@ fu_efi_lz77_decompressor_read_pt_len(FuEfiLz77DecompressHelper *helper,
 	}
 	if (number == 0) {
 		/* this represents only Huffman code used */
-		guint16 char_c = 0;
-		if (!fu_efi_lz77_decompressor_get_bits(helper, number_of_bits, &char_c, error))
-			return FALSE;
+		guint16 char_c = fu_efi_lz77_decompressor_get_bits(helper, number_of_bits);
 		fu_efi_lz77_decompressor_memset16(&helper->pt_table[0],
 						  sizeof(helper->pt_table),
 						  char_c);
@@ -337,11 +323,8 @@ fu_efi_lz77_decompressor_read_pt_len(FuEfiLz77DecompressHelper *helper,
 			}
 		}
 
-		if (!fu_efi_lz77_decompressor_read_source_bits(
-			helper,
-			(guint16)((char_c < 7) ? 3 : char_c - 3),
-			error))
-			return FALSE;
+		fu_efi_lz77_decompressor_read_source_bits(helper,
+							  (guint16)((char_c < 7) ? 3 : char_c - 3));
 
 		helper->pt_len[index++] = (guint8)char_c;
 
@@ -349,8 +332,7 @@ fu_efi_lz77_decompressor_read_pt_len(FuEfiLz77DecompressHelper *helper,
 		 * a 2-bit value is used to indicated the number of consecutive zero lengths after
 		 * the third length */
 		if (index == special_symbol) {
-			if (!fu_efi_lz77_decompressor_get_bits(helper, 2, &char_c, error))
-				return FALSE;
+			char_c = fu_efi_lz77_decompressor_get_bits(helper, 2);
 			if (char_c == 0) {
 				g_set_error_literal(error,
 						    FWUPD_ERROR,
@@ -381,13 +363,10 @@ fu_efi_lz77_decompressor_read_c_len(FuEfiLz77DecompressHelper *helper, GError **
 	guint16 number = 0;
 	guint16 index = 0;
 
-	if (!fu_efi_lz77_decompressor_get_bits(helper, CBIT, &number, error))
-		return FALSE;
+	number = fu_efi_lz77_decompressor_get_bits(helper, CBIT);
 	if (number == 0) {
 		/* this represents only Huffman code used */
-		guint16 char_c = 0;
-		if (!fu_efi_lz77_decompressor_get_bits(helper, CBIT, &char_c, error))
-			return FALSE;
+		guint16 char_c = fu_efi_lz77_decompressor_get_bits(helper, CBIT);
 		memset(helper->c_len, 0, sizeof(helper->c_len));
 		fu_efi_lz77_decompressor_memset16(&helper->c_table[0],
 						  sizeof(helper->c_table),
@@ -411,25 +390,15 @@ fu_efi_lz77_decompressor_read_c_len(FuEfiLz77DecompressHelper *helper, GError **
 		}
 
 		/* advance what we have read */
-		if (!fu_efi_lz77_decompressor_read_source_bits(helper,
-							       helper->pt_len[char_c],
-							       error))
-			return FALSE;
+		fu_efi_lz77_decompressor_read_source_bits(helper, helper->pt_len[char_c]);
 
 		if (char_c <= 2) {
 			if (char_c == 0) {
 				char_c = 1;
 			} else if (char_c == 1) {
-				if (!fu_efi_lz77_decompressor_get_bits(helper, 4, &char_c, error))
-					return FALSE;
-				char_c += 3;
+				char_c = fu_efi_lz77_decompressor_get_bits(helper, 4) + 3;
 			} else if (char_c == 2) {
-				if (!fu_efi_lz77_decompressor_get_bits(helper,
-								       CBIT,
-								       &char_c,
-								       error))
-					return FALSE;
-				char_c += 20;
+				char_c = fu_efi_lz77_decompressor_get_bits(helper, CBIT) + 20;
 			}
 			if (char_c == 0) {
 				g_set_error_literal(error,
@@ -463,8 +432,7 @@ fu_efi_lz77_decompressor_decode_c(FuEfiLz77DecompressHelper *helper, guint16 *va
 
 	if (helper->block_size == 0) {
 		/* starting a new block, so read blocksize from block header */
-		if (!fu_efi_lz77_decompressor_get_bits(helper, 16, &helper->block_size, error))
-			return FALSE;
+		helper->block_size = fu_efi_lz77_decompressor_get_bits(helper, 16);
 
 		/* read in the extra set code length array */
 		if (!fu_efi_lz77_decompressor_read_pt_len(helper, NT, TBIT, 3, error)) {
@@ -519,8 +487,7 @@ fu_efi_lz77_decompressor_decode_c(FuEfiLz77DecompressHelper *helper, guint16 *va
 	}
 
 	/* advance what we have read */
-	if (!fu_efi_lz77_decompressor_read_source_bits(helper, helper->c_len[index2], error))
-		return FALSE;
+	fu_efi_lz77_decompressor_read_source_bits(helper, helper->c_len[index2]);
 	*value = index2;
 	return TRUE;
 }
@@ -550,8 +517,7 @@ fu_efi_lz77_decompressor_internal(FuEfiLz77DecompressHelper *helper,
 	}
 
 	/* fill the first BITBUFSIZ bits */
-	if (!fu_efi_lz77_decompressor_read_source_bits(helper, BITBUFSIZ, error))
-		return FALSE;
+	fu_efi_lz77_decompressor_refill(helper);
 
 	/* decode each char */
 	while (dst_offset < helper->dst->len) {
@@ -566,12 +532,12 @@ fu_efi_lz77_decompressor_internal(FuEfiLz77DecompressHelper *helper,
 		} else {
 			guint16 bytes_remaining;
 			guint32 data_offset;
-			guint32 tmp = 0;
+			guint32 tmp;
 
 			/* process a pointer, so get string length */
 			bytes_remaining = (guint16)(char_c - (0x00000100U - THRESHOLD));
-			if (!fu_efi_lz77_decompressor_decode_p(helper, &tmp, error))
-				return FALSE;
+			tmp = fu_efi_lz77_decompressor_decode_p(helper);
+
 			/* validate tmp to prevent underflow in offset calculation */
 			if (tmp >= dst_offset) {
 				g_set_error(error,
@@ -583,26 +549,25 @@ fu_efi_lz77_decompressor_internal(FuEfiLz77DecompressHelper *helper,
 				return FALSE;
 			}
 			data_offset = dst_offset - tmp - 1;
+			if (bytes_remaining > helper->dst->len - dst_offset) {
+				g_set_error_literal(error,
+						    FWUPD_ERROR,
+						    FWUPD_ERROR_INVALID_DATA,
+						    "bad pointer offset");
+				return FALSE;
+			}
 
-			/* write bytes_remaining of bytes into dst_buf */
-			bytes_remaining--;
-			while ((gint16)bytes_remaining >= 0) {
-				if (dst_offset >= helper->dst->len) {
-					g_set_error_literal(error,
-							    FWUPD_ERROR,
-							    FWUPD_ERROR_INVALID_DATA,
-							    "bad pointer offset");
-					return FALSE;
-				}
-				if (data_offset >= helper->dst->len) {
-					g_set_error_literal(error,
-							    FWUPD_ERROR,
-							    FWUPD_ERROR_INVALID_DATA,
-							    "bad table");
-					return FALSE;
-				}
-				helper->dst->data[dst_offset++] = helper->dst->data[data_offset++];
-				bytes_remaining--;
+			/* write bytes_remaining of bytes into dst_buf, where a short distance
+			 * means the match overlaps what is being written and has to be bytewise */
+			if (tmp + 1 >= bytes_remaining) {
+				memcpy(helper->dst->data + dst_offset, /* nocheck:blocked */
+				       helper->dst->data + data_offset,
+				       bytes_remaining);
+				dst_offset += bytes_remaining;
+			} else {
+				for (guint16 i = 0; i < bytes_remaining; i++)
+					helper->dst->data[dst_offset++] =
+					    helper->dst->data[data_offset++];
 			}
 		}
 	}
@@ -623,6 +588,7 @@ fu_efi_lz77_decompressor_parse(FuFirmware *firmware,
 	g_autoptr(FuStructEfiLz77DecompressorHeader) st = NULL;
 	g_autoptr(GError) error_all = NULL;
 	g_autoptr(GByteArray) dst = g_byte_array_new();
+	g_autoptr(GBytes) src = NULL;
 	FuEfiLz77DecompressorVersion decompressor_versions[] = {
 	    FU_EFI_LZ77_DECOMPRESSOR_VERSION_LEGACY,
 	    FU_EFI_LZ77_DECOMPRESSOR_VERSION_TIANO,
@@ -663,20 +629,31 @@ fu_efi_lz77_decompressor_parse(FuFirmware *firmware,
 	}
 	fu_byte_array_set_size(dst, dst_bufsz, 0x0);
 
+	/* everything after the header, which is read just once and then used for both versions */
+	if (streamsz > st->buf->len) {
+		src = fu_input_stream_read_bytes(stream,
+						 st->buf->len,
+						 streamsz - st->buf->len,
+						 NULL,
+						 error);
+		if (src == NULL)
+			return FALSE;
+	} else {
+		src = g_bytes_new(NULL, 0);
+	}
+
 	/* try both position */
 	for (guint i = 0; i < G_N_ELEMENTS(decompressor_versions); i++) {
-		FuEfiLz77DecompressHelper helper = {
-		    .dst = dst,
-		    .stream = stream,
-		};
+		FuEfiLz77DecompressHelper helper = {.dst = dst};
 		g_autoptr(GError) error_local = NULL;
 
-		if (!g_seekable_seek(G_SEEKABLE(stream), st->buf->len, G_SEEK_SET, NULL, error))
-			return FALSE;
+		helper.src = g_bytes_get_data(src, &helper.srcsz);
+
 		if (fu_efi_lz77_decompressor_internal(&helper,
 						      decompressor_versions[i],
 						      &error_local)) {
 			g_autoptr(GBytes) blob = g_byte_array_free_to_bytes(g_steal_pointer(&dst));
+			fu_firmware_profiler_add_decompressed(src_bufsz, g_bytes_get_size(blob));
 			if (!fu_firmware_set_stream(firmware, NULL, error))
 				return FALSE;
 			fu_firmware_set_bytes(firmware, blob);
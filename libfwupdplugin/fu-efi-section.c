@@ -10,13 +10,13 @@
 
 #include "fu-byte-array.h"
 #include "fu-common.h"
+#include "fu-decompress-input-stream-private.h"
 #include "fu-efi-common.h"
 #include "fu-efi-lz77-decompressor.h"
 #include "fu-efi-section.h"
 #include "fu-efi-struct.h"
 #include "fu-efi-volume.h"
 #include "fu-input-stream.h"
-#include "fu-lzma-common.h"
 #include "fu-partial-input-stream.h"
 #include "fu-string.h"
 
@@ -36,6 +36,8 @@ typedef struct {
 G_DEFINE_TYPE_WITH_PRIVATE(FuEfiSection, fu_efi_section, FU_TYPE_FIRMWARE)
 #define GET_PRIVATE(o) (fu_efi_section_get_instance_private(o))
 
+#define FU_EFI_SECTION_LZMA_STREAMING_THRESHOLD (16 * FU_MB)
+
 static void
 fu_efi_section_export(FuFirmware *firmware, FuFirmwareExportFlags flags, XbBuilderNode *bn)
 {
@@ -78,20 +80,39 @@ fu_efi_section_parse_lzma_sections(FuEfiSection *self,
 				   FuFirmwareParseFlags flags,
 				   GError **error)
 {
-	g_autoptr(GBytes) blob = NULL;
+	gsize streamsz = 0;
 	g_autoptr(GBytes) blob_uncomp = NULL;
 	g_autoptr(GInputStream) stream_uncomp = NULL;
 
-	/* parse all sections */
-	blob = fu_input_stream_read_bytes(stream, 0, G_MAXSIZE, NULL, error);
-	if (blob == NULL)
-		return FALSE;
-	blob_uncomp = fu_lzma_decompress_bytes(blob, 128 * FU_MB, error);
-	if (blob_uncomp == NULL) {
-		g_prefix_error_literal(error, "failed to decompress: ");
+	/* only decompress large volumes as they are parsed */
+	stream_uncomp = fu_decompress_input_stream_new_lzma(stream, 128 * FU_MB, error);
+	if (stream_uncomp == NULL)
 		return FALSE;
+	if (!fu_decompress_input_stream_has_size(FU_DECOMPRESS_INPUT_STREAM(stream_uncomp))) {
+		/* the legacy .lzma header may not declare the size, so decode it just once */
+		blob_uncomp = fu_input_stream_read_bytes(stream_uncomp, 0, G_MAXSIZE, NULL, error);
+		if (blob_uncomp == NULL) {
+			g_prefix_error_literal(error, "failed to decompress: ");
+			return FALSE;
+		}
+	} else {
+		if (!fu_input_stream_size(stream_uncomp, &streamsz, error)) {
+			g_prefix_error_literal(error, "failed to decompress: ");
+			return FALSE;
+		}
+		if (streamsz <= FU_EFI_SECTION_LZMA_STREAMING_THRESHOLD) {
+			blob_uncomp =
+			    fu_input_stream_read_bytes(stream_uncomp, 0, streamsz, NULL, error);
+			if (blob_uncomp == NULL) {
+				g_prefix_error_literal(error, "failed to decompress: ");
+				return FALSE;
+			}
+		}
+	}
+	if (blob_uncomp != NULL) {
+		g_object_unref(stream_uncomp);
+		stream_uncomp = g_memory_input_stream_new_from_bytes(blob_uncomp);
 	}
-	stream_uncomp = g_memory_input_stream_new_from_bytes(blob_uncomp);
 	if (!fu_efi_parse_sections(FU_FIRMWARE(self), stream_uncomp, 0, flags, error)) {
 		g_prefix_error_literal(error, "failed to parse sections: ");
 		return FALSE;
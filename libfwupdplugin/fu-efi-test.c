@@ -145,6 +145,216 @@ fu_efi_signature_list_func(void)
 	g_assert_cmpint(fu_firmware_get_version_raw(FU_FIRMWARE(sig)), ==, 2024);
 }
 
+static void
+fu_efi_filesystem_parallel_func(void)
+{
+	gboolean ret;
+	gsize bufsz = 0;
+	g_autofree gchar *xml_parallel = NULL;
+	g_autofree gchar *xml_serial = NULL;
+	g_autofree guint8 *buf = NULL;
+	g_autoptr(FuFirmware) filesystem = fu_efi_filesystem_new();
+	g_autoptr(FuFirmware) filesystem_invalid = fu_efi_filesystem_new();
+	g_autoptr(FuFirmware) filesystem_parallel = fu_efi_filesystem_new();
+	g_autoptr(FuFirmware) filesystem_serial = fu_efi_filesystem_new();
+	g_autoptr(GBytes) blob = NULL;
+	g_autoptr(GBytes) blob_invalid = NULL;
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GError) error_serial = NULL;
+	g_autoptr(GPtrArray) imgs = NULL;
+	g_autoptr(GPtrArray) imgs_src = NULL;
+
+	/* independent files */
+	for (guint i = 0; i < 8; i++) {
+		g_autoptr(FuFirmware) img = fu_efi_file_new();
+		g_autoptr(GBytes) blob_tmp = NULL;
+		g_autofree guint8 *buf_tmp = g_malloc0(0x100 + i);
+		memset(buf_tmp, i, 0x100 + i);
+		blob_tmp = g_bytes_new(buf_tmp, 0x100 + i);
+		fu_firmware_set_id(img, "ced4eac6-49f3-4c12-a597-fc8c33447691");
+		fu_firmware_set_bytes(img, blob_tmp);
+		ret = fu_firmware_add_image(filesystem, img, &error);
+		g_assert_no_error(error);
+		g_assert_true(ret);
+	}
+	blob = fu_firmware_write(filesystem, &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(blob);
+
+	/* parse serially */
+	ret = fu_firmware_parse_bytes(filesystem_serial,
+				      blob,
+				      0x0,
+				      FU_FIRMWARE_PARSE_FLAG_NO_SEARCH,
+				      &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+
+	/* parse using a worker pool */
+	ret = fu_firmware_parse_bytes(filesystem_parallel,
+				      blob,
+				      0x0,
+				      FU_FIRMWARE_PARSE_FLAG_NO_SEARCH |
+					  FU_FIRMWARE_PARSE_FLAG_PARALLEL,
+				      &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+
+	/* same result, in the same order */
+	xml_serial =
+	    fu_firmware_export_to_xml(filesystem_serial, FU_FIRMWARE_EXPORT_FLAG_NONE, &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(xml_serial);
+	xml_parallel =
+	    fu_firmware_export_to_xml(filesystem_parallel, FU_FIRMWARE_EXPORT_FLAG_NONE, &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(xml_parallel);
+	g_assert_cmpstr(xml_serial, ==, xml_parallel);
+
+	/* each file has the offset it was written at, and the filesystem is unchanged */
+	imgs = fu_firmware_get_images(filesystem_parallel);
+	imgs_src = fu_firmware_get_images(filesystem);
+	g_assert_cmpint(imgs->len, ==, 8);
+	for (guint i = 0; i < imgs->len; i++) {
+		FuFirmware *img = g_ptr_array_index(imgs, i);
+		FuFirmware *img_src = g_ptr_array_index(imgs_src, i);
+		g_assert_cmpint(fu_firmware_get_offset(img), ==, fu_firmware_get_offset(img_src));
+	}
+	g_assert_cmpint(fu_firmware_get_offset(filesystem_parallel), ==, 0x0);
+
+	/* corrupt the header checksum of the third file, and get the same error */
+	buf = g_memdup2(g_bytes_get_data(blob, &bufsz), bufsz);
+	buf[fu_firmware_get_offset(g_ptr_array_index(imgs_src, 2)) + 0x10] ^= 0xFF;
+	blob_invalid = g_bytes_new_take(g_steal_pointer(&buf), bufsz);
+	ret = fu_firmware_parse_bytes(filesystem_invalid,
+				      blob_invalid,
+				      0x0,
+				      FU_FIRMWARE_PARSE_FLAG_NO_SEARCH,
+				      &error_serial);
+	g_assert_error(error_serial, FWUPD_ERROR, FWUPD_ERROR_INVALID_FILE);
+	g_assert_false(ret);
+	g_clear_object(&filesystem_invalid);
+	filesystem_invalid = fu_efi_filesystem_new();
+	ret = fu_firmware_parse_bytes(filesystem_invalid,
+				      blob_invalid,
+				      0x0,
+				      FU_FIRMWARE_PARSE_FLAG_NO_SEARCH |
+					  FU_FIRMWARE_PARSE_FLAG_PARALLEL,
+				      &error);
+	g_assert_error(error, FWUPD_ERROR, FWUPD_ERROR_INVALID_FILE);
+	g_assert_false(ret);
+	g_assert_cmpstr(error->message, ==, error_serial->message);
+}
+
+static void
+fu_efi_filesystem_lazy_func(void)
+{
+	gboolean ret;
+	gsize bufsz = 0;
+	g_autofree gchar *str = NULL;
+	g_autofree gchar *xml_lazy = NULL;
+	g_autofree gchar *xml_serial = NULL;
+	g_autofree guint8 *buf = NULL;
+	g_autoptr(FuFirmware) filesystem = fu_efi_filesystem_new();
+	g_autoptr(FuFirmware) filesystem_invalid = fu_efi_filesystem_new();
+	g_autoptr(FuFirmware) filesystem_lazy = fu_efi_filesystem_new();
+	g_autoptr(FuFirmware) filesystem_serial = fu_efi_filesystem_new();
+	g_autoptr(FuFirmware) img = NULL;
+	g_autoptr(FuFirmware) img_invalid = NULL;
+	g_autoptr(FuFirmwareProfiler) profiler = fu_firmware_profiler_new();
+	g_autoptr(GBytes) blob = NULL;
+	g_autoptr(GBytes) blob_invalid = NULL;
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GPtrArray) imgs_invalid = NULL;
+	g_autoptr(GPtrArray) imgs_src = NULL;
+
+	/* lots of files, but only one is required */
+	for (guint i = 0; i < 64; i++) {
+		g_autoptr(FuFirmware) img_tmp = fu_efi_file_new();
+		g_autoptr(GBytes) blob_tmp = NULL;
+		g_autofree gchar *id = g_strdup_printf("ced4eac6-49f3-4c12-a597-%012x", i);
+		g_autofree guint8 *buf_tmp = g_malloc0(0x1000 + i);
+		memset(buf_tmp, i, 0x1000 + i);
+		blob_tmp = g_bytes_new(buf_tmp, 0x1000 + i);
+		fu_firmware_set_id(img_tmp, id);
+		fu_firmware_set_bytes(img_tmp, blob_tmp);
+		ret = fu_firmware_add_image(filesystem, img_tmp, &error);
+		g_assert_no_error(error);
+		g_assert_true(ret);
+	}
+	blob = fu_firmware_write(filesystem, &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(blob);
+
+	/* only the file that was looked up gets parsed */
+	fu_firmware_profiler_push_thread_default(profiler);
+	ret = fu_firmware_parse_bytes(filesystem_lazy,
+				      blob,
+				      0x0,
+				      FU_FIRMWARE_PARSE_FLAG_NO_SEARCH |
+					  FU_FIRMWARE_PARSE_FLAG_LAZY,
+				      &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	img = fu_firmware_get_image_by_id(filesystem_lazy,
+					  "ced4eac6-49f3-4c12-a597-00000000001f",
+					  &error);
+	fu_firmware_profiler_pop_thread_default(profiler);
+	g_assert_no_error(error);
+	g_assert_nonnull(img);
+	str = fu_firmware_profiler_to_string(profiler);
+	g_debug("%s", str);
+	g_assert_nonnull(g_strstr_len(str, -1, "0 FuEfiFile: count=1 "));
+
+	/* the remaining files are parsed on export */
+	ret = fu_firmware_parse_bytes(filesystem_serial,
+				      blob,
+				      0x0,
+				      FU_FIRMWARE_PARSE_FLAG_NO_SEARCH,
+				      &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	xml_serial =
+	    fu_firmware_export_to_xml(filesystem_serial, FU_FIRMWARE_EXPORT_FLAG_NONE, &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(xml_serial);
+	xml_lazy = fu_firmware_export_to_xml(filesystem_lazy, FU_FIRMWARE_EXPORT_FLAG_NONE, &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(xml_lazy);
+	g_assert_cmpstr(xml_serial, ==, xml_lazy);
+
+	/* a corrupt file is not found until it is parsed, but then the error is returned */
+	imgs_src = fu_firmware_get_images(filesystem);
+	buf = g_memdup2(g_bytes_get_data(blob, &bufsz), bufsz);
+	buf[fu_firmware_get_offset(g_ptr_array_index(imgs_src, 2)) + 0x10] ^= 0xFF;
+	blob_invalid = g_bytes_new_take(g_steal_pointer(&buf), bufsz);
+	ret = fu_firmware_parse_bytes(filesystem_invalid,
+				      blob_invalid,
+				      0x0,
+				      FU_FIRMWARE_PARSE_FLAG_NO_SEARCH |
+					  FU_FIRMWARE_PARSE_FLAG_LAZY,
+				      &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	img_invalid = fu_firmware_get_image_by_id(filesystem_invalid,
+						  "ced4eac6-49f3-4c12-a597-000000000002",
+						  &error);
+	g_assert_error(error, FWUPD_ERROR, FWUPD_ERROR_INVALID_FILE);
+	g_assert_null(img_invalid);
+	g_clear_error(&error);
+	ret = fu_firmware_ensure_images_parsed(filesystem_invalid, &error);
+	g_assert_error(error, FWUPD_ERROR, FWUPD_ERROR_INVALID_FILE);
+	g_assert_false(ret);
+
+	/* getting all the images parses them, leaving out the corrupt file */
+	imgs_invalid = fu_firmware_get_images(filesystem_invalid);
+	g_assert_cmpint(imgs_invalid->len, ==, 63);
+	for (guint i = 0; i < imgs_invalid->len; i++) {
+		FuFirmware *img_tmp = g_ptr_array_index(imgs_invalid, i);
+		g_assert_cmpint(fu_firmware_get_size(img_tmp), >, 0x1000);
+	}
+}
+
 static void
 fu_efi_lz77_decompressor_func(void)
 {
@@ -208,6 +418,105 @@ fu_efi_lz77_decompressor_func(void)
 	g_assert_cmpstr(csum_legacy, ==, "40f7fbaff684a6bcf67c81b3079422c2529741e1");
 }
 
+static void
+fu_efi_lz77_decompressor_parity_func(void)
+{
+	g_autofree gchar *filename = NULL;
+	g_autoptr(GBytes) blob = NULL;
+	g_autoptr(GError) error = NULL;
+
+	/* multiple Tiano blocks with long codes, overlapping matches and incompressible data */
+	filename = g_test_build_filename(G_TEST_DIST, "tests", "efi-lz77-tiano-parity.bin", NULL);
+	blob = fu_bytes_get_contents(filename, &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(blob);
+
+	/* the checksum is of the output of the previous byte-at-a-time decoder, and trailing data
+	 * is never used but changes how the bit buffer is refilled */
+	for (guint i = 0; i < 16; i++) {
+		gboolean ret;
+		g_autofree gchar *csum = NULL;
+		g_autoptr(FuFirmware) lz77_decompressor = fu_efi_lz77_decompressor_new();
+		g_autoptr(GByteArray) buf = g_byte_array_new();
+		g_autoptr(GBytes) blob_padded = NULL;
+		g_autoptr(GBytes) blob_out = NULL;
+
+		fu_byte_array_append_bytes(buf, blob);
+		fu_byte_array_set_size(buf, buf->len + i, 0xFF);
+		blob_padded = g_byte_array_free_to_bytes(g_steal_pointer(&buf));
+		ret = fu_firmware_parse_bytes(lz77_decompressor,
+					      blob_padded,
+					      0x0,
+					      FU_FIRMWARE_PARSE_FLAG_NONE,
+					      &error);
+		g_assert_no_error(error);
+		g_assert_true(ret);
+		g_assert_cmpint(fu_firmware_get_version_raw(lz77_decompressor),
+				==,
+				FU_EFI_LZ77_DECOMPRESSOR_VERSION_TIANO);
+		blob_out = fu_firmware_get_bytes(lz77_decompressor, &error);
+		g_assert_no_error(error);
+		g_assert_nonnull(blob_out);
+		g_assert_cmpint(g_bytes_get_size(blob_out), ==, 47107);
+		csum = g_compute_checksum_for_bytes(G_CHECKSUM_SHA1, blob_out);
+		g_assert_cmpstr(csum, ==, "eb51b1189ecb36790b410a63201569e40d5b4347");
+	}
+
+	/* corrupt each byte of the payload in turn, which must never crash */
+	for (gsize i = FU_STRUCT_EFI_LZ77_DECOMPRESSOR_HEADER_SIZE; i < g_bytes_get_size(blob);
+	     i++) {
+		g_autoptr(FuFirmware) lz77_decompressor = fu_efi_lz77_decompressor_new();
+		g_autoptr(GByteArray) buf = g_byte_array_new();
+		g_autoptr(GBytes) blob_corrupt = NULL;
+		g_autoptr(GError) error_local = NULL;
+
+		fu_byte_array_append_bytes(buf, blob);
+		buf->data[i] ^= 0xFF;
+		blob_corrupt = g_byte_array_free_to_bytes(g_steal_pointer(&buf));
+		if (!fu_firmware_parse_bytes(lz77_decompressor,
+					     blob_corrupt,
+					     0x0,
+					     FU_FIRMWARE_PARSE_FLAG_NONE,
+					     &error_local))
+			g_debug("corrupt @0x%x: %s", (guint)i, error_local->message);
+	}
+}
+
+static void
+fu_efi_lz77_decompressor_throughput_func(void)
+{
+	gsize total = 0;
+	g_autofree gchar *filename = NULL;
+	g_autoptr(GBytes) blob = NULL;
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GTimer) timer = g_timer_new();
+
+	filename = g_test_build_filename(G_TEST_DIST, "tests", "efi-lz77-tiano-parity.bin", NULL);
+	blob = fu_bytes_get_contents(filename, &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(blob);
+	for (guint i = 0; i < 10000; i++) {
+		gboolean ret;
+		g_autoptr(FuFirmware) lz77_decompressor = fu_efi_lz77_decompressor_new();
+		g_autoptr(GBytes) blob_out = NULL;
+		ret = fu_firmware_parse_bytes(lz77_decompressor,
+					      blob,
+					      0x0,
+					      FU_FIRMWARE_PARSE_FLAG_NONE,
+					      &error);
+		g_assert_no_error(error);
+		g_assert_true(ret);
+		blob_out = fu_firmware_get_bytes(lz77_decompressor, &error);
+		g_assert_no_error(error);
+		g_assert_nonnull(blob_out);
+		g_assert_cmpint(g_bytes_get_size(blob_out), ==, 47107);
+		total += g_bytes_get_size(blob_out);
+	}
+	g_test_message("decompressed %" G_GSIZE_FORMAT " bytes at %.1fMB/s",
+		       total,
+		       (total / (1024.f * 1024.f)) / g_timer_elapsed(timer, NULL));
+}
+
 static void
 fu_efi_load_option_path_func(void)
 {
@@ -385,7 +694,15 @@ main(int argc, char **argv)
 	g_test_add_func("/fwupd/efi/variable-authentication2",
 			fu_efi_variable_authentication2_func);
 #endif
+	g_test_add_func("/fwupd/efi/filesystem/parallel", fu_efi_filesystem_parallel_func);
+	g_test_add_func("/fwupd/efi/filesystem/lazy", fu_efi_filesystem_lazy_func);
 	g_test_add_func("/fwupd/efi/lz77/decompressor", fu_efi_lz77_decompressor_func);
+	g_test_add_func("/fwupd/efi/lz77/decompressor/parity",
+			fu_efi_lz77_decompressor_parity_func);
+	if (g_test_slow()) {
+		g_test_add_func("/fwupd/efi/lz77/decompressor/throughput",
+				fu_efi_lz77_decompressor_throughput_func);
+	}
 	g_test_add_func("/fwupd/efi/timestamp/roundtrip", fu_efi_timestamp_roundtrip_func);
 	g_test_add_func("/fwupd/efi/timestamp/export-zero", fu_efi_timestamp_export_zero_func);
 	return g_test_run();
@@ -16,3 +16,9 @@ gboolean
 fu_efivars_build_boot_order(FuEfivars *self, GError **error, ...) G_GNUC_NON_NULL(1);
 FuPathStore *
 fu_efivars_get_path_store(FuEfivars *self) G_GNUC_NON_NULL(1);
+void
+fu_efivars_invalidate(FuEfivars *self) G_GNUC_NON_NULL(1);
+guint
+fu_efivars_get_snapshot_hits(FuEfivars *self) G_GNUC_NON_NULL(1);
+guint
+fu_efivars_get_snapshot_misses(FuEfivars *self) G_GNUC_NON_NULL(1);
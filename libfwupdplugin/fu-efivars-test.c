@@ -61,6 +61,46 @@ fu_efivars_func(void)
 			FU_EFI_VARIABLE_ATTR_NON_VOLATILE | FU_EFI_VARIABLE_ATTR_RUNTIME_ACCESS);
 	g_assert_cmpint(data[0], ==, '1');
 
+	/* read again from the snapshot */
+	g_clear_pointer(&data, g_free);
+	ret = fu_efivars_get_data(efivars,
+				  FU_EFIVARS_GUID_EFI_GLOBAL,
+				  "Test",
+				  &data,
+				  &sz,
+				  NULL,
+				  &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	g_assert_cmpint(sz, ==, 1);
+	g_assert_cmpint(data[0], ==, '1');
+	g_assert_cmpint(fu_efivars_get_snapshot_misses(efivars), ==, 1);
+	g_assert_cmpint(fu_efivars_get_snapshot_hits(efivars), ==, 1);
+
+	/* writing invalidates the snapshot */
+	ret = fu_efivars_set_data(efivars,
+				  FU_EFIVARS_GUID_EFI_GLOBAL,
+				  "Test",
+				  (guint8 *)"2",
+				  1,
+				  FU_EFI_VARIABLE_ATTR_NON_VOLATILE |
+				      FU_EFI_VARIABLE_ATTR_RUNTIME_ACCESS,
+				  &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	g_clear_pointer(&data, g_free);
+	ret = fu_efivars_get_data(efivars,
+				  FU_EFIVARS_GUID_EFI_GLOBAL,
+				  "Test",
+				  &data,
+				  &sz,
+				  NULL,
+				  &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	g_assert_cmpint(data[0], ==, '2');
+	g_assert_cmpint(fu_efivars_get_snapshot_misses(efivars), ==, 2);
+
 	/* check free space again */
 	total = fu_efivars_space_free(efivars, &error);
 	g_assert_no_error(error);
@@ -17,8 +17,18 @@
 #include "fu-mem.h"
 #include "fu-pefile-firmware.h"
 
+typedef struct {
+	GBytes *blob;
+	FuEfiVariableAttrs attr;
+} FuEfivarsSnapshotItem;
+
 typedef struct {
 	FuPathStore *pstore;
+	GHashTable *snapshot;	    /* (element-type utf8 FuEfivarsSnapshotItem) */
+	GHashTable *snapshot_names; /* (element-type utf8 GPtrArray) */
+	guint64 snapshot_space_used;
+	guint snapshot_hits;
+	guint snapshot_misses;
 } FuEfivarsPrivate;
 
 enum { PROP_0, PROP_PATH_STORE, PROP_LAST };
@@ -45,6 +55,84 @@ fu_efivars_get_path_store(FuEfivars *self)
 	return priv->pstore;
 }
 
+static void
+fu_efivars_snapshot_item_free(FuEfivarsSnapshotItem *item)
+{
+	g_bytes_unref(item->blob);
+	g_free(item);
+}
+
+static gchar *
+fu_efivars_snapshot_key(const gchar *guid, const gchar *name)
+{
+	return g_strdup_printf("%s-%s", name, guid);
+}
+
+/**
+ * fu_efivars_invalidate:
+ * @self: a #FuEfivars
+ *
+ * Invalidates the in-memory snapshot of the EFI variable store, which is required if the
+ * variables are changed by something other than this object.
+ *
+ * Since: 2.1.6
+ **/
+void
+fu_efivars_invalidate(FuEfivars *self)
+{
+	FuEfivarsPrivate *priv = GET_PRIVATE(self);
+	g_return_if_fail(FU_IS_EFIVARS(self));
+	g_hash_table_remove_all(priv->snapshot);
+	g_hash_table_remove_all(priv->snapshot_names);
+	priv->snapshot_space_used = G_MAXUINT64;
+}
+
+static void
+fu_efivars_invalidate_key(FuEfivars *self, const gchar *guid, const gchar *name)
+{
+	FuEfivarsPrivate *priv = GET_PRIVATE(self);
+	g_autofree gchar *key = fu_efivars_snapshot_key(guid, name);
+	g_hash_table_remove(priv->snapshot, key);
+	g_hash_table_remove(priv->snapshot_names, guid);
+	priv->snapshot_space_used = G_MAXUINT64;
+}
+
+/**
+ * fu_efivars_get_snapshot_hits:
+ * @self: a #FuEfivars
+ *
+ * Gets the number of reads that were served from the in-memory snapshot.
+ *
+ * Returns: integer
+ *
+ * Since: 2.1.6
+ **/
+guint
+fu_efivars_get_snapshot_hits(FuEfivars *self)
+{
+	FuEfivarsPrivate *priv = GET_PRIVATE(self);
+	g_return_val_if_fail(FU_IS_EFIVARS(self), 0);
+	return priv->snapshot_hits;
+}
+
+/**
+ * fu_efivars_get_snapshot_misses:
+ * @self: a #FuEfivars
+ *
+ * Gets the number of reads that had to query the EFI variable store.
+ *
+ * Returns: integer
+ *
+ * Since: 2.1.6
+ **/
+guint
+fu_efivars_get_snapshot_misses(FuEfivars *self)
+{
+	FuEfivarsPrivate *priv = GET_PRIVATE(self);
+	g_return_val_if_fail(FU_IS_EFIVARS(self), 0);
+	return priv->snapshot_misses;
+}
+
 /**
  * fu_efivars_supported:
  * @self: a #FuEfivars
@@ -98,6 +186,7 @@ fu_efivars_delete(FuEfivars *self, const gchar *guid, const gchar *name, GError
 		g_set_error_literal(error, FWUPD_ERROR, FWUPD_ERROR_NOT_SUPPORTED, "not supported");
 		return FALSE;
 	}
+	fu_efivars_invalidate_key(self, guid, name);
 	return efivars_class->delete(self, guid, name, error);
 }
 
@@ -131,6 +220,7 @@ fu_efivars_delete_with_glob(FuEfivars *self,
 		g_set_error_literal(error, FWUPD_ERROR, FWUPD_ERROR_NOT_SUPPORTED, "not supported");
 		return FALSE;
 	}
+	fu_efivars_invalidate(self);
 	return efivars_class->delete_with_glob(self, guid, name_glob, error);
 }
 
@@ -150,10 +240,19 @@ gboolean
 fu_efivars_exists(FuEfivars *self, const gchar *guid, const gchar *name)
 {
 	FuEfivarsClass *efivars_class = FU_EFIVARS_GET_CLASS(self);
+	FuEfivarsPrivate *priv = GET_PRIVATE(self);
 
 	g_return_val_if_fail(FU_IS_EFIVARS(self), FALSE);
 	g_return_val_if_fail(guid != NULL, FALSE);
 
+	/* already read */
+	if (name != NULL) {
+		g_autofree gchar *key = fu_efivars_snapshot_key(guid, name);
+		if (g_hash_table_contains(priv->snapshot, key)) {
+			priv->snapshot_hits++;
+			return TRUE;
+		}
+	}
 	if (efivars_class->exists == NULL)
 		return FALSE;
 	return efivars_class->exists(self, guid, name);
@@ -185,6 +284,11 @@ fu_efivars_get_data(FuEfivars *self,
 		    GError **error)
 {
 	FuEfivarsClass *efivars_class = FU_EFIVARS_GET_CLASS(self);
+	FuEfivarsPrivate *priv = GET_PRIVATE(self);
+	FuEfivarsSnapshotItem *item;
+	gsize bufsz = 0;
+	const guint8 *buf;
+	g_autofree gchar *key = NULL;
 
 	g_return_val_if_fail(FU_IS_EFIVARS(self), FALSE);
 	g_return_val_if_fail(guid != NULL, FALSE);
@@ -195,7 +299,41 @@ fu_efivars_get_data(FuEfivars *self,
 		g_set_error_literal(error, FWUPD_ERROR, FWUPD_ERROR_NOT_SUPPORTED, "not supported");
 		return FALSE;
 	}
-	return efivars_class->get_data(self, guid, name, data, data_sz, attr, error);
+
+	/* read the whole variable once, as each read goes through the firmware runtime services */
+	key = fu_efivars_snapshot_key(guid, name);
+	item = g_hash_table_lookup(priv->snapshot, key);
+	if (item == NULL) {
+		guint8 *data_tmp = NULL;
+		gsize data_sz_tmp = 0;
+		FuEfiVariableAttrs attr_tmp = FU_EFI_VARIABLE_ATTR_NONE;
+
+		priv->snapshot_misses++;
+		if (!efivars_class->get_data(self,
+					     guid,
+					     name,
+					     &data_tmp,
+					     &data_sz_tmp,
+					     &attr_tmp,
+					     error))
+			return FALSE;
+		item = g_new0(FuEfivarsSnapshotItem, 1);
+		item->blob = g_bytes_new_take(data_tmp, data_sz_tmp);
+		item->attr = attr_tmp;
+		g_hash_table_insert(priv->snapshot, g_steal_pointer(&key), item);
+	} else {
+		priv->snapshot_hits++;
+	}
+
+	/* copy out */
+	buf = g_bytes_get_data(item->blob, &bufsz);
+	if (data != NULL)
+		*data = g_memdup2(buf, bufsz);
+	if (data_sz != NULL)
+		*data_sz = bufsz;
+	if (attr != NULL)
+		*attr = item->attr;
+	return TRUE;
 }
 
 /**
@@ -226,11 +364,7 @@ fu_efivars_get_attrs(FuEfivars *self,
 	g_return_val_if_fail(name != NULL, FALSE);
 	g_return_val_if_fail(error == NULL || *error == NULL, FALSE);
 
-	if (efivars_class->get_data == NULL) {
-		g_set_error_literal(error, FWUPD_ERROR, FWUPD_ERROR_NOT_SUPPORTED, "not supported");
-		return FALSE;
-	}
-	return efivars_class->get_data(self, guid, name, NULL, NULL, attrs, error);
+	return fu_efivars_get_data(self, guid, name, NULL, NULL, attrs, error);
 }
 
 /**
@@ -284,6 +418,9 @@ GPtrArray *
 fu_efivars_get_names(FuEfivars *self, const gchar *guid, GError **error)
 {
 	FuEfivarsClass *efivars_class = FU_EFIVARS_GET_CLASS(self);
+	FuEfivarsPrivate *priv = GET_PRIVATE(self);
+	GPtrArray *names;
+	g_autoptr(GPtrArray) names_copy = g_ptr_array_new_with_free_func(g_free);
 
 	g_return_val_if_fail(FU_IS_EFIVARS(self), NULL);
 	g_return_val_if_fail(guid != NULL, NULL);
@@ -293,7 +430,27 @@ fu_efivars_get_names(FuEfivars *self, const gchar *guid, GError **error)
 		g_set_error_literal(error, FWUPD_ERROR, FWUPD_ERROR_NOT_SUPPORTED, "not supported");
 		return NULL;
 	}
-	return efivars_class->get_names(self, guid, error);
+
+	/* this requires listing every variable */
+	names = g_hash_table_lookup(priv->snapshot_names, guid);
+	if (names == NULL) {
+		priv->snapshot_misses++;
+		names = efivars_class->get_names(self, guid, error);
+		if (names == NULL)
+			return NULL;
+		g_hash_table_insert(priv->snapshot_names, g_strdup(guid), names);
+	} else {
+		priv->snapshot_hits++;
+	}
+	for (guint i = 0; i < names->len; i++)
+		g_ptr_array_add(names_copy, g_strdup(g_ptr_array_index(names, i)));
+	return g_steal_pointer(&names_copy);
+}
+
+static void
+fu_efivars_monitor_changed_cb(FuEfivars *self)
+{
+	fu_efivars_invalidate(self);
 }
 
 /**
@@ -313,6 +470,7 @@ GFileMonitor *
 fu_efivars_get_monitor(FuEfivars *self, const gchar *guid, const gchar *name, GError **error)
 {
 	FuEfivarsClass *efivars_class = FU_EFIVARS_GET_CLASS(self);
+	GFileMonitor *monitor;
 
 	g_return_val_if_fail(FU_IS_EFIVARS(self), NULL);
 	g_return_val_if_fail(guid != NULL, NULL);
@@ -322,7 +480,15 @@ fu_efivars_get_monitor(FuEfivars *self, const gchar *guid, const gchar *name, GE
 		g_set_error_literal(error, FWUPD_ERROR, FWUPD_ERROR_NOT_SUPPORTED, "not supported");
 		return NULL;
 	}
-	return efivars_class->get_monitor(self, guid, name, error);
+	monitor = efivars_class->get_monitor(self, guid, name, error);
+	if (monitor == NULL)
+		return NULL;
+	g_signal_connect_object(monitor,
+				"changed",
+				G_CALLBACK(fu_efivars_monitor_changed_cb),
+				self,
+				G_CONNECT_SWAPPED);
+	return monitor;
 }
 
 /**
@@ -341,6 +507,7 @@ guint64
 fu_efivars_space_used(FuEfivars *self, GError **error)
 {
 	FuEfivarsClass *efivars_class = FU_EFIVARS_GET_CLASS(self);
+	FuEfivarsPrivate *priv = GET_PRIVATE(self);
 
 	g_return_val_if_fail(FU_IS_EFIVARS(self), G_MAXUINT64);
 	g_return_val_if_fail(error == NULL || *error == NULL, G_MAXUINT64);
@@ -349,7 +516,13 @@ fu_efivars_space_used(FuEfivars *self, GError **error)
 		g_set_error_literal(error, FWUPD_ERROR, FWUPD_ERROR_NOT_SUPPORTED, "not supported");
 		return G_MAXUINT64;
 	}
-	return efivars_class->space_used(self, error);
+	if (priv->snapshot_space_used != G_MAXUINT64) {
+		priv->snapshot_hits++;
+		return priv->snapshot_space_used;
+	}
+	priv->snapshot_misses++;
+	priv->snapshot_space_used = efivars_class->space_used(self, error);
+	return priv->snapshot_space_used;
 }
 
 /**
@@ -415,6 +588,7 @@ fu_efivars_set_data(FuEfivars *self,
 		g_set_error_literal(error, FWUPD_ERROR, FWUPD_ERROR_NOT_SUPPORTED, "not supported");
 		return FALSE;
 	}
+	fu_efivars_invalidate_key(self, guid, name);
 	return efivars_class->set_data(self, guid, name, data, sz, attr, error);
 }
 
@@ -1023,6 +1197,16 @@ fu_efivars_set_property(GObject *object, guint prop_id, const GValue *value, GPa
 static void
 fu_efivars_init(FuEfivars *self)
 {
+	FuEfivarsPrivate *priv = GET_PRIVATE(self);
+	priv->snapshot = g_hash_table_new_full(g_str_hash,
+					       g_str_equal,
+					       g_free,
+					       (GDestroyNotify)fu_efivars_snapshot_item_free);
+	priv->snapshot_names = g_hash_table_new_full(g_str_hash,
+						     g_str_equal,
+						     g_free,
+						     (GDestroyNotify)g_ptr_array_unref);
+	priv->snapshot_space_used = G_MAXUINT64;
 }
 
 static void
@@ -1033,6 +1217,8 @@ fu_efivars_finalize(GObject *object)
 
 	if (priv->pstore != NULL)
 		g_object_unref(priv->pstore);
+	g_hash_table_unref(priv->snapshot);
+	g_hash_table_unref(priv->snapshot_names);
 
 	G_OBJECT_CLASS(fu_efivars_parent_class)->finalize(object);
 }
@@ -226,3 +226,71 @@ fu_firmware_strparse_uint32_safe(const gchar *data,
 		*value = (guint32)valuetmp;
 	return TRUE;
 }
+
+/* the digit value plus one, so that zero marks an invalid char */
+static const guint8 fu_firmware_strparse_hex_lut[256] = {
+    ['0'] = 0x01, ['1'] = 0x02, ['2'] = 0x03, ['3'] = 0x04, ['4'] = 0x05, ['5'] = 0x06,
+    ['6'] = 0x07, ['7'] = 0x08, ['8'] = 0x09, ['9'] = 0x0A, ['A'] = 0x0B, ['B'] = 0x0C,
+    ['C'] = 0x0D, ['D'] = 0x0E, ['E'] = 0x0F, ['F'] = 0x10, ['a'] = 0x0B, ['b'] = 0x0C,
+    ['c'] = 0x0D, ['d'] = 0x0E, ['e'] = 0x0F, ['f'] = 0x10,
+};
+
+/**
+ * fu_firmware_strparse_hex_safe:
+ * @data: source buffer
+ * @datasz: size of @data, typically the same as `strlen(data)`
+ * @offset: offset in chars into @data to read
+ * @buf: destination buffer
+ * @bufsz: number of bytes to decode into @buf
+ * @error: (nullable): optional return location for an error
+ *
+ * Decodes a run of `bufsz * 2` base 16 characters into bytes, without allocating.
+ *
+ * This is much faster than calling fu_firmware_strparse_uint8_safe() on each byte when
+ * decoding an entire record of a large text firmware.
+ *
+ * Returns: %TRUE if parsed, %FALSE otherwise
+ *
+ * Since: 2.1.6
+ **/
+gboolean
+fu_firmware_strparse_hex_safe(const gchar *data,
+			      gsize datasz,
+			      gsize offset,
+			      guint8 *buf,
+			      gsize bufsz,
+			      GError **error)
+{
+	const guint8 *src;
+
+	g_return_val_if_fail(data != NULL, FALSE);
+	g_return_val_if_fail(buf != NULL || bufsz == 0, FALSE);
+
+	/* check bounds */
+	if (offset > datasz || bufsz > (datasz - offset) / 2) {
+		g_set_error(error,
+			    FWUPD_ERROR,
+			    FWUPD_ERROR_INVALID_DATA,
+			    "cannot parse 0x%x chars at offset 0x%x of 0x%x",
+			    (guint)(bufsz * 2),
+			    (guint)offset,
+			    (guint)datasz);
+		return FALSE;
+	}
+
+	src = (const guint8 *)data + offset;
+	for (gsize i = 0; i < bufsz; i++) {
+		guint8 hi = fu_firmware_strparse_hex_lut[src[i * 2]];
+		guint8 lo = fu_firmware_strparse_hex_lut[src[(i * 2) + 1]];
+		if (hi == 0 || lo == 0) {
+			g_set_error(error,
+				    FWUPD_ERROR,
+				    FWUPD_ERROR_INVALID_DATA,
+				    "cannot parse char at offset 0x%x as hex",
+				    (guint)(offset + (i * 2)));
+			return FALSE;
+		}
+		buf[i] = ((hi - 1) << 4) | (lo - 1);
+	}
+	return TRUE;
+}
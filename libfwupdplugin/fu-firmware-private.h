@@ -12,3 +12,27 @@
 
 GArray *
 fu_firmware_get_image_gtypes(FuFirmware *self) G_GNUC_NON_NULL(1);
+guint
+fu_firmware_get_images_generation(FuFirmware *self) G_GNUC_NON_NULL(1);
+
+typedef gboolean (*FuFirmwareParallelFunc)(gpointer item, gpointer user_data, GError **error);
+
+gboolean
+fu_firmware_parallel_foreach(GPtrArray *items,
+			     FuFirmwareParseFlags flags,
+			     FuFirmwareParallelFunc func,
+			     gpointer user_data,
+			     GError **error) G_GNUC_NON_NULL(1, 3);
+gboolean
+fu_firmware_parse_images(GPtrArray *imgs,
+			 GPtrArray *streams,
+			 FuFirmwareParseFlags flags,
+			 guint *idx_failed,
+			 GError **error) G_GNUC_NON_NULL(1, 2);
+gboolean
+fu_firmware_add_image_lazy(FuFirmware *self,
+			   FuFirmware *img,
+			   GInputStream *stream,
+			   gsize offset,
+			   FuFirmwareParseFlags flags,
+			   GError **error) G_GNUC_NON_NULL(1, 2, 3);
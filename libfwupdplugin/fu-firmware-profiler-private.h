@@ -0,0 +1,24 @@
+/*
+ * Copyright 2026 Richard Hughes <richard@hughsie.com>
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ */
+
+#pragma once
+
+#include "fu-firmware-profiler.h"
+
+typedef struct FuFirmwareProfilerFrame FuFirmwareProfilerFrame;
+
+FuFirmwareProfilerFrame *
+fu_firmware_profiler_frame_get_current(void);
+void
+fu_firmware_profiler_push_worker(FuFirmwareProfiler *self, FuFirmwareProfilerFrame *parent)
+    G_GNUC_NON_NULL(1);
+void
+fu_firmware_profiler_pop_worker(FuFirmwareProfiler *self) G_GNUC_NON_NULL(1);
+FuFirmwareProfilerFrame *
+fu_firmware_profiler_frame_new(FuFirmwareProfiler *self, GType gtype) G_GNUC_NON_NULL(1);
+void
+fu_firmware_profiler_frame_done(FuFirmwareProfilerFrame *frame, gsize size, gboolean success)
+    G_GNUC_NON_NULL(1);
@@ -0,0 +1,390 @@
+/*
+ * Copyright 2026 Richard Hughes <richard@hughsie.com>
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ */
+
+#define G_LOG_DOMAIN "FuFirmwareProfiler"
+
+#include "config.h"
+
+#ifdef HAVE_MALLOC_H
+#include <malloc.h>
+#endif
+
+#include "fu-firmware-profiler-private.h"
+
+/**
+ * FuFirmwareProfiler:
+ *
+ * An opt-in profiler that records where time and memory is spent when parsing nested firmware.
+ *
+ * Results are aggregated per #FuFirmware GType and nesting depth. The profiler only records
+ * firmware parsed in threads where it has been made the thread default, or in the workers used
+ * by %FU_FIRMWARE_PARSE_FLAG_PARALLEL.
+ *
+ * The heap delta is process-wide, and so is not reported if any worker threads were used.
+ *
+ * See also: [class@FuFirmware]
+ */
+
+typedef struct {
+	GType gtype;
+	guint depth;
+	guint count;
+	guint failures;
+	guint64 size;
+	guint64 elapsed;      /* us, including children */
+	guint64 elapsed_self; /* us, excluding children */
+	gint64 heap_delta;    /* bytes */
+	guint64 size_compressed;
+	guint64 size_decompressed;
+} FuFirmwareProfilerEntry;
+
+struct FuFirmwareProfilerFrame {
+	FuFirmwareProfiler *profiler; /* no-ref */
+	FuFirmwareProfilerFrame *parent;
+	GType gtype;
+	guint depth;
+	gint64 time_start;
+	gint64 time_children;
+	gint64 heap_start;
+	guint64 size_compressed;
+	guint64 size_decompressed;
+};
+
+struct _FuFirmwareProfiler {
+	GObject parent_instance;
+	GMutex mutex;	    /* for entries and has_workers */
+	GPtrArray *entries; /* element-type FuFirmwareProfilerEntry */
+	gboolean has_workers;
+};
+
+G_DEFINE_TYPE(FuFirmwareProfiler, fu_firmware_profiler, G_TYPE_OBJECT)
+
+static GPrivate fu_firmware_profiler_thread_default = G_PRIVATE_INIT(NULL); /* nocheck:static */
+static GPrivate fu_firmware_profiler_frame_current = G_PRIVATE_INIT(NULL); /* nocheck:static */
+
+static gint64
+fu_firmware_profiler_get_heap_used(void)
+{
+#ifdef HAVE_MALLINFO2
+	struct mallinfo2 mi = mallinfo2();
+	return (gint64)mi.uordblks + (gint64)mi.hblkhd;
+#else
+	return 0;
+#endif
+}
+
+/**
+ * fu_firmware_profiler_push_thread_default:
+ * @self: a #FuFirmwareProfiler
+ *
+ * Records all firmware parsed by this thread into @self until
+ * fu_firmware_profiler_pop_thread_default() is called.
+ *
+ * Since: 2.1.6
+ **/
+void
+fu_firmware_profiler_push_thread_default(FuFirmwareProfiler *self)
+{
+	g_return_if_fail(FU_IS_FIRMWARE_PROFILER(self));
+	g_return_if_fail(g_private_get(&fu_firmware_profiler_thread_default) == NULL);
+	g_private_set(&fu_firmware_profiler_thread_default, g_object_ref(self));
+}
+
+/**
+ * fu_firmware_profiler_pop_thread_default:
+ * @self: a #FuFirmwareProfiler
+ *
+ * Stops recording firmware parsed by this thread.
+ *
+ * Since: 2.1.6
+ **/
+void
+fu_firmware_profiler_pop_thread_default(FuFirmwareProfiler *self)
+{
+	g_return_if_fail(FU_IS_FIRMWARE_PROFILER(self));
+	g_return_if_fail(g_private_get(&fu_firmware_profiler_thread_default) == self);
+	g_private_set(&fu_firmware_profiler_thread_default, NULL);
+	g_object_unref(self);
+}
+
+/**
+ * fu_firmware_profiler_get_thread_default:
+ *
+ * Gets the profiler used for the current thread, if any.
+ *
+ * Returns: (transfer none) (nullable): a #FuFirmwareProfiler
+ *
+ * Since: 2.1.6
+ **/
+FuFirmwareProfiler *
+fu_firmware_profiler_get_thread_default(void)
+{
+	return g_private_get(&fu_firmware_profiler_thread_default);
+}
+
+/**
+ * fu_firmware_profiler_add_decompressed:
+ * @size_compressed: size of the compressed input, in bytes
+ * @size_decompressed: size of the decompressed output, in bytes
+ *
+ * Records a decompression against the firmware currently being parsed in this thread.
+ *
+ * This does nothing if there is no thread default profiler.
+ *
+ * Since: 2.1.6
+ **/
+void
+fu_firmware_profiler_add_decompressed(gsize size_compressed, gsize size_decompressed)
+{
+	FuFirmwareProfilerFrame *frame = g_private_get(&fu_firmware_profiler_frame_current);
+	if (frame == NULL)
+		return;
+	frame->size_compressed += size_compressed;
+	frame->size_decompressed += size_decompressed;
+}
+
+/* private */
+FuFirmwareProfilerFrame *
+fu_firmware_profiler_frame_get_current(void)
+{
+	return g_private_get(&fu_firmware_profiler_frame_current);
+}
+
+/* private: records firmware parsed by this worker thread as children of @parent, which belongs
+ * to the thread that is blocked waiting for the worker to finish */
+void
+fu_firmware_profiler_push_worker(FuFirmwareProfiler *self, FuFirmwareProfilerFrame *parent)
+{
+	g_autoptr(GMutexLocker) locker = g_mutex_locker_new(&self->mutex);
+	self->has_workers = TRUE;
+	g_private_set(&fu_firmware_profiler_thread_default, g_object_ref(self));
+	g_private_set(&fu_firmware_profiler_frame_current, parent);
+}
+
+/* private */
+void
+fu_firmware_profiler_pop_worker(FuFirmwareProfiler *self)
+{
+	g_private_set(&fu_firmware_profiler_frame_current, NULL);
+	g_private_set(&fu_firmware_profiler_thread_default, NULL);
+	g_object_unref(self);
+}
+
+/* private */
+FuFirmwareProfilerFrame *
+fu_firmware_profiler_frame_new(FuFirmwareProfiler *self, GType gtype)
+{
+	FuFirmwareProfilerFrame *frame = g_new0(FuFirmwareProfilerFrame, 1);
+	frame->profiler = self;
+	frame->gtype = gtype;
+	frame->parent = g_private_get(&fu_firmware_profiler_frame_current);
+	if (frame->parent != NULL)
+		frame->depth = frame->parent->depth + 1;
+	frame->heap_start = fu_firmware_profiler_get_heap_used();
+	frame->time_start = g_get_monotonic_time();
+	g_private_set(&fu_firmware_profiler_frame_current, frame);
+	return frame;
+}
+
+static FuFirmwareProfilerEntry *
+fu_firmware_profiler_ensure_entry(FuFirmwareProfiler *self, GType gtype, guint depth)
+{
+	FuFirmwareProfilerEntry *entry;
+
+	for (guint i = 0; i < self->entries->len; i++) {
+		entry = g_ptr_array_index(self->entries, i);
+		if (entry->gtype == gtype && entry->depth == depth)
+			return entry;
+	}
+	entry = g_new0(FuFirmwareProfilerEntry, 1);
+	entry->gtype = gtype;
+	entry->depth = depth;
+	g_ptr_array_add(self->entries, entry);
+	return entry;
+}
+
+/* private */
+void
+fu_firmware_profiler_frame_done(FuFirmwareProfilerFrame *frame, gsize size, gboolean success)
+{
+	FuFirmwareProfiler *self = frame->profiler;
+	FuFirmwareProfilerEntry *entry;
+	gint64 elapsed = g_get_monotonic_time() - frame->time_start;
+	g_autoptr(GMutexLocker) locker = g_mutex_locker_new(&self->mutex);
+
+	entry = fu_firmware_profiler_ensure_entry(self, frame->gtype, frame->depth);
+	entry->count++;
+	if (!success)
+		entry->failures++;
+	entry->size += size;
+	entry->elapsed += elapsed;
+	entry->elapsed_self += MAX(elapsed - frame->time_children, 0);
+	entry->heap_delta += fu_firmware_profiler_get_heap_used() - frame->heap_start;
+	entry->size_compressed += frame->size_compressed;
+	entry->size_decompressed += frame->size_decompressed;
+
+	/* restore the parent frame, which may be owned by a different thread */
+	if (frame->parent != NULL)
+		frame->parent->time_children += elapsed;
+	g_private_set(&fu_firmware_profiler_frame_current, frame->parent);
+	g_free(frame);
+}
+
+static gint
+fu_firmware_profiler_entry_sort_cb(gconstpointer a, gconstpointer b)
+{
+	FuFirmwareProfilerEntry *entry1 = *((FuFirmwareProfilerEntry **)a);
+	FuFirmwareProfilerEntry *entry2 = *((FuFirmwareProfilerEntry **)b);
+	if (entry1->depth < entry2->depth)
+		return -1;
+	if (entry1->depth > entry2->depth)
+		return 1;
+	return g_strcmp0(g_type_name(entry1->gtype), g_type_name(entry2->gtype));
+}
+
+static gchar *
+fu_firmware_profiler_entry_get_ratio(FuFirmwareProfilerEntry *entry)
+{
+	gchar buf[G_ASCII_DTOSTR_BUF_SIZE] = {0x0};
+	if (entry->size_compressed == 0)
+		return NULL;
+	return g_strdup(g_ascii_formatd(buf,
+					sizeof(buf),
+					"%.3f",
+					(gdouble)entry->size_decompressed /
+					    (gdouble)entry->size_compressed));
+}
+
+/**
+ * fu_firmware_profiler_add_json:
+ * @self: a #FuFirmwareProfiler
+ * @json_obj: a #FwupdJsonObject
+ *
+ * Adds the recorded profile to a JSON object, sorted by depth and then GType name.
+ *
+ * Since: 2.1.6
+ **/
+void
+fu_firmware_profiler_add_json(FuFirmwareProfiler *self, FwupdJsonObject *json_obj)
+{
+	g_autoptr(FwupdJsonArray) json_arr = fwupd_json_array_new();
+	g_autoptr(GMutexLocker) locker = NULL;
+
+	g_return_if_fail(FU_IS_FIRMWARE_PROFILER(self));
+	g_return_if_fail(json_obj != NULL);
+
+	locker = g_mutex_locker_new(&self->mutex);
+
+	g_ptr_array_sort(self->entries, fu_firmware_profiler_entry_sort_cb);
+	for (guint i = 0; i < self->entries->len; i++) {
+		FuFirmwareProfilerEntry *entry = g_ptr_array_index(self->entries, i);
+		g_autofree gchar *ratio = fu_firmware_profiler_entry_get_ratio(entry);
+		g_autoptr(FwupdJsonObject) json_entry = fwupd_json_object_new();
+
+		fwupd_json_object_add_string(json_entry, "GType", g_type_name(entry->gtype));
+		fwupd_json_object_add_integer(json_entry, "Depth", entry->depth);
+		fwupd_json_object_add_integer(json_entry, "Count", entry->count);
+		fwupd_json_object_add_integer(json_entry, "Failures", entry->failures);
+		fwupd_json_object_add_integer(json_entry, "Size", entry->size);
+		fwupd_json_object_add_integer(json_entry, "ElapsedUs", entry->elapsed);
+		fwupd_json_object_add_integer(json_entry, "ElapsedSelfUs", entry->elapsed_self);
+#ifdef HAVE_MALLINFO2
+		if (!self->has_workers)
+			fwupd_json_object_add_integer(json_entry, "HeapDelta", entry->heap_delta);
+#endif
+		if (ratio != NULL) {
+			fwupd_json_object_add_integer(json_entry,
+						      "SizeCompressed",
+						      entry->size_compressed);
+			fwupd_json_object_add_integer(json_entry,
+						      "SizeDecompressed",
+						      entry->size_decompressed);
+			fwupd_json_object_add_raw(json_entry, "DecompressionRatio", ratio);
+		}
+		fwupd_json_array_add_object(json_arr, json_entry);
+	}
+	fwupd_json_object_add_array(json_obj, "FirmwareProfile", json_arr);
+}
+
+/**
+ * fu_firmware_profiler_to_string:
+ * @self: a #FuFirmwareProfiler
+ *
+ * Prints the recorded profile as a table suitable for debugging.
+ *
+ * Returns: (transfer full): a string
+ *
+ * Since: 2.1.6
+ **/
+gchar *
+fu_firmware_profiler_to_string(FuFirmwareProfiler *self)
+{
+	GString *str;
+	g_autoptr(GMutexLocker) locker = NULL;
+
+	g_return_val_if_fail(FU_IS_FIRMWARE_PROFILER(self), NULL);
+
+	str = g_string_new(NULL);
+	locker = g_mutex_locker_new(&self->mutex);
+
+	g_ptr_array_sort(self->entries, fu_firmware_profiler_entry_sort_cb);
+	for (guint i = 0; i < self->entries->len; i++) {
+		FuFirmwareProfilerEntry *entry = g_ptr_array_index(self->entries, i);
+		g_autofree gchar *ratio = fu_firmware_profiler_entry_get_ratio(entry);
+		g_string_append_printf(str,
+				       "%u %s: count=%u size=0x%" G_GINT64_MODIFIER
+				       "x elapsed=%" G_GUINT64_FORMAT "us self=%" G_GUINT64_FORMAT
+				       "us",
+				       entry->depth,
+				       g_type_name(entry->gtype),
+				       entry->count,
+				       entry->size,
+				       entry->elapsed,
+				       entry->elapsed_self);
+		if (entry->failures > 0)
+			g_string_append_printf(str, " failures=%u", entry->failures);
+		if (ratio != NULL)
+			g_string_append_printf(str, " ratio=%s", ratio);
+		g_string_append_c(str, '\n');
+	}
+	return g_string_free(str, FALSE);
+}
+
+static void
+fu_firmware_profiler_finalize(GObject *object)
+{
+	FuFirmwareProfiler *self = FU_FIRMWARE_PROFILER(object);
+	g_mutex_clear(&self->mutex);
+	g_ptr_array_unref(self->entries);
+	G_OBJECT_CLASS(fu_firmware_profiler_parent_class)->finalize(object);
+}
+
+static void
+fu_firmware_profiler_class_init(FuFirmwareProfilerClass *klass)
+{
+	GObjectClass *object_class = G_OBJECT_CLASS(klass);
+	object_class->finalize = fu_firmware_profiler_finalize;
+}
+
+static void
+fu_firmware_profiler_init(FuFirmwareProfiler *self)
+{
+	g_mutex_init(&self->mutex);
+	self->entries = g_ptr_array_new_with_free_func(g_free);
+}
+
+/**
+ * fu_firmware_profiler_new:
+ *
+ * Returns: (transfer full): a #FuFirmwareProfiler
+ *
+ * Since: 2.1.6
+ **/
+FuFirmwareProfiler *
+fu_firmware_profiler_new(void)
+{
+	return g_object_new(FU_TYPE_FIRMWARE_PROFILER, NULL);
+}
@@ -0,0 +1,31 @@
+/*
+ * Copyright 2026 Richard Hughes <richard@hughsie.com>
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ */
+
+#pragma once
+
+#include <fwupd.h>
+
+#define FU_TYPE_FIRMWARE_PROFILER (fu_firmware_profiler_get_type())
+G_DECLARE_FINAL_TYPE(FuFirmwareProfiler, fu_firmware_profiler, FU, FIRMWARE_PROFILER, GObject)
+
+void
+fu_firmware_profiler_push_thread_default(FuFirmwareProfiler *self) G_GNUC_NON_NULL(1);
+void
+fu_firmware_profiler_pop_thread_default(FuFirmwareProfiler *self) G_GNUC_NON_NULL(1);
+FuFirmwareProfiler *
+fu_firmware_profiler_get_thread_default(void);
+
+void
+fu_firmware_profiler_add_decompressed(gsize size_compressed, gsize size_decompressed);
+
+void
+fu_firmware_profiler_add_json(FuFirmwareProfiler *self, FwupdJsonObject *json_obj)
+    G_GNUC_NON_NULL(1, 2);
+gchar *
+fu_firmware_profiler_to_string(FuFirmwareProfiler *self) G_GNUC_NON_NULL(1);
+
+FuFirmwareProfiler *
+fu_firmware_profiler_new(void) G_GNUC_WARN_UNUSED_RESULT;
@@ -120,6 +120,101 @@ fu_firmware_fit_func(void)
 	g_assert_cmpstr(val[3], ==, NULL);
 }
 
+static void
+fu_firmware_profiler_func(void)
+{
+	gboolean ret;
+	g_autofree gchar *filename = NULL;
+	g_autofree gchar *str = NULL;
+	g_autoptr(FuFirmware) firmware1 = NULL;
+	g_autoptr(FuFirmware) firmware2 = fu_linear_firmware_new(FU_TYPE_DFU_FIRMWARE);
+	g_autoptr(FuFirmwareProfiler) profiler = fu_firmware_profiler_new();
+	g_autoptr(FwupdJsonObject) json_obj = fwupd_json_object_new();
+	g_autoptr(GBytes) blob = NULL;
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GString) json = NULL;
+
+	filename = g_test_build_filename(G_TEST_DIST, "tests", "linear.builder.xml", NULL);
+	firmware1 = fu_firmware_new_from_filename(filename, &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(firmware1);
+	blob = fu_firmware_write(firmware1, &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(blob);
+
+	/* parse with the profiler enabled */
+	fu_firmware_profiler_push_thread_default(profiler);
+	ret = fu_firmware_parse_bytes(firmware2,
+				      blob,
+				      0x0,
+				      FU_FIRMWARE_PARSE_FLAG_NO_SEARCH,
+				      &error);
+	fu_firmware_profiler_pop_thread_default(profiler);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	g_assert_null(fu_firmware_profiler_get_thread_default());
+
+	/* both images are at the same depth */
+	str = fu_firmware_profiler_to_string(profiler);
+	g_debug("%s", str);
+	g_assert_nonnull(g_strstr_len(str, -1, "0 FuLinearFirmware: count=1 "));
+	g_assert_nonnull(g_strstr_len(str, -1, "1 FuDfuFirmware: count=2 "));
+
+	/* machine readable */
+	fu_firmware_profiler_add_json(profiler, json_obj);
+	json = fwupd_json_object_to_string(json_obj, FWUPD_JSON_EXPORT_FLAG_NONE);
+	g_assert_nonnull(g_strstr_len(json->str, -1, "\"GType\": \"FuDfuFirmware\""));
+}
+
+static void
+fu_firmware_profiler_parallel_func(void)
+{
+	gboolean ret;
+	g_autofree gchar *str = NULL;
+	g_autoptr(FuFirmware) firmware1 = fu_efi_filesystem_new();
+	g_autoptr(FuFirmware) firmware2 = fu_efi_filesystem_new();
+	g_autoptr(FuFirmwareProfiler) profiler = fu_firmware_profiler_new();
+	g_autoptr(FwupdJsonObject) json_obj = fwupd_json_object_new();
+	g_autoptr(GBytes) blob = NULL;
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GString) json = NULL;
+
+	for (guint i = 0; i < 4; i++) {
+		g_autoptr(FuFirmware) img = fu_efi_file_new();
+		g_autoptr(GBytes) blob_tmp = g_bytes_new_static("hello world", 11);
+		fu_firmware_set_id(img, "ced4eac6-49f3-4c12-a597-fc8c33447691");
+		fu_firmware_set_bytes(img, blob_tmp);
+		ret = fu_firmware_add_image(firmware1, img, &error);
+		g_assert_no_error(error);
+		g_assert_true(ret);
+	}
+	blob = fu_firmware_write(firmware1, &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(blob);
+
+	/* the workers record into the profiler of the calling thread */
+	fu_firmware_profiler_push_thread_default(profiler);
+	ret = fu_firmware_parse_bytes(firmware2,
+				      blob,
+				      0x0,
+				      FU_FIRMWARE_PARSE_FLAG_NO_SEARCH |
+					  FU_FIRMWARE_PARSE_FLAG_PARALLEL,
+				      &error);
+	fu_firmware_profiler_pop_thread_default(profiler);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	str = fu_firmware_profiler_to_string(profiler);
+	g_debug("%s", str);
+	g_assert_nonnull(g_strstr_len(str, -1, "0 FuEfiFilesystem: count=1 "));
+	g_assert_nonnull(g_strstr_len(str, -1, "1 FuEfiFile: count=4 "));
+
+	/* the heap delta is meaningless when other threads are allocating */
+	fu_firmware_profiler_add_json(profiler, json_obj);
+	json = fwupd_json_object_to_string(json_obj, FWUPD_JSON_EXPORT_FLAG_NONE);
+	if (g_get_num_processors() > 1)
+		g_assert_null(g_strstr_len(json->str, -1, "HeapDelta"));
+}
+
 static void
 fu_firmware_build_func(void)
 {
@@ -825,6 +920,7 @@ fu_firmware_common_func(void)
 {
 	gboolean ret;
 	guint8 value = 0;
+	guint8 buf[3] = {0x0};
 	g_autoptr(GError) error = NULL;
 
 	ret = fu_firmware_strparse_uint8_safe("ff00XX", 6, 0, &value, &error);
@@ -840,6 +936,23 @@ fu_firmware_common_func(void)
 	ret = fu_firmware_strparse_uint8_safe("ff00XX", 6, 4, &value, &error);
 	g_assert_error(error, FWUPD_ERROR, FWUPD_ERROR_INVALID_DATA);
 	g_assert_false(ret);
+	g_clear_error(&error);
+
+	ret = fu_firmware_strparse_hex_safe(":a0Bf9c", 7, 1, buf, sizeof(buf), &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	g_assert_cmpint(buf[0], ==, 0xA0);
+	g_assert_cmpint(buf[1], ==, 0xBF);
+	g_assert_cmpint(buf[2], ==, 0x9C);
+
+	ret = fu_firmware_strparse_hex_safe(":a0Bf9", 6, 1, buf, sizeof(buf), &error);
+	g_assert_error(error, FWUPD_ERROR, FWUPD_ERROR_INVALID_DATA);
+	g_assert_false(ret);
+	g_clear_error(&error);
+
+	ret = fu_firmware_strparse_hex_safe(":a0 f9c", 7, 1, buf, sizeof(buf), &error);
+	g_assert_error(error, FWUPD_ERROR, FWUPD_ERROR_INVALID_DATA);
+	g_assert_false(ret);
 }
 
 static void
@@ -1177,6 +1290,8 @@ main(int argc, char **argv)
 	g_test_add_func("/fwupd/firmware/builder-round-trip", fu_firmware_builder_round_trip_func);
 	g_test_add_func("/fwupd/firmware/csv", fu_firmware_csv_func);
 	g_test_add_func("/fwupd/firmware/linear", fu_firmware_linear_func);
+	g_test_add_func("/fwupd/firmware/profiler", fu_firmware_profiler_func);
+	g_test_add_func("/fwupd/firmware/profiler/parallel", fu_firmware_profiler_parallel_func);
 	g_test_add_func("/fwupd/firmware/dedupe", fu_firmware_dedupe_func);
 	g_test_add_func("/fwupd/firmware/build", fu_firmware_build_func);
 	g_test_add_func("/fwupd/firmware/raw-aligned", fu_firmware_raw_aligned_func);
@@ -13,6 +13,7 @@
 #include "fu-chunk-private.h"
 #include "fu-common.h"
 #include "fu-firmware-private.h"
+#include "fu-firmware-profiler-private.h"
 #include "fu-fuzzer.h"
 #include "fu-input-stream.h"
 #include "fu-mem.h"
@@ -47,11 +48,16 @@ typedef struct {
 	gsize size;
 	gsize size_max;
 	guint images_max;
-	GArray *image_gtypes; /* nullable, element-type GType */
+	guint images_generation; /* incremented when images are added or removed */
+	GArray *image_gtypes;	 /* nullable, element-type GType */
 	guint depth;
 	GPtrArray *chunks;  /* nullable, element-type FuChunk */
 	GPtrArray *patches; /* nullable, element-type FuFirmwarePatch */
 	GPtrArray *magic;   /* nullable, element-type FuFirmwarePatch */
+	GInputStream *lazy_stream; /* nullable */
+	gsize lazy_offset;
+	FuFirmwareParseFlags lazy_flags;
+	GError *lazy_error; /* nullable */
 } FuFirmwarePrivate;
 
 static void
@@ -1079,26 +1085,12 @@ fu_firmware_validate_for_offset(FuFirmware *self,
 	return klass->validate(self, stream, offset, error);
 }
 
-/**
- * fu_firmware_parse_stream:
- * @self: a #FuFirmware
- * @stream: input stream
- * @offset: start offset
- * @flags: #FuFirmwareParseFlags, e.g. %FWUPD_INSTALL_FLAG_FORCE
- * @error: (nullable): optional return location for an error
- *
- * Parses a firmware from a stream, typically breaking the firmware into images.
- *
- * Returns: %TRUE for success
- *
- * Since: 2.0.0
- **/
-gboolean
-fu_firmware_parse_stream(FuFirmware *self,
-			 GInputStream *stream,
-			 gsize offset,
-			 FuFirmwareParseFlags flags,
-			 GError **error)
+static gboolean
+fu_firmware_parse_stream_internal(FuFirmware *self,
+				  GInputStream *stream,
+				  gsize offset,
+				  FuFirmwareParseFlags flags,
+				  GError **error)
 {
 	FuFirmwareClass *klass = FU_FIRMWARE_GET_CLASS(self);
 	FuFirmwarePrivate *priv = GET_PRIVATE(self);
@@ -1107,10 +1099,6 @@ fu_firmware_parse_stream(FuFirmware *self,
 	g_autoptr(GInputStream) seekable_stream = NULL;
 	g_autoptr(GBytes) blob = NULL;
 
-	g_return_val_if_fail(FU_IS_FIRMWARE(self), FALSE);
-	g_return_val_if_fail(G_IS_INPUT_STREAM(stream), FALSE);
-	g_return_val_if_fail(error == NULL || *error == NULL, FALSE);
-
 	/* sanity check */
 	if (fu_firmware_has_flag(self, FU_FIRMWARE_FLAG_DONE_PARSE)) {
 		g_set_error_literal(error,
@@ -1255,6 +1243,46 @@ fu_firmware_parse_stream(FuFirmware *self,
 	return TRUE;
 }
 
+/**
+ * fu_firmware_parse_stream:
+ * @self: a #FuFirmware
+ * @stream: input stream
+ * @offset: start offset
+ * @flags: #FuFirmwareParseFlags, e.g. %FWUPD_INSTALL_FLAG_FORCE
+ * @error: (nullable): optional return location for an error
+ *
+ * Parses a firmware from a stream, typically breaking the firmware into images.
+ *
+ * Returns: %TRUE for success
+ *
+ * Since: 2.0.0
+ **/
+gboolean
+fu_firmware_parse_stream(FuFirmware *self,
+			 GInputStream *stream,
+			 gsize offset,
+			 FuFirmwareParseFlags flags,
+			 GError **error)
+{
+	FuFirmwarePrivate *priv = GET_PRIVATE(self);
+	FuFirmwareProfiler *profiler = fu_firmware_profiler_get_thread_default();
+	FuFirmwareProfilerFrame *frame;
+	gboolean ret;
+
+	g_return_val_if_fail(FU_IS_FIRMWARE(self), FALSE);
+	g_return_val_if_fail(G_IS_INPUT_STREAM(stream), FALSE);
+	g_return_val_if_fail(error == NULL || *error == NULL, FALSE);
+
+	/* not profiling */
+	if (profiler == NULL)
+		return fu_firmware_parse_stream_internal(self, stream, offset, flags, error);
+
+	frame = fu_firmware_profiler_frame_new(profiler, G_OBJECT_TYPE(self));
+	ret = fu_firmware_parse_stream_internal(self, stream, offset, flags, error);
+	fu_firmware_profiler_frame_done(frame, priv->streamsz, ret);
+	return ret;
+}
+
 /**
  * fu_firmware_parse_bytes:
  * @self: a #FuFirmware
@@ -1286,6 +1314,212 @@ fu_firmware_parse_bytes(FuFirmware *self,
 	return fu_firmware_parse_stream(self, stream, offset, flags, error);
 }
 
+typedef struct {
+	gpointer item;
+	FuFirmwareParallelFunc func;
+	gpointer user_data;
+	FuFirmwareProfiler *profiler;	         /* no-ref */
+	FuFirmwareProfilerFrame *profiler_frame; /* no-ref */
+	gboolean ret;
+	GError *error;
+} FuFirmwareParallelHelper;
+
+static void
+fu_firmware_parallel_worker_cb(gpointer data, gpointer user_data)
+{
+	FuFirmwareParallelHelper *helper = (FuFirmwareParallelHelper *)data;
+
+	/* the pool threads are shared, so only profile for the duration of this item */
+	if (helper->profiler != NULL)
+		fu_firmware_profiler_push_worker(helper->profiler, helper->profiler_frame);
+	helper->ret = helper->func(helper->item, helper->user_data, &helper->error);
+	if (helper->profiler != NULL)
+		fu_firmware_profiler_pop_worker(helper->profiler);
+}
+
+/* number of worker threads in use by all the pools, so that nested parallel parsing does not
+ * create more threads than there are processors */
+static gint fu_firmware_parallel_workers = 0; /* nocheck:static */
+
+/* returns the number of worker threads reserved for @n_items, or 0 to run in this thread */
+static guint
+fu_firmware_parallel_reserve(FuFirmwareParseFlags flags, guint n_items)
+{
+	gint n_processors = (gint)g_get_num_processors();
+
+	if ((flags & FU_FIRMWARE_PARSE_FLAG_PARALLEL) == 0)
+		return 0;
+	while (TRUE) {
+		gint workers = g_atomic_int_get(&fu_firmware_parallel_workers);
+		gint n_threads = MIN(n_processors - workers, (gint)n_items);
+
+		/* not worth it */
+		if (n_threads < 2)
+			return 0;
+		if (g_atomic_int_compare_and_exchange(&fu_firmware_parallel_workers,
+						      workers,
+						      workers + n_threads))
+			return n_threads;
+	}
+}
+
+static void
+fu_firmware_parallel_release(guint n_threads)
+{
+	g_atomic_int_add(&fu_firmware_parallel_workers, -(gint)n_threads);
+}
+
+static gboolean
+fu_firmware_parallel_foreach_full(GPtrArray *items,
+				  guint n_threads,
+				  FuFirmwareParallelFunc func,
+				  gpointer user_data,
+				  guint *idx_failed,
+				  GError **error)
+{
+	GThreadPool *pool;
+	g_autofree FuFirmwareParallelHelper *helpers = NULL;
+
+	/* in this thread, in index order */
+	if (n_threads == 0) {
+		for (guint i = 0; i < items->len; i++) {
+			if (!func(g_ptr_array_index(items, i), user_data, error)) {
+				if (idx_failed != NULL)
+					*idx_failed = i;
+				return FALSE;
+			}
+		}
+		return TRUE;
+	}
+
+	/* run everything, blocking until all the workers have finished */
+	pool = g_thread_pool_new(fu_firmware_parallel_worker_cb, NULL, n_threads, FALSE, error);
+	if (pool == NULL)
+		return FALSE;
+	helpers = g_new0(FuFirmwareParallelHelper, items->len);
+	for (guint i = 0; i < items->len; i++) {
+		helpers[i].item = g_ptr_array_index(items, i);
+		helpers[i].func = func;
+		helpers[i].user_data = user_data;
+		helpers[i].profiler = fu_firmware_profiler_get_thread_default();
+		helpers[i].profiler_frame = fu_firmware_profiler_frame_get_current();
+		if (!g_thread_pool_push(pool, &helpers[i], &helpers[i].error))
+			break;
+	}
+	g_thread_pool_free(pool, FALSE, TRUE);
+
+	/* report the first failure */
+	for (guint i = 0; i < items->len; i++) {
+		if (!helpers[i].ret) {
+			for (guint j = i + 1; j < items->len; j++)
+				g_clear_error(&helpers[j].error);
+			if (idx_failed != NULL)
+				*idx_failed = i;
+			if (helpers[i].error == NULL) {
+				g_set_error_literal(error,
+						    FWUPD_ERROR,
+						    FWUPD_ERROR_INTERNAL,
+						    "worker failed without an error");
+				return FALSE;
+			}
+			g_propagate_error(error, g_steal_pointer(&helpers[i].error));
+			return FALSE;
+		}
+	}
+
+	/* success */
+	return TRUE;
+}
+
+/* private: runs @func on each item, returning the error of the lowest index that failed --
+ * if FU_FIRMWARE_PARSE_FLAG_PARALLEL is not set, or all the processors are already busy, then
+ * this runs in this thread in index order */
+gboolean
+fu_firmware_parallel_foreach(GPtrArray *items,
+			     FuFirmwareParseFlags flags,
+			     FuFirmwareParallelFunc func,
+			     gpointer user_data,
+			     GError **error)
+{
+	guint n_threads = fu_firmware_parallel_reserve(flags, items->len);
+	gboolean ret;
+
+	ret = fu_firmware_parallel_foreach_full(items, n_threads, func, user_data, NULL, error);
+	fu_firmware_parallel_release(n_threads);
+	return ret;
+}
+
+typedef struct {
+	FuFirmware *img;      /* no-ref */
+	GInputStream *stream; /* ref */
+} FuFirmwareParseJob;
+
+static void
+fu_firmware_parse_job_free(FuFirmwareParseJob *job)
+{
+	if (job->stream != NULL)
+		g_object_unref(job->stream);
+	g_free(job);
+}
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC(FuFirmwareParseJob, fu_firmware_parse_job_free)
+
+static gboolean
+fu_firmware_parse_job_cb(gpointer item, gpointer user_data, GError **error)
+{
+	FuFirmwareParseJob *job = (FuFirmwareParseJob *)item;
+	FuFirmwareParseFlags flags = GPOINTER_TO_UINT(user_data);
+	return fu_firmware_parse_stream(job->img, job->stream, 0x0, flags, error);
+}
+
+/* private: parses each image from the stream at the same index, setting @idx_failed to the
+ * lowest index that failed -- if any worker threads are used then each stream is read into
+ * memory so that no seekable stream is shared between the workers */
+gboolean
+fu_firmware_parse_images(GPtrArray *imgs,
+			 GPtrArray *streams,
+			 FuFirmwareParseFlags flags,
+			 guint *idx_failed,
+			 GError **error)
+{
+	guint n_threads;
+	gboolean ret;
+	g_autoptr(GPtrArray) jobs =
+	    g_ptr_array_new_with_free_func((GDestroyNotify)fu_firmware_parse_job_free);
+
+	g_return_val_if_fail(imgs->len == streams->len, FALSE);
+
+	n_threads = fu_firmware_parallel_reserve(flags, imgs->len);
+	for (guint i = 0; i < imgs->len; i++) {
+		GInputStream *stream = g_ptr_array_index(streams, i);
+		g_autoptr(FuFirmwareParseJob) job = g_new0(FuFirmwareParseJob, 1);
+
+		job->img = g_ptr_array_index(imgs, i);
+		if (n_threads > 0) {
+			g_autoptr(GBytes) blob = NULL;
+			blob = fu_input_stream_read_bytes(stream, 0x0, G_MAXSIZE, NULL, error);
+			if (blob == NULL) {
+				fu_firmware_parallel_release(n_threads);
+				return FALSE;
+			}
+			job->stream = g_memory_input_stream_new_from_bytes(blob);
+		} else {
+			job->stream = g_object_ref(stream);
+		}
+		g_ptr_array_add(jobs, g_steal_pointer(&job));
+	}
+
+	/* nested images can use the workers that are not already busy */
+	ret = fu_firmware_parallel_foreach_full(jobs,
+						n_threads,
+						fu_firmware_parse_job_cb,
+						GUINT_TO_POINTER(flags),
+						idx_failed,
+						error);
+	fu_firmware_parallel_release(n_threads);
+	return ret;
+}
+
 /**
  * fu_firmware_build:
  * @self: a #FuFirmware
@@ -1665,6 +1899,10 @@ fu_firmware_write(FuFirmware *self, GError **error)
 	g_return_val_if_fail(FU_IS_FIRMWARE(self), NULL);
 	g_return_val_if_fail(error == NULL || *error == NULL, NULL);
 
+	/* the images may have been deferred */
+	if (!fu_firmware_ensure_images_parsed(self, error))
+		return NULL;
+
 	/* subclassed */
 	if (klass->write != NULL) {
 		g_autoptr(GByteArray) buf = klass->write(self, error);
@@ -1993,6 +2231,7 @@ fu_firmware_add_image(FuFirmware *self, FuFirmware *img, GError **error)
 	}
 
 	g_ptr_array_add(priv->images, g_object_ref(img));
+	priv->images_generation++;
 
 	/* set the other way around */
 	fu_firmware_set_parent(img, self);
@@ -2002,6 +2241,103 @@ fu_firmware_add_image(FuFirmware *self, FuFirmware *img, GError **error)
 	return TRUE;
 }
 
+/* private: adds @img without parsing it -- the ID, idx, GType and size should be set by the
+ * caller as @stream is only parsed when the image is returned by one of the getters, and an
+ * image with no ID is always parsed when looking up by ID */
+gboolean
+fu_firmware_add_image_lazy(FuFirmware *self,
+			   FuFirmware *img,
+			   GInputStream *stream,
+			   gsize offset,
+			   FuFirmwareParseFlags flags,
+			   GError **error)
+{
+	FuFirmwarePrivate *priv_img = GET_PRIVATE(img);
+
+	g_return_val_if_fail(FU_IS_FIRMWARE(self), FALSE);
+	g_return_val_if_fail(FU_IS_FIRMWARE(img), FALSE);
+	g_return_val_if_fail(G_IS_INPUT_STREAM(stream), FALSE);
+	g_return_val_if_fail(error == NULL || *error == NULL, FALSE);
+
+	/* sanity check */
+	if (fu_firmware_has_flag(img, FU_FIRMWARE_FLAG_DONE_PARSE)) {
+		g_set_error_literal(error,
+				    FWUPD_ERROR,
+				    FWUPD_ERROR_NOT_SUPPORTED,
+				    "firmware object cannot be reused");
+		return FALSE;
+	}
+	if (!fu_firmware_add_image(self, img, error))
+		return FALSE;
+	g_set_object(&priv_img->lazy_stream, stream);
+	priv_img->lazy_offset = offset;
+	priv_img->lazy_flags = flags;
+	return TRUE;
+}
+
+/* parse the image if it was added using fu_firmware_add_image_lazy() */
+static gboolean
+fu_firmware_ensure_parsed(FuFirmware *self, GError **error)
+{
+	FuFirmwarePrivate *priv = GET_PRIVATE(self);
+	g_autoptr(GError) error_local = NULL;
+	g_autoptr(GInputStream) stream = NULL;
+
+	/* already done, or the object cannot be parsed again */
+	if (priv->lazy_error != NULL) {
+		if (error != NULL)
+			*error = g_error_copy(priv->lazy_error);
+		return FALSE;
+	}
+	if (priv->lazy_stream == NULL)
+		return TRUE;
+	stream = g_steal_pointer(&priv->lazy_stream);
+	if (!fu_firmware_parse_stream(self,
+				      stream,
+				      priv->lazy_offset,
+				      priv->lazy_flags,
+				      &error_local)) {
+		g_prefix_error(&error_local, "failed to parse %s: ", G_OBJECT_TYPE_NAME(self));
+		priv->lazy_error = g_error_copy(error_local);
+		g_propagate_error(error, g_steal_pointer(&error_local));
+		return FALSE;
+	}
+	return TRUE;
+}
+
+/**
+ * fu_firmware_ensure_images_parsed:
+ * @self: a #FuFirmware
+ * @error: (nullable): optional return location for an error
+ *
+ * Parses all the child images, and their children, that were deferred when parsing with
+ * %FU_FIRMWARE_PARSE_FLAG_LAZY.
+ *
+ * This is done automatically by fu_firmware_write(), fu_firmware_export_to_xml() and when
+ * getting images, but only this function returns the error for the images that are invalid.
+ *
+ * Returns: %TRUE for success
+ *
+ * Since: 2.1.6
+ **/
+gboolean
+fu_firmware_ensure_images_parsed(FuFirmware *self, GError **error)
+{
+	FuFirmwarePrivate *priv = GET_PRIVATE(self);
+
+	g_return_val_if_fail(FU_IS_FIRMWARE(self), FALSE);
+	g_return_val_if_fail(error == NULL || *error == NULL, FALSE);
+
+	for (guint i = 0; i < priv->images->len; i++) {
+		FuFirmware *img = g_ptr_array_index(priv->images, i);
+		if (!fu_firmware_ensure_parsed(img, error))
+			return FALSE;
+		if (!fu_firmware_ensure_images_parsed(img, error))
+			return FALSE;
+	}
+	return TRUE;
+}
+
 /**
  * fu_firmware_set_images_max:
  * @self: a #FuPlugin
@@ -2037,6 +2373,15 @@ fu_firmware_get_images_max(FuFirmware *self)
 	return priv->images_max;
 }
 
+/* private: used to invalidate data derived from the images */
+guint
+fu_firmware_get_images_generation(FuFirmware *self)
+{
+	FuFirmwarePrivate *priv = GET_PRIVATE(self);
+	g_return_val_if_fail(FU_IS_FIRMWARE(self), 0);
+	return priv->images_generation;
+}
+
 /**
  * fu_firmware_remove_image:
  * @self: a #FuPlugin
@@ -2058,8 +2403,10 @@ fu_firmware_remove_image(FuFirmware *self, FuFirmware *img, GError **error)
 	g_return_val_if_fail(FU_IS_FIRMWARE(img), FALSE);
 	g_return_val_if_fail(error == NULL || *error == NULL, FALSE);
 
-	if (g_ptr_array_remove(priv->images, img))
+	if (g_ptr_array_remove(priv->images, img)) {
+		priv->images_generation++;
 		return TRUE;
+	}
 
 	/* did not exist */
 	g_set_error(error,
@@ -2095,6 +2442,7 @@ fu_firmware_remove_image_by_idx(FuFirmware *self, guint64 idx, GError **error)
 	if (img == NULL)
 		return FALSE;
 	g_ptr_array_remove(priv->images, img);
+	priv->images_generation++;
 	return TRUE;
 }
 
@@ -2123,6 +2471,7 @@ fu_firmware_remove_image_by_id(FuFirmware *self, const gchar *id, GError **error
 	if (img == NULL)
 		return FALSE;
 	g_ptr_array_remove(priv->images, img);
+	priv->images_generation++;
 	return TRUE;
 }
 
@@ -2132,6 +2481,10 @@ fu_firmware_remove_image_by_id(FuFirmware *self, const gchar *id, GError **error
  *
  * Returns all the images in the firmware.
  *
+ * Any images deferred using %FU_FIRMWARE_PARSE_FLAG_LAZY are parsed first, and the images
+ * that fail to parse are not returned. Use fu_firmware_ensure_images_parsed() first to get
+ * the error instead.
+ *
  * Returns: (transfer container) (element-type FuFirmware): images
  *
  * Since: 1.3.1
@@ -2147,6 +2500,11 @@ fu_firmware_get_images(FuFirmware *self)
 	imgs = g_ptr_array_new_with_free_func((GDestroyNotify)g_object_unref);
 	for (guint i = 0; i < priv->images->len; i++) {
 		FuFirmware *img = g_ptr_array_index(priv->images, i);
+		g_autoptr(GError) error_local = NULL;
+		if (!fu_firmware_ensure_parsed(img, &error_local)) {
+			g_debug("ignoring image: %s", error_local->message);
+			continue;
+		}
 		g_ptr_array_add(imgs, g_object_ref(img));
 	}
 	return g_steal_pointer(&imgs);
@@ -2188,16 +2546,27 @@ fu_firmware_get_image_by_id(FuFirmware *self, const gchar *id, GError **error)
 		g_auto(GStrv) split = g_strsplit(id, "|", 0);
 		for (guint i = 0; i < priv->images->len; i++) {
 			FuFirmware *img = g_ptr_array_index(priv->images, i);
+			if (fu_firmware_get_id(img) == NULL) {
+				if (!fu_firmware_ensure_parsed(img, error))
+					return NULL;
+			}
 			for (guint j = 0; split[j] != NULL; j++) {
 				if (fu_firmware_get_id(img) == NULL)
 					continue;
-				if (g_pattern_match_simple(split[j], fu_firmware_get_id(img)))
+				if (g_pattern_match_simple(split[j], fu_firmware_get_id(img))) {
+					if (!fu_firmware_ensure_parsed(img, error))
+						return NULL;
 					return g_object_ref(img);
+				}
 			}
 		}
 	} else {
 		for (guint i = 0; i < priv->images->len; i++) {
 			FuFirmware *img = g_ptr_array_index(priv->images, i);
+			if (fu_firmware_get_id(img) != NULL)
+				continue;
+			if (!fu_firmware_ensure_parsed(img, error))
+				return NULL;
 			if (fu_firmware_get_id(img) == NULL)
 				return g_object_ref(img);
 		}
@@ -2282,8 +2651,11 @@ fu_firmware_get_image_by_idx(FuFirmware *self, guint64 idx, GError **error)
 
 	for (guint i = 0; i < priv->images->len; i++) {
 		FuFirmware *img = g_ptr_array_index(priv->images, i);
-		if (fu_firmware_get_idx(img) == idx)
+		if (fu_firmware_get_idx(img) == idx) {
+			if (!fu_firmware_ensure_parsed(img, error))
+				return NULL;
 			return g_object_ref(img);
+		}
 	}
 	g_set_error(error,
 		    FWUPD_ERROR,
@@ -2323,6 +2695,8 @@ fu_firmware_get_image_by_checksum(FuFirmware *self, const gchar *checksum, GErro
 
 		/* if this expensive then the subclassed FuFirmware can
 		 * cache the result as required */
+		if (!fu_firmware_ensure_parsed(img, error))
+			return NULL;
 		checksum_tmp = fu_firmware_get_checksum(img, csum_kind, error);
 		if (checksum_tmp == NULL)
 			return NULL;
@@ -2423,8 +2797,11 @@ fu_firmware_get_image_by_gtype(FuFirmware *self, GType gtype, GError **error)
 
 	for (guint i = 0; i < priv->images->len; i++) {
 		FuFirmware *img = g_ptr_array_index(priv->images, i);
-		if (g_type_is_a(G_OBJECT_TYPE(img), gtype))
+		if (g_type_is_a(G_OBJECT_TYPE(img), gtype)) {
+			if (!fu_firmware_ensure_parsed(img, error))
+				return NULL;
 			return g_object_ref(img);
+		}
 	}
 	g_set_error(error,
 		    FWUPD_ERROR,
@@ -2632,6 +3009,8 @@ gchar *
 fu_firmware_export_to_xml(FuFirmware *self, FuFirmwareExportFlags flags, GError **error)
 {
 	g_autoptr(XbBuilderNode) bn = xb_builder_node_new("firmware");
+	if (!fu_firmware_ensure_images_parsed(self, error))
+		return NULL;
 	fu_firmware_export(self, flags, bn);
 	return xb_builder_node_export(bn,
 				      XB_NODE_EXPORT_FLAG_FORMAT_MULTILINE |
@@ -2737,6 +3116,10 @@ fu_firmware_finalize(GObject *object)
 		g_ptr_array_unref(priv->patches);
 	if (priv->magic != NULL)
 		g_ptr_array_unref(priv->magic);
+	if (priv->lazy_stream != NULL)
+		g_object_unref(priv->lazy_stream);
+	if (priv->lazy_error != NULL)
+		g_error_free(priv->lazy_error);
 	if (priv->parent != NULL)
 		g_object_remove_weak_pointer(G_OBJECT(priv->parent), (gpointer *)&priv->parent);
 	g_ptr_array_unref(priv->images);
@@ -243,6 +243,8 @@ fu_firmware_remove_image_by_id(FuFirmware *self, const gchar *id, GError **error
     G_GNUC_NON_NULL(1);
 GPtrArray *
 fu_firmware_get_images(FuFirmware *self) G_GNUC_NON_NULL(1);
+gboolean
+fu_firmware_ensure_images_parsed(FuFirmware *self, GError **error) G_GNUC_NON_NULL(1);
 FuFirmware *
 fu_firmware_get_image_by_id(FuFirmware *self, const gchar *id, GError **error) G_GNUC_NON_NULL(1);
 GBytes *
@@ -18,6 +18,8 @@ enum FuFirmwareParseFlags {
     OnlyTrustPqSignatures = 1 << 12,
     OnlyPartitionLayout = 1 << 13,
     OnlyBasename = 1 << 14,
+    Parallel = 1 << 15, // parse independent child images using a worker pool
+    Lazy = 1 << 16, // only parse child images or decompress data when they are read
 }
 
 enum FuFirmwareBuilderFlags {
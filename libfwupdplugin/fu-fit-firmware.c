@@ -12,6 +12,7 @@
 #include "fu-crc.h"
 #include "fu-dump.h"
 #include "fu-fdt-image.h"
+#include "fu-firmware-private.h"
 #include "fu-fit-firmware.h"
 #include "fu-input-stream.h"
 #include "fu-mem.h"
@@ -29,6 +30,23 @@
 
 G_DEFINE_TYPE(FuFitFirmware, fu_fit_firmware, FU_TYPE_FDT_FIRMWARE)
 
+typedef struct {
+	FuFirmware *img; /* no-ref */
+	GBytes *blob;
+	FuFirmwareParseFlags flags;
+	gboolean has_checksum;
+} FuFitFirmwareVerifyHelper;
+
+static void
+fu_fit_firmware_verify_helper_free(FuFitFirmwareVerifyHelper *helper)
+{
+	if (helper->blob != NULL)
+		g_bytes_unref(helper->blob);
+	g_free(helper);
+}
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC(FuFitFirmwareVerifyHelper, fu_fit_firmware_verify_helper_free)
+
 static FuFdtImage *
 fu_fit_firmware_get_image_root(FuFitFirmware *self)
 {
@@ -89,11 +107,7 @@ fu_fit_firmware_set_timestamp(FuFitFirmware *self, guint32 timestamp)
 }
 
 static gboolean
-fu_fit_firmware_verify_crc32(FuFitFirmware *self,
-			     FuFirmware *img,
-			     FuFirmware *img_hash,
-			     GBytes *blob,
-			     GError **error)
+fu_fit_firmware_verify_crc32(FuFirmware *img, FuFirmware *img_hash, GBytes *blob, GError **error)
 {
 	guint32 value = 0;
 	guint32 value_calc;
@@ -117,13 +131,11 @@ fu_fit_firmware_verify_crc32(FuFitFirmware *self,
 	}
 
 	/* success */
-	fu_firmware_add_flag(FU_FIRMWARE(self), FU_FIRMWARE_FLAG_HAS_CHECKSUM);
 	return TRUE;
 }
 
 static gboolean
-fu_fit_firmware_verify_checksum(FuFitFirmware *self,
-				FuFirmware *img,
+fu_fit_firmware_verify_checksum(FuFirmware *img,
 				FuFirmware *img_hash,
 				GChecksumType checksum_type,
 				GBytes *blob,
@@ -158,18 +170,22 @@ fu_fit_firmware_verify_checksum(FuFitFirmware *self,
 		return FALSE;
 
 	/* success */
-	fu_firmware_add_flag(FU_FIRMWARE(self), FU_FIRMWARE_FLAG_HAS_CHECKSUM);
 	return TRUE;
 }
 
 static gboolean
-fu_fit_firmware_verify_hash(FuFitFirmware *self,
-			    FuFirmware *img,
-			    FuFirmware *img_hash,
-			    GBytes *blob,
-			    GError **error)
+fu_fit_firmware_verify_hash(FuFitFirmwareVerifyHelper *helper, FuFirmware *img_hash, GError **error)
 {
+	FuFirmware *img = helper->img;
 	g_autofree gchar *algo = NULL;
+	struct {
+		const gchar *algo;
+		GChecksumType checksum_type;
+	} checksum_types[] = {
+	    {"md5", G_CHECKSUM_MD5},
+	    {"sha1", G_CHECKSUM_SHA1},
+	    {"sha256", G_CHECKSUM_SHA256},
+	};
 
 	/* what is this */
 	if (!fu_fdt_image_get_attr_str(FU_FDT_IMAGE(img_hash),
@@ -179,55 +195,49 @@ fu_fit_firmware_verify_hash(FuFitFirmware *self,
 		g_prefix_error(error, "cannot get algo for %s: ", fu_firmware_get_id(img));
 		return FALSE;
 	}
-	if (g_strcmp0(algo, "crc32") == 0)
-		return fu_fit_firmware_verify_crc32(self, img, img_hash, blob, error);
-	if (g_strcmp0(algo, "md5") == 0) {
-		return fu_fit_firmware_verify_checksum(self,
-						       img,
-						       img_hash,
-						       G_CHECKSUM_MD5,
-						       blob,
-						       error);
-	}
-	if (g_strcmp0(algo, "sha1") == 0) {
-		return fu_fit_firmware_verify_checksum(self,
-						       img,
-						       img_hash,
-						       G_CHECKSUM_SHA1,
-						       blob,
-						       error);
+	if (g_strcmp0(algo, "crc32") == 0) {
+		if (!fu_fit_firmware_verify_crc32(img, img_hash, helper->blob, error))
+			return FALSE;
+		helper->has_checksum = TRUE;
+		return TRUE;
 	}
-	if (g_strcmp0(algo, "sha256") == 0) {
-		return fu_fit_firmware_verify_checksum(self,
-						       img,
-						       img_hash,
-						       G_CHECKSUM_SHA256,
-						       blob,
-						       error);
+	for (guint i = 0; i < G_N_ELEMENTS(checksum_types); i++) {
+		if (g_strcmp0(algo, checksum_types[i].algo) != 0)
+			continue;
+		if (!fu_fit_firmware_verify_checksum(img,
+						     img_hash,
+						     checksum_types[i].checksum_type,
+						     helper->blob,
+						     error))
+			return FALSE;
+		helper->has_checksum = TRUE;
+		return TRUE;
 	}
 
 	/* ignore any hashes we do not support: success */
 	return TRUE;
 }
 
-static gboolean
-fu_fit_firmware_verify_image(FuFitFirmware *self,
-			     GInputStream *stream,
-			     FuFirmware *img,
-			     FuFirmwareParseFlags flags,
-			     GError **error)
+static FuFitFirmwareVerifyHelper *
+fu_fit_firmware_verify_helper_new(GInputStream *stream,
+				  FuFirmware *img,
+				  FuFirmwareParseFlags flags,
+				  GError **error)
 {
-	g_autoptr(GBytes) blob = NULL;
+	g_autoptr(FuFitFirmwareVerifyHelper) helper = g_new0(FuFitFirmwareVerifyHelper, 1);
+
+	helper->img = img;
+	helper->flags = flags;
 
 	/* sanity check */
 	if (!fu_fdt_image_get_attr_str(FU_FDT_IMAGE(img), "type", NULL, error))
-		return FALSE;
+		return NULL;
 	if (!fu_fdt_image_get_attr_str(FU_FDT_IMAGE(img), "description", NULL, error))
-		return FALSE;
+		return NULL;
 
 	/* if has data */
-	blob = fu_fdt_image_get_attr(FU_FDT_IMAGE(img), FU_FIT_FIRMWARE_ATTR_DATA, NULL);
-	if (blob == NULL) {
+	helper->blob = fu_fdt_image_get_attr(FU_FDT_IMAGE(img), FU_FIT_FIRMWARE_ATTR_DATA, NULL);
+	if (helper->blob == NULL) {
 		guint32 data_size = 0x0;
 		guint32 data_offset = 0x0;
 
@@ -236,34 +246,46 @@ fu_fit_firmware_verify_image(FuFitFirmware *self,
 					       FU_FIT_FIRMWARE_ATTR_DATA_OFFSET,
 					       &data_offset,
 					       error))
-			return FALSE;
+			return NULL;
 		if (!fu_fdt_image_get_attr_u32(FU_FDT_IMAGE(img),
 					       FU_FIT_FIRMWARE_ATTR_DATA_SIZE,
 					       &data_size,
 					       error))
-			return FALSE;
-		blob = fu_input_stream_read_bytes(stream, data_offset, data_size, NULL, error);
-		if (blob == NULL)
-			return FALSE;
+			return NULL;
+		helper->blob =
+		    fu_input_stream_read_bytes(stream, data_offset, data_size, NULL, error);
+		if (helper->blob == NULL)
+			return NULL;
 	}
-	fu_dump_bytes(G_LOG_DOMAIN, "data", blob);
+	fu_dump_bytes(G_LOG_DOMAIN, "data", helper->blob);
+
+	/* success */
+	return g_steal_pointer(&helper);
+}
+
+/* this may be run in a worker thread, so must not modify the FuFitFirmware */
+static gboolean
+fu_fit_firmware_verify_image_cb(gpointer item, gpointer user_data, GError **error)
+{
+	FuFitFirmwareVerifyHelper *helper = (FuFitFirmwareVerifyHelper *)item;
+	g_autoptr(GPtrArray) img_hashes = NULL;
 
 	/* verify any hashes we recognize */
-	if ((flags & FU_FIRMWARE_PARSE_FLAG_IGNORE_CHECKSUM) == 0) {
-		g_autoptr(GPtrArray) img_hashes = fu_firmware_get_images(img);
-		for (guint i = 0; i < img_hashes->len; i++) {
-			FuFirmware *img_hash = g_ptr_array_index(img_hashes, i);
-			if (fu_firmware_get_id(img_hash) == NULL) {
-				g_set_error_literal(error,
-						    FWUPD_ERROR,
-						    FWUPD_ERROR_INVALID_DATA,
-						    "no ID for image hash");
+	if (helper->flags & FU_FIRMWARE_PARSE_FLAG_IGNORE_CHECKSUM)
+		return TRUE;
+	img_hashes = fu_firmware_get_images(helper->img);
+	for (guint i = 0; i < img_hashes->len; i++) {
+		FuFirmware *img_hash = g_ptr_array_index(img_hashes, i);
+		if (fu_firmware_get_id(img_hash) == NULL) {
+			g_set_error_literal(error,
+					    FWUPD_ERROR,
+					    FWUPD_ERROR_INVALID_DATA,
+					    "no ID for image hash");
+			return FALSE;
+		}
+		if (g_str_has_prefix(fu_firmware_get_id(img_hash), "hash")) {
+			if (!fu_fit_firmware_verify_hash(helper, img_hash, error))
 				return FALSE;
-			}
-			if (g_str_has_prefix(fu_firmware_get_id(img_hash), "hash")) {
-				if (!fu_fit_firmware_verify_hash(self, img, img_hash, blob, error))
-					return FALSE;
-			}
 		}
 	}
 
@@ -300,6 +322,8 @@ fu_fit_firmware_parse(FuFirmware *firmware,
 	g_autoptr(FuFirmware) img_root = NULL;
 	g_autoptr(GPtrArray) img_images_array = NULL;
 	g_autoptr(GPtrArray) img_cfgs_array = NULL;
+	g_autoptr(GPtrArray) helpers =
+	    g_ptr_array_new_with_free_func((GDestroyNotify)fu_fit_firmware_verify_helper_free);
 
 	/* FuFdtFirmware->parse */
 	if (!FU_FIRMWARE_CLASS(fu_fit_firmware_parent_class)->parse(firmware, stream, flags, error))
@@ -322,8 +346,32 @@ fu_fit_firmware_parse(FuFirmware *firmware,
 	img_images_array = fu_firmware_get_images(img_images);
 	for (guint i = 0; i < img_images_array->len; i++) {
 		FuFirmware *img = g_ptr_array_index(img_images_array, i);
-		if (!fu_fit_firmware_verify_image(self, stream, img, flags, error))
+		g_autoptr(FuFitFirmwareVerifyHelper) helper = NULL;
+
+		helper = fu_fit_firmware_verify_helper_new(stream, img, flags, error);
+		if (helper == NULL)
 			return FALSE;
+
+		/* only keep all the image data in memory if verifying at the same time */
+		if ((flags & FU_FIRMWARE_PARSE_FLAG_PARALLEL) == 0) {
+			if (!fu_fit_firmware_verify_image_cb(helper, NULL, error))
+				return FALSE;
+			if (helper->has_checksum)
+				fu_firmware_add_flag(firmware, FU_FIRMWARE_FLAG_HAS_CHECKSUM);
+			continue;
+		}
+		g_ptr_array_add(helpers, g_steal_pointer(&helper));
+	}
+	if (!fu_firmware_parallel_foreach(helpers,
+					  flags,
+					  fu_fit_firmware_verify_image_cb,
+					  NULL,
+					  error))
+		return FALSE;
+	for (guint i = 0; i < helpers->len; i++) {
+		FuFitFirmwareVerifyHelper *helper = g_ptr_array_index(helpers, i);
+		if (helper->has_checksum)
+			fu_firmware_add_flag(firmware, FU_FIRMWARE_FLAG_HAS_CHECKSUM);
 	}
 
 	/* check the setup of each configuration */
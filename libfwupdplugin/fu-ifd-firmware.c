@@ -12,6 +12,7 @@
 #include "fu-common.h"
 #include "fu-composite-input-stream.h"
 #include "fu-efi-volume.h"
+#include "fu-firmware-private.h"
 #include "fu-ifd-bios.h"
 #include "fu-ifd-firmware.h"
 #include "fu-ifd-image.h"
@@ -291,18 +292,32 @@ fu_ifd_firmware_parse(FuFirmware *firmware,
 		} else {
 			img = fu_ifd_image_new();
 		}
-		if (!fu_firmware_parse_stream(img,
-					      partial_stream,
-					      0x0,
-					      flags | FU_FIRMWARE_PARSE_FLAG_NO_SEARCH,
-					      error))
-			return FALSE;
+		if ((flags & FU_FIRMWARE_PARSE_FLAG_LAZY) == 0) {
+			if (!fu_firmware_parse_stream(img,
+						      partial_stream,
+						      0x0,
+						      flags | FU_FIRMWARE_PARSE_FLAG_NO_SEARCH,
+						      error))
+				return FALSE;
+		}
 		fu_firmware_set_addr(img, freg_base);
 		fu_firmware_set_idx(img, i);
 		if (freg_str != NULL)
 			fu_firmware_set_id(img, freg_str);
-		if (!fu_firmware_add_image(firmware, img, error))
-			return FALSE;
+		if (flags & FU_FIRMWARE_PARSE_FLAG_LAZY) {
+			/* the EFI volumes in the BIOS region are only parsed when required */
+			fu_firmware_set_size(img, freg_size);
+			if (!fu_firmware_add_image_lazy(firmware,
+							img,
+							partial_stream,
+							0x0,
+							flags | FU_FIRMWARE_PARSE_FLAG_NO_SEARCH,
+							error))
+				return FALSE;
+		} else {
+			if (!fu_firmware_add_image(firmware, img, error))
+				return FALSE;
+		}
 
 		/* is writable by anything other than the region itself */
 		for (FuIfdRegion r = 1; r <= 3; r++) {
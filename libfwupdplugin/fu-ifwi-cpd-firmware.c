@@ -11,6 +11,7 @@
 
 #include "fu-byte-array.h"
 #include "fu-common.h"
+#include "fu-firmware-private.h"
 #include "fu-ifwi-cpd-firmware.h"
 #include "fu-ifwi-struct.h"
 #include "fu-input-stream.h"
@@ -175,6 +176,10 @@ fu_ifwi_cpd_firmware_parse(FuFirmware *firmware,
 	g_autoptr(FuStructIfwiCpd) st_hdr = NULL;
 	gsize offset = 0;
 	guint32 num_of_entries;
+	g_autoptr(GPtrArray) imgs = g_ptr_array_new_with_free_func((GDestroyNotify)g_object_unref);
+	g_autoptr(GPtrArray) streams =
+	    g_ptr_array_new_with_free_func((GDestroyNotify)g_object_unref);
+	g_autoptr(GArray) lengths = g_array_new(FALSE, FALSE, sizeof(guint32));
 
 	/* other header fields */
 	st_hdr = fu_struct_ifwi_cpd_parse_stream(stream, offset, error);
@@ -199,6 +204,7 @@ fu_ifwi_cpd_firmware_parse(FuFirmware *firmware,
 		return FALSE;
 	for (guint32 i = 0; i < num_of_entries; i++) {
 		guint32 img_offset = 0;
+		guint32 img_length;
 		g_autofree gchar *id = NULL;
 		g_autoptr(FuFirmware) img = fu_firmware_new();
 		g_autoptr(FuStructIfwiCpdEntry) st_ent = NULL;
@@ -221,22 +227,30 @@ fu_ifwi_cpd_firmware_parse(FuFirmware *firmware,
 		fu_firmware_set_offset(img, img_offset);
 
 		/* copy data */
-		partial_stream =
-		    fu_partial_input_stream_new(stream,
-						img_offset,
-						fu_struct_ifwi_cpd_entry_get_length(st_ent),
-						error);
+		img_length = fu_struct_ifwi_cpd_entry_get_length(st_ent);
+		partial_stream = fu_partial_input_stream_new(stream, img_offset, img_length, error);
 		if (partial_stream == NULL) {
 			g_prefix_error_literal(error, "failed to cut IFD image: ");
 			return FALSE;
 		}
-		if (!fu_firmware_parse_stream(img, partial_stream, 0x0, flags, error))
+		g_array_append_val(lengths, img_length);
+		g_ptr_array_add(imgs, g_steal_pointer(&img));
+		g_ptr_array_add(streams, g_steal_pointer(&partial_stream));
+		if (!fu_size_checked_inc(&offset, st_ent->buf->len, error))
 			return FALSE;
+	}
+
+	/* the entries are independent of each other */
+	if (!fu_firmware_parse_images(imgs, streams, flags, NULL, error))
+		return FALSE;
+
+	for (guint i = 0; i < imgs->len; i++) {
+		FuFirmware *img = g_ptr_array_index(imgs, i);
+		GInputStream *partial_stream = g_ptr_array_index(streams, i);
 
 		/* read the manifest */
 		if (i == FU_IFWI_CPD_FIRMWARE_IDX_MANIFEST &&
-		    fu_struct_ifwi_cpd_entry_get_length(st_ent) >
-			FU_STRUCT_IFWI_CPD_MANIFEST_SIZE) {
+		    g_array_index(lengths, guint32, i) > FU_STRUCT_IFWI_CPD_MANIFEST_SIZE) {
 			if (!fu_ifwi_cpd_firmware_parse_manifest(self,
 								 img,
 								 partial_stream,
@@ -248,8 +262,6 @@ fu_ifwi_cpd_firmware_parse(FuFirmware *firmware,
 		/* success */
 		if (!fu_firmware_add_image(firmware, img, error))
 			return FALSE;
-		if (!fu_size_checked_inc(&offset, st_ent->buf->len, error))
-			return FALSE;
 	}
 
 	/* success */
@@ -124,6 +124,131 @@ fu_ihex_firmware_offset_func(void)
 	g_assert_cmpint(g_bytes_get_size(data_verify), ==, 0x4);
 }
 
+static void
+fu_ihex_firmware_chunks_func(void)
+{
+	FuChunk *chk;
+	FuIhexFirmwareRecord *rcd;
+	GPtrArray *records;
+	gboolean ret;
+	g_autoptr(FuFirmware) firmware = fu_ihex_firmware_new();
+	g_autoptr(GBytes) blob = NULL;
+	g_autoptr(GBytes) data_fw = NULL;
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GPtrArray) chunks = NULL;
+	const gchar *buf = ":0400000001020304F2\r\n"
+			   ":02001000AABB89\r\n"
+			   ":00000001FF\r\n";
+
+	blob = g_bytes_new_static(buf, strlen(buf));
+	ret =
+	    fu_firmware_parse_bytes(firmware, blob, 0x0, FU_FIRMWARE_PARSE_FLAG_NO_SEARCH, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	data_fw = fu_firmware_get_bytes(firmware, &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(data_fw);
+	g_assert_cmpint(g_bytes_get_size(data_fw), ==, 0x12);
+
+	/* only the ranges in the file, without the padding */
+	chunks = fu_ihex_firmware_get_chunks(FU_IHEX_FIRMWARE(firmware), &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(chunks);
+	g_assert_cmpint(chunks->len, ==, 2);
+	chk = g_ptr_array_index(chunks, 0);
+	g_assert_cmpint(fu_chunk_get_address(chk), ==, 0x0);
+	g_assert_cmpint(fu_chunk_get_data_sz(chk), ==, 4);
+	chk = g_ptr_array_index(chunks, 1);
+	g_assert_cmpint(fu_chunk_get_address(chk), ==, 0x10);
+	g_assert_cmpint(fu_chunk_get_data_sz(chk), ==, 2);
+	g_assert_cmpint(fu_chunk_get_data(chk)[0], ==, 0xAA);
+
+	/* records are still available when asked for */
+	records = fu_ihex_firmware_get_records(FU_IHEX_FIRMWARE(firmware));
+	g_assert_nonnull(records);
+	g_assert_cmpint(records->len, ==, 3);
+	rcd = g_ptr_array_index(records, 1);
+	g_assert_cmpint(rcd->ln, ==, 2);
+	g_assert_cmpint(rcd->addr, ==, 0x10);
+	g_assert_cmpint(rcd->data->len, ==, 2);
+}
+
+/* a subclass that edits the records before the image is built */
+#define FU_TYPE_IHEX_FIRMWARE_EDIT (fu_ihex_firmware_edit_get_type())
+G_DECLARE_FINAL_TYPE(FuIhexFirmwareEdit,
+		     fu_ihex_firmware_edit,
+		     FU,
+		     IHEX_FIRMWARE_EDIT,
+		     FuIhexFirmware)
+
+struct _FuIhexFirmwareEdit {
+	FuIhexFirmware parent_instance;
+};
+
+G_DEFINE_TYPE(FuIhexFirmwareEdit, fu_ihex_firmware_edit, FU_TYPE_IHEX_FIRMWARE)
+
+static gboolean
+fu_ihex_firmware_edit_parse(FuFirmware *firmware,
+			    GInputStream *stream,
+			    FuFirmwareParseFlags flags,
+			    GError **error)
+{
+	FuFirmwareClass *klass = FU_FIRMWARE_CLASS(fu_ihex_firmware_edit_parent_class);
+	FuIhexFirmwareRecord *rcd;
+	GPtrArray *records;
+
+	if (!fu_ihex_firmware_ensure_records(FU_IHEX_FIRMWARE(firmware), error))
+		return FALSE;
+	records = fu_ihex_firmware_get_records(FU_IHEX_FIRMWARE(firmware));
+	rcd = g_ptr_array_index(records, 0);
+	rcd->data->data[0] = 0xFF;
+	return klass->parse(firmware, stream, flags, error);
+}
+
+static void
+fu_ihex_firmware_edit_init(FuIhexFirmwareEdit *self)
+{
+}
+
+static void
+fu_ihex_firmware_edit_class_init(FuIhexFirmwareEditClass *klass)
+{
+	FuFirmwareClass *firmware_class = FU_FIRMWARE_CLASS(klass);
+	firmware_class->parse = fu_ihex_firmware_edit_parse;
+}
+
+static void
+fu_ihex_firmware_records_edit_func(void)
+{
+	gboolean ret;
+	g_autoptr(FuFirmware) firmware = g_object_new(FU_TYPE_IHEX_FIRMWARE_EDIT, NULL);
+	g_autoptr(GBytes) blob = NULL;
+	g_autoptr(GBytes) data_fw = NULL;
+	g_autoptr(GError) error = NULL;
+	const gchar *buf = ":0400000001020304F2\r\n"
+			   ":00000001FF\r\n";
+
+	blob = g_bytes_new_static(buf, strlen(buf));
+	ret =
+	    fu_firmware_parse_bytes(firmware, blob, 0x0, FU_FIRMWARE_PARSE_FLAG_NO_SEARCH, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+
+	/* the image was built from the edited records, not from the stream */
+	data_fw = fu_firmware_get_bytes(firmware, &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(data_fw);
+	g_assert_cmpint(g_bytes_get_size(data_fw), ==, 4);
+	g_assert_cmpint(((const guint8 *)g_bytes_get_data(data_fw, NULL))[0], ==, 0xFF);
+	g_assert_cmpint(((const guint8 *)g_bytes_get_data(data_fw, NULL))[1], ==, 0x02);
+
+	/* the records are kept */
+	ret = fu_ihex_firmware_ensure_records(FU_IHEX_FIRMWARE(firmware), &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	g_assert_cmpint(fu_ihex_firmware_get_records(FU_IHEX_FIRMWARE(firmware))->len, ==, 2);
+}
+
 int
 main(int argc, char **argv)
 {
@@ -133,5 +258,7 @@ main(int argc, char **argv)
 	g_test_add_func("/fwupd/ihex-firmware", fu_ihex_firmware_func);
 	g_test_add_func("/fwupd/ihex-firmware/offset", fu_ihex_firmware_offset_func);
 	g_test_add_func("/fwupd/ihex-firmware/signed", fu_ihex_firmware_signed_func);
+	g_test_add_func("/fwupd/ihex-firmware/chunks", fu_ihex_firmware_chunks_func);
+	g_test_add_func("/fwupd/ihex-firmware/records-edit", fu_ihex_firmware_records_edit_func);
 	return g_test_run();
 }
@@ -11,6 +11,8 @@
 #include <string.h>
 
 #include "fu-byte-array.h"
+#include "fu-bytes.h"
+#include "fu-chunk.h"
 #include "fu-common.h"
 #include "fu-firmware-common.h"
 #include "fu-ihex-firmware.h"
@@ -26,8 +28,19 @@
  * See also: [class@FuFirmware]
  */
 
+/* a contiguous range of data records, as found in the image */
+typedef struct {
+	guint32 addr;
+	gsize offset;
+	gsize size;
+} FuIhexFirmwareRegion;
+
 typedef struct {
 	GPtrArray *records;
+	gboolean records_valid;
+	GInputStream *stream;
+	FuFirmwareParseFlags flags;
+	GArray *regions; /* of FuIhexFirmwareRegion */
 	guint8 padding_value;
 } FuIhexFirmwarePrivate;
 
@@ -45,7 +58,12 @@ G_DEFINE_TYPE_WITH_PRIVATE(FuIhexFirmware, fu_ihex_firmware, FU_TYPE_FIRMWARE)
  * This might be useful if the plugin is expecting the hex file to be a list
  * of operations, rather than a simple linear image with filled holes.
  *
- * Returns: (transfer none) (element-type FuIhexFirmwareRecord): records
+ * The records are only created when they are first needed, as parsing the image does
+ * not use them. Call fu_ihex_firmware_ensure_records() first to get the error if they
+ * cannot be created.
+ *
+ * Returns: (transfer none) (element-type FuIhexFirmwareRecord) (nullable): records, or
+ * %NULL if they could not be created
  *
  * Since: 1.3.4
  **/
@@ -54,9 +72,54 @@ fu_ihex_firmware_get_records(FuIhexFirmware *self)
 {
 	FuIhexFirmwarePrivate *priv = GET_PRIVATE(self);
 	g_return_val_if_fail(FU_IS_IHEX_FIRMWARE(self), NULL);
+	if (!fu_ihex_firmware_ensure_records(self, NULL))
+		return NULL;
 	return priv->records;
 }
 
+/**
+ * fu_ihex_firmware_get_chunks:
+ * @self: A #FuIhexFirmware
+ * @error: (nullable): optional return location for an error
+ *
+ * Returns the address ranges that were defined by data records in the parsed file,
+ * without any of the padding used to fill the holes between them.
+ *
+ * Returns: (transfer container) (element-type FuChunk): chunks, or %NULL on error
+ *
+ * Since: 2.1.6
+ **/
+GPtrArray *
+fu_ihex_firmware_get_chunks(FuIhexFirmware *self, GError **error)
+{
+	FuIhexFirmwarePrivate *priv = GET_PRIVATE(self);
+	g_autoptr(GBytes) blob = NULL;
+	g_autoptr(GPtrArray) chunks =
+	    g_ptr_array_new_with_free_func((GDestroyNotify)g_object_unref);
+
+	g_return_val_if_fail(FU_IS_IHEX_FIRMWARE(self), NULL);
+	g_return_val_if_fail(error == NULL || *error == NULL, NULL);
+
+	blob = fu_firmware_get_bytes(FU_FIRMWARE(self), error);
+	if (blob == NULL)
+		return NULL;
+	for (guint i = 0; i < priv->regions->len; i++) {
+		FuIhexFirmwareRegion *region =
+		    &g_array_index(priv->regions, FuIhexFirmwareRegion, i);
+		g_autoptr(FuChunk) chk = NULL;
+		g_autoptr(GBytes) blob_chk = NULL;
+
+		blob_chk = fu_bytes_new_offset(blob, region->offset, region->size, error);
+		if (blob_chk == NULL)
+			return NULL;
+		chk = fu_chunk_bytes_new(blob_chk);
+		fu_chunk_set_idx(chk, i);
+		fu_chunk_set_address(chk, region->addr);
+		g_ptr_array_add(chunks, g_steal_pointer(&chk));
+	}
+	return g_steal_pointer(&chunks);
+}
+
 /**
  * fu_ihex_firmware_set_padding_value:
  * @self: A #FuIhexFirmware
@@ -209,6 +272,46 @@ fu_ihex_firmware_tokenize_cb(GString *token, guint token_idx, gpointer user_data
 	return TRUE;
 }
 
+/**
+ * fu_ihex_firmware_ensure_records:
+ * @self: A #FuIhexFirmware
+ * @error: (nullable): optional return location for an error
+ *
+ * Creates the records from the parsed stream, if not already done. The stream is
+ * released once the records have been created.
+ *
+ * Returns: %TRUE for success
+ *
+ * Since: 2.1.6
+ **/
+gboolean
+fu_ihex_firmware_ensure_records(FuIhexFirmware *self, GError **error)
+{
+	FuIhexFirmwarePrivate *priv = GET_PRIVATE(self);
+	FuIhexFirmwareTokenHelper helper = {.self = self, .flags = priv->flags};
+
+	g_return_val_if_fail(FU_IS_IHEX_FIRMWARE(self), FALSE);
+	g_return_val_if_fail(error == NULL || *error == NULL, FALSE);
+
+	/* already done, or nothing to tokenize */
+	if (priv->records_valid || priv->stream == NULL)
+		return TRUE;
+	if (!fu_strsplit_stream(priv->stream,
+				0x0,
+				"\n",
+				fu_ihex_firmware_tokenize_cb,
+				&helper,
+				error)) {
+		g_ptr_array_set_size(priv->records, 0);
+		return FALSE;
+	}
+
+	/* the stream is not needed again */
+	priv->records_valid = TRUE;
+	g_clear_object(&priv->stream);
+	return TRUE;
+}
+
 static gboolean
 fu_ihex_firmware_tokenize(FuFirmware *firmware,
 			  GInputStream *stream,
@@ -216,229 +319,361 @@ fu_ihex_firmware_tokenize(FuFirmware *firmware,
 			  GError **error)
 {
 	FuIhexFirmware *self = FU_IHEX_FIRMWARE(firmware);
-	FuIhexFirmwareTokenHelper helper = {.self = self, .flags = flags};
-	return fu_strsplit_stream(stream, 0x0, "\n", fu_ihex_firmware_tokenize_cb, &helper, error);
+	FuIhexFirmwarePrivate *priv = GET_PRIVATE(self);
+
+	/* records are created on demand as ->parse() decodes the stream directly */
+	g_set_object(&priv->stream, stream);
+	g_ptr_array_set_size(priv->records, 0);
+	priv->records_valid = FALSE;
+	priv->flags = flags;
+	if (!fu_firmware_has_flag(firmware, FU_FIRMWARE_FLAG_DONE_PARSE))
+		return fu_ihex_firmware_ensure_records(self, error);
+	return TRUE;
+}
+
+typedef struct {
+	FuFirmwareParseFlags flags;
+	GByteArray *buf;
+	guint idx;
+	gboolean got_eof;
+	gboolean got_sig;
+	guint32 abs_addr;
+	guint32 addr_last;
+	guint32 img_addr;
+	guint32 seg_addr;
+} FuIhexFirmwareParseHelper;
+
+static void
+fu_ihex_firmware_add_region(FuIhexFirmware *self, guint32 addr, gsize offset, gsize size)
+{
+	FuIhexFirmwarePrivate *priv = GET_PRIVATE(self);
+	FuIhexFirmwareRegion region = {.addr = addr, .offset = offset, .size = size};
+
+	/* extend the last region if contiguous */
+	if (priv->regions->len > 0) {
+		FuIhexFirmwareRegion *last =
+		    &g_array_index(priv->regions, FuIhexFirmwareRegion, priv->regions->len - 1);
+		if (last->addr + last->size == addr && last->offset + last->size == offset) {
+			last->size += size;
+			return;
+		}
+	}
+	g_array_append_val(priv->regions, region);
 }
 
 static gboolean
-fu_ihex_firmware_parse(FuFirmware *firmware,
-		       GInputStream *stream,
-		       FuFirmwareParseFlags flags,
-		       GError **error)
+fu_ihex_firmware_parse_record(FuIhexFirmware *self,
+			      FuIhexFirmwareParseHelper *helper,
+			      guint ln,
+			      guint8 record_type,
+			      guint32 rec_addr,
+			      const guint8 *data,
+			      gsize datasz,
+			      GError **error)
 {
-	FuIhexFirmware *self = FU_IHEX_FIRMWARE(firmware);
 	FuIhexFirmwarePrivate *priv = GET_PRIVATE(self);
-	gboolean got_eof = FALSE;
-	gboolean got_sig = FALSE;
-	guint32 abs_addr = 0x0;
-	guint32 addr_last = 0x0;
-	guint32 img_addr = G_MAXUINT32;
-	guint32 seg_addr = 0x0;
-	g_autoptr(GBytes) img_bytes = NULL;
-	g_autoptr(GByteArray) buf = g_byte_array_new();
+	guint16 addr16 = 0;
+	guint idx = helper->idx++;
+	gsize addr;
+	guint32 len_hole;
+
+	/* calculate address with overflow checking */
+	addr = rec_addr;
+	if (!fu_size_checked_inc(&addr, helper->seg_addr, error)) {
+		g_prefix_error(error, "address overflow on line %u: ", ln);
+		return FALSE;
+	}
+	if (!fu_size_checked_inc(&addr, helper->abs_addr, error)) {
+		g_prefix_error(error, "address overflow on line %u: ", ln);
+		return FALSE;
+	}
+	if (addr > G_MAXUINT32) {
+		g_set_error(error,
+			    FWUPD_ERROR,
+			    FWUPD_ERROR_INVALID_DATA,
+			    "address 0x%zx exceeds 32-bit limit on line %u",
+			    addr,
+			    ln);
+		return FALSE;
+	}
 
-	/* parse records */
-	for (guint k = 0; k < priv->records->len; k++) {
-		FuIhexFirmwareRecord *rcd = g_ptr_array_index(priv->records, k);
-		guint16 addr16 = 0;
-		gsize addr;
-		guint32 len_hole;
-
-		/* calculate address with overflow checking */
-		addr = rcd->addr;
-		if (!fu_size_checked_inc(&addr, seg_addr, error)) {
-			g_prefix_error(error, "address overflow on line %u: ", rcd->ln);
+	/* sanity check */
+	if (record_type != FU_IHEX_FIRMWARE_RECORD_TYPE_EOF && datasz == 0) {
+		g_set_error(error,
+			    FWUPD_ERROR,
+			    FWUPD_ERROR_NOT_SUPPORTED,
+			    "record 0x%x had zero size",
+			    idx);
+		return FALSE;
+	}
+
+	/* process different record types */
+	switch (record_type) {
+	case FU_IHEX_FIRMWARE_RECORD_TYPE_DATA:
+
+		/* does not make sense */
+		if (helper->got_eof) {
+			g_set_error_literal(error,
+					    FWUPD_ERROR,
+					    FWUPD_ERROR_INVALID_FILE,
+					    "cannot process data after EOF");
 			return FALSE;
 		}
-		if (!fu_size_checked_inc(&addr, abs_addr, error)) {
-			g_prefix_error(error, "address overflow on line %u: ", rcd->ln);
+		if (datasz == 0) {
+			g_set_error_literal(error,
+					    FWUPD_ERROR,
+					    FWUPD_ERROR_INVALID_FILE,
+					    "cannot parse invalid data");
 			return FALSE;
 		}
-		if (addr > G_MAXUINT32) {
+
+		/* base address for element */
+		if (helper->img_addr == G_MAXUINT32)
+			helper->img_addr = addr;
+
+		/* does not make sense */
+		if (addr < helper->addr_last) {
 			g_set_error(error,
 				    FWUPD_ERROR,
-				    FWUPD_ERROR_INVALID_DATA,
-				    "address 0x%zx exceeds 32-bit limit on line %u",
-				    addr,
-				    rcd->ln);
+				    FWUPD_ERROR_INVALID_FILE,
+				    "invalid address 0x%x, last was 0x%x on line %u",
+				    (guint)addr,
+				    (guint)helper->addr_last,
+				    ln);
 			return FALSE;
 		}
 
-		/* debug */
-		g_debug("%s:", fu_ihex_firmware_record_type_to_string(rcd->record_type));
-		g_debug("length:\t0x%02x", rcd->data->len);
-		g_debug("addr:\t0x%08x", (guint)addr);
-
-		/* sanity check */
-		if (rcd->record_type != FU_IHEX_FIRMWARE_RECORD_TYPE_EOF && rcd->data->len == 0) {
+		/* any holes in the hex record */
+		len_hole = addr - helper->addr_last;
+		if (helper->addr_last > 0 && len_hole > 1 * FU_MB) {
 			g_set_error(error,
 				    FWUPD_ERROR,
-				    FWUPD_ERROR_NOT_SUPPORTED,
-				    "record 0x%x had zero size",
-				    k);
+				    FWUPD_ERROR_INVALID_FILE,
+				    "hole of 0x%x bytes too large to fill on line %u",
+				    (guint)len_hole,
+				    ln);
+			return FALSE;
+		}
+		if (helper->addr_last > 0x0 && len_hole > 1) {
+			g_debug("filling address 0x%08x to 0x%08x on line %u",
+				helper->addr_last + 1,
+				helper->addr_last + len_hole - 1,
+				ln);
+			fu_byte_array_set_size(helper->buf,
+					       helper->buf->len + len_hole - 1,
+					       priv->padding_value);
+		}
+		helper->addr_last = addr + datasz - 1;
+		if (helper->addr_last < addr) {
+			g_set_error(error,
+				    FWUPD_ERROR,
+				    FWUPD_ERROR_INVALID_FILE,
+				    "overflow of address 0x%x on line %u",
+				    (guint)addr,
+				    ln);
 			return FALSE;
 		}
 
-		/* process different record types */
-		switch (rcd->record_type) {
-		case FU_IHEX_FIRMWARE_RECORD_TYPE_DATA:
-
-			/* does not make sense */
-			if (got_eof) {
-				g_set_error_literal(error,
-						    FWUPD_ERROR,
-						    FWUPD_ERROR_INVALID_FILE,
-						    "cannot process data after EOF");
-				return FALSE;
-			}
-			if (rcd->data->len == 0) {
-				g_set_error_literal(error,
-						    FWUPD_ERROR,
-						    FWUPD_ERROR_INVALID_FILE,
-						    "cannot parse invalid data");
-				return FALSE;
-			}
-
-			/* base address for element */
-			if (img_addr == G_MAXUINT32)
-				img_addr = addr;
-
-			/* does not make sense */
-			if (addr < addr_last) {
-				g_set_error(error,
-					    FWUPD_ERROR,
-					    FWUPD_ERROR_INVALID_FILE,
-					    "invalid address 0x%x, last was 0x%x on line %u",
-					    (guint)addr,
-					    (guint)addr_last,
-					    rcd->ln);
-				return FALSE;
-			}
-
-			/* any holes in the hex record */
-			len_hole = addr - addr_last;
-			if (addr_last > 0 && len_hole > 1 * FU_MB) {
-				g_set_error(error,
+		/* write into buf */
+		fu_ihex_firmware_add_region(self, addr, helper->buf->len, datasz);
+		g_byte_array_append(helper->buf, data, datasz);
+		break;
+	case FU_IHEX_FIRMWARE_RECORD_TYPE_EOF:
+		if (helper->got_eof) {
+			g_set_error_literal(error,
 					    FWUPD_ERROR,
 					    FWUPD_ERROR_INVALID_FILE,
-					    "hole of 0x%x bytes too large to fill on line %u",
-					    (guint)len_hole,
-					    rcd->ln);
-				return FALSE;
-			}
-			if (addr_last > 0x0 && len_hole > 1) {
-				g_debug("filling address 0x%08x to 0x%08x on line %u",
-					addr_last + 1,
-					addr_last + len_hole - 1,
-					rcd->ln);
-				for (guint j = 1; j < len_hole; j++)
-					fu_byte_array_append_uint8(buf, priv->padding_value);
-			}
-			addr_last = addr + rcd->data->len - 1;
-			if (addr_last < addr) {
-				g_set_error(error,
+					    "duplicate EOF, perhaps "
+					    "corrupt file");
+			return FALSE;
+		}
+		helper->got_eof = TRUE;
+		break;
+	case FU_IHEX_FIRMWARE_RECORD_TYPE_EXTENDED_LINEAR:
+		if (!fu_memread_uint16_safe(data, datasz, 0x0, &addr16, G_BIG_ENDIAN, error))
+			return FALSE;
+		helper->abs_addr = (guint32)addr16 << 16;
+		g_debug("abs_addr:\t0x%02x on line %u", helper->abs_addr, ln);
+		break;
+	case FU_IHEX_FIRMWARE_RECORD_TYPE_START_LINEAR:
+		if (!fu_memread_uint32_safe(data,
+					    datasz,
+					    0x0,
+					    &helper->abs_addr,
+					    G_BIG_ENDIAN,
+					    error))
+			return FALSE;
+		g_debug("abs_addr:\t0x%08x on line %u", helper->abs_addr, ln);
+		break;
+	case FU_IHEX_FIRMWARE_RECORD_TYPE_EXTENDED_SEGMENT:
+		if (!fu_memread_uint16_safe(data, datasz, 0x0, &addr16, G_BIG_ENDIAN, error))
+			return FALSE;
+		/* segment base address, so ~1Mb addressable */
+		helper->seg_addr = (guint32)addr16 * 16;
+		g_debug("seg_addr:\t0x%08x on line %u", helper->seg_addr, ln);
+		break;
+	case FU_IHEX_FIRMWARE_RECORD_TYPE_START_SEGMENT:
+		/* initial content of the CS:IP registers */
+		if (!fu_memread_uint32_safe(data,
+					    datasz,
+					    0x0,
+					    &helper->seg_addr,
+					    G_BIG_ENDIAN,
+					    error))
+			return FALSE;
+		g_debug("seg_addr:\t0x%02x on line %u", helper->seg_addr, ln);
+		break;
+	case FU_IHEX_FIRMWARE_RECORD_TYPE_SIGNATURE:
+		if (helper->got_sig) {
+			g_set_error_literal(error,
 					    FWUPD_ERROR,
 					    FWUPD_ERROR_INVALID_FILE,
-					    "overflow of address 0x%x on line %u",
-					    (guint)addr,
-					    rcd->ln);
-				return FALSE;
-			}
-
-			/* write into buf */
-			g_byte_array_append(buf, rcd->data->data, rcd->data->len);
-			break;
-		case FU_IHEX_FIRMWARE_RECORD_TYPE_EOF:
-			if (got_eof) {
-				g_set_error_literal(error,
-						    FWUPD_ERROR,
-						    FWUPD_ERROR_INVALID_FILE,
-						    "duplicate EOF, perhaps "
-						    "corrupt file");
-				return FALSE;
-			}
-			got_eof = TRUE;
-			break;
-		case FU_IHEX_FIRMWARE_RECORD_TYPE_EXTENDED_LINEAR:
-			if (!fu_memread_uint16_safe(rcd->data->data,
-						    rcd->data->len,
-						    0x0,
-						    &addr16,
-						    G_BIG_ENDIAN,
-						    error))
-				return FALSE;
-			abs_addr = (guint32)addr16 << 16;
-			g_debug("abs_addr:\t0x%02x on line %u", abs_addr, rcd->ln);
-			break;
-		case FU_IHEX_FIRMWARE_RECORD_TYPE_START_LINEAR:
-			if (!fu_memread_uint32_safe(rcd->data->data,
-						    rcd->data->len,
-						    0x0,
-						    &abs_addr,
-						    G_BIG_ENDIAN,
-						    error))
-				return FALSE;
-			g_debug("abs_addr:\t0x%08x on line %u", abs_addr, rcd->ln);
-			break;
-		case FU_IHEX_FIRMWARE_RECORD_TYPE_EXTENDED_SEGMENT:
-			if (!fu_memread_uint16_safe(rcd->data->data,
-						    rcd->data->len,
-						    0x0,
-						    &addr16,
-						    G_BIG_ENDIAN,
-						    error))
-				return FALSE;
-			/* segment base address, so ~1Mb addressable */
-			seg_addr = (guint32)addr16 * 16;
-			g_debug("seg_addr:\t0x%08x on line %u", seg_addr, rcd->ln);
-			break;
-		case FU_IHEX_FIRMWARE_RECORD_TYPE_START_SEGMENT:
-			/* initial content of the CS:IP registers */
-			if (!fu_memread_uint32_safe(rcd->data->data,
-						    rcd->data->len,
-						    0x0,
-						    &seg_addr,
-						    G_BIG_ENDIAN,
-						    error))
-				return FALSE;
-			g_debug("seg_addr:\t0x%02x on line %u", seg_addr, rcd->ln);
-			break;
-		case FU_IHEX_FIRMWARE_RECORD_TYPE_SIGNATURE:
-			if (got_sig) {
-				g_set_error_literal(error,
-						    FWUPD_ERROR,
-						    FWUPD_ERROR_INVALID_FILE,
-						    "duplicate signature, perhaps "
-						    "corrupt file");
+					    "duplicate signature, perhaps "
+					    "corrupt file");
+			return FALSE;
+		}
+		if (datasz > 0) {
+			g_autoptr(GBytes) data_sig = g_bytes_new(data, datasz);
+			g_autoptr(FuFirmware) img_sig = fu_firmware_new_from_bytes(data_sig);
+			fu_firmware_set_id(img_sig, FU_FIRMWARE_ID_SIGNATURE);
+			if (!fu_firmware_add_image(FU_FIRMWARE(self), img_sig, error))
 				return FALSE;
-			}
-			if (rcd->data->len > 0) {
-				g_autoptr(GBytes) data_sig =
-				    g_bytes_new(rcd->data->data, rcd->data->len);
-				g_autoptr(FuFirmware) img_sig =
-				    fu_firmware_new_from_bytes(data_sig);
-				fu_firmware_set_id(img_sig, FU_FIRMWARE_ID_SIGNATURE);
-				if (!fu_firmware_add_image(firmware, img_sig, error))
-					return FALSE;
-			}
-			got_sig = TRUE;
+		}
+		helper->got_sig = TRUE;
+		break;
+	default:
+		/* vendors sneak in nonstandard sections past the EOF */
+		if (helper->got_eof)
 			break;
-		default:
-			/* vendors sneak in nonstandard sections past the EOF */
-			if (got_eof)
-				break;
-			g_set_error(error,
+		g_set_error(error,
+			    FWUPD_ERROR,
+			    FWUPD_ERROR_INVALID_FILE,
+			    "invalid ihex record type %i on line %u",
+			    record_type,
+			    ln);
+		return FALSE;
+	}
+
+	/* success */
+	return TRUE;
+}
+
+typedef struct {
+	FuIhexFirmware *self;
+	FuIhexFirmwareParseHelper *helper;
+} FuIhexFirmwareStreamHelper;
+
+static gboolean
+fu_ihex_firmware_parse_stream_cb(GString *token,
+				 guint token_idx,
+				 gpointer user_data,
+				 GError **error)
+{
+	FuIhexFirmwareStreamHelper *stream_helper = (FuIhexFirmwareStreamHelper *)user_data;
+	FuIhexFirmwareParseHelper *helper = stream_helper->helper;
+	guint8 rec[5 + G_MAXUINT8] = {0x0}; /* count, addr, type, data, checksum */
+	g_autoptr(FuIhexFirmwareRecord) rcd = NULL;
+
+	/* sanity check */
+	if (token_idx > FU_IHEX_FIRMWARE_TOKENS_MAX) {
+		g_set_error_literal(error,
 				    FWUPD_ERROR,
-				    FWUPD_ERROR_INVALID_FILE,
-				    "invalid ihex record type %i on line %u",
-				    rcd->record_type,
-				    rcd->ln);
-			return FALSE;
+				    FWUPD_ERROR_INVALID_DATA,
+				    "file has too many lines");
+		return FALSE;
+	}
+
+	/* remove WIN32 line endings */
+	g_strdelimit(token->str, "\r\x1a", '\0');
+	token->len = strlen(token->str);
+
+	/* ignore blank lines */
+	if (token->len == 0)
+		return TRUE;
+
+	/* ignore comments */
+	if (token->str[0] == ';')
+		return TRUE;
+
+	/* decode the entire record into the stack buffer, and verify the checksum */
+	if (token->str[0] == ':' &&
+	    fu_firmware_strparse_hex_safe(token->str, token->len, 1, rec, 1, NULL)) {
+		gsize recsz = 5 + rec[0];
+		if (fu_firmware_strparse_hex_safe(token->str, token->len, 1, rec, recsz, NULL) &&
+		    ((helper->flags & FU_FIRMWARE_PARSE_FLAG_IGNORE_CHECKSUM) > 0 ||
+		     fu_sum8(rec, recsz) == 0)) {
+			guint16 rec_addr = fu_memread_uint16(rec + 1, G_BIG_ENDIAN);
+			return fu_ihex_firmware_parse_record(stream_helper->self,
+							     helper,
+							     token_idx + 1,
+							     rec[3],
+							     rec_addr,
+							     rec + 4,
+							     rec[0],
+							     error);
 		}
 	}
 
+	/* something unusual, so fall back to the slow parser for the detailed error */
+	rcd = fu_ihex_firmware_record_new(token_idx + 1, token->str, helper->flags, error);
+	if (rcd == NULL) {
+		g_prefix_error(error, "invalid line %u: ", token_idx + 1);
+		return FALSE;
+	}
+	return fu_ihex_firmware_parse_record(stream_helper->self,
+					     helper,
+					     rcd->ln,
+					     rcd->record_type,
+					     rcd->addr,
+					     rcd->data->data,
+					     rcd->data->len,
+					     error);
+}
+
+static gboolean
+fu_ihex_firmware_parse(FuFirmware *firmware,
+		       GInputStream *stream,
+		       FuFirmwareParseFlags flags,
+		       GError **error)
+{
+	FuIhexFirmware *self = FU_IHEX_FIRMWARE(firmware);
+	FuIhexFirmwarePrivate *priv = GET_PRIVATE(self);
+	g_autoptr(GBytes) img_bytes = NULL;
+	g_autoptr(GByteArray) buf = g_byte_array_new();
+	FuIhexFirmwareParseHelper helper = {
+	    .flags = flags,
+	    .buf = buf,
+	    .img_addr = G_MAXUINT32,
+	};
+
+	/* use the records if the subclass asked for them, as it may have modified them */
+	g_array_set_size(priv->regions, 0);
+	if (priv->records_valid) {
+		for (guint k = 0; k < priv->records->len; k++) {
+			FuIhexFirmwareRecord *rcd = g_ptr_array_index(priv->records, k);
+			if (!fu_ihex_firmware_parse_record(self,
+							   &helper,
+							   rcd->ln,
+							   rcd->record_type,
+							   rcd->addr,
+							   rcd->data->data,
+							   rcd->data->len,
+							   error))
+				return FALSE;
+		}
+	} else {
+		FuIhexFirmwareStreamHelper stream_helper = {.self = self, .helper = &helper};
+		if (!fu_strsplit_stream(stream,
+					0x0,
+					"\n",
+					fu_ihex_firmware_parse_stream_cb,
+					&stream_helper,
+					error))
+			return FALSE;
+	}
+
 	/* no EOF */
-	if (!got_eof) {
+	if (!helper.got_eof) {
 		g_set_error_literal(error,
 				    FWUPD_ERROR,
 				    FWUPD_ERROR_INVALID_FILE,
@@ -448,8 +683,8 @@ fu_ihex_firmware_parse(FuFirmware *firmware,
 
 	/* add single image */
 	img_bytes = g_bytes_new(buf->data, buf->len);
-	if (img_addr != G_MAXUINT32)
-		fu_firmware_set_addr(firmware, img_addr);
+	if (helper.img_addr != G_MAXUINT32)
+		fu_firmware_set_addr(firmware, helper.img_addr);
 	fu_firmware_set_bytes(firmware, img_bytes);
 	return TRUE;
 }
@@ -554,6 +789,9 @@ fu_ihex_firmware_finalize(GObject *object)
 	FuIhexFirmware *self = FU_IHEX_FIRMWARE(object);
 	FuIhexFirmwarePrivate *priv = GET_PRIVATE(self);
 	g_ptr_array_unref(priv->records);
+	g_array_unref(priv->regions);
+	if (priv->stream != NULL)
+		g_object_unref(priv->stream);
 	G_OBJECT_CLASS(fu_ihex_firmware_parent_class)->finalize(object);
 }
 
@@ -563,6 +801,7 @@ fu_ihex_firmware_init(FuIhexFirmware *self)
 	FuIhexFirmwarePrivate *priv = GET_PRIVATE(self);
 	priv->padding_value = 0x00; /* chosen as we can't write 0xffff to PIC14 */
 	priv->records = g_ptr_array_new_with_free_func((GFreeFunc)fu_ihex_firmware_record_free);
+	priv->regions = g_array_new(FALSE, FALSE, sizeof(FuIhexFirmwareRegion));
 	fu_firmware_add_flag(FU_FIRMWARE(self), FU_FIRMWARE_FLAG_HAS_CHECKSUM);
 	fu_firmware_add_image_gtype(FU_FIRMWARE(self), FU_TYPE_FIRMWARE);
 	fu_firmware_set_images_max(FU_FIRMWARE(self), 10);
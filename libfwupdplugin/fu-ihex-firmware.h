@@ -32,7 +32,11 @@ typedef struct {
 
 FuFirmware *
 fu_ihex_firmware_new(void);
+gboolean
+fu_ihex_firmware_ensure_records(FuIhexFirmware *self, GError **error) G_GNUC_NON_NULL(1);
 GPtrArray *
 fu_ihex_firmware_get_records(FuIhexFirmware *self) G_GNUC_NON_NULL(1);
+GPtrArray *
+fu_ihex_firmware_get_chunks(FuIhexFirmware *self, GError **error) G_GNUC_NON_NULL(1);
 void
 fu_ihex_firmware_set_padding_value(FuIhexFirmware *self, guint8 padding_value) G_GNUC_NON_NULL(1);
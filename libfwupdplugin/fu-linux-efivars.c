@@ -30,6 +30,7 @@
 
 struct _FuLinuxEfivars {
 	FuEfivars parent_instance;
+	GFileMonitor *monitor; /* (nullable) */
 };
 
 G_DEFINE_TYPE(FuLinuxEfivars, fu_linux_efivars, FU_TYPE_EFIVARS)
@@ -58,6 +59,45 @@ fu_linux_efivars_get_filename(FuEfivars *efivars,
 	return g_strdup_printf("%s/%s-%s", efivarsdir, name, guid);
 }
 
+static void
+fu_linux_efivars_monitor_changed_cb(GFileMonitor *monitor,
+				    GFile *file,
+				    GFile *other_file,
+				    GFileMonitorEvent event_type,
+				    gpointer user_data)
+{
+	FuEfivars *efivars = FU_EFIVARS(user_data);
+	fu_efivars_invalidate(efivars);
+}
+
+/* the snapshot in FuEfivars is only valid while we know about changes made by other processes */
+static void
+fu_linux_efivars_ensure_monitor(FuEfivars *efivars)
+{
+	FuLinuxEfivars *self = FU_LINUX_EFIVARS(efivars);
+	g_autofree gchar *path = NULL;
+	g_autoptr(GError) error_local = NULL;
+	g_autoptr(GFile) file = NULL;
+
+	if (self->monitor != NULL)
+		return;
+	path = fu_linux_efivars_get_path(efivars, &error_local);
+	if (path == NULL) {
+		g_debug("failed to get efivars path: %s", error_local->message);
+		return;
+	}
+	file = g_file_new_for_path(path);
+	self->monitor = g_file_monitor_directory(file, G_FILE_MONITOR_NONE, NULL, &error_local);
+	if (self->monitor == NULL) {
+		g_debug("failed to watch %s: %s", path, error_local->message);
+		return;
+	}
+	g_signal_connect(self->monitor,
+			 "changed",
+			 G_CALLBACK(fu_linux_efivars_monitor_changed_cb),
+			 self);
+}
+
 static gboolean
 fu_linux_efivars_supported(FuEfivars *efivars, GError **error)
 {
@@ -258,6 +298,7 @@ fu_linux_efivars_get_data(FuEfivars *efivars,
 	g_autoptr(GInputStream) istr = NULL;
 
 	/* open file as stream */
+	fu_linux_efivars_ensure_monitor(efivars);
 	fn = fu_linux_efivars_get_filename(efivars, guid, name, error);
 	if (fn == NULL)
 		return FALSE;
@@ -329,6 +370,7 @@ fu_linux_efivars_get_names(FuEfivars *efivars, const gchar *guid, GError **error
 	g_autoptr(GPtrArray) names = g_ptr_array_new_with_free_func(g_free);
 
 	/* find names with matching GUID */
+	fu_linux_efivars_ensure_monitor(efivars);
 	path = fu_linux_efivars_get_path(efivars, error);
 	if (path == NULL)
 		return NULL;
@@ -393,6 +435,7 @@ fu_linux_efivars_space_used(FuEfivars *efivars, GError **error)
 	g_autoptr(GError) error_local = NULL;
 
 	/* this is only supported in new kernels */
+	fu_linux_efivars_ensure_monitor(efivars);
 	path = fu_linux_efivars_get_path(efivars, error);
 	if (path == NULL)
 		return G_MAXUINT64;
@@ -559,10 +602,23 @@ fu_linux_efivars_init(FuLinuxEfivars *self)
 {
 }
 
+static void
+fu_linux_efivars_finalize(GObject *object)
+{
+	FuLinuxEfivars *self = FU_LINUX_EFIVARS(object);
+	if (self->monitor != NULL) {
+		g_file_monitor_cancel(self->monitor);
+		g_object_unref(self->monitor);
+	}
+	G_OBJECT_CLASS(fu_linux_efivars_parent_class)->finalize(object);
+}
+
 static void
 fu_linux_efivars_class_init(FuLinuxEfivarsClass *klass)
 {
+	GObjectClass *object_class = G_OBJECT_CLASS(klass);
 	FuEfivarsClass *efivars_class = FU_EFIVARS_CLASS(klass);
+	object_class->finalize = fu_linux_efivars_finalize;
 	efivars_class->supported = fu_linux_efivars_supported;
 	efivars_class->space_used = fu_linux_efivars_space_used;
 	efivars_class->space_free = fu_linux_efivars_space_free;
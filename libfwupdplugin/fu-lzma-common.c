@@ -8,6 +8,7 @@
 
 #include <lzma.h>
 
+#include "fu-firmware-profiler.h"
 #include "fu-lzma-common.h"
 
 /**
@@ -63,6 +64,7 @@ fu_lzma_decompress_bytes(GBytes *blob, guint64 memlimit, GError **error)
 			    rc);
 		return NULL;
 	}
+	fu_firmware_profiler_add_decompressed(g_bytes_get_size(blob), buf->len);
 	return g_bytes_new(buf->data, buf->len);
 }
 
@@ -6,9 +6,31 @@
 
 #pragma once
 
+#include "fu-composite-input-stream.h"
 #include "fu-msgpack-item.h"
 
+/* the keys of a map, only valid for the items array it was built from */
+typedef struct {
+	GHashTable *offsets;	  /* key:offset of the value from the map */
+	gconstpointer items;	  /* (not owned): only compared */
+	guint items_len;	  /* of @items when built */
+	guint idx;		  /* of the map in @items */
+	guint invalid_key_offset; /* of the first key that is not a string, or 0 */
+} FuMsgpackMapIndex;
+
+void
+fu_msgpack_item_map_index_free(FuMsgpackMapIndex *map_index);
+
 gboolean
 fu_msgpack_item_append(FuMsgpackItem *self, GByteArray *buf, GError **error) G_GNUC_NON_NULL(1, 2);
+gboolean
+fu_msgpack_item_append_stream(FuMsgpackItem *self,
+			      FuCompositeInputStream *composite,
+			      GByteArray *buf,
+			      GError **error) G_GNUC_NON_NULL(1, 2, 3);
+FuMsgpackMapIndex *
+fu_msgpack_item_get_map_index(FuMsgpackItem *self) G_GNUC_NON_NULL(1);
+void
+fu_msgpack_item_set_map_index(FuMsgpackItem *self, FuMsgpackMapIndex *map_index) G_GNUC_NON_NULL(1);
 FuMsgpackItem *
 fu_msgpack_item_parse(GByteArray *buf, gsize *offset, GError **error) G_GNUC_NON_NULL(1, 2);
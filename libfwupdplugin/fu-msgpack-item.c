@@ -12,6 +12,7 @@
 
 #include "fu-byte-array.h"
 #include "fu-common.h"
+#include "fu-composite-input-stream.h"
 #include "fu-input-stream.h"
 #include "fu-mem-private.h"
 #include "fu-msgpack-item-private.h"
@@ -20,6 +21,7 @@ struct _FuMsgpackItem {
 	GObject parent_instance;
 	FuMsgpackItemKind kind;
 	GInputStream *stream;
+	FuMsgpackMapIndex *map_index; /* (nullable) */
 	union {
 		gint64 i64;
 		gdouble f64;
@@ -469,6 +471,28 @@ fu_msgpack_item_append_string(GByteArray *buf, GString *str, GError **error)
 	return FALSE;
 }
 
+static gboolean
+fu_msgpack_item_append_binary_header(GByteArray *buf, gsize bufsz, GError **error)
+{
+	if (bufsz <= G_MAXUINT8) {
+		fu_byte_array_append_uint8(buf, FU_MSGPACK_CMD_BIN8);
+		fu_byte_array_append_uint8(buf, bufsz);
+		return TRUE;
+	}
+	if (bufsz <= G_MAXUINT16) {
+		fu_byte_array_append_uint8(buf, FU_MSGPACK_CMD_BIN16);
+		fu_byte_array_append_uint16(buf, bufsz, G_BIG_ENDIAN);
+		return TRUE;
+	}
+	if (bufsz <= G_MAXUINT32) {
+		fu_byte_array_append_uint8(buf, FU_MSGPACK_CMD_BIN32);
+		fu_byte_array_append_uint32(buf, bufsz, G_BIG_ENDIAN);
+		return TRUE;
+	}
+	g_set_error_literal(error, FWUPD_ERROR, FWUPD_ERROR_NOT_SUPPORTED, "binary too large");
+	return FALSE;
+}
+
 static gboolean
 fu_msgpack_item_append_binary_stream_chunk_cb(const guint8 *buf,
 					      gsize bufsz,
@@ -486,57 +510,21 @@ fu_msgpack_item_append_binary_stream(GByteArray *buf, GInputStream *stream, GErr
 	gsize streamsz = 0;
 	if (!fu_input_stream_size(stream, &streamsz, error))
 		return FALSE;
-	if (streamsz <= G_MAXUINT8) {
-		fu_byte_array_append_uint8(buf, FU_MSGPACK_CMD_BIN8);
-		fu_byte_array_append_uint8(buf, streamsz);
-		return fu_input_stream_chunkify(stream,
-						fu_msgpack_item_append_binary_stream_chunk_cb,
-						buf,
-						error);
-	}
-	if (streamsz <= G_MAXUINT16) {
-		fu_byte_array_append_uint8(buf, FU_MSGPACK_CMD_BIN16);
-		fu_byte_array_append_uint16(buf, streamsz, G_BIG_ENDIAN);
-		return fu_input_stream_chunkify(stream,
-						fu_msgpack_item_append_binary_stream_chunk_cb,
-						buf,
-						error);
-	}
-	if (streamsz <= G_MAXUINT32) {
-		fu_byte_array_append_uint8(buf, FU_MSGPACK_CMD_BIN32);
-		fu_byte_array_append_uint32(buf, streamsz, G_BIG_ENDIAN);
-		return fu_input_stream_chunkify(stream,
-						fu_msgpack_item_append_binary_stream_chunk_cb,
-						buf,
-						error);
-	}
-	g_set_error_literal(error, FWUPD_ERROR, FWUPD_ERROR_NOT_SUPPORTED, "binary too large");
-	return FALSE;
+	if (!fu_msgpack_item_append_binary_header(buf, streamsz, error))
+		return FALSE;
+	return fu_input_stream_chunkify(stream,
+					fu_msgpack_item_append_binary_stream_chunk_cb,
+					buf,
+					error);
 }
 
 static gboolean
 fu_msgpack_item_append_binary(GByteArray *buf, GByteArray *donor, GError **error)
 {
-	if (donor->len <= G_MAXUINT8) {
-		fu_byte_array_append_uint8(buf, FU_MSGPACK_CMD_BIN8);
-		fu_byte_array_append_uint8(buf, donor->len);
-		g_byte_array_append(buf, donor->data, donor->len);
-		return TRUE;
-	}
-	if (donor->len <= G_MAXUINT16) {
-		fu_byte_array_append_uint8(buf, FU_MSGPACK_CMD_BIN16);
-		fu_byte_array_append_uint16(buf, donor->len, G_BIG_ENDIAN);
-		g_byte_array_append(buf, donor->data, donor->len);
-		return TRUE;
-	}
-	if (donor->len <= G_MAXUINT32) {
-		fu_byte_array_append_uint8(buf, FU_MSGPACK_CMD_BIN32);
-		fu_byte_array_append_uint32(buf, donor->len, G_BIG_ENDIAN);
-		g_byte_array_append(buf, donor->data, donor->len);
-		return TRUE;
-	}
-	g_set_error_literal(error, FWUPD_ERROR, FWUPD_ERROR_NOT_SUPPORTED, "binary too large");
-	return FALSE;
+	if (!fu_msgpack_item_append_binary_header(buf, donor->len, error))
+		return FALSE;
+	g_byte_array_append(buf, donor->data, donor->len);
+	return TRUE;
 }
 
 /* private */
@@ -580,6 +568,73 @@ fu_msgpack_item_append(FuMsgpackItem *self, GByteArray *buf, GError **error)
 	return FALSE;
 }
 
+/* private */
+gboolean
+fu_msgpack_item_append_stream(FuMsgpackItem *self,
+			      FuCompositeInputStream *composite,
+			      GByteArray *buf,
+			      GError **error)
+{
+	gsize payloadsz = 0;
+	g_autoptr(GBytes) blob_header = NULL;
+	g_autoptr(GBytes) blob_payload = NULL;
+
+	g_return_val_if_fail(FU_IS_MSGPACK_ITEM(self), FALSE);
+
+	/* everything apart from the binary payload is small enough to be buffered */
+	if (self->kind != FU_MSGPACK_ITEM_KIND_BINARY)
+		return fu_msgpack_item_append(self, buf, error);
+	if (self->stream != NULL) {
+		if (!fu_input_stream_size(self->stream, &payloadsz, error))
+			return FALSE;
+	} else {
+		payloadsz = self->value.buf->len;
+	}
+	if (!fu_msgpack_item_append_binary_header(buf, payloadsz, error))
+		return FALSE;
+
+	/* flush everything buffered so far, then add the payload without copying it */
+	blob_header = g_bytes_new(buf->data, buf->len);
+	g_byte_array_set_size(buf, 0);
+	if (!fu_composite_input_stream_add_bytes(composite, blob_header, error))
+		return FALSE;
+	if (payloadsz == 0)
+		return TRUE;
+	if (self->stream != NULL)
+		return fu_composite_input_stream_add_stream(composite, self->stream, error);
+	blob_payload = g_bytes_new_with_free_func(self->value.buf->data,
+						  self->value.buf->len,
+						  (GDestroyNotify)g_byte_array_unref,
+						  g_byte_array_ref(self->value.buf));
+	return fu_composite_input_stream_add_bytes(composite, blob_payload, error);
+}
+
+/* private */
+void
+fu_msgpack_item_map_index_free(FuMsgpackMapIndex *map_index)
+{
+	g_hash_table_unref(map_index->offsets);
+	g_free(map_index);
+}
+
+/* private */
+FuMsgpackMapIndex *
+fu_msgpack_item_get_map_index(FuMsgpackItem *self)
+{
+	g_return_val_if_fail(FU_IS_MSGPACK_ITEM(self), NULL);
+	return self->map_index;
+}
+
+/* private: takes ownership of @map_index */
+void
+fu_msgpack_item_set_map_index(FuMsgpackItem *self, FuMsgpackMapIndex *map_index)
+{
+	g_return_if_fail(FU_IS_MSGPACK_ITEM(self));
+	if (self->map_index != NULL)
+		fu_msgpack_item_map_index_free(self->map_index);
+	self->map_index = map_index;
+}
+
 static GByteArray *
 fu_msgpack_item_read_binary(GByteArray *buf, gsize offset, gsize n, GError **error)
 {
@@ -839,6 +894,8 @@ fu_msgpack_item_finalize(GObject *object)
 {
 	FuMsgpackItem *self = FU_MSGPACK_ITEM(object);
 
+	if (self->map_index != NULL)
+		fu_msgpack_item_map_index_free(self->map_index);
 	if (self->stream != NULL) {
 		g_object_unref(self->stream);
 	} else {
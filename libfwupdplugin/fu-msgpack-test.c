@@ -17,6 +17,7 @@ fu_msgpack_lookup_func(void)
 	g_autoptr(FuMsgpackItem) item4 = NULL;
 	g_autoptr(FuMsgpackItem) item5 = NULL;
 	g_autoptr(FuMsgpackItem) item6 = NULL;
+	g_autoptr(FuMsgpackItem) item7 = NULL;
 	g_autoptr(GError) error = NULL;
 	g_autoptr(GPtrArray) items = g_ptr_array_new_with_free_func((GDestroyNotify)g_object_unref);
 	g_autoptr(GPtrArray) items_invalid =
@@ -56,6 +57,12 @@ fu_msgpack_lookup_func(void)
 	g_assert_no_error(error);
 	g_assert_nonnull(item4);
 
+	/* get valid again, using the cached index */
+	item7 = fu_msgpack_map_lookup(items, 1, "uint8", &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(item7);
+	g_assert_cmpint(fu_msgpack_item_get_integer(item7), ==, 256);
+
 	/* not found */
 	item5 = fu_msgpack_map_lookup(items, 1, "not-going-to-exist", &error);
 	g_assert_error(error, FWUPD_ERROR, FWUPD_ERROR_NOT_FOUND);
@@ -74,6 +81,53 @@ fu_msgpack_lookup_func(void)
 	g_clear_error(&error);
 }
 
+static void
+fu_msgpack_lookup_index_func(void)
+{
+	g_autoptr(FuMsgpackItem) item1 = NULL;
+	g_autoptr(FuMsgpackItem) item2 = NULL;
+	g_autoptr(FuMsgpackItem) item3 = NULL;
+	g_autoptr(FuMsgpackItem) item4 = NULL;
+	g_autoptr(FuMsgpackItem) item_map = fu_msgpack_item_new_map(1);
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GPtrArray) items1 =
+	    g_ptr_array_new_with_free_func((GDestroyNotify)g_object_unref);
+	g_autoptr(GPtrArray) items2 =
+	    g_ptr_array_new_with_free_func((GDestroyNotify)g_object_unref);
+	g_autoptr(GPtrArray) items3 =
+	    g_ptr_array_new_with_free_func((GDestroyNotify)g_object_unref);
+
+	/* build the index on the map item */
+	g_ptr_array_add(items1, g_object_ref(item_map));
+	g_ptr_array_add(items1, fu_msgpack_item_new_string("fixint"));
+	g_ptr_array_add(items1, fu_msgpack_item_new_integer(6));
+	item1 = fu_msgpack_map_lookup(items1, 0, "fixint", &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(item1);
+
+	/* the same map item in a different array, with a key the index does not have */
+	g_ptr_array_add(items2, g_object_ref(item_map));
+	g_ptr_array_add(items2, fu_msgpack_item_new_string("serial"));
+	g_ptr_array_add(items2, fu_msgpack_item_new_integer(12));
+	item2 = fu_msgpack_map_lookup(items2, 0, "serial", &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(item2);
+	g_assert_cmpint(fu_msgpack_item_get_integer(item2), ==, 12);
+
+	/* a key before the first key that is not a string can still be found */
+	g_ptr_array_add(items3, fu_msgpack_item_new_map(2));
+	g_ptr_array_add(items3, fu_msgpack_item_new_string("fixint"));
+	g_ptr_array_add(items3, fu_msgpack_item_new_integer(6));
+	g_ptr_array_add(items3, fu_msgpack_item_new_integer(12));
+	g_ptr_array_add(items3, fu_msgpack_item_new_integer(34));
+	item3 = fu_msgpack_map_lookup(items3, 0, "fixint", &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(item3);
+	item4 = fu_msgpack_map_lookup(items3, 0, "not-going-to-exist", &error);
+	g_assert_error(error, FWUPD_ERROR, FWUPD_ERROR_INVALID_DATA);
+	g_assert_null(item4);
+}
+
 static void
 fu_msgpack_binary_stream_func(void)
 {
@@ -100,6 +154,42 @@ fu_msgpack_binary_stream_func(void)
 	g_assert_cmpuint(buf->data[7], ==, '\0');
 }
 
+static void
+fu_msgpack_write_stream_func(void)
+{
+	const gchar data[] = "hello";
+	g_autoptr(GByteArray) buf = NULL;
+	g_autoptr(GByteArray) buf_bin = g_byte_array_new();
+	g_autoptr(GByteArray) buf_stream = NULL;
+	g_autoptr(GBytes) blob = g_bytes_new(data, sizeof(data));
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GInputStream) stream = G_INPUT_STREAM(g_memory_input_stream_new_from_bytes(blob));
+	g_autoptr(GInputStream) stream_out = NULL;
+	g_autoptr(GPtrArray) items = g_ptr_array_new_with_free_func((GDestroyNotify)g_object_unref);
+
+	fu_byte_array_set_size(buf_bin, 300, 0xAB);
+	g_ptr_array_add(items, fu_msgpack_item_new_map(3));
+	g_ptr_array_add(items, fu_msgpack_item_new_string("name"));
+	g_ptr_array_add(items, fu_msgpack_item_new_string("firmware.bin"));
+	g_ptr_array_add(items, fu_msgpack_item_new_string("header"));
+	g_ptr_array_add(items, fu_msgpack_item_new_binary(buf_bin));
+	g_ptr_array_add(items, fu_msgpack_item_new_string("file_data"));
+	g_ptr_array_add(items, fu_msgpack_item_new_binary_stream(stream));
+
+	/* streamed output is identical to the buffered output */
+	buf = fu_msgpack_write(items, &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(buf);
+	stream_out = fu_msgpack_write_stream(items, &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(stream_out);
+	buf_stream = fu_input_stream_read_byte_array(stream_out, 0x0, G_MAXSIZE, NULL, &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(buf_stream);
+	g_assert_cmpint(buf_stream->len, ==, buf->len);
+	g_assert_cmpmem(buf_stream->data, buf_stream->len, buf->data, buf->len);
+}
+
 static void
 fu_msgpack_parse_binary_func(void)
 {
@@ -201,7 +291,9 @@ main(int argc, char **argv)
 	g_test_init(&argc, &argv, NULL);
 	g_test_add_func("/fwupd/msgpack", fu_msgpack_func);
 	g_test_add_func("/fwupd/msgpack/binary-stream", fu_msgpack_binary_stream_func);
+	g_test_add_func("/fwupd/msgpack/write-stream", fu_msgpack_write_stream_func);
 	g_test_add_func("/fwupd/msgpack/parse-binary", fu_msgpack_parse_binary_func);
 	g_test_add_func("/fwupd/msgpack/lookup", fu_msgpack_lookup_func);
+	g_test_add_func("/fwupd/msgpack/lookup-index", fu_msgpack_lookup_index_func);
 	return g_test_run();
 }
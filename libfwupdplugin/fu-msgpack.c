@@ -8,6 +8,7 @@
 
 #include "config.h"
 
+#include "fu-composite-input-stream.h"
 #include "fu-msgpack-item-private.h"
 #include "fu-msgpack.h"
 
@@ -73,6 +74,77 @@ fu_msgpack_write(GPtrArray *items, GError **error)
 	return g_steal_pointer(&buf);
 }
 
+/**
+ * fu_msgpack_write_stream:
+ * @items: (element-type FuMsgpackItem): items
+ * @error: (nullable): optional return location for an error
+ *
+ * Writes messagepack items into a stream. Binary payloads are not copied, and binary stream
+ * payloads are only read when the returned stream is read.
+ *
+ * Returns: (transfer full): a #GInputStream, or %NULL on error
+ *
+ * Since: 2.1.6
+ **/
+GInputStream *
+fu_msgpack_write_stream(GPtrArray *items, GError **error)
+{
+	g_autoptr(GByteArray) buf = g_byte_array_new();
+	g_autoptr(GInputStream) composite = fu_composite_input_stream_new();
+
+	g_return_val_if_fail(items != NULL, NULL);
+	g_return_val_if_fail(error == NULL || *error == NULL, NULL);
+
+	for (guint i = 0; i < items->len; i++) {
+		FuMsgpackItem *item = g_ptr_array_index(items, i);
+		if (!fu_msgpack_item_append_stream(item,
+						   FU_COMPOSITE_INPUT_STREAM(composite),
+						   buf,
+						   error))
+			return NULL;
+	}
+	if (buf->len > 0) {
+		g_autoptr(GBytes) blob = g_bytes_new(buf->data, buf->len);
+		if (!fu_composite_input_stream_add_bytes(FU_COMPOSITE_INPUT_STREAM(composite),
+							 blob,
+							 error))
+			return NULL;
+	}
+
+	/* success */
+	return g_steal_pointer(&composite);
+}
+
+static FuMsgpackMapIndex *
+fu_msgpack_map_index_new(GPtrArray *items, guint idx, guint64 map_size)
+{
+	FuMsgpackMapIndex *map_index = g_new0(FuMsgpackMapIndex, 1);
+
+	map_index->offsets = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, NULL);
+	map_index->items = items;
+	map_index->items_len = items->len;
+	map_index->idx = idx;
+	for (guint i = idx + 1; i < idx + (map_size * 2); i += 2) {
+		FuMsgpackItem *item_key = g_ptr_array_index(items, i);
+		const gchar *key;
+
+		/* keys after this cannot be found, as when the map was searched in order */
+		if (fu_msgpack_item_get_kind(item_key) != FU_MSGPACK_ITEM_KIND_STRING) {
+			map_index->invalid_key_offset = i - idx;
+			break;
+		}
+
+		/* the first key wins */
+		key = fu_msgpack_item_get_string(item_key)->str;
+		if (g_hash_table_contains(map_index->offsets, key))
+			continue;
+		g_hash_table_insert(map_index->offsets,
+				    g_strdup(key),
+				    GUINT_TO_POINTER(i + 1 - idx));
+	}
+	return map_index;
+}
+
 /**
  * fu_msgpack_map_lookup:
  * @items: (element-type FuMsgpackItem): items
@@ -91,7 +163,9 @@ FuMsgpackItem *
 fu_msgpack_map_lookup(GPtrArray *items, guint idx, const gchar *key, GError **error)
 {
 	guint64 map_size = 0;
+	gpointer offset = NULL;
 	FuMsgpackItem *item_map;
+	FuMsgpackMapIndex *map_index;
 
 	g_return_val_if_fail(items != NULL, NULL);
 	g_return_val_if_fail(key != NULL, NULL);
@@ -127,22 +201,36 @@ fu_msgpack_map_lookup(GPtrArray *items, guint idx, const gchar *key, GError **er
 			    items->len);
 		return NULL;
 	}
-	for (guint i = idx + 1; i < idx + (map_size * 2); i += 2) {
-		FuMsgpackItem *item_key = g_ptr_array_index(items, i);
-		FuMsgpackItem *item_value = g_ptr_array_index(items, i + 1);
-		FuMsgpackItemKind kind_key = fu_msgpack_item_get_kind(item_key);
-
-		if (kind_key != FU_MSGPACK_ITEM_KIND_STRING) {
-			g_set_error(error,
-				    FWUPD_ERROR,
-				    FWUPD_ERROR_INVALID_DATA,
-				    "at index %u, key is not a string, got %s",
-				    i,
-				    fu_msgpack_item_kind_to_string(kind_key));
-			return NULL;
+
+	/* the index is built on the first lookup, and again if the map has been reused */
+	map_index = fu_msgpack_item_get_map_index(item_map);
+	if (map_index == NULL || map_index->items != (gconstpointer)items ||
+	    map_index->items_len != items->len || map_index->idx != idx) {
+		map_index = fu_msgpack_map_index_new(items, idx, map_size);
+		fu_msgpack_item_set_map_index(item_map, map_index);
+	}
+	if (g_hash_table_lookup_extended(map_index->offsets, key, NULL, &offset)) {
+		guint idx_value = idx + GPOINTER_TO_UINT(offset);
+		FuMsgpackItem *item_key = g_ptr_array_index(items, idx_value - 1);
+
+		/* an item in the array has been replaced since the index was built */
+		if (fu_msgpack_item_get_kind(item_key) != FU_MSGPACK_ITEM_KIND_STRING ||
+		    g_strcmp0(fu_msgpack_item_get_string(item_key)->str, key) != 0) {
+			fu_msgpack_item_set_map_index(item_map, NULL);
+			return fu_msgpack_map_lookup(items, idx, key, error);
 		}
-		if (g_strcmp0(fu_msgpack_item_get_string(item_key)->str, key) == 0)
-			return g_object_ref(item_value);
+		return g_object_ref(g_ptr_array_index(items, idx_value));
+	}
+	if (map_index->invalid_key_offset != 0) {
+		guint idx_key = idx + map_index->invalid_key_offset;
+		FuMsgpackItem *item_key = g_ptr_array_index(items, idx_key);
+		g_set_error(error,
+			    FWUPD_ERROR,
+			    FWUPD_ERROR_INVALID_DATA,
+			    "at index %u, key is not a string, got %s",
+			    idx_key,
+			    fu_msgpack_item_kind_to_string(fu_msgpack_item_get_kind(item_key)));
+		return NULL;
 	}
 	g_set_error(error, FWUPD_ERROR, FWUPD_ERROR_NOT_FOUND, "no key %s in map", key);
 	return NULL;
@@ -604,6 +604,10 @@ fu_pci_device_probe_complete(FuDevice *device)
 static void
 fu_pci_device_init(FuPciDevice *self)
 {
+	fu_udev_device_add_sysfs_prefetch(FU_UDEV_DEVICE(self), "revision");
+	fu_udev_device_add_sysfs_prefetch(FU_UDEV_DEVICE(self), "subsystem_vendor");
+	fu_udev_device_add_sysfs_prefetch(FU_UDEV_DEVICE(self), "subsystem_device");
+	fu_udev_device_add_sysfs_prefetch(FU_UDEV_DEVICE(self), "vbios_version");
 }
 
 static void
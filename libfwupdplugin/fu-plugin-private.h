@@ -50,6 +50,8 @@ fu_plugin_runner_startup(FuPlugin *self,
 			 FuProgress *progress,
 			 GError **error) G_GNUC_WARN_UNUSED_RESULT G_GNUC_NON_NULL(1, 2);
 gboolean
+fu_plugin_runner_can_defer_startup(FuPlugin *self) G_GNUC_NON_NULL(1);
+gboolean
 fu_plugin_runner_ready(FuPlugin *self,
 		       FuProgress *progress,
 		       GError **error) G_GNUC_WARN_UNUSED_RESULT G_GNUC_NON_NULL(1, 2);
@@ -159,6 +161,10 @@ fu_plugin_runner_reboot_cleanup(FuPlugin *self,
 				GError **error) G_GNUC_WARN_UNUSED_RESULT G_GNUC_NON_NULL(1, 2);
 void
 fu_plugin_runner_add_security_attrs(FuPlugin *self, FuSecurityAttrs *attrs) G_GNUC_NON_NULL(1, 2);
+gdouble
+fu_plugin_get_security_attrs_elapsed(FuPlugin *self) G_GNUC_NON_NULL(1);
+FuSecurityAttrsDepends
+fu_plugin_get_security_attrs_depends(FuPlugin *self) G_GNUC_NON_NULL(1);
 gboolean
 fu_plugin_runner_modify_config(FuPlugin *self, const gchar *key, const gchar *value, GError **error)
     G_GNUC_NON_NULL(1, 2, 3);
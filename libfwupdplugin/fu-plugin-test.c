@@ -198,6 +198,7 @@ fu_plugin_vfuncs_func(void)
 	gboolean ret;
 	g_autoptr(FuContext) ctx = fu_context_new();
 	g_autoptr(FuPlugin) plugin = fu_plugin_new(ctx);
+	g_autoptr(FuProgress) progress = fu_progress_new(G_STRLOC);
 	g_autoptr(GError) error = NULL;
 
 	/* nop: error */
@@ -205,6 +206,15 @@ fu_plugin_vfuncs_func(void)
 	g_assert_error(error, FWUPD_ERROR, FWUPD_ERROR_NOT_SUPPORTED);
 	g_assert_false(ret);
 	g_clear_error(&error);
+
+	/* nothing to defer, and safe to call more than once */
+	g_assert_false(fu_plugin_runner_can_defer_startup(plugin));
+	ret = fu_plugin_runner_startup(plugin, progress, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	ret = fu_plugin_runner_startup(plugin, progress, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
 }
 
 static void
@@ -397,6 +407,24 @@ fu_plugin_private_flags_func(void)
 	g_assert_false(fu_plugin_has_private_flag(plugin, "flag-a"));
 }
 
+static void
+fu_plugin_security_attrs_depends_func(void)
+{
+	g_autofree gchar *str = NULL;
+	g_autoptr(FuPlugin) plugin = fu_plugin_new(NULL);
+
+	/* recomputed on every change by default */
+	str = fu_security_attrs_depends_to_string(fu_plugin_get_security_attrs_depends(plugin));
+	g_assert_cmpstr(str, ==, "devices,metadata,kernel");
+
+	/* only computed once */
+	fu_plugin_set_security_attrs_depends(plugin, FU_SECURITY_ATTRS_DEPENDS_NONE);
+	g_assert_cmpint(fu_plugin_get_security_attrs_depends(plugin),
+			==,
+			FU_SECURITY_ATTRS_DEPENDS_NONE);
+	g_assert_cmpfloat(fu_plugin_get_security_attrs_elapsed(plugin), ==, 0);
+}
+
 int
 main(int argc, char **argv)
 {
@@ -412,5 +440,7 @@ main(int argc, char **argv)
 	g_test_add_func("/fwupd/plugin/delay", fu_plugin_delay_func);
 	g_test_add_func("/fwupd/plugin/quirks-device", fu_plugin_quirks_device_func);
 	g_test_add_func("/fwupd/plugin/private-flags", fu_plugin_private_flags_func);
+	g_test_add_func("/fwupd/plugin/security-attrs-depends",
+			fu_plugin_security_attrs_depends_func);
 	return g_test_run();
 }
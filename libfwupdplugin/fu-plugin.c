@@ -41,6 +41,7 @@ typedef struct {
 	guint order;
 	guint priority;
 	gboolean done_init;
+	gboolean done_startup;
 	GPtrArray *rules[FU_PLUGIN_RULE_LAST];
 	GPtrArray *devices; /* (nullable) (element-type FuDevice) */
 	GHashTable *runtime_versions;
@@ -55,6 +56,8 @@ typedef struct {
 	FuPluginVfuncs vfuncs;
 	GArray *private_flags_registered; /* (element-type GQuark) */
 	GArray *private_flags;		  /* (element-type GQuark) */
+	FuSecurityAttrsDepends security_attrs_depends;
+	gdouble security_attrs_elapsed; /* ms */
 } FuPluginPrivate;
 
 enum { PROP_0, PROP_CONTEXT, PROP_LAST };
@@ -65,6 +68,7 @@ enum {
 	SIGNAL_DEVICE_REGISTER,
 	SIGNAL_RULES_CHANGED,
 	SIGNAL_CHECK_SUPPORTED,
+	SIGNAL_DEVICE_RESTORE,
 	SIGNAL_LAST
 };
 
@@ -579,6 +583,15 @@ fu_plugin_add_string(FuPlugin *self, guint idt, GString *str)
 			fwupd_codec_string_append(str, idt + 1, "PrivateFlags", tmps);
 		}
 	}
+	if (priv->security_attrs_depends != FU_SECURITY_ATTRS_DEPENDS_NONE) {
+		g_autofree gchar *tmp =
+		    fu_security_attrs_depends_to_string(priv->security_attrs_depends);
+		fwupd_codec_string_append(str, idt + 1, "SecurityAttrsDepends", tmp);
+	}
+	if (priv->security_attrs_elapsed > 0) {
+		g_autofree gchar *tmp = g_strdup_printf("%.1fms", priv->security_attrs_elapsed);
+		fwupd_codec_string_append(str, idt + 1, "SecurityAttrsElapsed", tmp);
+	}
 
 	/* optional */
 	if (vfuncs->to_string != NULL)
@@ -825,6 +838,15 @@ fu_plugin_check_supported(FuPlugin *self, const gchar *guid)
 	return retval;
 }
 
+/* returns TRUE if the daemon has restored the device from a cache */
+static gboolean
+fu_plugin_device_restore(FuPlugin *self, FuDevice *device)
+{
+	gboolean retval = FALSE;
+	g_signal_emit(self, signals[SIGNAL_DEVICE_RESTORE], 0, device, &retval);
+	return retval;
+}
+
 /**
  * fu_plugin_get_context:
  * @self: a #FuPlugin
@@ -1055,6 +1077,7 @@ fu_plugin_device_read_firmware(FuPlugin *self,
 gboolean
 fu_plugin_runner_startup(FuPlugin *self, FuProgress *progress, GError **error)
 {
+	FuPluginPrivate *priv = GET_PRIVATE(self);
 	FuPluginVfuncs *vfuncs = fu_plugin_get_vfuncs(self);
 	g_autoptr(GError) error_local = NULL;
 
@@ -1070,6 +1093,10 @@ fu_plugin_runner_startup(FuPlugin *self, FuProgress *progress, GError **error)
 	if (fu_plugin_has_flag(self, FWUPD_PLUGIN_FLAG_DISABLED))
 		return TRUE;
 
+	/* already done, perhaps when the first backend device was added */
+	if (priv->done_startup)
+		return TRUE;
+
 	/* optional */
 	if (vfuncs->startup != NULL) {
 		g_debug("startup(%s)", fu_plugin_get_name(self));
@@ -1091,6 +1118,54 @@ fu_plugin_runner_startup(FuPlugin *self, FuProgress *progress, GError **error)
 		}
 	}
 
+	/* success */
+	priv->done_startup = TRUE;
+	return TRUE;
+}
+
+/**
+ * fu_plugin_runner_can_defer_startup:
+ * @self: a #FuPlugin
+ *
+ * Checks if the startup routine only needs to be run when the first backend device is added
+ * to the plugin, rather than when the daemon starts.
+ *
+ * This is only possible if the plugin can be given backend devices, has nothing to coldplug, or
+ * requires a HwId that was not matched, and also has no vfuncs that are run for every plugin.
+ *
+ * Returns: %TRUE if fu_plugin_runner_startup() can be deferred
+ *
+ * Since: 2.1.6
+ **/
+gboolean
+fu_plugin_runner_can_defer_startup(FuPlugin *self)
+{
+	FuPluginPrivate *priv = GET_PRIVATE(self);
+	FuPluginVfuncs *vfuncs = fu_plugin_get_vfuncs(self);
+
+	g_return_val_if_fail(FU_IS_PLUGIN(self), FALSE);
+
+	/* nothing to save */
+	if (vfuncs->startup == NULL)
+		return FALSE;
+
+	/* never added a backend device, so would never be started */
+	if ((priv->device_gtypes == NULL || priv->device_gtypes->len == 0) &&
+	    vfuncs->backend_device_added == NULL)
+		return FALSE;
+
+	/* will not be coldplugged */
+	if (vfuncs->coldplug != NULL && !fu_plugin_has_flag(self, FWUPD_PLUGIN_FLAG_REQUIRE_HWID))
+		return FALSE;
+
+	/* these may depend on the startup state and are run without a device from the plugin */
+	if (vfuncs->ready != NULL || vfuncs->device_registered != NULL ||
+	    vfuncs->add_security_attrs != NULL || vfuncs->prepare != NULL ||
+	    vfuncs->cleanup != NULL || vfuncs->composite_prepare != NULL ||
+	    vfuncs->composite_cleanup != NULL || vfuncs->reboot_cleanup != NULL ||
+	    vfuncs->fix_host_security_attr != NULL || vfuncs->undo_host_security_attr != NULL)
+		return FALSE;
+
 	/* success */
 	return TRUE;
 }
@@ -1622,13 +1697,76 @@ fu_plugin_runner_reboot_cleanup(FuPlugin *self, FuDevice *device, GError **error
 void
 fu_plugin_runner_add_security_attrs(FuPlugin *self, FuSecurityAttrs *attrs)
 {
+	FuPluginPrivate *priv = GET_PRIVATE(self);
 	FuPluginVfuncs *vfuncs = fu_plugin_get_vfuncs(self);
+	g_autoptr(GTimer) timer = NULL;
 
 	/* optional, but gets called even for disabled plugins */
 	if (vfuncs->add_security_attrs == NULL)
 		return;
 	g_debug("add_security_attrs(%s)", fu_plugin_get_name(self));
+	timer = g_timer_new();
 	vfuncs->add_security_attrs(self, attrs);
+	priv->security_attrs_elapsed = g_timer_elapsed(timer, NULL) * 1000.f;
+}
+
+/**
+ * fu_plugin_get_security_attrs_elapsed:
+ * @self: a #FuPlugin
+ *
+ * Gets how long the last call to fu_plugin_runner_add_security_attrs() took.
+ *
+ * Returns: time in milliseconds, or 0 if never run
+ *
+ * Since: 2.1.6
+ **/
+gdouble
+fu_plugin_get_security_attrs_elapsed(FuPlugin *self)
+{
+	FuPluginPrivate *priv = GET_PRIVATE(self);
+	g_return_val_if_fail(FU_IS_PLUGIN(self), 0);
+	return priv->security_attrs_elapsed;
+}
+
+/**
+ * fu_plugin_set_security_attrs_depends:
+ * @self: a #FuPlugin
+ * @security_attrs_depends: inputs, e.g. %FU_SECURITY_ATTRS_DEPENDS_DEVICES
+ *
+ * Sets the inputs the security attributes added by the plugin depend on, so that the daemon
+ * only calls the `add_security_attrs()` vfunc again when one of them changes.
+ *
+ * If unset, the plugin is called every time the host security attributes are invalidated.
+ * Plugins that read or modify attributes added by other plugins should not use this method.
+ *
+ * Plugins can use this method only in fu_plugin_init()
+ *
+ * Since: 2.1.6
+ **/
+void
+fu_plugin_set_security_attrs_depends(FuPlugin *self, FuSecurityAttrsDepends security_attrs_depends)
+{
+	FuPluginPrivate *priv = GET_PRIVATE(self);
+	g_return_if_fail(FU_IS_PLUGIN(self));
+	priv->security_attrs_depends = security_attrs_depends;
+}
+
+/**
+ * fu_plugin_get_security_attrs_depends:
+ * @self: a #FuPlugin
+ *
+ * Gets the inputs the security attributes added by the plugin depend on.
+ *
+ * Returns: inputs, e.g. %FU_SECURITY_ATTRS_DEPENDS_DEVICES
+ *
+ * Since: 2.1.6
+ **/
+FuSecurityAttrsDepends
+fu_plugin_get_security_attrs_depends(FuPlugin *self)
+{
+	FuPluginPrivate *priv = GET_PRIVATE(self);
+	g_return_val_if_fail(FU_IS_PLUGIN(self), FU_SECURITY_ATTRS_DEPENDS_NONE);
+	return priv->security_attrs_depends;
 }
 
 /**
@@ -1919,6 +2057,15 @@ fu_plugin_backend_device_added(FuPlugin *self,
 		return FALSE;
 	fu_progress_step_done(progress);
 
+	/* the daemon already knows everything about the device without opening it */
+	if (fu_device_get_proxy_internal(dev) == NULL && fu_plugin_device_restore(self, dev)) {
+		fu_progress_step_done(progress);
+		fu_plugin_add_device(self, dev);
+		fu_plugin_runner_device_added(self, dev);
+		fu_progress_step_done(progress);
+		return TRUE;
+	}
+
 	/* there are a lot of different devices that match, but not all respond
 	 * well to opening -- so limit some ones with issued updates */
 	if (fu_device_has_private_flag(dev, FU_DEVICE_PRIVATE_FLAG_ONLY_SUPPORTED)) {
@@ -3239,6 +3386,28 @@ fu_plugin_class_init(FuPluginClass *klass)
 			 G_TYPE_BOOLEAN,
 			 1,
 			 G_TYPE_STRING);
+	/**
+	 * FuPlugin::device-restore:
+	 * @self: the #FuPlugin instance that emitted the signal
+	 * @device: the #FuDevice
+	 *
+	 * The ::device-restore signal is emitted when a backend device has been created, and gives
+	 * the daemon the chance to restore the device from a cache rather than opening it.
+	 *
+	 * Returns: %TRUE if the device was restored
+	 *
+	 * Since: 2.1.6
+	 **/
+	signals[SIGNAL_DEVICE_RESTORE] = g_signal_new("device-restore",
+						      G_TYPE_FROM_CLASS(object_class),
+						      G_SIGNAL_RUN_LAST,
+						      0,
+						      NULL,
+						      NULL,
+						      g_cclosure_marshal_generic,
+						      G_TYPE_BOOLEAN,
+						      1,
+						      FU_TYPE_DEVICE);
 	signals[SIGNAL_RULES_CHANGED] = g_signal_new("rules-changed",
 						     G_TYPE_FROM_CLASS(object_class),
 						     G_SIGNAL_RUN_LAST,
@@ -3271,6 +3440,11 @@ fu_plugin_init(FuPlugin *self)
 	priv->device_gtype_default = G_TYPE_INVALID;
 	priv->private_flags_registered = g_array_new(FALSE, FALSE, sizeof(GQuark));
 	priv->private_flags = g_array_new(FALSE, FALSE, sizeof(GQuark));
+
+	/* unless told otherwise, recompute on every change */
+	priv->security_attrs_depends = FU_SECURITY_ATTRS_DEPENDS_DEVICES |
+				       FU_SECURITY_ATTRS_DEPENDS_METADATA |
+				       FU_SECURITY_ATTRS_DEPENDS_KERNEL;
 }
 
 static void
@@ -333,6 +333,56 @@ fu_progress_child_finished(void)
 	fu_progress_step_done(progress);
 }
 
+static void
+fu_progress_trace_func(void)
+{
+	FuProgress *child;
+	g_autoptr(FuProgress) progress = fu_progress_new(G_STRLOC);
+	g_autoptr(FwupdJsonArray) json_arr = NULL;
+	g_autoptr(FwupdJsonObject) json_args = NULL;
+	g_autoptr(FwupdJsonObject) json_event = NULL;
+	g_autoptr(FwupdJsonObject) json_obj = NULL;
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GRefString) name = NULL;
+	g_autoptr(GRefString) plugin = NULL;
+	g_autoptr(GString) json_str = NULL;
+
+	fu_progress_set_profile(progress, TRUE);
+	fu_progress_add_step(progress, FWUPD_STATUS_LOADING, 90, "load-plugins");
+	fu_progress_add_step(progress, FWUPD_STATUS_LOADING, 10, "coldplug");
+
+	child = fu_progress_get_child(progress);
+	fu_progress_set_id(child, G_STRLOC);
+	fu_progress_set_steps(child, 2);
+	fu_progress_add_trace_arg(child, "Plugin", "dfu");
+	fu_progress_step_done(child);
+	fu_progress_step_done(child);
+	fu_progress_step_done(progress);
+
+	/* the second step has not finished yet */
+	json_obj = fu_progress_to_trace(progress);
+	json_arr = fwupd_json_object_get_array(json_obj, "traceEvents", &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(json_arr);
+	g_assert_cmpint(fwupd_json_array_get_size(json_arr), ==, 5);
+	json_event = fwupd_json_array_get_object(json_arr, 1, &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(json_event);
+	name = fwupd_json_object_get_string(json_event, "name", &error);
+	g_assert_no_error(error);
+	g_assert_cmpstr(name, ==, "load-plugins");
+	json_args = fwupd_json_object_get_object(json_event, "args", &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(json_args);
+	plugin = fwupd_json_object_get_string(json_args, "Plugin", &error);
+	g_assert_no_error(error);
+	g_assert_cmpstr(plugin, ==, "dfu");
+	fu_progress_step_done(progress);
+
+	json_str = fwupd_json_object_to_string(json_obj, FWUPD_JSON_EXPORT_FLAG_INDENT);
+	g_debug("%s", json_str->str);
+}
+
 int
 main(int argc, char **argv)
 {
@@ -348,5 +398,6 @@ main(int argc, char **argv)
 	g_test_add_func("/fwupd/progress/no-equal", fu_progress_non_equal_steps_func);
 	g_test_add_func("/fwupd/progress/finish", fu_progress_finish_func);
 	g_test_add_func("/fwupd/progress/global-fraction", fu_progress_global_fraction_func);
+	g_test_add_func("/fwupd/progress/trace", fu_progress_trace_func);
 	return g_test_run();
 }
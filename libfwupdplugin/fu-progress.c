@@ -10,6 +10,7 @@
 
 #include <math.h>
 
+#include "fu-bytes.h"
 #include "fu-progress-private.h"
 #include "fu-string.h"
 
@@ -77,6 +78,10 @@ struct _FuProgress {
 	guint step_scaling;
 	FuProgress *parent; /* no-ref */
 	guint sleep_timeout_id;
+	gint64 time_start; /* monotonic µs, only set when profiling */
+	gint64 time_stop;
+	gint64 time_child;
+	GHashTable *trace_args; /* (nullable) */
 };
 
 enum { SIGNAL_PERCENTAGE_CHANGED, SIGNAL_STATUS_CHANGED, SIGNAL_LAST };
@@ -327,6 +332,14 @@ fu_progress_set_duration(FuProgress *self, gdouble duration)
 	self->duration = duration;
 }
 
+static void
+fu_progress_restart_child_timer(FuProgress *self)
+{
+	g_timer_start(self->timer_child);
+	if (self->profile)
+		self->time_child = g_get_monotonic_time();
+}
+
 static void
 fu_progress_build_parent_chain(FuProgress *self, GString *str, guint level)
 {
@@ -378,6 +391,8 @@ fu_progress_set_percentage(FuProgress *self, gdouble percentage)
 	/* done */
 	if (percentage >= 100.0) {
 		fu_progress_set_duration(self, g_timer_elapsed(self->timer, NULL));
+		if (self->profile && self->time_stop == 0)
+			self->time_stop = g_get_monotonic_time();
 		for (guint i = 0; i < self->children->len; i++) {
 			FuProgress *child = g_ptr_array_index(self->children, i);
 			g_signal_handlers_disconnect_by_data(child, self);
@@ -426,6 +441,10 @@ void
 fu_progress_set_profile(FuProgress *self, gboolean profile)
 {
 	g_return_if_fail(FU_IS_PROGRESS(self));
+	if (profile && !self->profile) {
+		self->time_start = g_get_monotonic_time();
+		self->time_child = self->time_start;
+	}
 	self->profile = profile;
 }
 
@@ -469,7 +488,9 @@ fu_progress_reset(FuProgress *self)
 	/* only use the timer if profiling; it's expensive */
 	if (self->profile) {
 		g_timer_start(self->timer);
-		g_timer_start(self->timer_child);
+		fu_progress_restart_child_timer(self);
+		self->time_start = self->time_child;
+		self->time_stop = 0;
 	}
 
 	/* no more step data */
@@ -522,7 +543,7 @@ fu_progress_set_steps(FuProgress *self, guint step_max)
 	fu_progress_add_flag(self, FU_PROGRESS_FLAG_NO_PROFILE);
 
 	/* reset child timer */
-	g_timer_start(self->timer_child);
+	fu_progress_restart_child_timer(self);
 }
 
 /**
@@ -721,7 +742,7 @@ fu_progress_add_step(FuProgress *self, FwupdStatus status, guint value, const gc
 	g_ptr_array_add(self->children, g_steal_pointer(&child));
 
 	/* reset child timer */
-	g_timer_start(self->timer_child);
+	fu_progress_restart_child_timer(self);
 
 	/* now ready */
 	self->percentage = 0.0;
@@ -902,9 +923,12 @@ fu_progress_step_done(FuProgress *self)
 
 	/* save the duration in the array */
 	if (self->profile) {
-		if (child != NULL)
+		if (child != NULL) {
 			fu_progress_set_duration(child, g_timer_elapsed(self->timer_child, NULL));
-		g_timer_start(self->timer_child);
+			child->time_start = self->time_child;
+			child->time_stop = g_get_monotonic_time();
+		}
+		fu_progress_restart_child_timer(self);
 	}
 
 	/* is already at 100%? */
@@ -1091,6 +1115,143 @@ fu_progress_traceback(FuProgress *self)
 	return g_string_free(g_steal_pointer(&str), FALSE);
 }
 
+/**
+ * fu_progress_add_trace_arg:
+ * @self: A #FuProgress
+ * @key: (not nullable): a key, e.g. `DeviceId`
+ * @value: (nullable): a value, e.g. `362301da643102b9f38477387e2193e57abaa590`
+ *
+ * Adds extra metadata to the step, which is included in the exported trace.
+ *
+ * Nothing is saved unless profiling has been enabled with fu_progress_set_profile().
+ *
+ * Since: 2.1.6
+ **/
+void
+fu_progress_add_trace_arg(FuProgress *self, const gchar *key, const gchar *value)
+{
+	g_return_if_fail(FU_IS_PROGRESS(self));
+	g_return_if_fail(key != NULL);
+
+	if (!self->profile || value == NULL)
+		return;
+	if (self->trace_args == NULL)
+		self->trace_args = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, g_free);
+	g_hash_table_insert(self->trace_args, g_strdup(key), g_strdup(value));
+}
+
+static void
+fu_progress_to_trace_cb(FuProgress *self,
+			gint64 time_start,
+			gint64 time_stop,
+			gint64 time_now,
+			FwupdJsonArray *json_arr)
+{
+	g_autoptr(FwupdJsonObject) json_obj = fwupd_json_object_new();
+	g_autoptr(FwupdJsonObject) json_args = fwupd_json_object_new();
+
+	/* a complete event */
+	fwupd_json_object_add_string(json_obj, "name", fu_progress_get_name_fallback(self));
+	fwupd_json_object_add_string(json_obj, "cat", "fwupd");
+	fwupd_json_object_add_string(json_obj, "ph", "X");
+	fwupd_json_object_add_integer(json_obj, "ts", time_start);
+	fwupd_json_object_add_integer(json_obj, "dur", time_stop - time_start);
+	fwupd_json_object_add_integer(json_obj, "pid", 1);
+	fwupd_json_object_add_integer(json_obj, "tid", 1);
+	if (self->id != NULL)
+		fwupd_json_object_add_string(json_args, "Id", self->id);
+	if (self->status != FWUPD_STATUS_UNKNOWN)
+		fwupd_json_object_add_string(json_args,
+					     "Status",
+					     fwupd_status_to_string(self->status));
+	if (self->step_weighting > 0)
+		fwupd_json_object_add_integer(json_args, "StepWeighting", self->step_weighting);
+	if (self->trace_args != NULL) {
+		GHashTableIter iter;
+		gpointer key, value;
+		g_hash_table_iter_init(&iter, self->trace_args);
+		while (g_hash_table_iter_next(&iter, &key, &value))
+			fwupd_json_object_add_string(json_args, key, value);
+	}
+	fwupd_json_object_add_object(json_obj, "args", json_args);
+	fwupd_json_array_add_object(json_arr, json_obj);
+
+	/* only the children that have started */
+	for (guint i = 0; i < self->children->len; i++) {
+		FuProgress *child = g_ptr_array_index(self->children, i);
+		if (child->time_start != 0 && child->time_stop != 0) {
+			fu_progress_to_trace_cb(child,
+						child->time_start,
+						child->time_stop,
+						time_now,
+						json_arr);
+		} else if (i == self->step_now && self->time_child != 0) {
+			fu_progress_to_trace_cb(child, self->time_child, time_now, time_now, json_arr);
+		}
+	}
+}
+
+/**
+ * fu_progress_to_trace:
+ * @self: A #FuProgress
+ *
+ * Exports the recorded step timings as a Chrome trace-event document, which can be loaded
+ * into tools such as Perfetto or `chrome://tracing` to show a flame graph.
+ *
+ * Profiling must have been enabled with fu_progress_set_profile() before any steps were added.
+ *
+ * Returns: (transfer full): a #FwupdJsonObject
+ *
+ * Since: 2.1.6
+ **/
+FwupdJsonObject *
+fu_progress_to_trace(FuProgress *self)
+{
+	gint64 time_now = g_get_monotonic_time();
+	g_autoptr(FwupdJsonObject) json_obj = fwupd_json_object_new();
+	g_autoptr(FwupdJsonArray) json_arr = fwupd_json_array_new();
+
+	g_return_val_if_fail(FU_IS_PROGRESS(self), NULL);
+
+	if (self->time_start != 0) {
+		fu_progress_to_trace_cb(self,
+					self->time_start,
+					self->time_stop != 0 ? self->time_stop : time_now,
+					time_now,
+					json_arr);
+	}
+	fwupd_json_object_add_array(json_obj, "traceEvents", json_arr);
+	fwupd_json_object_add_string(json_obj, "displayTimeUnit", "ms");
+	return g_steal_pointer(&json_obj);
+}
+
+/**
+ * fu_progress_save_trace:
+ * @self: A #FuProgress
+ * @filename: (not nullable): a filename, e.g. `/tmp/fwupd-trace.json`
+ * @error: (nullable): optional return location for an error
+ *
+ * Saves the output of fu_progress_to_trace() to a file.
+ *
+ * Returns: %TRUE for success
+ *
+ * Since: 2.1.6
+ **/
+gboolean
+fu_progress_save_trace(FuProgress *self, const gchar *filename, GError **error)
+{
+	g_autoptr(FwupdJsonObject) json_obj = NULL;
+	g_autoptr(GBytes) blob = NULL;
+
+	g_return_val_if_fail(FU_IS_PROGRESS(self), FALSE);
+	g_return_val_if_fail(filename != NULL, FALSE);
+	g_return_val_if_fail(error == NULL || *error == NULL, FALSE);
+
+	json_obj = fu_progress_to_trace(self);
+	blob = fwupd_json_object_to_bytes(json_obj, FWUPD_JSON_EXPORT_FLAG_TRAILING_NEWLINE);
+	return fu_bytes_set_contents(filename, blob, error);
+}
+
 static void
 fu_progress_add_string(FwupdCodec *codec, guint idt, GString *str)
 {
@@ -1148,6 +1309,8 @@ fu_progress_finalize(GObject *object)
 	g_free(self->id);
 	g_free(self->name);
 	g_ptr_array_unref(self->children);
+	if (self->trace_args != NULL)
+		g_hash_table_unref(self->trace_args);
 	g_timer_destroy(self->timer);
 	g_timer_destroy(self->timer_child);
 	if (self->sleep_timeout_id != 0)
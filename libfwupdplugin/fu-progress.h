@@ -69,3 +69,11 @@ void
 fu_progress_sleep_idle(FuProgress *self, guint delay_ms) G_GNUC_NON_NULL(1);
 gchar *
 fu_progress_traceback(FuProgress *self) G_GNUC_NON_NULL(1);
+void
+fu_progress_add_trace_arg(FuProgress *self, const gchar *key, const gchar *value)
+    G_GNUC_NON_NULL(1, 2);
+FwupdJsonObject *
+fu_progress_to_trace(FuProgress *self) G_GNUC_NON_NULL(1);
+gboolean
+fu_progress_save_trace(FuProgress *self, const gchar *filename, GError **error)
+    G_GNUC_NON_NULL(1, 2);
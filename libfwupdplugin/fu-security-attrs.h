@@ -8,6 +8,8 @@
 
 #include <libfwupd/fwupd-security-attr.h>
 
+#include "fu-security-attrs-struct.h"
+
 #define FU_TYPE_SECURITY_ATTRS (fu_security_attrs_get_type())
 
 G_DECLARE_FINAL_TYPE(FuSecurityAttrs, fu_security_attrs, FU, SECURITY_ATTRS, GObject)
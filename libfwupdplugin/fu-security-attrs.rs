@@ -8,3 +8,16 @@ enum FuSecurityAttrsFlags {
     // Add the daemon version to the HSI string
     AddVersion = 1 << 0,
 }
+
+// The inputs that the attributes added by a plugin depend on.
+#[derive(Bitfield, ToString)]
+enum FuSecurityAttrsDepends {
+    // Only computed once
+    None = 0,
+    // A device was added, removed or changed
+    Devices = 1 << 0,
+    // The metadata was reloaded
+    Metadata = 1 << 1,
+    // Kernel state changed, e.g. lockdown, swap or taint
+    Kernel = 1 << 2,
+}
@@ -60,6 +60,129 @@ fu_srec_firmware_tokenization_func(void)
 	g_assert_cmpint(rcd->buf->data[0], ==, 0x50);
 }
 
+static void
+fu_srec_firmware_chunks_func(void)
+{
+	FuChunk *chk;
+	gboolean ret;
+	g_autoptr(FuFirmware) firmware = fu_srec_firmware_new();
+	g_autoptr(GBytes) blob = NULL;
+	g_autoptr(GBytes) data_fw = NULL;
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GPtrArray) chunks = NULL;
+	const gchar *buf = "S0030000FC\n"
+			   "S107010001020304ED\n"
+			   "S10501040506EA\n"
+			   "S104011007E3\n"
+			   "S5030003F9\n"
+			   "S9030000FC\n";
+
+	blob = g_bytes_new_static(buf, strlen(buf));
+	ret =
+	    fu_firmware_parse_bytes(firmware, blob, 0x0, FU_FIRMWARE_PARSE_FLAG_NO_SEARCH, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	g_assert_cmpint(fu_firmware_get_addr(firmware), ==, 0x100);
+	data_fw = fu_firmware_get_bytes(firmware, &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(data_fw);
+	g_assert_cmpint(g_bytes_get_size(data_fw), ==, 17);
+
+	/* contiguous records are merged, and the padding is skipped */
+	chunks = fu_srec_firmware_get_chunks(FU_SREC_FIRMWARE(firmware), &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(chunks);
+	g_assert_cmpint(chunks->len, ==, 2);
+	chk = g_ptr_array_index(chunks, 0);
+	g_assert_cmpint(fu_chunk_get_address(chk), ==, 0x100);
+	g_assert_cmpint(fu_chunk_get_data_sz(chk), ==, 6);
+	chk = g_ptr_array_index(chunks, 1);
+	g_assert_cmpint(fu_chunk_get_address(chk), ==, 0x110);
+	g_assert_cmpint(fu_chunk_get_data_sz(chk), ==, 1);
+	g_assert_cmpint(fu_chunk_get_data(chk)[0], ==, 0x07);
+
+	/* records are still available when asked for */
+	g_assert_cmpint(fu_srec_firmware_get_records(FU_SREC_FIRMWARE(firmware))->len, ==, 6);
+}
+
+/* a subclass that edits the records before the image is built */
+#define FU_TYPE_SREC_FIRMWARE_EDIT (fu_srec_firmware_edit_get_type())
+G_DECLARE_FINAL_TYPE(FuSrecFirmwareEdit,
+		     fu_srec_firmware_edit,
+		     FU,
+		     SREC_FIRMWARE_EDIT,
+		     FuSrecFirmware)
+
+struct _FuSrecFirmwareEdit {
+	FuSrecFirmware parent_instance;
+};
+
+G_DEFINE_TYPE(FuSrecFirmwareEdit, fu_srec_firmware_edit, FU_TYPE_SREC_FIRMWARE)
+
+static gboolean
+fu_srec_firmware_edit_parse(FuFirmware *firmware,
+			    GInputStream *stream,
+			    FuFirmwareParseFlags flags,
+			    GError **error)
+{
+	FuFirmwareClass *klass = FU_FIRMWARE_CLASS(fu_srec_firmware_edit_parent_class);
+	FuSrecFirmwareRecord *rcd;
+	GPtrArray *records;
+
+	if (!fu_srec_firmware_ensure_records(FU_SREC_FIRMWARE(firmware), error))
+		return FALSE;
+	records = fu_srec_firmware_get_records(FU_SREC_FIRMWARE(firmware));
+	rcd = g_ptr_array_index(records, 1);
+	rcd->buf->data[0] = 0xFF;
+	return klass->parse(firmware, stream, flags, error);
+}
+
+static void
+fu_srec_firmware_edit_init(FuSrecFirmwareEdit *self)
+{
+}
+
+static void
+fu_srec_firmware_edit_class_init(FuSrecFirmwareEditClass *klass)
+{
+	FuFirmwareClass *firmware_class = FU_FIRMWARE_CLASS(klass);
+	firmware_class->parse = fu_srec_firmware_edit_parse;
+}
+
+static void
+fu_srec_firmware_records_edit_func(void)
+{
+	gboolean ret;
+	g_autoptr(FuFirmware) firmware = g_object_new(FU_TYPE_SREC_FIRMWARE_EDIT, NULL);
+	g_autoptr(GBytes) blob = NULL;
+	g_autoptr(GBytes) data_fw = NULL;
+	g_autoptr(GError) error = NULL;
+	const gchar *buf = "S0030000FC\n"
+			   "S107010001020304ED\n"
+			   "S5030001FB\n"
+			   "S9030000FC\n";
+
+	blob = g_bytes_new_static(buf, strlen(buf));
+	ret =
+	    fu_firmware_parse_bytes(firmware, blob, 0x0, FU_FIRMWARE_PARSE_FLAG_NO_SEARCH, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+
+	/* the image was built from the edited records, not from the stream */
+	data_fw = fu_firmware_get_bytes(firmware, &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(data_fw);
+	g_assert_cmpint(g_bytes_get_size(data_fw), ==, 4);
+	g_assert_cmpint(((const guint8 *)g_bytes_get_data(data_fw, NULL))[0], ==, 0xFF);
+	g_assert_cmpint(((const guint8 *)g_bytes_get_data(data_fw, NULL))[1], ==, 0x02);
+
+	/* the records are kept */
+	ret = fu_srec_firmware_ensure_records(FU_SREC_FIRMWARE(firmware), &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	g_assert_cmpint(fu_srec_firmware_get_records(FU_SREC_FIRMWARE(firmware))->len, ==, 4);
+}
+
 int
 main(int argc, char **argv)
 {
@@ -68,5 +191,7 @@ main(int argc, char **argv)
 	g_type_ensure(FU_TYPE_SREC_FIRMWARE);
 	g_test_add_func("/fwupd/srec-firmware", fu_srec_firmware_func);
 	g_test_add_func("/fwupd/srec-firmware/tokenization", fu_srec_firmware_tokenization_func);
+	g_test_add_func("/fwupd/srec-firmware/chunks", fu_srec_firmware_chunks_func);
+	g_test_add_func("/fwupd/srec-firmware/records-edit", fu_srec_firmware_records_edit_func);
 	return g_test_run();
 }
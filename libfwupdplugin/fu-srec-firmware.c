@@ -11,9 +11,11 @@
 #include <string.h>
 
 #include "fu-byte-array.h"
+#include "fu-bytes.h"
 #include "fu-chunk-array.h"
 #include "fu-common.h"
 #include "fu-firmware-common.h"
+#include "fu-mem.h"
 #include "fu-srec-firmware.h"
 #include "fu-string.h"
 #include "fu-sum.h"
@@ -26,8 +28,19 @@
  * See also: [class@FuFirmware]
  */
 
+/* a contiguous range of data records, as found in the image */
+typedef struct {
+	guint32 addr;
+	gsize offset;
+	gsize size;
+} FuSrecFirmwareRegion;
+
 typedef struct {
 	GPtrArray *records;
+	gboolean records_valid;
+	GInputStream *stream;
+	FuFirmwareParseFlags flags;
+	GArray *regions; /* of FuSrecFirmwareRegion */
 	guint32 addr_min;
 	guint32 addr_max;
 } FuSrecFirmwarePrivate;
@@ -46,7 +59,12 @@ G_DEFINE_TYPE_WITH_PRIVATE(FuSrecFirmware, fu_srec_firmware, FU_TYPE_FIRMWARE)
  * This might be useful if the plugin is expecting the SREC file to be a list
  * of operations, rather than a simple linear image with filled holes.
  *
- * Returns: (transfer none) (element-type FuSrecFirmwareRecord): records
+ * The records are only created when they are first needed, as parsing the image does
+ * not use them. Call fu_srec_firmware_ensure_records() first to get the error if they
+ * cannot be created.
+ *
+ * Returns: (transfer none) (element-type FuSrecFirmwareRecord) (nullable): records, or
+ * %NULL if they could not be created
  *
  * Since: 1.3.2
  **/
@@ -55,9 +73,54 @@ fu_srec_firmware_get_records(FuSrecFirmware *self)
 {
 	FuSrecFirmwarePrivate *priv = GET_PRIVATE(self);
 	g_return_val_if_fail(FU_IS_SREC_FIRMWARE(self), NULL);
+	if (!fu_srec_firmware_ensure_records(self, NULL))
+		return NULL;
 	return priv->records;
 }
 
+/**
+ * fu_srec_firmware_get_chunks:
+ * @self: A #FuSrecFirmware
+ * @error: (nullable): optional return location for an error
+ *
+ * Returns the address ranges that were defined by data records in the parsed file,
+ * without any of the padding used to fill the holes between them.
+ *
+ * Returns: (transfer container) (element-type FuChunk): chunks, or %NULL on error
+ *
+ * Since: 2.1.6
+ **/
+GPtrArray *
+fu_srec_firmware_get_chunks(FuSrecFirmware *self, GError **error)
+{
+	FuSrecFirmwarePrivate *priv = GET_PRIVATE(self);
+	g_autoptr(GBytes) blob = NULL;
+	g_autoptr(GPtrArray) chunks =
+	    g_ptr_array_new_with_free_func((GDestroyNotify)g_object_unref);
+
+	g_return_val_if_fail(FU_IS_SREC_FIRMWARE(self), NULL);
+	g_return_val_if_fail(error == NULL || *error == NULL, NULL);
+
+	blob = fu_firmware_get_bytes(FU_FIRMWARE(self), error);
+	if (blob == NULL)
+		return NULL;
+	for (guint i = 0; i < priv->regions->len; i++) {
+		FuSrecFirmwareRegion *region =
+		    &g_array_index(priv->regions, FuSrecFirmwareRegion, i);
+		g_autoptr(FuChunk) chk = NULL;
+		g_autoptr(GBytes) blob_chk = NULL;
+
+		blob_chk = fu_bytes_new_offset(blob, region->offset, region->size, error);
+		if (blob_chk == NULL)
+			return NULL;
+		chk = fu_chunk_bytes_new(blob_chk);
+		fu_chunk_set_idx(chk, i);
+		fu_chunk_set_address(chk, region->addr);
+		g_ptr_array_add(chunks, g_steal_pointer(&chk));
+	}
+	return g_steal_pointer(&chunks);
+}
+
 /**
  * fu_srec_firmware_set_addr_min:
  * @self: A #FuSrecFirmware
@@ -159,18 +222,63 @@ fu_srec_firmware_record_get_type(void)
 	return type_id;
 }
 
-typedef struct {
-	FuSrecFirmware *self;
-	FuFirmwareParseFlags flags;
-	gboolean got_eof;
-} FuSrecFirmwareTokenHelper;
-
+/* returns FALSE if the record kind is invalid */
 static gboolean
-fu_srec_firmware_tokenize_cb(GString *token, guint token_idx, gpointer user_data, GError **error)
+fu_srec_firmware_record_kind_info(guint8 rec_kind,
+				  guint8 *addrsz,
+				  gboolean *require_data,
+				  gboolean *is_eof)
+{
+	*require_data = FALSE;
+	*is_eof = FALSE;
+	switch (rec_kind) {
+	case FU_FIRMWARE_SREC_RECORD_KIND_S0_HEADER:
+	case FU_FIRMWARE_SREC_RECORD_KIND_S1_DATA_16:
+		*addrsz = 2;
+		*require_data = TRUE;
+		break;
+	case FU_FIRMWARE_SREC_RECORD_KIND_S2_DATA_24:
+		*addrsz = 3;
+		*require_data = TRUE;
+		break;
+	case FU_FIRMWARE_SREC_RECORD_KIND_S3_DATA_32:
+		*addrsz = 4;
+		*require_data = TRUE;
+		break;
+	case FU_FIRMWARE_SREC_RECORD_KIND_S5_COUNT_16:
+		*addrsz = 2;
+		*is_eof = TRUE;
+		break;
+	case FU_FIRMWARE_SREC_RECORD_KIND_S6_COUNT_24:
+		*addrsz = 3;
+		break;
+	case FU_FIRMWARE_SREC_RECORD_KIND_S7_COUNT_32:
+		*addrsz = 4;
+		*is_eof = TRUE;
+		break;
+	case FU_FIRMWARE_SREC_RECORD_KIND_S8_TERMINATION_24:
+		*addrsz = 3;
+		*is_eof = TRUE;
+		break;
+	case FU_FIRMWARE_SREC_RECORD_KIND_S9_TERMINATION_16:
+		*addrsz = 2;
+		*is_eof = TRUE;
+		break;
+	default:
+		return FALSE;
+	}
+	return TRUE;
+}
+
+static FuSrecFirmwareRecord *
+fu_srec_firmware_record_parse(GString *token,
+			      guint token_idx,
+			      FuFirmwareParseFlags flags,
+			      gboolean *got_eof,
+			      GError **error)
 {
-	FuSrecFirmwareTokenHelper *helper = (FuSrecFirmwareTokenHelper *)user_data;
-	FuSrecFirmwarePrivate *priv = GET_PRIVATE(helper->self);
 	g_autoptr(FuSrecFirmwareRecord) rcd = NULL;
+	gboolean is_eof = FALSE;
 	gboolean require_data = FALSE;
 	guint32 rec_addr32;
 	guint16 rec_addr16;
@@ -178,23 +286,6 @@ fu_srec_firmware_tokenize_cb(GString *token, guint token_idx, gpointer user_data
 	guint8 rec_count;  /* words */
 	guint8 rec_kind;
 
-	/* sanity check */
-	if (token_idx > FU_SREC_FIRMWARE_TOKENS_MAX) {
-		g_set_error_literal(error,
-				    FWUPD_ERROR,
-				    FWUPD_ERROR_INVALID_DATA,
-				    "file has too many lines");
-		return FALSE;
-	}
-
-	/* remove WIN32 line endings */
-	g_strdelimit(token->str, "\r\x1a", '\0');
-	token->len = strlen(token->str);
-
-	/* ignore blank lines */
-	if (token->len == 0)
-		return TRUE;
-
 	/* check starting token */
 	if (token->str[0] != 'S' || token->len < 3) {
 		g_autofree gchar *strsafe = fu_strsafe(token->str, 3);
@@ -205,20 +296,20 @@ fu_srec_firmware_tokenize_cb(GString *token, guint token_idx, gpointer user_data
 				    "invalid starting token, got '%s' at line %u",
 				    strsafe,
 				    token_idx + 1);
-			return FALSE;
+			return NULL;
 		}
 		g_set_error(error,
 			    FWUPD_ERROR,
 			    FWUPD_ERROR_INVALID_FILE,
 			    "invalid starting token at line %u",
 			    token_idx + 1);
-		return FALSE;
+		return NULL;
 	}
 
 	/* kind, count, address, (data), checksum, linefeed */
 	rec_kind = token->str[1] - '0';
 	if (!fu_firmware_strparse_uint8_safe(token->str, token->len, 2, &rec_count, error))
-		return FALSE;
+		return NULL;
 	if (rec_count * 2 != token->len - 4) {
 		g_set_error(error,
 			    FWUPD_ERROR,
@@ -228,11 +319,11 @@ fu_srec_firmware_tokenize_cb(GString *token, guint token_idx, gpointer user_data
 			    token_idx + 1,
 			    (guint)token->len - 4,
 			    (guint)rec_count * 2);
-		return FALSE;
+		return NULL;
 	}
 
 	/* checksum check */
-	if ((helper->flags & FU_FIRMWARE_PARSE_FLAG_IGNORE_CHECKSUM) == 0) {
+	if ((flags & FU_FIRMWARE_PARSE_FLAG_IGNORE_CHECKSUM) == 0) {
 		guint8 rec_csum = 0;
 		guint8 rec_csum_expected;
 		for (guint8 i = 0; i < rec_count; i++) {
@@ -242,7 +333,7 @@ fu_srec_firmware_tokenize_cb(GString *token, guint token_idx, gpointer user_data
 							     (i * 2) + 2,
 							     &csum_tmp,
 							     error))
-				return FALSE;
+				return NULL;
 			rec_csum += csum_tmp;
 		}
 		rec_csum ^= 0xff;
@@ -251,7 +342,7 @@ fu_srec_firmware_tokenize_cb(GString *token, guint token_idx, gpointer user_data
 						     (rec_count * 2) + 2,
 						     &rec_csum_expected,
 						     error))
-			return FALSE;
+			return NULL;
 		if (rec_csum != rec_csum_expected) {
 			g_set_error(error,
 				    FWUPD_ERROR,
@@ -261,53 +352,22 @@ fu_srec_firmware_tokenize_cb(GString *token, guint token_idx, gpointer user_data
 				    token_idx + 1,
 				    rec_csum_expected,
 				    rec_csum);
-			return FALSE;
+			return NULL;
 		}
 	}
 
 	/* set each command settings */
-	switch (rec_kind) {
-	case FU_FIRMWARE_SREC_RECORD_KIND_S0_HEADER:
-	case FU_FIRMWARE_SREC_RECORD_KIND_S1_DATA_16:
-		addrsz = 2;
-		require_data = TRUE;
-		break;
-	case FU_FIRMWARE_SREC_RECORD_KIND_S2_DATA_24:
-		addrsz = 3;
-		require_data = TRUE;
-		break;
-	case FU_FIRMWARE_SREC_RECORD_KIND_S3_DATA_32:
-		addrsz = 4;
-		require_data = TRUE;
-		break;
-	case FU_FIRMWARE_SREC_RECORD_KIND_S5_COUNT_16:
-		addrsz = 2;
-		helper->got_eof = TRUE;
-		break;
-	case FU_FIRMWARE_SREC_RECORD_KIND_S6_COUNT_24:
-		addrsz = 3;
-		break;
-	case FU_FIRMWARE_SREC_RECORD_KIND_S7_COUNT_32:
-		addrsz = 4;
-		helper->got_eof = TRUE;
-		break;
-	case FU_FIRMWARE_SREC_RECORD_KIND_S8_TERMINATION_24:
-		addrsz = 3;
-		helper->got_eof = TRUE;
-		break;
-	case FU_FIRMWARE_SREC_RECORD_KIND_S9_TERMINATION_16:
-		addrsz = 2;
-		helper->got_eof = TRUE;
-		break;
-	default:
+	if (!fu_srec_firmware_record_kind_info(rec_kind, &addrsz, &require_data, &is_eof)) {
 		g_set_error(error,
 			    FWUPD_ERROR,
 			    FWUPD_ERROR_INVALID_FILE,
 			    "invalid srec record type S%c at line %u",
 			    token->str[1],
 			    token_idx + 1);
-		return FALSE;
+		return NULL;
 	}
+	if (is_eof)
+		*got_eof = TRUE;
 
 	/* parse address */
 	switch (addrsz) {
@@ -317,7 +377,7 @@ fu_srec_firmware_tokenize_cb(GString *token, guint token_idx, gpointer user_data
 						      4,
 						      &rec_addr16,
 						      error))
-			return FALSE;
+			return NULL;
 		rec_addr32 = rec_addr16;
 		break;
 	case 3:
@@ -326,7 +386,7 @@ fu_srec_firmware_tokenize_cb(GString *token, guint token_idx, gpointer user_data
 						      4,
 						      &rec_addr32,
 						      error))
-			return FALSE;
+			return NULL;
 		break;
 	case 4:
 		if (!fu_firmware_strparse_uint32_safe(token->str,
@@ -334,7 +394,7 @@ fu_srec_firmware_tokenize_cb(GString *token, guint token_idx, gpointer user_data
 						      4,
 						      &rec_addr32,
 						      error))
-			return FALSE;
+			return NULL;
 		break;
 	default:
 		g_assert_not_reached();
@@ -350,7 +410,7 @@ fu_srec_firmware_tokenize_cb(GString *token, guint token_idx, gpointer user_data
 			    FWUPD_ERROR_INVALID_FILE,
 			    "S%u required data but not provided",
 			    rec_kind);
-		return FALSE;
+		return NULL;
 	}
 
 	/* data */
@@ -363,183 +423,436 @@ fu_srec_firmware_tokenize_cb(GString *token, guint token_idx, gpointer user_data
 							     i,
 							     &tmp,
 							     error))
-				return FALSE;
+				return NULL;
 			fu_byte_array_append_uint8(rcd->buf, tmp);
 		}
 	}
-	g_ptr_array_add(priv->records, g_steal_pointer(&rcd));
-	return TRUE;
+	return g_steal_pointer(&rcd);
 }
 
+typedef struct {
+	FuSrecFirmware *self;
+	FuFirmwareParseFlags flags;
+	gboolean got_eof;
+} FuSrecFirmwareTokenHelper;
+
 static gboolean
-fu_srec_firmware_tokenize(FuFirmware *firmware,
-			  GInputStream *stream,
-			  FuFirmwareParseFlags flags,
-			  GError **error)
+fu_srec_firmware_tokenize_cb(GString *token, guint token_idx, gpointer user_data, GError **error)
 {
-	FuSrecFirmware *self = FU_SREC_FIRMWARE(firmware);
-	FuSrecFirmwareTokenHelper helper = {.self = self, .flags = flags, .got_eof = FALSE};
+	FuSrecFirmwareTokenHelper *helper = (FuSrecFirmwareTokenHelper *)user_data;
+	FuSrecFirmwarePrivate *priv = GET_PRIVATE(helper->self);
+	FuSrecFirmwareRecord *rcd;
+
+	/* sanity check */
+	if (token_idx > FU_SREC_FIRMWARE_TOKENS_MAX) {
+		g_set_error_literal(error,
+				    FWUPD_ERROR,
+				    FWUPD_ERROR_INVALID_DATA,
+				    "file has too many lines");
+		return FALSE;
+	}
+
+	/* remove WIN32 line endings */
+	g_strdelimit(token->str, "\r\x1a", '\0');
+	token->len = strlen(token->str);
 
-	/* parse records */
-	if (!fu_strsplit_stream(stream, 0x0, "\n", fu_srec_firmware_tokenize_cb, &helper, error))
+	/* ignore blank lines */
+	if (token->len == 0)
+		return TRUE;
+
+	rcd = fu_srec_firmware_record_parse(token,
+					    token_idx,
+					    helper->flags,
+					    &helper->got_eof,
+					    error);
+	if (rcd == NULL)
 		return FALSE;
+	g_ptr_array_add(priv->records, rcd);
+	return TRUE;
+}
+
+/**
+ * fu_srec_firmware_ensure_records:
+ * @self: A #FuSrecFirmware
+ * @error: (nullable): optional return location for an error
+ *
+ * Creates the records from the parsed stream, if not already done. The stream is
+ * released once the records have been created.
+ *
+ * Returns: %TRUE for success
+ *
+ * Since: 2.1.6
+ **/
+gboolean
+fu_srec_firmware_ensure_records(FuSrecFirmware *self, GError **error)
+{
+	FuSrecFirmwarePrivate *priv = GET_PRIVATE(self);
+	FuSrecFirmwareTokenHelper helper = {.self = self, .flags = priv->flags, .got_eof = FALSE};
+
+	g_return_val_if_fail(FU_IS_SREC_FIRMWARE(self), FALSE);
+	g_return_val_if_fail(error == NULL || *error == NULL, FALSE);
+
+	/* already done, or nothing to tokenize */
+	if (priv->records_valid || priv->stream == NULL)
+		return TRUE;
+	if (!fu_strsplit_stream(priv->stream,
+				0x0,
+				"\n",
+				fu_srec_firmware_tokenize_cb,
+				&helper,
+				error)) {
+		g_ptr_array_set_size(priv->records, 0);
+		return FALSE;
+	}
 
 	/* no EOF */
 	if (!helper.got_eof) {
+		g_ptr_array_set_size(priv->records, 0);
 		g_set_error_literal(error,
 				    FWUPD_ERROR,
 				    FWUPD_ERROR_INVALID_FILE,
 				    "no EOF, perhaps truncated file");
 		return FALSE;
 	}
+
+	/* the stream is not needed again */
+	priv->records_valid = TRUE;
+	g_clear_object(&priv->stream);
 	return TRUE;
 }
 
 static gboolean
-fu_srec_firmware_parse(FuFirmware *firmware,
-		       GInputStream *stream,
-		       FuFirmwareParseFlags flags,
-		       GError **error)
+fu_srec_firmware_tokenize(FuFirmware *firmware,
+			  GInputStream *stream,
+			  FuFirmwareParseFlags flags,
+			  GError **error)
 {
 	FuSrecFirmware *self = FU_SREC_FIRMWARE(firmware);
 	FuSrecFirmwarePrivate *priv = GET_PRIVATE(self);
-	gboolean got_hdr = FALSE;
-	guint16 data_cnt = 0;
-	guint32 addr32_last = 0;
-	guint32 img_address = 0;
-	g_autoptr(GBytes) img_bytes = NULL;
-	g_autoptr(GByteArray) outbuf = g_byte_array_new();
 
-	/* parse records */
-	for (guint j = 0; j < priv->records->len; j++) {
-		FuSrecFirmwareRecord *rcd = g_ptr_array_index(priv->records, j);
+	/* records are created on demand as ->parse() decodes the stream directly */
+	g_set_object(&priv->stream, stream);
+	g_ptr_array_set_size(priv->records, 0);
+	priv->records_valid = FALSE;
+	priv->flags = flags;
+	if (!fu_firmware_has_flag(firmware, FU_FIRMWARE_FLAG_DONE_PARSE))
+		return fu_srec_firmware_ensure_records(self, error);
+	return TRUE;
+}
+
+typedef struct {
+	FuSrecFirmware *self;
+	FuFirmwareParseFlags flags;
+	GByteArray *outbuf;
+	gboolean got_eof;
+	gboolean got_hdr;
+	guint16 data_cnt;
+	guint32 addr32_last;
+	guint32 img_address;
+} FuSrecFirmwareParseHelper;
+
+static void
+fu_srec_firmware_add_region(FuSrecFirmware *self, guint32 addr, gsize offset, gsize size)
+{
+	FuSrecFirmwarePrivate *priv = GET_PRIVATE(self);
+	FuSrecFirmwareRegion region = {.addr = addr, .offset = offset, .size = size};
+
+	/* extend the last region if contiguous */
+	if (priv->regions->len > 0) {
+		FuSrecFirmwareRegion *last =
+		    &g_array_index(priv->regions, FuSrecFirmwareRegion, priv->regions->len - 1);
+		if (last->addr + last->size == addr && last->offset + last->size == offset) {
+			last->size += size;
+			return;
+		}
+	}
+	g_array_append_val(priv->regions, region);
+}
 
-		/* header */
-		if (rcd->kind == FU_FIRMWARE_SREC_RECORD_KIND_S0_HEADER) {
-			g_autoptr(GString) modname = g_string_new(NULL);
+static gboolean
+fu_srec_firmware_parse_record(FuSrecFirmwareParseHelper *helper,
+			      guint ln,
+			      FuFirmwareSrecRecordKind kind,
+			      guint32 rec_addr,
+			      const guint8 *data,
+			      gsize datasz,
+			      GError **error)
+{
+	FuSrecFirmwarePrivate *priv = GET_PRIVATE(helper->self);
 
-			/* check for duplicate */
-			if (got_hdr) {
-				g_set_error(error,
-					    FWUPD_ERROR,
-					    FWUPD_ERROR_INVALID_FILE,
-					    "duplicate header record at line %u",
-					    rcd->ln);
-				return FALSE;
-			}
+	/* header */
+	if (kind == FU_FIRMWARE_SREC_RECORD_KIND_S0_HEADER) {
+		g_autoptr(GString) modname = g_string_new(NULL);
 
-			/* could be anything, lets assume text */
-			for (guint i = 0; i < rcd->buf->len; i++) {
-				gchar tmp = rcd->buf->data[i];
-				if (!g_ascii_isgraph(tmp))
-					break;
-				g_string_append_c(modname, tmp);
-			}
-			if (modname->len != 0)
-				fu_firmware_set_id(firmware, modname->str);
-			got_hdr = TRUE;
-			continue;
+		/* check for duplicate */
+		if (helper->got_hdr) {
+			g_set_error(error,
+				    FWUPD_ERROR,
+				    FWUPD_ERROR_INVALID_FILE,
+				    "duplicate header record at line %u",
+				    ln);
+			return FALSE;
+		}
+
+		/* could be anything, lets assume text */
+		for (gsize i = 0; i < datasz; i++) {
+			gchar tmp = data[i];
+			if (!g_ascii_isgraph(tmp))
+				break;
+			g_string_append_c(modname, tmp);
+		}
+		if (modname->len != 0)
+			fu_firmware_set_id(FU_FIRMWARE(helper->self), modname->str);
+		helper->got_hdr = TRUE;
+		return TRUE;
+	}
+
+	/* verify we got all records */
+	if (kind == FU_FIRMWARE_SREC_RECORD_KIND_S5_COUNT_16) {
+		if (rec_addr != helper->data_cnt) {
+			g_set_error(error,
+				    FWUPD_ERROR,
+				    FWUPD_ERROR_INVALID_FILE,
+				    "count record was not valid, got 0x%02x expected "
+				    "0x%02x at line %u",
+				    (guint)rec_addr,
+				    (guint)helper->data_cnt,
+				    ln);
+			return FALSE;
+		}
+		return TRUE;
+	}
+
+	/* data */
+	if (kind == FU_FIRMWARE_SREC_RECORD_KIND_S1_DATA_16 ||
+	    kind == FU_FIRMWARE_SREC_RECORD_KIND_S2_DATA_24 ||
+	    kind == FU_FIRMWARE_SREC_RECORD_KIND_S3_DATA_32) {
+		/* invalid */
+		if (!helper->got_hdr) {
+			g_set_error(error,
+				    FWUPD_ERROR,
+				    FWUPD_ERROR_INVALID_FILE,
+				    "missing header record at line %u",
+				    ln);
+			return FALSE;
 		}
 
-		/* verify we got all records */
-		if (rcd->kind == FU_FIRMWARE_SREC_RECORD_KIND_S5_COUNT_16) {
-			if (rcd->addr != data_cnt) {
+		/* does not make sense */
+		if (rec_addr < helper->addr32_last) {
+			g_set_error(error,
+				    FWUPD_ERROR,
+				    FWUPD_ERROR_INVALID_FILE,
+				    "invalid address 0x%x, last was 0x%x at line %u",
+				    (guint)rec_addr,
+				    (guint)helper->addr32_last,
+				    ln);
+			return FALSE;
+		}
+		if (rec_addr < priv->addr_min) {
+			g_debug("ignoring data at 0x%x as before start address 0x%x at line %u",
+				(guint)rec_addr,
+				priv->addr_min,
+				ln);
+		} else if (priv->addr_max > 0 && rec_addr > priv->addr_max) {
+			g_debug("ignoring data at 0x%x as after end address 0x%x at line %u",
+				(guint)rec_addr,
+				priv->addr_max,
+				ln);
+		} else {
+			guint32 len_hole = rec_addr - helper->addr32_last;
+
+			/* fill any holes, but only up to 1Mb to avoid a DoS */
+			if (helper->addr32_last > 0 && len_hole > 1 * FU_MB) {
 				g_set_error(error,
 					    FWUPD_ERROR,
 					    FWUPD_ERROR_INVALID_FILE,
-					    "count record was not valid, got 0x%02x expected "
-					    "0x%02x at line %u",
-					    (guint)rcd->addr,
-					    (guint)data_cnt,
-					    rcd->ln);
+					    "hole of 0x%x bytes too large to fill at line %u",
+					    (guint)len_hole,
+					    ln);
 				return FALSE;
 			}
-			continue;
-		}
+			if (helper->addr32_last > 0x0 && len_hole > 1) {
+				g_debug("filling address 0x%08x to 0x%08x at line %u",
+					helper->addr32_last + 1,
+					helper->addr32_last + len_hole - 1,
+					ln);
+				fu_byte_array_set_size(helper->outbuf,
+						       helper->outbuf->len + len_hole,
+						       0xff);
+			}
 
-		/* data */
-		if (rcd->kind == FU_FIRMWARE_SREC_RECORD_KIND_S1_DATA_16 ||
-		    rcd->kind == FU_FIRMWARE_SREC_RECORD_KIND_S2_DATA_24 ||
-		    rcd->kind == FU_FIRMWARE_SREC_RECORD_KIND_S3_DATA_32) {
-			/* invalid */
-			if (!got_hdr) {
+			/* add data */
+			fu_srec_firmware_add_region(helper->self,
+						    rec_addr,
+						    helper->outbuf->len,
+						    datasz);
+			g_byte_array_append(helper->outbuf, data, datasz);
+			if (helper->img_address == 0x0)
+				helper->img_address = rec_addr;
+			helper->addr32_last = rec_addr + datasz;
+			if (helper->addr32_last < rec_addr) {
 				g_set_error(error,
 					    FWUPD_ERROR,
 					    FWUPD_ERROR_INVALID_FILE,
-					    "missing header record at line %u",
-					    rcd->ln);
+					    "overflow from address 0x%x at line %u",
+					    (guint)rec_addr,
+					    ln);
 				return FALSE;
 			}
+		}
+		helper->data_cnt++;
+	}
 
-			/* does not make sense */
-			if (rcd->addr < addr32_last) {
-				g_set_error(error,
+	/* success */
+	return TRUE;
+}
+
+static gboolean
+fu_srec_firmware_parse_stream_cb(GString *token,
+				 guint token_idx,
+				 gpointer user_data,
+				 GError **error)
+{
+	FuSrecFirmwareParseHelper *helper = (FuSrecFirmwareParseHelper *)user_data;
+	guint8 rec[1 + G_MAXUINT8] = {0x0}; /* count, addr, data, checksum */
+	g_autoptr(FuSrecFirmwareRecord) rcd = NULL;
+
+	/* sanity check */
+	if (token_idx > FU_SREC_FIRMWARE_TOKENS_MAX) {
+		g_set_error_literal(error,
+				    FWUPD_ERROR,
+				    FWUPD_ERROR_INVALID_DATA,
+				    "file has too many lines");
+		return FALSE;
+	}
+
+	/* remove WIN32 line endings */
+	g_strdelimit(token->str, "\r\x1a", '\0');
+	token->len = strlen(token->str);
+
+	/* ignore blank lines */
+	if (token->len == 0)
+		return TRUE;
+
+	/* decode the entire record into the stack buffer, and verify the checksum */
+	if (token->str[0] == 'S' && token->len >= 4 &&
+	    fu_firmware_strparse_hex_safe(token->str, token->len, 2, rec, 1, NULL)) {
+		gboolean is_eof = FALSE;
+		gboolean require_data = FALSE;
+		guint8 addrsz = 0;
+		guint8 rec_count = rec[0];
+		guint8 rec_kind = token->str[1] - '0';
+
+		if (fu_srec_firmware_record_kind_info(rec_kind, &addrsz, &require_data, &is_eof) &&
+		    rec_count > addrsz && token->len == 4 + ((gsize)rec_count * 2) &&
+		    fu_firmware_strparse_hex_safe(token->str,
+						  token->len,
+						  2,
+						  rec,
+						  (gsize)rec_count + 1,
+						  NULL) &&
+		    ((helper->flags & FU_FIRMWARE_PARSE_FLAG_IGNORE_CHECKSUM) > 0 ||
+		     (fu_sum8(rec, rec_count) ^ 0xff) == rec[rec_count])) {
+			guint32 rec_addr = 0;
+			gsize datasz = 0;
+
+			if (addrsz == 2)
+				rec_addr = fu_memread_uint16(rec + 1, G_BIG_ENDIAN);
+			else if (addrsz == 3)
+				rec_addr = fu_memread_uint24(rec + 1, G_BIG_ENDIAN);
+			else
+				rec_addr = fu_memread_uint32(rec + 1, G_BIG_ENDIAN);
+			if (rec_kind == FU_FIRMWARE_SREC_RECORD_KIND_S1_DATA_16 ||
+			    rec_kind == FU_FIRMWARE_SREC_RECORD_KIND_S2_DATA_24 ||
+			    rec_kind == FU_FIRMWARE_SREC_RECORD_KIND_S3_DATA_32)
+				datasz = rec_count - addrsz - 1;
+			if (is_eof)
+				helper->got_eof = TRUE;
+			return fu_srec_firmware_parse_record(helper,
+							     token_idx + 1,
+							     rec_kind,
+							     rec_addr,
+							     rec + 1 + addrsz,
+							     datasz,
+							     error);
+		}
+	}
+
+	/* something unusual, so fall back to the slow parser for the detailed error */
+	rcd = fu_srec_firmware_record_parse(token,
+					    token_idx,
+					    helper->flags,
+					    &helper->got_eof,
+					    error);
+	if (rcd == NULL)
+		return FALSE;
+	return fu_srec_firmware_parse_record(helper,
+					     rcd->ln,
+					     rcd->kind,
+					     rcd->addr,
+					     rcd->buf->data,
+					     rcd->buf->len,
+					     error);
+}
+
+static gboolean
+fu_srec_firmware_parse(FuFirmware *firmware,
+		       GInputStream *stream,
+		       FuFirmwareParseFlags flags,
+		       GError **error)
+{
+	FuSrecFirmware *self = FU_SREC_FIRMWARE(firmware);
+	FuSrecFirmwarePrivate *priv = GET_PRIVATE(self);
+	g_autoptr(GBytes) img_bytes = NULL;
+	g_autoptr(GByteArray) outbuf = g_byte_array_new();
+	FuSrecFirmwareParseHelper helper = {
+	    .self = self,
+	    .flags = flags,
+	    .outbuf = outbuf,
+	};
+
+	/* use the records if the subclass asked for them, as it may have modified them */
+	g_array_set_size(priv->regions, 0);
+	if (priv->records_valid) {
+		if (priv->records->len == 0) {
+			g_set_error_literal(error,
 					    FWUPD_ERROR,
 					    FWUPD_ERROR_INVALID_FILE,
-					    "invalid address 0x%x, last was 0x%x at line %u",
-					    (guint)rcd->addr,
-					    (guint)addr32_last,
-					    rcd->ln);
+					    "no EOF, perhaps truncated file");
+			return FALSE;
+		}
+		for (guint j = 0; j < priv->records->len; j++) {
+			FuSrecFirmwareRecord *rcd = g_ptr_array_index(priv->records, j);
+			if (!fu_srec_firmware_parse_record(&helper,
+							   rcd->ln,
+							   rcd->kind,
+							   rcd->addr,
+							   rcd->buf->data,
+							   rcd->buf->len,
+							   error))
 				return FALSE;
-			}
-			if (rcd->addr < priv->addr_min) {
-				g_debug(
-				    "ignoring data at 0x%x as before start address 0x%x at line %u",
-				    (guint)rcd->addr,
-				    priv->addr_min,
-				    rcd->ln);
-			} else if (priv->addr_max > 0 && rcd->addr > priv->addr_max) {
-				g_debug(
-				    "ignoring data at 0x%x as after end address 0x%x at line %u",
-				    (guint)rcd->addr,
-				    priv->addr_max,
-				    rcd->ln);
-			} else {
-				guint32 len_hole = rcd->addr - addr32_last;
-
-				/* fill any holes, but only up to 1Mb to avoid a DoS */
-				if (addr32_last > 0 && len_hole > 1 * FU_MB) {
-					g_set_error(
-					    error,
+		}
+	} else {
+		if (!fu_strsplit_stream(stream,
+					0x0,
+					"\n",
+					fu_srec_firmware_parse_stream_cb,
+					&helper,
+					error))
+			return FALSE;
+		if (!helper.got_eof) {
+			g_set_error_literal(error,
 					    FWUPD_ERROR,
 					    FWUPD_ERROR_INVALID_FILE,
-					    "hole of 0x%x bytes too large to fill at line %u",
-					    (guint)len_hole,
-					    rcd->ln);
-					return FALSE;
-				}
-				if (addr32_last > 0x0 && len_hole > 1) {
-					g_debug("filling address 0x%08x to 0x%08x at line %u",
-						addr32_last + 1,
-						addr32_last + len_hole - 1,
-						rcd->ln);
-					for (guint i = 0; i < len_hole; i++)
-						fu_byte_array_append_uint8(outbuf, 0xff);
-				}
-
-				/* add data */
-				g_byte_array_append(outbuf, rcd->buf->data, rcd->buf->len);
-				if (img_address == 0x0)
-					img_address = rcd->addr;
-				addr32_last = rcd->addr + rcd->buf->len;
-				if (addr32_last < rcd->addr) {
-					g_set_error(error,
-						    FWUPD_ERROR,
-						    FWUPD_ERROR_INVALID_FILE,
-						    "overflow from address 0x%x at line %u",
-						    (guint)rcd->addr,
-						    rcd->ln);
-					return FALSE;
-				}
-			}
-			data_cnt++;
+					    "no EOF, perhaps truncated file");
+			return FALSE;
 		}
 	}
 
 	/* add single image */
 	img_bytes = g_bytes_new(outbuf->data, outbuf->len);
 	fu_firmware_set_bytes(firmware, img_bytes);
-	fu_firmware_set_addr(firmware, img_address);
+	fu_firmware_set_addr(firmware, helper.img_address);
 	return TRUE;
 }
 
@@ -657,6 +970,9 @@ fu_srec_firmware_finalize(GObject *object)
 	FuSrecFirmware *self = FU_SREC_FIRMWARE(object);
 	FuSrecFirmwarePrivate *priv = GET_PRIVATE(self);
 	g_ptr_array_unref(priv->records);
+	g_array_unref(priv->regions);
+	if (priv->stream != NULL)
+		g_object_unref(priv->stream);
 	G_OBJECT_CLASS(fu_srec_firmware_parent_class)->finalize(object);
 }
 
@@ -665,6 +981,7 @@ fu_srec_firmware_init(FuSrecFirmware *self)
 {
 	FuSrecFirmwarePrivate *priv = GET_PRIVATE(self);
 	priv->records = g_ptr_array_new_with_free_func((GFreeFunc)fu_srec_firmware_record_free);
+	priv->regions = g_array_new(FALSE, FALSE, sizeof(FuSrecFirmwareRegion));
 	fu_firmware_add_flag(FU_FIRMWARE(self), FU_FIRMWARE_FLAG_HAS_CHECKSUM);
 	fu_firmware_set_size_max(FU_FIRMWARE(self), 32 * FU_MB);
 }
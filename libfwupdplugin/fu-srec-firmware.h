@@ -38,8 +38,12 @@ void
 fu_srec_firmware_set_addr_min(FuSrecFirmware *self, guint32 addr_min) G_GNUC_NON_NULL(1);
 void
 fu_srec_firmware_set_addr_max(FuSrecFirmware *self, guint32 addr_max) G_GNUC_NON_NULL(1);
+gboolean
+fu_srec_firmware_ensure_records(FuSrecFirmware *self, GError **error) G_GNUC_NON_NULL(1);
 GPtrArray *
 fu_srec_firmware_get_records(FuSrecFirmware *self) G_GNUC_NON_NULL(1);
+GPtrArray *
+fu_srec_firmware_get_chunks(FuSrecFirmware *self, GError **error) G_GNUC_NON_NULL(1);
 GType
 fu_srec_firmware_record_get_type(void);
 FuSrecFirmwareRecord *
@@ -438,6 +438,7 @@ typedef struct {
 	gsize delimiter_sz;
 	gboolean detected_nul;
 	gboolean more_chunks;
+	GString *token; /* reused for each callback */
 } FuStrsplitHelper;
 
 static gboolean
@@ -446,7 +447,7 @@ fu_strsplit_buffer_drain(GByteArray *buf, FuStrsplitHelper *helper, GError **err
 	gsize buf_offset = 0;
 	while (buf_offset <= buf->len) {
 		gsize offset;
-		g_autoptr(GString) token = g_string_new(NULL);
+		GString *token = helper->token;
 
 		/* find first match in buffer, starting at the buffer offset */
 		for (offset = buf_offset; offset < buf->len; offset++) {
@@ -454,7 +455,10 @@ fu_strsplit_buffer_drain(GByteArray *buf, FuStrsplitHelper *helper, GError **err
 				helper->detected_nul = TRUE;
 				break;
 			}
-			if (strncmp((const gchar *)buf->data + offset,
+			if (buf->data[offset] != (guint8)helper->delimiter[0])
+				continue;
+			if (helper->delimiter_sz == 1 ||
+			    strncmp((const gchar *)buf->data + offset,
 				    helper->delimiter,
 				    helper->delimiter_sz) == 0)
 				break;
@@ -465,6 +469,7 @@ fu_strsplit_buffer_drain(GByteArray *buf, FuStrsplitHelper *helper, GError **err
 			break;
 
 		/* sanity check is valid UTF-8 */
+		g_string_truncate(token, 0);
 		g_string_append_len(token,
 				    (const gchar *)buf->data + buf_offset,
 				    offset - buf_offset);
@@ -514,11 +519,13 @@ fu_strsplit_stream(GInputStream *stream,
 	g_autoptr(FuChunkArray) chunks = NULL;
 	g_autoptr(GByteArray) buf = g_byte_array_new();
 	g_autoptr(GInputStream) stream_partial = NULL;
+	g_autoptr(GString) token = g_string_new(NULL);
 	FuStrsplitHelper helper = {
 	    .callback = callback,
 	    .user_data = user_data,
 	    .delimiter = delimiter,
 	    .token_idx = 0,
+	    .token = token,
 	};
 
 	g_return_val_if_fail(G_IS_INPUT_STREAM(stream), FALSE);
@@ -0,0 +1,39 @@
+/*
+ * Copyright 2026 Richard Hughes <richard@hughsie.com>
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ */
+
+#pragma once
+
+#include "fu-tpm-eventlog-common.h"
+#include "fu-tpm-eventlog.h"
+#include "fu-tpm-struct.h"
+
+/* the number of PCRs defined by the TCG PC client platform specification */
+#define FU_TPM_EVENTLOG_PCR_MAX 24
+
+typedef enum {
+	FU_TPM_EVENTLOG_BANK_SHA1,
+	FU_TPM_EVENTLOG_BANK_SHA256,
+	FU_TPM_EVENTLOG_BANK_SHA384,
+	FU_TPM_EVENTLOG_BANK_LAST,
+} FuTpmEventlogBank;
+
+/* a compact copy of the measurement, used for PCR replay */
+typedef struct {
+	guint8 pcr;
+	FuTpmEventlogItemKind kind;
+	gboolean has_locality;
+	guint8 locality;
+	guint8 digestsz[FU_TPM_EVENTLOG_BANK_LAST]; /* 0 if not measured into the bank */
+	guint8 digest[FU_TPM_EVENTLOG_BANK_LAST][FU_TPM_DIGEST_SIZE_SHA384];
+} FuTpmEventlogEvent;
+
+FuTpmEventlogBank
+fu_tpm_eventlog_bank_from_alg(FuTpmAlg alg);
+FuTpmAlg
+fu_tpm_eventlog_bank_to_alg(FuTpmEventlogBank bank);
+void
+fu_tpm_eventlog_add_event(FuTpmEventlog *self, FuTpmEventlogEvent *event, GBytes *blob)
+    G_GNUC_NON_NULL(1, 2);
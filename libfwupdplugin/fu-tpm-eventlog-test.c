@@ -8,6 +8,8 @@
 
 #include <fwupdplugin.h>
 
+#include "fu-tpm-eventlog-common.h"
+
 static void
 fu_tpm_eventlog_func(void)
 {
@@ -50,10 +52,194 @@ fu_tpm_eventlog_func(void)
 	g_assert_cmpstr(csum_sha1, ==, "2942632a0231d481bf40564515998dd72c01c118");
 }
 
+static FuTpmEventlogItem *
+fu_tpm_eventlog_replay_item_new(guint8 pcr, guint8 value)
+{
+	FuTpmEventlogItem *item = fu_tpm_eventlog_item_new();
+	guint8 digest[FU_TPM_DIGEST_SIZE_SHA384] = {0x0};
+	g_autoptr(GBytes) data = g_bytes_new(&value, sizeof(value));
+	g_autoptr(GBytes) checksum_sha1 = NULL;
+	g_autoptr(GBytes) checksum_sha256 = NULL;
+	g_autoptr(GBytes) checksum_sha384 = NULL;
+
+	memset(digest, value, sizeof(digest));
+	checksum_sha1 = g_bytes_new(digest, FU_TPM_DIGEST_SIZE_SHA1);
+	checksum_sha256 = g_bytes_new(digest, FU_TPM_DIGEST_SIZE_SHA256);
+	checksum_sha384 = g_bytes_new(digest, FU_TPM_DIGEST_SIZE_SHA384);
+	fu_tpm_eventlog_item_set_kind(item, FU_TPM_EVENTLOG_ITEM_KIND_EFI_ACTION);
+	fu_tpm_eventlog_item_set_pcr(item, pcr);
+	fu_tpm_eventlog_item_add_checksum(item, FU_TPM_ALG_SHA1, checksum_sha1);
+	fu_tpm_eventlog_item_add_checksum(item, FU_TPM_ALG_SHA256, checksum_sha256);
+	fu_tpm_eventlog_item_add_checksum(item, FU_TPM_ALG_SHA384, checksum_sha384);
+	fu_firmware_set_bytes(FU_FIRMWARE(item), data);
+	return item;
+}
+
+static void
+fu_tpm_eventlog_replay_check(FuTpmEventlog *log,
+			     guint8 pcr,
+			     const gchar *sha1,
+			     const gchar *sha256,
+			     const gchar *sha384)
+{
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GPtrArray) checksums = fu_tpm_eventlog_calc_checksums(log, pcr, &error);
+
+	g_assert_no_error(error);
+	g_assert_nonnull(checksums);
+	g_assert_cmpint(checksums->len, ==, 3);
+	g_assert_cmpstr(fwupd_checksum_get_by_kind(checksums, G_CHECKSUM_SHA1), ==, sha1);
+	g_assert_cmpstr(fwupd_checksum_get_by_kind(checksums, G_CHECKSUM_SHA256), ==, sha256);
+	g_assert_cmpstr(fwupd_checksum_get_by_kind(checksums, G_CHECKSUM_SHA384), ==, sha384);
+}
+
+static void
+fu_tpm_eventlog_replay_func(void)
+{
+	gboolean ret;
+	const gchar *pcr0_sha1 = "396c7c928ea8f72599c91313d7ff5bac3e419704";
+	const gchar *pcr0_sha256 =
+	    "b783a4f7e5a40f0dd29cd2e9ef83bcd4b3225a48fcc694de40e2ca6d517b9862";
+	const gchar *pcr0_sha384 = "6198ab2caaa45d0bcc5d1f27e7c4a763f5518d272c0d74c2"
+				   "166aec2c5d280418d9d341caf10434d4f87a4921778d2d6a";
+	const gchar *pcr1_sha1 = "58360efba5aa833dafce90fbf42907629a28806e";
+	const gchar *pcr1_sha256 =
+	    "36b7217f9799dadcda3546267e32d6774a1ce2a76de7c20c336f160e68481c38";
+	const gchar *pcr1_sha384 = "66f60db53f35b91eb7f71aad347e076712169849778651ce"
+				   "bd1b6f3c3b5eb756820617468d20330a8ea9913f60c1cc55";
+	g_autoptr(FuTpmEventlog) log = fu_tpm_eventlog_v2_new();
+	g_autoptr(FuTpmEventlog) log2 = fu_tpm_eventlog_v2_new();
+	g_autoptr(FuTpmEventlogItem) item0 = fu_tpm_eventlog_replay_item_new(0, 0x01);
+	g_autoptr(FuTpmEventlogItem) item1 = fu_tpm_eventlog_replay_item_new(1, 0x02);
+	g_autoptr(FuTpmEventlogItem) item2 = fu_tpm_eventlog_replay_item_new(0, 0x03);
+	g_autoptr(FuTpmEventlogItem) item3 = fu_tpm_eventlog_replay_item_new(0, 0x04);
+	g_autoptr(GBytes) blob = NULL;
+	g_autoptr(GError) error = NULL;
+
+	/* PCR0 is extended twice, PCR1 once, in all three banks */
+	ret = fu_firmware_add_image(FU_FIRMWARE(log), FU_FIRMWARE(item0), &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	ret = fu_firmware_add_image(FU_FIRMWARE(log), FU_FIRMWARE(item1), &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	ret = fu_firmware_add_image(FU_FIRMWARE(log), FU_FIRMWARE(item2), &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	fu_tpm_eventlog_replay_check(log, 0, pcr0_sha1, pcr0_sha256, pcr0_sha384);
+	fu_tpm_eventlog_replay_check(log, 1, pcr1_sha1, pcr1_sha256, pcr1_sha384);
+
+	/* parse it back, which replays from the events rather than the images */
+	blob = fu_firmware_write(FU_FIRMWARE(log), &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(blob);
+	ret = fu_firmware_parse_bytes(FU_FIRMWARE(log2),
+				      blob,
+				      0x0,
+				      FU_FIRMWARE_PARSE_FLAG_NONE,
+				      &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	fu_tpm_eventlog_replay_check(log2, 0, pcr0_sha1, pcr0_sha256, pcr0_sha384);
+	fu_tpm_eventlog_replay_check(log2, 1, pcr1_sha1, pcr1_sha256, pcr1_sha384);
+
+	/* replace the last event, keeping the same number of images */
+	ret = fu_firmware_remove_image(FU_FIRMWARE(log), FU_FIRMWARE(item2), &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	ret = fu_firmware_add_image(FU_FIRMWARE(log), FU_FIRMWARE(item3), &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	fu_tpm_eventlog_replay_check(
+	    log,
+	    0,
+	    "2c93ca8241c1e7bf6fddd6e13cd87a02fe7e51ae",
+	    "c7ba4b26c8bceb8c60eb67ef1a528f7cf24f23f8a0ad84d3fce32ff01834de6f",
+	    "f62ddd39bafc517e242b925a8cb3fd6bcff212d6d70ea411"
+	    "8ace21ace9c9f53d5d49fc912bc83377ec1b4da35801f619");
+	fu_tpm_eventlog_replay_check(log, 1, pcr1_sha1, pcr1_sha256, pcr1_sha384);
+}
+
+static void
+fu_tpm_eventlog_benchmark_func(void)
+{
+	gboolean ret;
+	guint8 digest_sha1[FU_TPM_DIGEST_SIZE_SHA1] = {0x0};
+	guint8 digest_sha256[FU_TPM_DIGEST_SIZE_SHA256] = {0x0};
+	guint8 digest_sha384[FU_TPM_DIGEST_SIZE_SHA384] = {0x0};
+	g_autoptr(FuTpmEventlog) log = fu_tpm_eventlog_v2_new();
+	g_autoptr(FuTpmEventlog) log2 = fu_tpm_eventlog_v2_new();
+	g_autoptr(GBytes) blob = NULL;
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GTimer) timer = g_timer_new();
+
+	/* build a large synthetic log with all three banks */
+	for (guint i = 0; i < 10000; i++) {
+		g_autoptr(FuTpmEventlogItem) item = fu_tpm_eventlog_item_new();
+		g_autoptr(GBytes) data = g_bytes_new(&i, sizeof(i));
+		g_autoptr(GBytes) checksum_sha1 = NULL;
+		g_autoptr(GBytes) checksum_sha256 = NULL;
+		g_autoptr(GBytes) checksum_sha384 = NULL;
+
+		digest_sha1[0] = i;
+		digest_sha256[0] = i;
+		digest_sha384[0] = i;
+		checksum_sha1 = g_bytes_new(digest_sha1, sizeof(digest_sha1));
+		checksum_sha256 = g_bytes_new(digest_sha256, sizeof(digest_sha256));
+		checksum_sha384 = g_bytes_new(digest_sha384, sizeof(digest_sha384));
+		fu_tpm_eventlog_item_set_kind(item, FU_TPM_EVENTLOG_ITEM_KIND_EFI_ACTION);
+		fu_tpm_eventlog_item_set_pcr(item, i % 8);
+		fu_tpm_eventlog_item_add_checksum(item, FU_TPM_ALG_SHA1, checksum_sha1);
+		fu_tpm_eventlog_item_add_checksum(item, FU_TPM_ALG_SHA256, checksum_sha256);
+		fu_tpm_eventlog_item_add_checksum(item, FU_TPM_ALG_SHA384, checksum_sha384);
+		fu_firmware_set_bytes(FU_FIRMWARE(item), data);
+		ret = fu_firmware_add_image(FU_FIRMWARE(log), FU_FIRMWARE(item), &error);
+		g_assert_no_error(error);
+		g_assert_true(ret);
+	}
+	blob = fu_firmware_write(FU_FIRMWARE(log), &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(blob);
+
+	/* parse it back */
+	g_timer_reset(timer);
+	ret = fu_firmware_parse_bytes(FU_FIRMWARE(log2),
+				      blob,
+				      0x0,
+				      FU_FIRMWARE_PARSE_FLAG_NONE,
+				      &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	g_test_message("parse took %.2fms", g_timer_elapsed(timer, NULL) * 1000.f);
+
+	/* replay every PCR, which should match the log that was not parsed */
+	g_timer_reset(timer);
+	for (guint8 pcr = 0; pcr < 8; pcr++) {
+		g_autoptr(GPtrArray) checksums = fu_tpm_eventlog_calc_checksums(log2, pcr, &error);
+		g_autoptr(GPtrArray) checksums_built = NULL;
+		g_assert_no_error(error);
+		g_assert_nonnull(checksums);
+		g_assert_cmpint(checksums->len, ==, 3);
+		checksums_built = fu_tpm_eventlog_calc_checksums(log, pcr, &error);
+		g_assert_no_error(error);
+		g_assert_nonnull(checksums_built);
+		g_assert_cmpint(checksums_built->len, ==, 3);
+		for (guint i = 0; i < checksums->len; i++) {
+			g_assert_cmpstr(g_ptr_array_index(checksums, i),
+					==,
+					g_ptr_array_index(checksums_built, i));
+		}
+	}
+	g_test_message("replay took %.2fms", g_timer_elapsed(timer, NULL) * 1000.f);
+}
+
 int
 main(int argc, char **argv)
 {
 	g_test_init(&argc, &argv, NULL);
 	g_test_add_func("/fwupd/tpm-eventlog", fu_tpm_eventlog_func);
+	g_test_add_func("/fwupd/tpm-eventlog/replay", fu_tpm_eventlog_replay_func);
+	if (g_test_slow())
+		g_test_add_func("/fwupd/tpm-eventlog/benchmark", fu_tpm_eventlog_benchmark_func);
 	return g_test_run();
 }
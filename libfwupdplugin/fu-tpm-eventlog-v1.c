@@ -11,7 +11,9 @@
 #include "fu-byte-array.h"
 #include "fu-common.h"
 #include "fu-input-stream.h"
+#include "fu-mem.h"
 #include "fu-tpm-eventlog-item.h"
+#include "fu-tpm-eventlog-private.h"
 #include "fu-tpm-eventlog-v1.h"
 #include "fu-tpm-struct.h"
 
@@ -32,19 +34,19 @@ fu_tpm_eventlog_v1_parse(FuFirmware *firmware,
 		return FALSE;
 	for (gsize idx = 0; idx < streamsz; idx += FU_STRUCT_TPM_EVENT_LOG1_ITEM_SIZE) {
 		guint32 datasz = 0;
-		guint32 pcr = 0;
-		guint32 event_type = 0;
 		gsize digestsz = 0;
 		const guint8 *digest;
+		FuTpmEventlogEvent event = {0x0};
 		g_autoptr(FuStructTpmEventLog1Item) st = NULL;
 		g_autoptr(FuTpmEventlogItem) item = fu_tpm_eventlog_item_new();
+		g_autoptr(GBytes) blob = NULL;
 		g_autoptr(GBytes) checksum_sha1 = NULL;
 
 		st = fu_struct_tpm_event_log1_item_parse_stream(stream, idx, error);
 		if (st == NULL)
 			return FALSE;
-		pcr = fu_struct_tpm_event_log1_item_get_pcr(st);
-		event_type = fu_struct_tpm_event_log1_item_get_type(st);
+		event.pcr = fu_struct_tpm_event_log1_item_get_pcr(st);
+		event.kind = fu_struct_tpm_event_log1_item_get_type(st);
 		datasz = fu_struct_tpm_event_log1_item_get_datasz(st);
 		if (datasz > FU_MB) {
 			g_set_error_literal(error,
@@ -55,13 +57,22 @@ fu_tpm_eventlog_v1_parse(FuFirmware *firmware,
 		}
 
 		/* build item */
-		fu_tpm_eventlog_item_set_pcr(item, pcr);
-		fu_tpm_eventlog_item_set_kind(item, event_type);
+		fu_tpm_eventlog_item_set_pcr(item, event.pcr);
+		fu_tpm_eventlog_item_set_kind(item, event.kind);
 		digest = fu_struct_tpm_event_log1_item_get_digest(st, &digestsz);
 		checksum_sha1 = g_bytes_new(digest, digestsz);
 		fu_tpm_eventlog_item_add_checksum(item, FU_TPM_ALG_SHA1, checksum_sha1);
+		if (!fu_memcpy_safe(event.digest[FU_TPM_EVENTLOG_BANK_SHA1],
+				    sizeof(event.digest[FU_TPM_EVENTLOG_BANK_SHA1]),
+				    0x0, /* dst */
+				    digest,
+				    digestsz,
+				    0x0, /* src */
+				    digestsz,
+				    error))
+			return FALSE;
+		event.digestsz[FU_TPM_EVENTLOG_BANK_SHA1] = digestsz;
 		if (datasz > 0) {
-			g_autoptr(GBytes) blob = NULL;
 			blob = fu_input_stream_read_bytes(stream,
 							  idx + st->buf->len,
 							  datasz,
@@ -73,6 +84,7 @@ fu_tpm_eventlog_v1_parse(FuFirmware *firmware,
 		}
 		if (!fu_firmware_add_image(firmware, FU_FIRMWARE(item), error))
 			return FALSE;
+		fu_tpm_eventlog_add_event(FU_TPM_EVENTLOG(firmware), &event, blob);
 		idx += datasz;
 	}
 
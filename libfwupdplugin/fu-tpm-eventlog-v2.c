@@ -10,8 +10,9 @@
 
 #include "fu-byte-array.h"
 #include "fu-common.h"
-#include "fu-tpm-eventlog-common.h"
+#include "fu-input-stream.h"
 #include "fu-tpm-eventlog-item.h"
+#include "fu-tpm-eventlog-private.h"
 #include "fu-tpm-eventlog-v2.h"
 #include "fu-tpm-struct.h"
 
@@ -49,12 +50,10 @@ fu_tpm_eventlog_v2_parse_item(FuTpmEventlogV2 *self,
 			      gsize *idx,
 			      GError **error)
 {
-	guint32 pcr;
 	guint32 digestcnt;
 	guint32 datasz = 0;
-	g_autoptr(GBytes) checksum_sha1 = NULL;
-	g_autoptr(GBytes) checksum_sha256 = NULL;
-	g_autoptr(GBytes) checksum_sha384 = NULL;
+	FuTpmEventlogEvent event = {0x0};
+	g_autoptr(GBytes) blob = NULL;
 	g_autoptr(FuStructTpmEventLog2) st = NULL;
 	g_autoptr(FuTpmEventlogItem) item = NULL;
 
@@ -67,7 +66,7 @@ fu_tpm_eventlog_v2_parse_item(FuTpmEventlogV2 *self,
 	for (guint i = 0; i < digestcnt; i++) {
 		guint16 alg_type = 0;
 		guint32 alg_size = 0;
-		g_autoptr(GBytes) checksum = NULL;
+		FuTpmEventlogBank bank;
 
 		/* get checksum type */
 		if (!fu_input_stream_read_u16(stream, *idx, &alg_type, G_LITTLE_ENDIAN, error))
@@ -85,18 +84,19 @@ fu_tpm_eventlog_v2_parse_item(FuTpmEventlogV2 *self,
 		/* build checksum */
 		*idx += sizeof(alg_type);
 
-		/* copy hash */
-		checksum = fu_input_stream_read_bytes(stream, *idx, alg_size, NULL, error);
-		if (checksum == NULL)
-			return FALSE;
-
-		/* save this for analysis */
-		if (alg_type == FU_TPM_ALG_SHA1)
-			checksum_sha1 = g_bytes_ref(checksum);
-		else if (alg_type == FU_TPM_ALG_SHA256)
-			checksum_sha256 = g_bytes_ref(checksum);
-		else if (alg_type == FU_TPM_ALG_SHA384)
-			checksum_sha384 = g_bytes_ref(checksum);
+		/* copy hash directly into the event, saving this for analysis */
+		bank = fu_tpm_eventlog_bank_from_alg(alg_type);
+		if (bank != FU_TPM_EVENTLOG_BANK_LAST) {
+			if (!fu_input_stream_read_safe(stream,
+						       event.digest[bank],
+						       sizeof(event.digest[bank]),
+						       0x0,  /* offset */
+						       *idx, /* seek */
+						       alg_size,
+						       error))
+				return FALSE;
+			event.digestsz[bank] = alg_size;
+		}
 
 		/* next block */
 		*idx += alg_size;
@@ -115,20 +115,23 @@ fu_tpm_eventlog_v2_parse_item(FuTpmEventlogV2 *self,
 
 	/* save blob */
 	*idx += sizeof(datasz);
-	pcr = fu_struct_tpm_event_log2_get_pcr(st);
+	event.pcr = fu_struct_tpm_event_log2_get_pcr(st);
+	event.kind = fu_struct_tpm_event_log2_get_type(st);
 
 	/* build item */
 	item = fu_tpm_eventlog_item_new();
-	fu_tpm_eventlog_item_set_pcr(item, pcr);
-	fu_tpm_eventlog_item_set_kind(item, fu_struct_tpm_event_log2_get_type(st));
-	if (checksum_sha1 != NULL)
-		fu_tpm_eventlog_item_add_checksum(item, FU_TPM_ALG_SHA1, checksum_sha1);
-	if (checksum_sha256 != NULL)
-		fu_tpm_eventlog_item_add_checksum(item, FU_TPM_ALG_SHA256, checksum_sha256);
-	if (checksum_sha384 != NULL)
-		fu_tpm_eventlog_item_add_checksum(item, FU_TPM_ALG_SHA384, checksum_sha384);
+	fu_tpm_eventlog_item_set_pcr(item, event.pcr);
+	fu_tpm_eventlog_item_set_kind(item, event.kind);
+	for (guint i = 0; i < FU_TPM_EVENTLOG_BANK_LAST; i++) {
+		g_autoptr(GBytes) checksum = NULL;
+		if (event.digestsz[i] == 0)
+			continue;
+		checksum = g_bytes_new(event.digest[i], event.digestsz[i]);
+		fu_tpm_eventlog_item_add_checksum(item,
+						  fu_tpm_eventlog_bank_to_alg(i),
+						  checksum);
+	}
 	if (datasz > 0) {
-		g_autoptr(GBytes) blob = NULL;
 		blob = fu_input_stream_read_bytes(stream, *idx, datasz, NULL, error);
 		if (blob == NULL)
 			return FALSE;
@@ -136,6 +139,7 @@ fu_tpm_eventlog_v2_parse_item(FuTpmEventlogV2 *self,
 	}
 	if (!fu_firmware_add_image(FU_FIRMWARE(self), FU_FIRMWARE(item), error))
 		return FALSE;
+	fu_tpm_eventlog_add_event(FU_TPM_EVENTLOG(self), &event, blob);
 
 	/* next entry */
 	*idx += datasz;
@@ -7,11 +7,164 @@
 #include "config.h"
 
 #include "fu-bytes.h"
-#include "fu-tpm-eventlog-common.h"
+#include "fu-firmware-private.h"
 #include "fu-tpm-eventlog-item.h"
-#include "fu-tpm-eventlog.h"
+#include "fu-tpm-eventlog-private.h"
 
-G_DEFINE_TYPE(FuTpmEventlog, fu_tpm_eventlog, FU_TYPE_FIRMWARE)
+/* the replayed value of one PCR in each bank */
+typedef struct {
+	guint cnt[FU_TPM_EVENTLOG_BANK_LAST];
+	guint8 digest[FU_TPM_EVENTLOG_BANK_LAST][FU_TPM_DIGEST_SIZE_SHA384];
+} FuTpmEventlogPcr;
+
+typedef struct {
+	GArray *events;		 /* (element-type FuTpmEventlogEvent) */
+	guint events_generation; /* of the images when @events was last changed */
+	FuTpmEventlogPcr *pcrs;	 /* (nullable), FU_TPM_EVENTLOG_PCR_MAX */
+} FuTpmEventlogPrivate;
+
+G_DEFINE_TYPE_WITH_PRIVATE(FuTpmEventlog, fu_tpm_eventlog, FU_TYPE_FIRMWARE)
+
+#define GET_PRIVATE(o) (fu_tpm_eventlog_get_instance_private(o))
+
+static const struct {
+	FuTpmAlg alg;
+	GChecksumType csum_kind;
+	gsize digestsz;
+} fu_tpm_eventlog_banks[FU_TPM_EVENTLOG_BANK_LAST] = {
+    {FU_TPM_ALG_SHA1, G_CHECKSUM_SHA1, FU_TPM_DIGEST_SIZE_SHA1},
+    {FU_TPM_ALG_SHA256, G_CHECKSUM_SHA256, FU_TPM_DIGEST_SIZE_SHA256},
+    {FU_TPM_ALG_SHA384, G_CHECKSUM_SHA384, FU_TPM_DIGEST_SIZE_SHA384},
+};
+
+/* private */
+FuTpmEventlogBank
+fu_tpm_eventlog_bank_from_alg(FuTpmAlg alg)
+{
+	for (guint i = 0; i < FU_TPM_EVENTLOG_BANK_LAST; i++) {
+		if (fu_tpm_eventlog_banks[i].alg == alg)
+			return i;
+	}
+	return FU_TPM_EVENTLOG_BANK_LAST;
+}
+
+/* private */
+FuTpmAlg
+fu_tpm_eventlog_bank_to_alg(FuTpmEventlogBank bank)
+{
+	if (bank >= FU_TPM_EVENTLOG_BANK_LAST)
+		return FU_TPM_ALG_UNKNOWN;
+	return fu_tpm_eventlog_banks[bank].alg;
+}
+
+/* private */
+void
+fu_tpm_eventlog_add_event(FuTpmEventlog *self, FuTpmEventlogEvent *event, GBytes *blob)
+{
+	FuTpmEventlogPrivate *priv = GET_PRIVATE(self);
+
+	g_return_if_fail(FU_IS_TPM_EVENTLOG(self));
+	g_return_if_fail(event != NULL);
+
+	/* if TXT is enabled then the first event for PCR0 should be a StartupLocality */
+	if (priv->events->len == 0 && event->kind == FU_TPM_EVENTLOG_ITEM_KIND_NO_ACTION &&
+	    event->pcr == 0 && blob != NULL) {
+		g_autoptr(FuStructTpmEfiStartupLocalityEvent) st_loc = NULL;
+		st_loc = fu_struct_tpm_efi_startup_locality_event_parse_bytes(blob, 0x0, NULL);
+		if (st_loc != NULL) {
+			event->has_locality = TRUE;
+			event->locality =
+			    fu_struct_tpm_efi_startup_locality_event_get_locality(st_loc);
+		}
+	}
+	g_array_append_val(priv->events, *event);
+	priv->events_generation = fu_firmware_get_images_generation(FU_FIRMWARE(self));
+	g_clear_pointer(&priv->pcrs, g_free);
+}
+
+/* images added or removed directly rather than by parsing */
+static void
+fu_tpm_eventlog_ensure_events(FuTpmEventlog *self)
+{
+	FuTpmEventlogPrivate *priv = GET_PRIVATE(self);
+	g_autoptr(GPtrArray) items = NULL;
+
+	if (priv->events_generation == fu_firmware_get_images_generation(FU_FIRMWARE(self)))
+		return;
+	items = fu_firmware_get_images(FU_FIRMWARE(self));
+	g_array_set_size(priv->events, 0);
+	g_clear_pointer(&priv->pcrs, g_free);
+	for (guint i = 0; i < items->len; i++) {
+		FuTpmEventlogItem *item = g_ptr_array_index(items, i);
+		FuTpmEventlogEvent event = {
+		    .pcr = fu_tpm_eventlog_item_get_pcr(item),
+		    .kind = fu_tpm_eventlog_item_get_kind(item),
+		};
+		g_autoptr(GBytes) blob = fu_firmware_get_bytes(FU_FIRMWARE(item), NULL);
+
+		for (guint j = 0; j < FU_TPM_EVENTLOG_BANK_LAST; j++) {
+			g_autoptr(GBytes) checksum = NULL;
+			checksum = fu_tpm_eventlog_item_get_checksum(item,
+								     fu_tpm_eventlog_banks[j].alg,
+								     NULL);
+			if (checksum == NULL || g_bytes_get_size(checksum) == 0 ||
+			    g_bytes_get_size(checksum) > sizeof(event.digest[j]))
+				continue;
+			event.digestsz[j] = g_bytes_get_size(checksum);
+			memcpy(event.digest[j], /* nocheck:blocked */
+			       g_bytes_get_data(checksum, NULL),
+			       event.digestsz[j]);
+		}
+		fu_tpm_eventlog_add_event(self, &event, blob);
+	}
+	priv->events_generation = fu_firmware_get_images_generation(FU_FIRMWARE(self));
+}
+
+/* take existing PCR hash, append new measurement to that, hash that with the same algorithm */
+static void
+fu_tpm_eventlog_replay(FuTpmEventlog *self)
+{
+	FuTpmEventlogPrivate *priv = GET_PRIVATE(self);
+	GChecksum *csums[FU_TPM_EVENTLOG_BANK_LAST] = {NULL};
+
+	priv->pcrs = g_new0(FuTpmEventlogPcr, FU_TPM_EVENTLOG_PCR_MAX);
+	for (guint j = 0; j < FU_TPM_EVENTLOG_BANK_LAST; j++)
+		csums[j] = g_checksum_new(fu_tpm_eventlog_banks[j].csum_kind);
+	for (guint i = 0; i < priv->events->len; i++) {
+		FuTpmEventlogEvent *event = &g_array_index(priv->events, FuTpmEventlogEvent, i);
+		FuTpmEventlogPcr *pcr;
+
+		if (event->pcr >= FU_TPM_EVENTLOG_PCR_MAX)
+			continue;
+		pcr = &priv->pcrs[event->pcr];
+
+		/* the locality is the initial value of PCR0 */
+		if (i == 0 && event->has_locality) {
+			for (guint j = 0; j < FU_TPM_EVENTLOG_BANK_LAST; j++) {
+				gsize digestsz = fu_tpm_eventlog_banks[j].digestsz;
+				pcr->digest[j][digestsz - 1] = event->locality;
+			}
+			continue;
+		}
+
+		/* ignore all subsequent no-action events */
+		if (event->kind == FU_TPM_EVENTLOG_ITEM_KIND_NO_ACTION)
+			continue;
+
+		for (guint j = 0; j < FU_TPM_EVENTLOG_BANK_LAST; j++) {
+			gsize digestsz = fu_tpm_eventlog_banks[j].digestsz;
+			if (event->digestsz[j] == 0)
+				continue;
+			g_checksum_reset(csums[j]);
+			g_checksum_update(csums[j], pcr->digest[j], digestsz);
+			g_checksum_update(csums[j], event->digest[j], event->digestsz[j]);
+			g_checksum_get_digest(csums[j], pcr->digest[j], &digestsz);
+			pcr->cnt[j]++;
+		}
+	}
+	for (guint j = 0; j < FU_TPM_EVENTLOG_BANK_LAST; j++)
+		g_checksum_free(csums[j]);
+}
 
 /**
  * fu_tpm_eventlog_calc_checksums:
@@ -21,6 +174,9 @@ G_DEFINE_TYPE(FuTpmEventlog, fu_tpm_eventlog, FU_TYPE_FIRMWARE)
  *
  * Calculate the possible checksums for a given PCR.
  *
+ * All the PCRs are replayed in every bank the first time this is called, and the results are
+ * reused until the event log is modified.
+ *
  * Returns: (element-type utf8) (transfer container): checksum strings
  *
  * Since: 2.1.1
@@ -28,133 +184,67 @@ G_DEFINE_TYPE(FuTpmEventlog, fu_tpm_eventlog, FU_TYPE_FIRMWARE)
 GPtrArray *
 fu_tpm_eventlog_calc_checksums(FuTpmEventlog *self, guint8 pcr, GError **error)
 {
-	guint cnt_sha1 = 0;
-	guint cnt_sha256 = 0;
-	guint cnt_sha384 = 0;
-	guint8 digest_sha1[FU_TPM_DIGEST_SIZE_SHA1] = {0x0};
-	guint8 digest_sha256[FU_TPM_DIGEST_SIZE_SHA256] = {0x0};
-	guint8 digest_sha384[FU_TPM_DIGEST_SIZE_SHA384] = {0x0};
-	gsize digest_sha1_len = sizeof(digest_sha1);
-	gsize digest_sha256_len = sizeof(digest_sha256);
-	gsize digest_sha384_len = sizeof(digest_sha384);
+	FuTpmEventlogPrivate *priv = GET_PRIVATE(self);
+	FuTpmEventlogPcr *pcr_value;
 	g_autoptr(GPtrArray) csums = g_ptr_array_new_with_free_func(g_free);
-	g_autoptr(GPtrArray) items = fu_firmware_get_images(FU_FIRMWARE(self));
+
+	g_return_val_if_fail(FU_IS_TPM_EVENTLOG(self), NULL);
+	g_return_val_if_fail(error == NULL || *error == NULL, NULL);
 
 	/* sanity check */
-	if (items->len == 0) {
+	fu_tpm_eventlog_ensure_events(self);
+	if (priv->events->len == 0) {
 		g_set_error_literal(error,
 				    FWUPD_ERROR,
 				    FWUPD_ERROR_INVALID_DATA,
 				    "no event log data");
 		return NULL;
 	}
+	if (priv->pcrs == NULL)
+		fu_tpm_eventlog_replay(self);
 
-	/* take existing PCR hash, append new measurement to that,
-	 * hash that with the same algorithm */
-	for (guint i = 0; i < items->len; i++) {
-		FuTpmEventlogItem *item = g_ptr_array_index(items, i);
-		FuTpmEventlogItemKind item_kind = fu_tpm_eventlog_item_get_kind(item);
-		guint8 item_pcr = fu_tpm_eventlog_item_get_pcr(item);
-		g_autoptr(GBytes) item_blob = fu_firmware_get_bytes(FU_FIRMWARE(item), NULL);
-		g_autoptr(GBytes) item_checksum_sha1 = NULL;
-		g_autoptr(GBytes) item_checksum_sha256 = NULL;
-		g_autoptr(GBytes) item_checksum_sha384 = NULL;
-
-		if (item_pcr != pcr)
-			continue;
-
-		/* if TXT is enabled then the first event for PCR0 should be a StartupLocality */
-		if (item_kind == FU_TPM_EVENTLOG_ITEM_KIND_NO_ACTION && item_pcr == 0 &&
-		    item_blob != NULL && i == 0) {
-			g_autoptr(FuStructTpmEfiStartupLocalityEvent) st_loc = NULL;
-			st_loc = fu_struct_tpm_efi_startup_locality_event_parse_bytes(item_blob,
-										      0x0,
-										      NULL);
-			if (st_loc != NULL) {
-				guint8 locality =
-				    fu_struct_tpm_efi_startup_locality_event_get_locality(st_loc);
-				digest_sha384[FU_TPM_DIGEST_SIZE_SHA384 - 1] = locality;
-				digest_sha256[FU_TPM_DIGEST_SIZE_SHA256 - 1] = locality;
-				digest_sha1[FU_TPM_DIGEST_SIZE_SHA1 - 1] = locality;
+	/* only the final value is converted to a string */
+	if (pcr < FU_TPM_EVENTLOG_PCR_MAX) {
+		pcr_value = &priv->pcrs[pcr];
+		for (guint j = 0; j < FU_TPM_EVENTLOG_BANK_LAST; j++) {
+			g_autoptr(GBytes) blob = NULL;
+			if (pcr_value->cnt[j] == 0)
 				continue;
-			}
-		}
-
-		/* ignore all subsequent no-action events */
-		if (item_kind == FU_TPM_EVENTLOG_ITEM_KIND_NO_ACTION)
-			continue;
-
-		item_checksum_sha1 = fu_tpm_eventlog_item_get_checksum(item, FU_TPM_ALG_SHA1, NULL);
-		if (item_checksum_sha1 != NULL) {
-			g_autoptr(GChecksum) csum_sha1 = g_checksum_new(G_CHECKSUM_SHA1);
-			g_checksum_update(csum_sha1, (const guchar *)digest_sha1, digest_sha1_len);
-			g_checksum_update(
-			    csum_sha1,
-			    (const guchar *)g_bytes_get_data(item_checksum_sha1, NULL),
-			    g_bytes_get_size(item_checksum_sha1));
-			g_checksum_get_digest(csum_sha1, digest_sha1, &digest_sha1_len);
-			cnt_sha1++;
-		}
-		item_checksum_sha256 =
-		    fu_tpm_eventlog_item_get_checksum(item, FU_TPM_ALG_SHA256, NULL);
-		if (item_checksum_sha256 != NULL) {
-			g_autoptr(GChecksum) csum_sha256 = g_checksum_new(G_CHECKSUM_SHA256);
-			g_checksum_update(csum_sha256,
-					  (const guchar *)digest_sha256,
-					  digest_sha256_len);
-			g_checksum_update(
-			    csum_sha256,
-			    (const guchar *)g_bytes_get_data(item_checksum_sha256, NULL),
-			    g_bytes_get_size(item_checksum_sha256));
-			g_checksum_get_digest(csum_sha256, digest_sha256, &digest_sha256_len);
-			cnt_sha256++;
-		}
-		item_checksum_sha384 =
-		    fu_tpm_eventlog_item_get_checksum(item, FU_TPM_ALG_SHA384, NULL);
-		if (item_checksum_sha384 != NULL) {
-			g_autoptr(GChecksum) csum_sha384 = g_checksum_new(G_CHECKSUM_SHA384);
-			g_checksum_update(csum_sha384,
-					  (const guchar *)digest_sha384,
-					  digest_sha384_len);
-			g_checksum_update(
-			    csum_sha384,
-			    (const guchar *)g_bytes_get_data(item_checksum_sha384, NULL),
-			    g_bytes_get_size(item_checksum_sha384));
-			g_checksum_get_digest(csum_sha384, digest_sha384, &digest_sha384_len);
-			cnt_sha384++;
+			blob = g_bytes_new_static(pcr_value->digest[j],
+						  fu_tpm_eventlog_banks[j].digestsz);
+			g_ptr_array_add(csums, fu_bytes_to_string(blob));
 		}
 	}
-	if (cnt_sha1 == 0 && cnt_sha256 == 0 && cnt_sha384 == 0) {
+	if (csums->len == 0) {
 		g_set_error_literal(error,
 				    FWUPD_ERROR,
 				    FWUPD_ERROR_INVALID_DATA,
 				    "no SHA1, SHA256, or SHA384 data");
 		return NULL;
 	}
-	if (cnt_sha1 > 0) {
-		g_autoptr(GBytes) blob_sha1 = NULL;
-		blob_sha1 = g_bytes_new_static(digest_sha1, sizeof(digest_sha1));
-		g_ptr_array_add(csums, fu_bytes_to_string(blob_sha1));
-	}
-	if (cnt_sha256 > 0) {
-		g_autoptr(GBytes) blob_sha256 = NULL;
-		blob_sha256 = g_bytes_new_static(digest_sha256, sizeof(digest_sha256));
-		g_ptr_array_add(csums, fu_bytes_to_string(blob_sha256));
-	}
-	if (cnt_sha384 > 0) {
-		g_autoptr(GBytes) blob_sha384 = NULL;
-		blob_sha384 = g_bytes_new_static(digest_sha384, sizeof(digest_sha384));
-		g_ptr_array_add(csums, fu_bytes_to_string(blob_sha384));
-	}
 	return g_steal_pointer(&csums);
 }
 
 static void
 fu_tpm_eventlog_init(FuTpmEventlog *self)
 {
+	FuTpmEventlogPrivate *priv = GET_PRIVATE(self);
+	priv->events = g_array_new(FALSE, FALSE, sizeof(FuTpmEventlogEvent));
+}
+
+static void
+fu_tpm_eventlog_finalize(GObject *object)
+{
+	FuTpmEventlog *self = FU_TPM_EVENTLOG(object);
+	FuTpmEventlogPrivate *priv = GET_PRIVATE(self);
+	g_array_unref(priv->events);
+	g_free(priv->pcrs);
+	G_OBJECT_CLASS(fu_tpm_eventlog_parent_class)->finalize(object);
 }
 
 static void
 fu_tpm_eventlog_class_init(FuTpmEventlogClass *klass)
 {
+	GObjectClass *object_class = G_OBJECT_CLASS(klass);
+	object_class->finalize = fu_tpm_eventlog_finalize;
 }
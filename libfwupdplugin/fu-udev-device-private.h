@@ -37,3 +37,11 @@ fu_udev_device_ioctl(FuUdevDevice *self,
 		     guint timeout,
 		     FuIoctlFlags flags,
 		     GError **error) G_GNUC_WARN_UNUSED_RESULT G_GNUC_NON_NULL(1);
+gboolean
+fu_udev_device_prefetch_sysfs(FuUdevDevice *self, GError **error) G_GNUC_NON_NULL(1);
+guint
+fu_udev_device_get_sysfs_cache_hits(FuUdevDevice *self) G_GNUC_NON_NULL(1);
+guint
+fu_udev_device_get_sysfs_cache_misses(FuUdevDevice *self) G_GNUC_NON_NULL(1);
+guint
+fu_udev_device_get_sysfs_prefetch_syscalls(FuUdevDevice *self) G_GNUC_NON_NULL(1);
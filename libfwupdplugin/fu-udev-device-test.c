@@ -32,11 +32,111 @@ fu_udev_device_func(void)
 	g_assert_cmpint(attrs->len, >, 10);
 }
 
+static void
+fu_udev_device_prefetch_func(void)
+{
+#ifdef HAVE_OPENAT
+	gboolean ret;
+	const gchar *attrs[] = {"uevent", "vendor", "device", "class", "sys_vendor", NULL};
+	guint hits;
+	guint syscalls_uncached = 0;
+	g_autofree gchar *prop = NULL;
+	g_autofree gchar *attr_sys_vendor = NULL;
+	g_autofree gchar *attr_chassis_type = NULL;
+	g_autofree gchar *attr_vendor = NULL;
+	g_autofree gchar *sysfs_path = g_test_build_filename(G_TEST_DIST, "tests", NULL);
+	g_autoptr(FuContext) ctx = fu_context_new();
+	g_autoptr(FuUdevDevice) udev_device = fu_udev_device_new(ctx, sysfs_path);
+	g_autoptr(FuUdevDevice) udev_device2 = fu_udev_device_new(ctx, sysfs_path);
+	g_autoptr(GError) error = NULL;
+
+	/* the uncached path needs at least an open, two polls, two reads and a close for each
+	 * attribute that exists, and an open for each one that does not */
+	for (guint i = 0; attrs[i] != NULL; i++) {
+		g_autofree gchar *fn = g_build_filename(sysfs_path, attrs[i], NULL);
+		syscalls_uncached += g_file_test(fn, G_FILE_TEST_EXISTS) ? 6 : 1;
+	}
+
+	/* open the directory, then uevent and sys_vendor, and fail to open the others */
+	fu_udev_device_add_sysfs_prefetch(udev_device, "sys_vendor");
+	ret = fu_udev_device_prefetch_sysfs(udev_device, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	g_assert_cmpint(fu_udev_device_get_sysfs_prefetch_syscalls(udev_device),
+			<,
+			syscalls_uncached);
+
+	/* uevent is cached */
+	prop = fu_udev_device_read_property(udev_device, "MODALIAS", &error);
+	g_assert_no_error(error);
+	g_assert_cmpstr(prop, ==, "hdaudio:v10EC0298r00100103a01");
+	attr_sys_vendor = fu_udev_device_read_sysfs(udev_device,
+						    "sys_vendor",
+						    FU_UDEV_DEVICE_ATTR_READ_TIMEOUT_DEFAULT,
+						    &error);
+	g_assert_no_error(error);
+	g_assert_cmpstr(attr_sys_vendor, ==, "FwupdTest");
+	g_assert_cmpint(fu_udev_device_get_sysfs_cache_hits(udev_device), ==, 2);
+
+	/* known to not exist */
+	attr_vendor = fu_udev_device_read_sysfs(udev_device,
+						"vendor",
+						FU_UDEV_DEVICE_ATTR_READ_TIMEOUT_DEFAULT,
+						&error);
+	g_assert_error(error, FWUPD_ERROR, FWUPD_ERROR_NOT_FOUND);
+	g_assert_null(attr_vendor);
+	g_clear_error(&error);
+	g_assert_cmpint(fu_udev_device_get_sysfs_cache_hits(udev_device), ==, 3);
+
+	/* not prefetched */
+	attr_chassis_type = fu_udev_device_read_sysfs(udev_device,
+						      "chassis_type",
+						      FU_UDEV_DEVICE_ATTR_READ_TIMEOUT_DEFAULT,
+						      &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(attr_chassis_type);
+	g_assert_cmpint(fu_udev_device_get_sysfs_cache_misses(udev_device), ==, 1);
+
+	/* cache is only valid during ->probe */
+	fu_device_probe_complete(FU_DEVICE(udev_device));
+	g_free(attr_sys_vendor);
+	attr_sys_vendor = fu_udev_device_read_sysfs(udev_device,
+						    "sys_vendor",
+						    FU_UDEV_DEVICE_ATTR_READ_TIMEOUT_DEFAULT,
+						    &error);
+	g_assert_no_error(error);
+	g_assert_cmpstr(attr_sys_vendor, ==, "FwupdTest");
+	g_assert_cmpint(fu_udev_device_get_sysfs_cache_hits(udev_device), ==, 3);
+	g_assert_cmpint(fu_udev_device_get_sysfs_cache_misses(udev_device), ==, 1);
+
+	/* not used after ->probe, even before ->probe_complete */
+	fu_udev_device_set_subsystem(udev_device2, "test");
+	fu_udev_device_add_sysfs_prefetch(udev_device2, "sys_vendor");
+	ret = fu_device_probe(FU_DEVICE(udev_device2), &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	hits = fu_udev_device_get_sysfs_cache_hits(udev_device2);
+	g_assert_cmpint(hits, >, 0);
+	g_free(attr_sys_vendor);
+	attr_sys_vendor = fu_udev_device_read_sysfs(udev_device2,
+						    "sys_vendor",
+						    FU_UDEV_DEVICE_ATTR_READ_TIMEOUT_DEFAULT,
+						    &error);
+	g_assert_no_error(error);
+	g_assert_cmpstr(attr_sys_vendor, ==, "FwupdTest");
+	g_assert_cmpint(fu_udev_device_get_sysfs_cache_hits(udev_device2), ==, hits);
+	g_assert_cmpint(fu_udev_device_get_sysfs_cache_misses(udev_device2), ==, 0);
+#else
+	g_test_skip("no openat support");
+#endif
+}
+
 int
 main(int argc, char **argv)
 {
 	(void)g_setenv("G_TEST_SRCDIR", SRCDIR, FALSE);
 	g_test_init(&argc, &argv, NULL);
 	g_test_add_func("/fwupd/udev-device", fu_udev_device_func);
+	g_test_add_func("/fwupd/udev-device/prefetch", fu_udev_device_prefetch_func);
 	return g_test_run();
 }
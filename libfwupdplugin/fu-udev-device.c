@@ -51,6 +51,11 @@ typedef struct {
 	FuIoChannelOpenFlags open_flags;
 	GHashTable *properties;
 	gboolean properties_valid;
+	GPtrArray *sysfs_prefetch; /* (element-type utf8) */
+	GHashTable *sysfs_cache;   /* (nullable): attr:value, or %NULL if not present */
+	guint sysfs_cache_hits;
+	guint sysfs_cache_misses;
+	guint sysfs_prefetch_syscalls;
 } FuUdevDevicePrivate;
 
 G_DEFINE_TYPE_WITH_PRIVATE(FuUdevDevice, fu_udev_device, FU_TYPE_DEVICE);
@@ -71,6 +76,22 @@ static guint signals[SIGNAL_LAST] = {0};
 
 #define GET_PRIVATE(o) (fu_udev_device_get_instance_private(o))
 
+/* sysfs attributes are never larger than one page */
+#define FU_UDEV_DEVICE_SYSFS_PREFETCH_SIZE_MAX 4096
+
+static void
+fu_udev_device_sysfs_cache_clear(FuUdevDevice *self)
+{
+	FuUdevDevicePrivate *priv = GET_PRIVATE(self);
+	if (priv->sysfs_cache == NULL)
+		return;
+	g_debug("sysfs prefetch used %u syscalls, %u hits, %u misses",
+		priv->sysfs_prefetch_syscalls,
+		priv->sysfs_cache_hits,
+		priv->sysfs_cache_misses);
+	g_clear_pointer(&priv->sysfs_cache, g_hash_table_unref);
+}
+
 /**
  * fu_udev_device_emit_changed:
  * @self: a #FuUdevDevice
@@ -359,6 +380,11 @@ fu_udev_device_probe(FuDevice *device, GError **error)
 	g_autofree gchar *subsystem = NULL;
 	g_autofree gchar *attr_device = NULL;
 	g_autofree gchar *attr_vendor = NULL;
+	g_autoptr(GError) error_local = NULL;
+
+	/* read all the attributes we need in one pass */
+	if (!fu_udev_device_prefetch_sysfs(self, &error_local))
+		g_debug("failed to prefetch sysfs attributes: %s", error_local->message);
 
 	/* find the subsystem, driver and devtype */
 	if (priv->subsystem == NULL) {
@@ -530,6 +556,7 @@ fu_udev_device_probe_complete(FuDevice *device)
 	FuUdevDevicePrivate *priv = GET_PRIVATE(self);
 	g_hash_table_remove_all(priv->properties);
 	priv->properties_valid = FALSE;
+	fu_udev_device_sysfs_cache_clear(self);
 }
 
 static gboolean
@@ -641,6 +668,7 @@ fu_udev_device_invalidate(FuDevice *device)
 	FuUdevDevicePrivate *priv = GET_PRIVATE(self);
 	priv->properties_valid = FALSE;
 	g_hash_table_remove_all(priv->properties);
+	fu_udev_device_sysfs_cache_clear(self);
 }
 
 static void
@@ -1096,6 +1124,9 @@ fu_udev_device_open(FuDevice *device, GError **error)
 	FuUdevDevice *self = FU_UDEV_DEVICE(device);
 	FuUdevDevicePrivate *priv = GET_PRIVATE(self);
 
+	/* the prefetched attributes are only valid during ->probe, not ->setup */
+	fu_udev_device_sysfs_cache_clear(self);
+
 	/* emulated */
 	if (fu_device_has_flag(FU_DEVICE(self), FWUPD_DEVICE_FLAG_EMULATED))
 		return TRUE;
@@ -1927,6 +1958,131 @@ fu_udev_device_list_sysfs(FuUdevDevice *self, GError **error)
 	return g_steal_pointer(&attrs);
 }
 
+/**
+ * fu_udev_device_add_sysfs_prefetch:
+ * @self: a #FuUdevDevice
+ * @attr: sysfs attribute name, e.g. `vendor`
+ *
+ * Adds a sysfs attribute that is read along with all the others at the start of ->probe.
+ *
+ * Any calls to fu_udev_device_read_sysfs() for the attribute during ->probe are then returned
+ * from the cache without touching the filesystem. The cache is dropped before ->setup.
+ *
+ * Since: 2.1.6
+ **/
+void
+fu_udev_device_add_sysfs_prefetch(FuUdevDevice *self, const gchar *attr)
+{
+	FuUdevDevicePrivate *priv = GET_PRIVATE(self);
+
+	g_return_if_fail(FU_IS_UDEV_DEVICE(self));
+	g_return_if_fail(attr != NULL);
+
+	for (guint i = 0; i < priv->sysfs_prefetch->len; i++) {
+		const gchar *attr_tmp = g_ptr_array_index(priv->sysfs_prefetch, i);
+		if (g_strcmp0(attr_tmp, attr) == 0)
+			return;
+	}
+	g_ptr_array_add(priv->sysfs_prefetch, g_strdup(attr));
+}
+
+/* private */
+guint
+fu_udev_device_get_sysfs_cache_hits(FuUdevDevice *self)
+{
+	FuUdevDevicePrivate *priv = GET_PRIVATE(self);
+	g_return_val_if_fail(FU_IS_UDEV_DEVICE(self), G_MAXUINT);
+	return priv->sysfs_cache_hits;
+}
+
+/* private */
+guint
+fu_udev_device_get_sysfs_cache_misses(FuUdevDevice *self)
+{
+	FuUdevDevicePrivate *priv = GET_PRIVATE(self);
+	g_return_val_if_fail(FU_IS_UDEV_DEVICE(self), G_MAXUINT);
+	return priv->sysfs_cache_misses;
+}
+
+/* private */
+guint
+fu_udev_device_get_sysfs_prefetch_syscalls(FuUdevDevice *self)
+{
+	FuUdevDevicePrivate *priv = GET_PRIVATE(self);
+	g_return_val_if_fail(FU_IS_UDEV_DEVICE(self), G_MAXUINT);
+	return priv->sysfs_prefetch_syscalls;
+}
+
+/* private: read all the prefetch attributes relative to the sysfs directory, which avoids
+ * the path lookup, poll and timeout handling for each attribute */
+gboolean
+fu_udev_device_prefetch_sysfs(FuUdevDevice *self, GError **error)
+{
+#ifdef HAVE_OPENAT
+	FuUdevDevicePrivate *priv = GET_PRIVATE(self);
+	const gchar *sysfs_path = fu_udev_device_get_sysfs_path(self);
+	gint dirfd;
+
+	g_return_val_if_fail(FU_IS_UDEV_DEVICE(self), FALSE);
+	g_return_val_if_fail(error == NULL || *error == NULL, FALSE);
+
+	/* nothing to do */
+	if (fu_device_has_flag(FU_DEVICE(self), FWUPD_DEVICE_FLAG_EMULATED))
+		return TRUE;
+	if (sysfs_path == NULL || priv->sysfs_prefetch->len == 0)
+		return TRUE;
+
+	dirfd = open(sysfs_path, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+	priv->sysfs_prefetch_syscalls++;
+	if (dirfd < 0) {
+		g_set_error(error,
+			    FWUPD_ERROR,
+			    FWUPD_ERROR_NOT_FOUND,
+			    "failed to open %s: %s",
+			    sysfs_path,
+			    fwupd_strerror(errno));
+		return FALSE;
+	}
+	if (priv->sysfs_cache == NULL) {
+		priv->sysfs_cache =
+		    g_hash_table_new_full(g_str_hash, g_str_equal, g_free, g_free);
+	}
+	for (guint i = 0; i < priv->sysfs_prefetch->len; i++) {
+		const gchar *attr = g_ptr_array_index(priv->sysfs_prefetch, i);
+		gchar buf[FU_UDEV_DEVICE_SYSFS_PREFETCH_SIZE_MAX] = {0x0};
+		gssize bufsz;
+		gint fd;
+
+		fd = openat(dirfd, attr, O_RDONLY | O_CLOEXEC | O_NONBLOCK);
+		priv->sysfs_prefetch_syscalls++;
+		if (fd < 0) {
+			if (errno == ENOENT)
+				g_hash_table_insert(priv->sysfs_cache, g_strdup(attr), NULL);
+			continue;
+		}
+		bufsz = read(fd, buf, sizeof(buf));
+		close(fd);
+		priv->sysfs_prefetch_syscalls += 2;
+
+		/* possibly truncated or not valid, so fall back to reading it later */
+		if (bufsz < 0 || (gsize)bufsz >= sizeof(buf))
+			continue;
+		if (!g_utf8_validate(buf, bufsz, NULL))
+			continue;
+
+		/* remove the trailing newline */
+		if (bufsz > 0 && buf[bufsz - 1] == '\n')
+			bufsz--;
+		g_hash_table_insert(priv->sysfs_cache, g_strdup(attr), g_strndup(buf, bufsz));
+	}
+	close(dirfd);
+	priv->sysfs_prefetch_syscalls++;
+#endif
+
+	/* success */
+	return TRUE;
+}
+
 /**
  * fu_udev_device_read_sysfs:
  * @self: a #FuUdevDevice
@@ -1943,6 +2099,7 @@ fu_udev_device_list_sysfs(FuUdevDevice *self, GError **error)
 gchar *
 fu_udev_device_read_sysfs(FuUdevDevice *self, const gchar *attr, guint timeout_ms, GError **error)
 {
+	FuUdevDevicePrivate *priv = GET_PRIVATE(self);
 	FuDeviceEvent *event = NULL;
 	g_autofree gchar *event_id = NULL;
 	g_autofree gchar *path = NULL;
@@ -1982,6 +2139,32 @@ fu_udev_device_read_sysfs(FuUdevDevice *self, const gchar *attr, guint timeout_m
 		return NULL;
 	}
 	path = g_build_filename(fu_udev_device_get_sysfs_path(self), attr, NULL);
+
+	/* prefetched during probe */
+	if (priv->sysfs_cache != NULL && fu_device_get_done_probe(FU_DEVICE(self)))
+		fu_udev_device_sysfs_cache_clear(self);
+	if (priv->sysfs_cache != NULL) {
+		const gchar *value_tmp = NULL;
+		if (g_hash_table_lookup_extended(priv->sysfs_cache,
+						 attr,
+						 NULL,
+						 (gpointer *)&value_tmp)) {
+			priv->sysfs_cache_hits++;
+			if (value_tmp == NULL) {
+				g_set_error(error,
+					    FWUPD_ERROR,
+					    FWUPD_ERROR_NOT_FOUND,
+					    "failed to open %s: not found",
+					    path);
+				return NULL;
+			}
+			if (event != NULL)
+				fu_device_event_set_str(event, "Data", value_tmp);
+			return g_strdup(value_tmp);
+		}
+		priv->sysfs_cache_misses++;
+	}
+
 	io_channel = fu_io_channel_new_file(path, FU_IO_CHANNEL_OPEN_FLAG_READ, error);
 	if (io_channel == NULL)
 		return NULL;
@@ -2114,6 +2297,7 @@ fu_udev_device_write_sysfs(FuUdevDevice *self,
 			   guint timeout_ms,
 			   GError **error)
 {
+	FuUdevDevicePrivate *priv = GET_PRIVATE(self);
 	FuDeviceEvent *event = NULL;
 	g_autofree gchar *event_id = NULL;
 	g_autofree gchar *path = NULL;
@@ -2149,6 +2333,8 @@ fu_udev_device_write_sysfs(FuUdevDevice *self,
 				    "sysfs_path undefined");
 		return FALSE;
 	}
+	if (priv->sysfs_cache != NULL)
+		g_hash_table_remove(priv->sysfs_cache, attr);
 	path = g_build_filename(fu_udev_device_get_sysfs_path(self), attr, NULL);
 	io_channel = fu_io_channel_new_file(path, FU_IO_CHANNEL_OPEN_FLAG_WRITE, error);
 	if (io_channel == NULL)
@@ -2228,6 +2414,8 @@ fu_udev_device_write_sysfs_byte_array(FuUdevDevice *self,
 				    "sysfs_path undefined");
 		return FALSE;
 	}
+	if (priv->sysfs_cache != NULL)
+		g_hash_table_remove(priv->sysfs_cache, attr);
 	path = g_build_filename(fu_udev_device_get_sysfs_path(self), attr, NULL);
 	io_channel = fu_io_channel_new_file(path, FU_IO_CHANNEL_OPEN_FLAG_WRITE, error);
 	if (io_channel == NULL)
@@ -2307,6 +2495,8 @@ fu_udev_device_write_sysfs_bytes(FuUdevDevice *self,
 				    "sysfs_path undefined");
 		return FALSE;
 	}
+	if (priv->sysfs_cache != NULL)
+		g_hash_table_remove(priv->sysfs_cache, attr);
 	path = g_build_filename(fu_udev_device_get_sysfs_path(self), attr, NULL);
 	io_channel = fu_io_channel_new_file(path, FU_IO_CHANNEL_OPEN_FLAG_WRITE, error);
 	if (io_channel == NULL)
@@ -2593,6 +2783,9 @@ fu_udev_device_finalize(GObject *object)
 	FuUdevDevicePrivate *priv = GET_PRIVATE(self);
 
 	g_hash_table_unref(priv->properties);
+	g_ptr_array_unref(priv->sysfs_prefetch);
+	if (priv->sysfs_cache != NULL)
+		g_hash_table_unref(priv->sysfs_cache);
 	g_free(priv->subsystem);
 	g_free(priv->devtype);
 	g_free(priv->bind_id);
@@ -2621,6 +2814,11 @@ fu_udev_device_init(FuUdevDevice *self)
 {
 	FuUdevDevicePrivate *priv = GET_PRIVATE(self);
 	priv->properties = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, g_free);
+	priv->sysfs_prefetch = g_ptr_array_new_with_free_func(g_free);
+	fu_udev_device_add_sysfs_prefetch(self, "uevent");
+	fu_udev_device_add_sysfs_prefetch(self, "vendor");
+	fu_udev_device_add_sysfs_prefetch(self, "device");
+	fu_udev_device_add_sysfs_prefetch(self, "class");
 	fu_device_set_acquiesce_delay(FU_DEVICE(self), 2500);
 	fu_device_add_flag(FU_DEVICE(self), FWUPD_DEVICE_FLAG_CAN_EMULATION_TAG);
 	fu_device_register_private_flag(FU_DEVICE(self), FU_UDEV_DEVICE_FLAG_SYSFS_USE_PHYSICAL_ID);
@@ -124,6 +124,8 @@ fu_udev_device_read_property(FuUdevDevice *self,
 GPtrArray *
 fu_udev_device_list_sysfs(FuUdevDevice *self, GError **error) G_GNUC_WARN_UNUSED_RESULT
     G_GNUC_NON_NULL(1);
+void
+fu_udev_device_add_sysfs_prefetch(FuUdevDevice *self, const gchar *attr) G_GNUC_NON_NULL(1, 2);
 gchar *
 fu_udev_device_read_sysfs(FuUdevDevice *self, const gchar *attr, guint timeout_ms, GError **error)
     G_GNUC_WARN_UNUSED_RESULT G_GNUC_NON_NULL(1, 2);
@@ -1568,6 +1568,19 @@ fu_usb_device_control_transfer(FuUsbDevice *self,
 	return TRUE;
 }
 
+static gchar *
+fu_usb_device_bulk_transfer_event_id(guint8 endpoint, const guint8 *data, gsize length)
+{
+	g_autofree gchar *data_base64 = fu_base64_encode(data, length);
+	return g_strdup_printf("BulkTransfer:"
+			       "Endpoint=0x%02x,"
+			       "Data=%s,"
+			       "Length=0x%x",
+			       endpoint,
+			       data_base64,
+			       (guint)length);
+}
+
 /**
  * fu_usb_device_bulk_transfer:
  * @self: a #FuUsbDevice
@@ -1613,14 +1626,7 @@ fu_usb_device_bulk_transfer(FuUsbDevice *self,
 	if (fu_device_has_flag(FU_DEVICE(self), FWUPD_DEVICE_FLAG_EMULATED) ||
 	    fu_context_has_flag(fu_device_get_context(FU_DEVICE(self)),
 				FU_CONTEXT_FLAG_SAVE_EVENTS)) {
-		g_autofree gchar *data_base64 = fu_base64_encode(data, length);
-		event_id = g_strdup_printf("BulkTransfer:"
-					   "Endpoint=0x%02x,"
-					   "Data=%s,"
-					   "Length=0x%x",
-					   endpoint,
-					   data_base64,
-					   (guint)length);
+		event_id = fu_usb_device_bulk_transfer_event_id(endpoint, data, length);
 	}
 
 	/* emulated */
@@ -1675,6 +1681,302 @@ fu_usb_device_bulk_transfer(FuUsbDevice *self,
 	return TRUE;
 }
 
+typedef struct {
+	struct libusb_transfer *transfer; /* NULL if emulated */
+	FuDeviceEvent *event;		  /* no-ref */
+	gint completed;
+	gsize actual_length; /* emulated */
+	GError *error;	     /* emulated */
+} FuUsbDeviceTransferHelper;
+
+static void LIBUSB_CALL
+fu_usb_device_bulk_transfer_queue_cb(struct libusb_transfer *transfer)
+{
+	gint *completed = (gint *)transfer->user_data;
+	*completed = 1;
+}
+
+static gboolean
+fu_usb_device_bulk_transfer_queue_check_length(guint8 endpoint,
+					       GByteArray *buf,
+					       gsize actual_length,
+					       GError **error)
+{
+	/* short reads are expected, but a short write means the device lost data */
+	if (endpoint & LIBUSB_ENDPOINT_IN) {
+		g_byte_array_set_size(buf, actual_length);
+		return TRUE;
+	}
+	if (actual_length != buf->len) {
+		g_set_error(error,
+			    FWUPD_ERROR,
+			    FWUPD_ERROR_WRITE,
+			    "only wrote 0x%x of 0x%x bytes",
+			    (guint)actual_length,
+			    buf->len);
+		return FALSE;
+	}
+	return TRUE;
+}
+
+static void
+fu_usb_device_bulk_transfer_queue_wait(libusb_context *usb_ctx, FuUsbDeviceTransferHelper *helper)
+{
+	/* the backend event thread may also be handling events, which libusb allows */
+	if (helper->transfer == NULL)
+		return;
+	while (!helper->completed) {
+		gint rc = libusb_handle_events_completed(usb_ctx, &helper->completed);
+		if (rc < 0 && rc != LIBUSB_ERROR_INTERRUPTED) {
+			g_debug("failed to handle events: %s", libusb_strerror(rc));
+			libusb_cancel_transfer(helper->transfer);
+			continue;
+		}
+		if (helper->transfer->dev_handle == NULL) {
+			helper->transfer->status = LIBUSB_TRANSFER_NO_DEVICE;
+			helper->completed = 1;
+		}
+	}
+}
+
+static void
+fu_usb_device_bulk_transfer_queue_cancel(libusb_context *usb_ctx,
+					 FuUsbDeviceTransferHelper *helpers,
+					 guint idx_start,
+					 guint idx_end)
+{
+	for (guint i = idx_start; i < idx_end; i++) {
+		if (helpers[i].transfer != NULL)
+			libusb_cancel_transfer(helpers[i].transfer);
+	}
+	for (guint i = idx_start; i < idx_end; i++) {
+		if (helpers[i].transfer == NULL) {
+			g_clear_error(&helpers[i].error);
+			continue;
+		}
+		fu_usb_device_bulk_transfer_queue_wait(usb_ctx, &helpers[i]);
+		if (helpers[i].event != NULL) {
+			fu_device_event_set_i64(helpers[i].event,
+						"Status",
+						helpers[i].transfer->status);
+		}
+		libusb_free_transfer(helpers[i].transfer);
+		helpers[i].transfer = NULL;
+	}
+}
+
+static gboolean
+fu_usb_device_bulk_transfer_queue_submit(FuUsbDevice *self,
+					 FuUsbDeviceTransferHelper *helper,
+					 guint8 endpoint,
+					 GByteArray *buf,
+					 guint timeout,
+					 GError **error)
+{
+	FuUsbDevicePrivate *priv = GET_PRIVATE(self);
+	gint rc;
+
+	/* emulated and fuzzed devices complete immediately, using the synchronous events; any
+	 * failure is only reported when the request is completed, just like a real transfer */
+	if (fu_device_has_flag(FU_DEVICE(self), FWUPD_DEVICE_FLAG_EMULATED) ||
+	    fu_device_has_private_flag(FU_DEVICE(self), FU_DEVICE_PRIVATE_FLAG_IS_FAKE)) {
+		(void)fu_usb_device_bulk_transfer(self,
+						  endpoint,
+						  buf->data,
+						  buf->len,
+						  &helper->actual_length,
+						  timeout,
+						  NULL,
+						  &helper->error);
+		helper->completed = 1;
+		return TRUE;
+	}
+
+	/* save, using the same key as the synchronous request so that it can be replayed */
+	if (fu_context_has_flag(fu_device_get_context(FU_DEVICE(self)),
+				FU_CONTEXT_FLAG_SAVE_EVENTS)) {
+		g_autofree gchar *event_id =
+		    fu_usb_device_bulk_transfer_event_id(endpoint, buf->data, buf->len);
+		helper->event = fu_device_save_event(FU_DEVICE(self), event_id);
+	}
+
+	helper->transfer = libusb_alloc_transfer(0);
+	if (helper->transfer == NULL) {
+		g_set_error_literal(error,
+				    FWUPD_ERROR,
+				    FWUPD_ERROR_INTERNAL,
+				    "failed to allocate transfer");
+		return FALSE;
+	}
+	libusb_fill_bulk_transfer(helper->transfer,
+				  priv->handle,
+				  endpoint,
+				  buf->data,
+				  (gint)buf->len,
+				  fu_usb_device_bulk_transfer_queue_cb,
+				  &helper->completed,
+				  timeout);
+	rc = libusb_submit_transfer(helper->transfer);
+	if (rc < 0) {
+		if (helper->event != NULL)
+			fu_device_event_set_i64(helper->event, "Error", rc);
+		libusb_free_transfer(helper->transfer);
+		helper->transfer = NULL;
+		return fu_usb_device_libusb_error_to_gerror(rc, error);
+	}
+	return TRUE;
+}
+
+static gboolean
+fu_usb_device_bulk_transfer_queue_complete(FuUsbDeviceTransferHelper *helper,
+					   guint8 endpoint,
+					   GByteArray *buf,
+					   GError **error)
+{
+	gint status;
+	gint actual_length;
+
+	/* emulated */
+	if (helper->transfer == NULL) {
+		if (helper->error != NULL) {
+			g_propagate_error(error, g_steal_pointer(&helper->error));
+			return FALSE;
+		}
+		return fu_usb_device_bulk_transfer_queue_check_length(endpoint,
+								      buf,
+								      helper->actual_length,
+								      error);
+	}
+
+	status = helper->transfer->status;
+	actual_length = helper->transfer->actual_length;
+	libusb_free_transfer(helper->transfer);
+	helper->transfer = NULL;
+	if (!fu_usb_device_libusb_status_to_gerror(status, error)) {
+		if (helper->event != NULL)
+			fu_device_event_set_i64(helper->event, "Status", status);
+		return FALSE;
+	}
+	if (helper->event != NULL)
+		fu_device_event_set_data(helper->event, "Data", buf->data, actual_length);
+	return fu_usb_device_bulk_transfer_queue_check_length(endpoint, buf, actual_length, error);
+}
+
+/**
+ * fu_usb_device_bulk_transfer_queue:
+ * @self: a #FuUsbDevice
+ * @endpoint: the address of a valid endpoint to communicate with
+ * @bufs: (element-type GByteArray): suitably-sized data buffers for either input or output
+ * @depth: the maximum number of requests to have in flight, e.g. 4
+ * @timeout: timeout (in milliseconds) for each request, or 0 for unlimited
+ * @progress: (nullable): a #FuProgress
+ * @error: (nullable): optional return location for an error
+ *
+ * Perform a number of USB bulk transfers, keeping up to @depth requests submitted to the host
+ * controller so that the device never has to wait for the next packet.
+ *
+ * The requests are always completed in the order of @bufs, and for input endpoints each
+ * buffer is truncated to the number of bytes actually received. A short write is an error.
+ *
+ * Emulated devices replay the same events as calling fu_usb_device_bulk_transfer() for each
+ * buffer in turn, although up to @depth events are loaded ahead of the request being completed.
+ *
+ * Returns: %TRUE on success
+ *
+ * Since: 2.1.6
+ **/
+gboolean
+fu_usb_device_bulk_transfer_queue(FuUsbDevice *self,
+				  guint8 endpoint,
+				  GPtrArray *bufs,
+				  guint depth,
+				  guint timeout,
+				  FuProgress *progress,
+				  GError **error)
+{
+	FuUsbDevicePrivate *priv = GET_PRIVATE(self);
+	libusb_context *usb_ctx;
+	guint idx_submit = 0;
+	g_autofree FuUsbDeviceTransferHelper *helpers = NULL;
+
+	g_return_val_if_fail(FU_IS_USB_DEVICE(self), FALSE);
+	g_return_val_if_fail(bufs != NULL, FALSE);
+	g_return_val_if_fail(progress == NULL || FU_IS_PROGRESS(progress), FALSE);
+	g_return_val_if_fail(error == NULL || *error == NULL, FALSE);
+
+	/* nothing to pipeline */
+	if (depth <= 1) {
+		for (guint i = 0; i < bufs->len; i++) {
+			GByteArray *buf = g_ptr_array_index(bufs, i);
+			gsize actual_length = 0;
+			if (!fu_usb_device_bulk_transfer(self,
+							 endpoint,
+							 buf->data,
+							 buf->len,
+							 &actual_length,
+							 timeout,
+							 NULL,
+							 error))
+				return FALSE;
+			if (!fu_usb_device_bulk_transfer_queue_check_length(endpoint,
+									    buf,
+									    actual_length,
+									    error))
+				return FALSE;
+			if (progress != NULL)
+				fu_progress_set_percentage_full(progress, i + 1, bufs->len);
+		}
+		return TRUE;
+	}
+
+	/* sanity check */
+	if (priv->handle == NULL &&
+	    !fu_device_has_flag(FU_DEVICE(self), FWUPD_DEVICE_FLAG_EMULATED) &&
+	    !fu_device_has_private_flag(FU_DEVICE(self), FU_DEVICE_PRIVATE_FLAG_IS_FAKE))
+		return fu_usb_device_not_open_error(self, error);
+
+	usb_ctx = fu_context_get_data(fu_device_get_context(FU_DEVICE(self)), "libusb_context");
+	helpers = g_new0(FuUsbDeviceTransferHelper, bufs->len);
+	for (guint i = 0; i < bufs->len; i++) {
+		GByteArray *buf = g_ptr_array_index(bufs, i);
+
+		/* keep the pipeline full */
+		for (; idx_submit < bufs->len && idx_submit < i + depth; idx_submit++) {
+			if (!fu_usb_device_bulk_transfer_queue_submit(
+				self,
+				&helpers[idx_submit],
+				endpoint,
+				g_ptr_array_index(bufs, idx_submit),
+				timeout,
+				error)) {
+				fu_usb_device_bulk_transfer_queue_cancel(usb_ctx,
+									 helpers,
+									 i,
+									 idx_submit);
+				return FALSE;
+			}
+		}
+
+		/* complete in order */
+		fu_usb_device_bulk_transfer_queue_wait(usb_ctx, &helpers[i]);
+		if (!fu_usb_device_bulk_transfer_queue_complete(&helpers[i],
+								endpoint,
+								buf,
+								error)) {
+			fu_usb_device_bulk_transfer_queue_cancel(usb_ctx,
+								 helpers,
+								 i + 1,
+								 idx_submit);
+			return FALSE;
+		}
+		if (progress != NULL)
+			fu_progress_set_percentage_full(progress, i + 1, bufs->len);
+	}
+
+	/* success */
+	return TRUE;
+}
+
 /**
  * fu_usb_device_interrupt_transfer:
  * @self: a #FuUsbDevice
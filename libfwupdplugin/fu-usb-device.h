@@ -87,6 +87,14 @@ fu_usb_device_bulk_transfer(FuUsbDevice *self,
 			    GCancellable *cancellable,
 			    GError **error) G_GNUC_NON_NULL(1);
 gboolean
+fu_usb_device_bulk_transfer_queue(FuUsbDevice *self,
+				  guint8 endpoint,
+				  GPtrArray *bufs,
+				  guint depth,
+				  guint timeout,
+				  FuProgress *progress,
+				  GError **error) G_GNUC_NON_NULL(1, 3);
+gboolean
 fu_usb_device_interrupt_transfer(FuUsbDevice *self,
 				 guint8 endpoint,
 				 guint8 *data,
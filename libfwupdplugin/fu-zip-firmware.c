@@ -10,6 +10,7 @@
 
 #include "fu-byte-array.h"
 #include "fu-common.h"
+#include "fu-decompress-input-stream.h"
 #include "fu-partial-input-stream.h"
 #include "fu-path.h"
 #include "fu-string.h"
@@ -60,6 +61,7 @@ fu_zip_firmware_parse_lfh(FuZipFirmware *self,
 	FuZipCompression compression;
 	gsize offset = fu_struct_zip_cdfh_get_offset_lfh(st_cdfh);
 	guint16 lfh_flags;
+	gboolean check_crc = (flags & FU_FIRMWARE_PARSE_FLAG_IGNORE_CHECKSUM) == 0;
 	guint32 actual_crc = 0xFFFFFFFF;
 	guint32 compressed_size;
 	guint32 uncompressed_size;
@@ -209,7 +211,7 @@ fu_zip_firmware_parse_lfh(FuZipFirmware *self,
 				    (guint)uncompressed_size);
 			return NULL;
 		}
-		if ((flags & FU_FIRMWARE_PARSE_FLAG_IGNORE_CHECKSUM) == 0) {
+		if (check_crc) {
 			if (!fu_input_stream_compute_crc32(stream_compressed,
 							   FU_CRC_KIND_B32_STANDARD,
 							   &actual_crc,
@@ -218,35 +220,27 @@ fu_zip_firmware_parse_lfh(FuZipFirmware *self,
 		}
 		if (!fu_firmware_set_stream(zip_file, stream_compressed, error))
 			return NULL;
+	} else if (compression == FU_ZIP_COMPRESSION_DEFLATE && uncompressed_size == 0) {
+		g_autoptr(GBytes) blob_raw = g_bytes_new(NULL, 0);
+		fu_firmware_set_bytes(zip_file, blob_raw);
+		actual_crc = 0x0;
 	} else if (compression == FU_ZIP_COMPRESSION_DEFLATE) {
-		g_autoptr(GBytes) blob_raw = NULL;
-		g_autoptr(GConverter) conv = NULL;
 		g_autoptr(GInputStream) stream_deflate = NULL;
 
-		conv = G_CONVERTER(g_zlib_decompressor_new(G_ZLIB_COMPRESSOR_FORMAT_RAW));
-		if (!g_seekable_seek(G_SEEKABLE(stream_compressed), 0, G_SEEK_SET, NULL, error))
-			return NULL;
-		stream_deflate = g_converter_input_stream_new(stream_compressed, conv);
-		g_filter_input_stream_set_close_base_stream(G_FILTER_INPUT_STREAM(stream_deflate),
-							    FALSE);
-		blob_raw =
-		    fu_input_stream_read_bytes(stream_deflate, 0, uncompressed_size, NULL, error);
-		if (blob_raw == NULL) {
-			g_prefix_error_literal(error, "failed to read compressed stream: ");
+		/* only decompressed when read, where the size and CRC are checked at the end */
+		stream_deflate = fu_decompress_input_stream_new_deflate(stream_compressed,
+									uncompressed_size,
+									error);
+		if (stream_deflate == NULL)
 			return NULL;
+		if (check_crc) {
+			fu_decompress_input_stream_set_crc32(
+			    FU_DECOMPRESS_INPUT_STREAM(stream_deflate),
+			    uncompressed_crc);
+			check_crc = FALSE;
 		}
-		if (g_bytes_get_size(blob_raw) != uncompressed_size) {
-			g_set_error(error,
-				    FWUPD_ERROR,
-				    FWUPD_ERROR_INVALID_DATA,
-				    "invalid decompression, got 0x%x bytes but expected 0x%x",
-				    (guint)g_bytes_get_size(blob_raw),
-				    (guint)uncompressed_size);
+		if (!fu_firmware_set_stream(zip_file, stream_deflate, error))
 			return NULL;
-		}
-		fu_firmware_set_bytes(zip_file, blob_raw);
-		if ((flags & FU_FIRMWARE_PARSE_FLAG_IGNORE_CHECKSUM) == 0)
-			actual_crc = fu_crc32_bytes(FU_CRC_KIND_B32_STANDARD, blob_raw);
 	} else {
 		g_set_error(error,
 			    FWUPD_ERROR,
@@ -258,7 +252,7 @@ fu_zip_firmware_parse_lfh(FuZipFirmware *self,
 	fu_zip_file_set_compression(FU_ZIP_FILE(zip_file), compression);
 
 	/* verify checksum */
-	if ((flags & FU_FIRMWARE_PARSE_FLAG_IGNORE_CHECKSUM) == 0) {
+	if (check_crc) {
 		if (actual_crc != uncompressed_crc) {
 			g_set_error(error,
 				    FWUPD_ERROR,
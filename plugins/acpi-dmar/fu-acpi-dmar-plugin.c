@@ -70,6 +70,7 @@ fu_acpi_dmar_plugin_add_security_attrs(FuPlugin *plugin, FuSecurityAttrs *attrs)
 static void
 fu_acpi_dmar_plugin_init(FuAcpiDmarPlugin *self)
 {
+	fu_plugin_set_security_attrs_depends(FU_PLUGIN(self), FU_SECURITY_ATTRS_DEPENDS_NONE);
 }
 
 static void
@@ -97,6 +97,7 @@ fu_bios_plugin_add_security_attrs(FuPlugin *plugin, FuSecurityAttrs *attrs)
 static void
 fu_bios_plugin_init(FuBiosPlugin *self)
 {
+	fu_plugin_set_security_attrs_depends(FU_PLUGIN(self), FU_SECURITY_ATTRS_DEPENDS_NONE);
 }
 
 static void
@@ -14,6 +14,7 @@
 #include "fu-dfu-device.h"
 #include "fu-dfu-sector.h"
 #include "fu-dfu-target-private.h"
+#include "fu-dfu-target-stm.h"
 
 static gchar *
 fu_dfu_target_sectors_to_string(FuDfuTarget *target)
@@ -125,6 +126,69 @@ fu_dfu_target_dfuse_func(void)
 	g_assert_false(ret);
 }
 
+static FuChunk *
+fu_dfu_target_stm_chunk_new(guint32 address, gsize bufsz, guint8 value)
+{
+	g_autoptr(GBytes) blob = NULL;
+	g_autoptr(FuChunk) chk = NULL;
+	g_autofree guint8 *buf = g_malloc(bufsz);
+
+	memset(buf, value, bufsz);
+	blob = g_bytes_new_take(g_steal_pointer(&buf), bufsz);
+	chk = fu_chunk_bytes_new(blob);
+	fu_chunk_set_address(chk, address);
+	return g_steal_pointer(&chk);
+}
+
+static void
+fu_dfu_target_stm_chunk_is_erased_func(void)
+{
+	GPtrArray *sectors;
+	gboolean ret;
+	g_autoptr(FuContext) ctx = fu_context_new();
+	g_autoptr(FuDfuDevice) device = g_object_new(FU_TYPE_DFU_DEVICE, "context", ctx, NULL);
+	g_autoptr(FuDfuTarget) target = NULL;
+	g_autoptr(FuChunk) chk1 = NULL;
+	g_autoptr(FuChunk) chk2 = NULL;
+	g_autoptr(FuChunk) chk3 = NULL;
+	g_autoptr(FuChunk) chk4 = NULL;
+	g_autoptr(FuChunk) chk5 = NULL;
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GPtrArray) sectors_erased = g_ptr_array_new();
+
+	target = g_object_new(FU_TYPE_DFU_TARGET, NULL);
+	fu_device_set_proxy(FU_DEVICE(target), FU_DEVICE(device));
+	ret = fu_dfu_target_parse_sectors(target, "@Flash /0x08000000/4*001Kg", &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+
+	/* only the first two sectors were erased */
+	sectors = fu_dfu_target_get_sectors(target);
+	g_assert_cmpint(sectors->len, ==, 4);
+	g_ptr_array_add(sectors_erased, g_ptr_array_index(sectors, 0));
+	g_ptr_array_add(sectors_erased, g_ptr_array_index(sectors, 1));
+
+	/* blank, and covering only erased sectors */
+	chk1 = fu_dfu_target_stm_chunk_new(0x08000000, 0x800, 0xFF);
+	g_assert_true(fu_dfu_target_stm_chunk_is_erased(target, sectors_erased, chk1));
+
+	/* not blank */
+	chk2 = fu_dfu_target_stm_chunk_new(0x08000000, 0x400, 0x00);
+	g_assert_false(fu_dfu_target_stm_chunk_is_erased(target, sectors_erased, chk2));
+
+	/* blank, but crossing into a sector that was not erased */
+	chk3 = fu_dfu_target_stm_chunk_new(0x08000400, 0x800, 0xFF);
+	g_assert_false(fu_dfu_target_stm_chunk_is_erased(target, sectors_erased, chk3));
+
+	/* blank, but the sector was not erased */
+	chk4 = fu_dfu_target_stm_chunk_new(0x08000c00, 0x400, 0xFF);
+	g_assert_false(fu_dfu_target_stm_chunk_is_erased(target, sectors_erased, chk4));
+
+	/* no sector at that address */
+	chk5 = fu_dfu_target_stm_chunk_new(0x09000000, 0x400, 0xFF);
+	g_assert_false(fu_dfu_target_stm_chunk_is_erased(target, sectors_erased, chk5));
+}
+
 int
 main(int argc, char **argv)
 {
@@ -132,5 +196,6 @@ main(int argc, char **argv)
 	g_test_init(&argc, &argv, NULL);
 	(void)g_setenv("G_MESSAGES_DEBUG", "all", FALSE);
 	g_test_add_func("/dfu/target/dfuse", fu_dfu_target_dfuse_func);
+	g_test_add_func("/dfu/target/stm/chunk-is-erased", fu_dfu_target_stm_chunk_is_erased_func);
 	return g_test_run();
 }
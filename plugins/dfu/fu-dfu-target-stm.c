@@ -360,6 +360,41 @@ fu_dfu_target_stm_download_element2(FuDfuTarget *target,
 	return TRUE;
 }
 
+/* the chunk only contains the erased value and every sector it covers was erased in pass 2 */
+gboolean
+fu_dfu_target_stm_chunk_is_erased(FuDfuTarget *target, GPtrArray *sectors_array, FuChunk *chk)
+{
+	GPtrArray *sectors = fu_dfu_target_get_sectors(target);
+	const guint8 *buf = fu_chunk_get_data(chk);
+	gsize bufsz = fu_chunk_get_data_sz(chk);
+	gsize address = fu_chunk_get_address(chk);
+
+	for (gsize i = 0; i < bufsz; i++) {
+		if (buf[i] != 0xFF)
+			return FALSE;
+	}
+	while (address < fu_chunk_get_address(chk) + bufsz) {
+		FuDfuSector *sector = NULL;
+
+		/* the sector end is exclusive, so that the next sector is found */
+		for (guint i = 0; i < sectors->len; i++) {
+			FuDfuSector *sector_tmp = g_ptr_array_index(sectors, i);
+			guint32 sector_addr = fu_dfu_sector_get_address(sector_tmp);
+			if (address >= sector_addr &&
+			    address < sector_addr + fu_dfu_sector_get_size(sector_tmp)) {
+				sector = sector_tmp;
+				break;
+			}
+		}
+		if (sector == NULL)
+			return FALSE;
+		if (!g_ptr_array_find(sectors_array, sector, NULL))
+			return FALSE;
+		address = fu_dfu_sector_get_address(sector) + fu_dfu_sector_get_size(sector);
+	}
+	return TRUE;
+}
+
 static gboolean
 fu_dfu_target_stm_download_element3(FuDfuTarget *target,
 				    FuChunkArray *chunks,
@@ -367,8 +402,13 @@ fu_dfu_target_stm_download_element3(FuDfuTarget *target,
 				    FuProgress *progress,
 				    GError **error)
 {
+	FuDevice *proxy;
 	guint zone_last = G_MAXUINT;
 
+	proxy = fu_device_get_proxy(FU_DEVICE(target), error);
+	if (proxy == NULL)
+		return FALSE;
+
 	/* progress */
 	fu_progress_set_id(progress, G_STRLOC);
 	fu_progress_set_steps(progress, fu_chunk_array_length(chunks));
@@ -406,6 +446,15 @@ fu_dfu_target_stm_download_element3(FuDfuTarget *target,
 			zone_last = fu_dfu_sector_get_zone(sector);
 		}
 
+		/* the wBlockNum sets the offset, so blank chunks do not have to be sent at all */
+		if (fu_device_has_private_flag(proxy, FU_DFU_DEVICE_FLAG_SKIP_ERASED_CHUNKS) &&
+		    fu_dfu_target_stm_chunk_is_erased(target, sectors_array, chk_tmp)) {
+			g_debug("skipping erased chunk at 0x%04x",
+				(guint)fu_chunk_get_address(chk_tmp));
+			fu_progress_step_done(progress);
+			continue;
+		}
+
 		/* we have to write one final zero-sized chunk for EOF */
 		bytes_tmp = fu_chunk_get_bytes(chk_tmp);
 		g_debug("writing sector at 0x%04x (0x%zu)",
@@ -425,8 +474,10 @@ fu_dfu_target_stm_download_element3(FuDfuTarget *target,
 		}
 
 		/* getting the status moves the state machine to DNLOAD-IDLE */
-		if (!fu_dfu_target_check_status(target, error))
-			return FALSE;
+		if (fu_device_has_private_flag(proxy, FU_DFU_DEVICE_FLAG_FIXED_DOWNLOAD_DELAY)) {
+			if (!fu_dfu_target_check_status(target, error))
+				return FALSE;
+		}
 
 		/* update UI */
 		fu_progress_step_done(progress);
@@ -17,3 +17,6 @@ struct _FuDfuTargetStmClass {
 
 FuDfuTarget *
 fu_dfu_target_stm_new(void);
+gboolean
+fu_dfu_target_stm_chunk_is_erased(FuDfuTarget *target, GPtrArray *sectors_array, FuChunk *chk)
+    G_GNUC_NON_NULL(1, 2, 3);
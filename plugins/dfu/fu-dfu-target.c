@@ -467,8 +467,8 @@ fu_dfu_target_manifest_wait(FuDfuTarget *self, GError **error)
 	return TRUE;
 }
 
-gboolean
-fu_dfu_target_check_status(FuDfuTarget *self, GError **error)
+static gboolean
+fu_dfu_target_check_status_full(FuDfuTarget *self, guint timeout_ms, GError **error)
 {
 	FuDevice *proxy;
 	FuDfuStatus status;
@@ -478,14 +478,15 @@ fu_dfu_target_check_status(FuDfuTarget *self, GError **error)
 	proxy = fu_device_get_proxy(FU_DEVICE(self), error);
 	if (proxy == NULL)
 		return FALSE;
-	if (!fu_dfu_device_refresh(FU_DFU_DEVICE(proxy), 0, error))
+	if (!fu_dfu_device_refresh(FU_DFU_DEVICE(proxy), timeout_ms, error))
 		return FALSE;
 
-	/* wait for dfuDNBUSY to not be set */
+	/* wait for dfuDNBUSY to not be set, using the bwPollTimeout from the last GetStatus */
 	while (fu_dfu_device_get_state(FU_DFU_DEVICE(proxy)) == FU_DFU_STATE_DFU_DNBUSY) {
-		g_debug("waiting for FU_DFU_STATE_DFU_DNBUSY to clear");
+		g_debug("waiting %ums for FU_DFU_STATE_DFU_DNBUSY to clear",
+			fu_dfu_device_get_download_timeout(FU_DFU_DEVICE(proxy)));
 		fu_device_sleep(proxy, fu_dfu_device_get_download_timeout(FU_DFU_DEVICE(proxy)));
-		if (!fu_dfu_device_refresh(FU_DFU_DEVICE(proxy), 0, error))
+		if (!fu_dfu_device_refresh(FU_DFU_DEVICE(proxy), timeout_ms, error))
 			return FALSE;
 		/* this is a really long time to save fwupd in case
 		 * the device has got wedged */
@@ -529,6 +530,12 @@ fu_dfu_target_check_status(FuDfuTarget *self, GError **error)
 	return FALSE;
 }
 
+gboolean
+fu_dfu_target_check_status(FuDfuTarget *self, GError **error)
+{
+	return fu_dfu_target_check_status_full(self, 0, error);
+}
+
 /**
  * fu_dfu_target_use_alt_setting:
  * @self: a #FuDfuTarget
@@ -692,6 +699,7 @@ fu_dfu_target_download_chunk(FuDfuTarget *self,
 			     GError **error)
 {
 	FuDevice *proxy;
+	guint status_timeout_ms = 0;
 	g_autoptr(GError) error_local = NULL;
 	gsize actual_length;
 
@@ -730,14 +738,22 @@ fu_dfu_target_download_chunk(FuDfuTarget *self,
 	/* for STM32 devices, the action only occurs when we do GetStatus --
 	 * and it can take a long time to complete! */
 	if (fu_dfu_device_get_version(FU_DFU_DEVICE(proxy)) == FU_DFU_FIRMWARE_VERSION_DFUSE) {
-		if (!fu_dfu_device_refresh(FU_DFU_DEVICE(proxy), 35000, error))
+		if (!fu_device_has_private_flag(proxy, FU_DFU_DEVICE_FLAG_FIXED_DOWNLOAD_DELAY)) {
+			status_timeout_ms = 35000;
+		} else if (!fu_dfu_device_refresh(FU_DFU_DEVICE(proxy), 35000, error)) {
 			return FALSE;
+		}
 	}
 
 	/* wait for the device to write contents to the EEPROM */
 	if (buf->len == 0 && fu_dfu_device_get_download_timeout(FU_DFU_DEVICE(proxy)) > 0)
 		fu_progress_set_status(progress, FWUPD_STATUS_DEVICE_BUSY);
-	if (fu_dfu_device_get_download_timeout(FU_DFU_DEVICE(proxy)) > 0) {
+
+	/* the first GetStatus is sent straight away and later polls use the bwPollTimeout,
+	 * unless the device is quirked to need the fixed delay or reports a bogus value */
+	if ((fu_device_has_private_flag(proxy, FU_DFU_DEVICE_FLAG_FIXED_DOWNLOAD_DELAY) ||
+	     fu_device_has_private_flag(proxy, FU_DFU_DEVICE_FLAG_IGNORE_POLLTIMEOUT)) &&
+	    fu_dfu_device_get_download_timeout(FU_DFU_DEVICE(proxy)) > 0) {
 		g_debug("sleeping for %ums…",
 			fu_dfu_device_get_download_timeout(FU_DFU_DEVICE(proxy)));
 		fu_device_sleep(FU_DEVICE(proxy),
@@ -745,7 +761,7 @@ fu_dfu_target_download_chunk(FuDfuTarget *self,
 	}
 
 	/* find out if the write was successful, waiting for BUSY to clear */
-	if (!fu_dfu_target_check_status(self, error)) {
+	if (!fu_dfu_target_check_status_full(self, status_timeout_ms, error)) {
 		g_prefix_error_literal(error, "cannot wait for busy: ");
 		return FALSE;
 	}
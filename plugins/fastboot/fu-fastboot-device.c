@@ -16,6 +16,8 @@
 #define FASTBOOT_EP_IN			   0x81
 #define FASTBOOT_EP_OUT			   0x01
 #define FASTBOOT_CMD_BUFSZ		   64 /* bytes */
+#define FASTBOOT_TRANSFER_QUEUE_DEPTH	   4
+#define FASTBOOT_TRANSFER_QUEUE_BATCH	   64 /* chunks */
 
 struct _FuFastbootDevice {
 	FuUsbDevice parent_instance;
@@ -253,6 +255,50 @@ fu_fastboot_device_flash(FuFastbootDevice *self,
 				      error);
 }
 
+static gboolean
+fu_fastboot_device_write_queue(FuFastbootDevice *self,
+			       FuChunkArray *chunks,
+			       FuProgress *progress,
+			       GError **error)
+{
+	guint chunks_len = fu_chunk_array_length(chunks);
+
+	/* keep the next packets queued while the device is busy with the current one */
+	for (guint i = 0; i < chunks_len; i += FASTBOOT_TRANSFER_QUEUE_BATCH) {
+		g_autoptr(GPtrArray) bufs =
+		    g_ptr_array_new_with_free_func((GDestroyNotify)g_byte_array_unref);
+
+		for (guint j = i; j < MIN(i + FASTBOOT_TRANSFER_QUEUE_BATCH, chunks_len); j++) {
+			GByteArray *buf = g_byte_array_new();
+			g_autoptr(FuChunk) chk = NULL;
+
+			g_ptr_array_add(bufs, buf);
+			chk = fu_chunk_array_index(chunks, j, error);
+			if (chk == NULL)
+				return FALSE;
+			fu_dump_raw(G_LOG_DOMAIN,
+				    "writing",
+				    fu_chunk_get_data(chk),
+				    fu_chunk_get_data_sz(chk));
+			g_byte_array_append(buf, fu_chunk_get_data(chk), fu_chunk_get_data_sz(chk));
+		}
+		if (!fu_usb_device_bulk_transfer_queue(FU_USB_DEVICE(self),
+						       FASTBOOT_EP_OUT,
+						       bufs,
+						       FASTBOOT_TRANSFER_QUEUE_DEPTH,
+						       FASTBOOT_TRANSACTION_TIMEOUT,
+						       NULL,
+						       error)) {
+			g_prefix_error_literal(error, "failed to do bulk transfer: ");
+			return FALSE;
+		}
+		fu_progress_set_percentage_full(progress, i + bufs->len, chunks_len);
+	}
+
+	/* success */
+	return TRUE;
+}
+
 static gboolean
 fu_fastboot_device_download(FuFastbootDevice *self,
 			    GBytes *fw,
@@ -277,6 +323,15 @@ fu_fastboot_device_download(FuFastbootDevice *self,
 					       FU_CHUNK_ADDR_OFFSET_NONE,
 					       FU_CHUNK_PAGESZ_NONE,
 					       self->blocksz);
+	if (fu_device_has_private_flag(FU_DEVICE(self), FU_FASTBOOT_DEVICE_FLAG_TRANSFER_QUEUE)) {
+		if (!fu_fastboot_device_write_queue(self, chunks, progress, error))
+			return FALSE;
+		return fu_fastboot_device_read(self,
+					       NULL,
+					       progress,
+					       FU_FASTBOOT_DEVICE_READ_FLAG_STATUS_POLL,
+					       error);
+	}
 	fu_progress_set_id(progress, G_STRLOC);
 	fu_progress_set_steps(progress, fu_chunk_array_length(chunks));
 	for (guint i = 0; i < fu_chunk_array_length(chunks); i++) {
@@ -739,6 +794,7 @@ fu_fastboot_device_init(FuFastbootDevice *self)
 	fu_device_set_remove_delay(FU_DEVICE(self), FASTBOOT_REMOVE_DELAY_RE_ENUMERATE);
 	fu_device_set_firmware_gtype(FU_DEVICE(self), FU_TYPE_ZIP_FIRMWARE);
 	fu_usb_device_set_claim_retry_count(FU_USB_DEVICE(self), 5);
+	fu_device_register_private_flag(FU_DEVICE(self), FU_FASTBOOT_DEVICE_FLAG_TRANSFER_QUEUE);
 }
 
 static void
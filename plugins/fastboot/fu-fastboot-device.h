@@ -10,3 +10,5 @@
 
 #define FU_TYPE_FASTBOOT_DEVICE (fu_fastboot_device_get_type())
 G_DECLARE_FINAL_TYPE(FuFastbootDevice, fu_fastboot_device, FU, FASTBOOT_DEVICE, FuUsbDevice)
+
+#define FU_FASTBOOT_DEVICE_FLAG_TRANSFER_QUEUE "transfer-queue"
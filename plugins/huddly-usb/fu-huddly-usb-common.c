@@ -66,6 +66,46 @@ fu_huddly_usb_hlink_msg_write(FuHuddlyUsbHLinkMsg *msg, GError **error)
 	return g_steal_pointer(&packet);
 }
 
+GInputStream *
+fu_huddly_usb_hlink_msg_write_stream(const gchar *msg_name, GInputStream *payload, GError **error)
+{
+	gsize payloadsz = 0;
+	g_autoptr(FuStructHLinkHeader) st = fu_struct_h_link_header_new();
+	g_autoptr(GByteArray) buf = g_byte_array_new();
+	g_autoptr(GBytes) blob = NULL;
+	g_autoptr(GInputStream) composite = fu_composite_input_stream_new();
+
+	g_return_val_if_fail(msg_name != NULL, NULL);
+	g_return_val_if_fail(G_IS_INPUT_STREAM(payload), NULL);
+	g_return_val_if_fail(error == NULL || *error == NULL, NULL);
+
+	if (!fu_input_stream_size(payload, &payloadsz, error))
+		return NULL;
+	if (payloadsz > G_MAXUINT32) {
+		g_set_error_literal(error,
+				    FWUPD_ERROR,
+				    FWUPD_ERROR_INVALID_DATA,
+				    "HLink payload too large");
+		return NULL;
+	}
+	fu_struct_h_link_header_set_msg_name_size(st, strlen(msg_name));
+	fu_struct_h_link_header_set_payload_size(st, payloadsz);
+	fu_byte_array_append_array(buf, st->buf);
+	g_byte_array_append(buf, (const guint8 *)msg_name, strlen(msg_name));
+
+	/* the payload is only read when the stream is */
+	blob = g_bytes_new(buf->data, buf->len);
+	if (!fu_composite_input_stream_add_bytes(FU_COMPOSITE_INPUT_STREAM(composite),
+						 blob,
+						 error))
+		return NULL;
+	if (!fu_composite_input_stream_add_stream(FU_COMPOSITE_INPUT_STREAM(composite),
+						  payload,
+						  error))
+		return NULL;
+	return g_steal_pointer(&composite);
+}
+
 FuHuddlyUsbHLinkMsg *
 fu_huddly_usb_hlink_msg_parse(const guint8 *buf, gsize bufsz, GError **error)
 {
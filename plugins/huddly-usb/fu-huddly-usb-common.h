@@ -20,6 +20,8 @@ FuHuddlyUsbHLinkMsg *
 fu_huddly_usb_hlink_msg_new_string(const gchar *msg_name, const gchar *payload);
 GByteArray *
 fu_huddly_usb_hlink_msg_write(FuHuddlyUsbHLinkMsg *msg, GError **error);
+GInputStream *
+fu_huddly_usb_hlink_msg_write_stream(const gchar *msg_name, GInputStream *payload, GError **error);
 FuHuddlyUsbHLinkMsg *
 fu_huddly_usb_hlink_msg_parse(const guint8 *buf, gsize bufsz, GError **error);
 
@@ -107,6 +107,57 @@ fu_huddly_usb_device_bulk_write(FuHuddlyUsbDevice *self,
 	return TRUE;
 }
 
+static gboolean
+fu_huddly_usb_device_bulk_write_stream(FuHuddlyUsbDevice *self,
+				       GInputStream *stream,
+				       FuProgress *progress,
+				       GError **error)
+{
+	gsize offset = 0;
+	gsize streamsz = 0;
+	const gsize max_chunk_size = 16 * FU_KB;
+	g_autofree guint8 *buf = g_malloc0(max_chunk_size);
+
+	if (!fu_input_stream_size(stream, &streamsz, error))
+		return FALSE;
+	fu_progress_set_id(progress, G_STRLOC);
+	while (offset < streamsz) {
+		gsize transmitted = 0;
+		gsize chunk_size = MIN(streamsz - offset, max_chunk_size);
+
+		/* only one chunk of the stream is in memory at any time */
+		if (!fu_input_stream_read_safe(stream,
+					       buf,
+					       max_chunk_size,
+					       0x0,
+					       offset, /* seek */
+					       chunk_size,
+					       error))
+			return FALSE;
+		if (!fu_usb_device_bulk_transfer(FU_USB_DEVICE(self),
+						 self->bulk_ep[EP_OUT],
+						 buf,
+						 chunk_size,
+						 &transmitted,
+						 5000,
+						 NULL,
+						 error)) {
+			return FALSE;
+		}
+		if (transmitted == 0) {
+			g_set_error_literal(error,
+					    FWUPD_ERROR,
+					    FWUPD_ERROR_WRITE,
+					    "no data was transmitted");
+			return FALSE;
+		}
+		if (!fu_size_checked_inc(&offset, transmitted, error))
+			return FALSE;
+		fu_progress_set_percentage_full(progress, offset, streamsz);
+	}
+	return TRUE;
+}
+
 static gboolean
 fu_huddly_usb_device_bulk_read(FuHuddlyUsbDevice *self,
 			       GByteArray *buf,
@@ -297,10 +348,9 @@ fu_huddly_usb_device_hcp_write_file(FuHuddlyUsbDevice *self,
 				    FuProgress *progress,
 				    GError **error)
 {
-	g_autoptr(FuHuddlyUsbHLinkMsg) msg_req = NULL;
 	g_autoptr(FuHuddlyUsbHLinkMsg) msg_res = NULL;
-	g_autoptr(GByteArray) buf = NULL;
-	g_autoptr(GByteArray) payload_msgpack = NULL;
+	g_autoptr(GInputStream) payload_msgpack = NULL;
+	g_autoptr(GInputStream) stream_req = NULL;
 	g_autoptr(GPtrArray) rcv_items = NULL;
 	g_autoptr(GPtrArray) msgpack_items =
 	    g_ptr_array_new_with_free_func((GDestroyNotify)g_object_unref);
@@ -312,15 +362,16 @@ fu_huddly_usb_device_hcp_write_file(FuHuddlyUsbDevice *self,
 	g_ptr_array_add(msgpack_items, fu_msgpack_item_new_string(filename));
 	g_ptr_array_add(msgpack_items, fu_msgpack_item_new_string("file_data"));
 	g_ptr_array_add(msgpack_items, fu_msgpack_item_new_binary_stream(stream));
-	payload_msgpack = fu_msgpack_write(msgpack_items, error);
-	msg_req = fu_huddly_usb_hlink_msg_new("hcp/write", payload_msgpack);
-	buf = fu_huddly_usb_hlink_msg_write(msg_req, error);
-	if (buf == NULL)
+	payload_msgpack = fu_msgpack_write_stream(msgpack_items, error);
+	if (payload_msgpack == NULL)
+		return FALSE;
+	stream_req = fu_huddly_usb_hlink_msg_write_stream("hcp/write", payload_msgpack, error);
+	if (stream_req == NULL)
 		return FALSE;
 
 	if (!fu_huddly_usb_device_hlink_subscribe(self, "hcp/write_reply", error))
 		return FALSE;
-	if (!fu_huddly_usb_device_bulk_write(self, buf, progress, error))
+	if (!fu_huddly_usb_device_bulk_write_stream(self, stream_req, progress, error))
 		return FALSE;
 
 	/* read reply and check status */
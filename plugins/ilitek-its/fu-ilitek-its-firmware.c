@@ -37,7 +37,7 @@ fu_ilitek_its_firmware_parse(FuFirmware *firmware,
 {
 	FuFirmwareClass *klass = FU_FIRMWARE_CLASS(fu_ilitek_its_firmware_parent_class);
 	FuIlitekItsFirmware *self = FU_ILITEK_ITS_FIRMWARE(firmware);
-	GPtrArray *records = fu_ihex_firmware_get_records(FU_IHEX_FIRMWARE(firmware));
+	GPtrArray *records;
 	FuIhexFirmwareRecord *rcd = NULL;
 	guint32 mm_ver;
 	guint32 start_addr;
@@ -54,6 +54,9 @@ fu_ilitek_its_firmware_parse(FuFirmware *firmware,
 	    "\xFF\xFF\xFF\xFF\xFF\xFF\xFF\xFF\xFF\xFF\xFF\xFF\xFF\xFF\xFF\xFFILITek END TAG  ";
 
 	/* first line is ILITEK-specific record type as memory mapping addr. */
+	if (!fu_ihex_firmware_ensure_records(FU_IHEX_FIRMWARE(firmware), error))
+		return FALSE;
+	records = fu_ihex_firmware_get_records(FU_IHEX_FIRMWARE(firmware));
 	if (records->len == 0) {
 		g_set_error_literal(error, FWUPD_ERROR, FWUPD_ERROR_INVALID_DATA, "no records");
 		return FALSE;
@@ -95,6 +95,9 @@ static void
 fu_iommu_plugin_init(FuIommuPlugin *self)
 {
 	fu_plugin_register_private_flag(FU_PLUGIN(self), FU_IOMMU_PLUGIN_FLAG_HAS_IOMMU);
+	fu_plugin_set_security_attrs_depends(FU_PLUGIN(self),
+					     FU_SECURITY_ATTRS_DEPENDS_DEVICES |
+						 FU_SECURITY_ATTRS_DEPENDS_KERNEL);
 }
 
 static void
@@ -199,6 +199,7 @@ fu_linux_lockdown_plugin_to_string(FuPlugin *plugin, guint idt, GString *str)
 static void
 fu_linux_lockdown_plugin_init(FuLinuxLockdownPlugin *self)
 {
+	fu_plugin_set_security_attrs_depends(FU_PLUGIN(self), FU_SECURITY_ATTRS_DEPENDS_KERNEL);
 }
 
 static void
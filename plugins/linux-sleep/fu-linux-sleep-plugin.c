@@ -67,6 +67,7 @@ fu_linux_sleep_plugin_add_security_attrs(FuPlugin *plugin, FuSecurityAttrs *attr
 static void
 fu_linux_sleep_plugin_init(FuLinuxSleepPlugin *self)
 {
+	fu_plugin_set_security_attrs_depends(FU_PLUGIN(self), FU_SECURITY_ATTRS_DEPENDS_KERNEL);
 }
 
 static void
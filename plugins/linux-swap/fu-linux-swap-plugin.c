@@ -114,6 +114,7 @@ fu_linux_swap_plugin_add_security_attrs(FuPlugin *plugin, FuSecurityAttrs *attrs
 static void
 fu_linux_swap_plugin_init(FuLinuxSwapPlugin *self)
 {
+	fu_plugin_set_security_attrs_depends(FU_PLUGIN(self), FU_SECURITY_ATTRS_DEPENDS_KERNEL);
 }
 
 static void
@@ -139,6 +139,7 @@ fu_linux_tainted_plugin_add_security_attrs(FuPlugin *plugin, FuSecurityAttrs *at
 static void
 fu_linux_tainted_plugin_init(FuLinuxTaintedPlugin *self)
 {
+	fu_plugin_set_security_attrs_depends(FU_PLUGIN(self), FU_SECURITY_ATTRS_DEPENDS_KERNEL);
 }
 
 static void
@@ -323,6 +323,8 @@ fu_logitech_hidpp_bootloader_nordic_write_firmware(FuDevice *device,
 	fu_progress_step_done(progress);
 
 	/* transfer payload */
+	if (!fu_ihex_firmware_ensure_records(FU_IHEX_FIRMWARE(firmware), error))
+		return FALSE;
 	records = fu_ihex_firmware_get_records(FU_IHEX_FIRMWARE(firmware));
 	pkts = fu_logitech_hidpp_bootloader_parse_pkts(self, records, error);
 	if (pkts == NULL)
@@ -1160,6 +1160,10 @@ fu_mtd_device_init(FuMtdDevice *self)
 	fu_device_add_icon(FU_DEVICE(self), FU_DEVICE_ICON_DRIVE_SSD);
 	fu_udev_device_add_open_flag(FU_UDEV_DEVICE(self), FU_IO_CHANNEL_OPEN_FLAG_READ);
 	fu_udev_device_add_open_flag(FU_UDEV_DEVICE(self), FU_IO_CHANNEL_OPEN_FLAG_SYNC);
+	fu_udev_device_add_sysfs_prefetch(FU_UDEV_DEVICE(self), "flags");
+	fu_udev_device_add_sysfs_prefetch(FU_UDEV_DEVICE(self), "name");
+	fu_udev_device_add_sysfs_prefetch(FU_UDEV_DEVICE(self), "size");
+	fu_udev_device_add_sysfs_prefetch(FU_UDEV_DEVICE(self), "erasesize");
 }
 
 static void
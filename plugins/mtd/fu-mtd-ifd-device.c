@@ -156,10 +156,10 @@ fu_mtd_ifd_device_prepare_firmware(FuDevice *device,
 		return NULL;
 	}
 
-	/* parse as Intel Flash Descriptor or IFD image */
+	/* parse as Intel Flash Descriptor or IFD image, deferring the regions not written */
 	firmware = fu_firmware_new_from_gtypes(stream,
 					       0x0,
-					       flags,
+					       flags | FU_FIRMWARE_PARSE_FLAG_LAZY,
 					       error,
 					       FU_TYPE_IFD_FIRMWARE,
 					       FU_TYPE_IFD_IMAGE,
@@ -189,6 +189,10 @@ fu_mtd_ifd_device_prepare_firmware(FuDevice *device,
 		fu_firmware_set_addr(img, fu_firmware_get_addr(FU_FIRMWARE(self->img)));
 	}
 
+	/* the region being written is always validated in full */
+	if (!fu_firmware_ensure_images_parsed(img, error))
+		return NULL;
+
 	/* sanity check */
 	if (fu_firmware_get_size(img) > fu_firmware_get_size(FU_FIRMWARE(self->img))) {
 		g_set_error(error,
@@ -209,6 +209,7 @@ fu_pci_bcr_plugin_init(FuPciBcrPlugin *self)
 	/* this is true except for some Atoms */
 	self->bcr_addr = 0xdc;
 	fu_plugin_register_private_flag(FU_PLUGIN(self), FU_PCI_BCR_PLUGIN_FLAG_HAS_DEVICE);
+	fu_plugin_set_security_attrs_depends(FU_PLUGIN(self), FU_SECURITY_ATTRS_DEPENDS_DEVICES);
 }
 
 static void
@@ -639,9 +639,14 @@ fu_synaptics_cxaudio_device_write_firmware(FuDevice *device,
 					   GError **error)
 {
 	FuSynapticsCxaudioDevice *self = FU_SYNAPTICS_CXAUDIO_DEVICE(device);
-	GPtrArray *records = fu_srec_firmware_get_records(FU_SREC_FIRMWARE(firmware));
+	GPtrArray *records;
 	FuSynapticsCxaudioFileKind file_kind;
 
+	/* build the records */
+	if (!fu_srec_firmware_ensure_records(FU_SREC_FIRMWARE(firmware), error))
+		return FALSE;
+	records = fu_srec_firmware_get_records(FU_SREC_FIRMWARE(firmware));
+
 	/* progress */
 	fu_progress_set_id(progress, G_STRLOC);
 	fu_progress_add_step(progress, FWUPD_STATUS_DEVICE_BUSY, 3, "park");
@@ -158,13 +158,18 @@ fu_synaptics_cxaudio_firmware_parse(FuFirmware *firmware,
 				    GError **error)
 {
 	FuSynapticsCxaudioFirmware *self = FU_SYNAPTICS_CXAUDIO_FIRMWARE(firmware);
-	GPtrArray *records = fu_srec_firmware_get_records(FU_SREC_FIRMWARE(firmware));
+	GPtrArray *records;
 	guint8 dev_kind_candidate = G_MAXUINT8;
 	g_autoptr(FuStructSynapticsCxaudioCustomInfo) st = NULL;
 	g_autoptr(FuStructSynapticsCxaudioValiditySignature) st_sig = NULL;
 	g_autoptr(FuStructSynapticsCxaudioPatchInfo) st_pat = NULL;
 	guint8 shadow[FU_SYNAPTICS_CXAUDIO_EEPROM_SHADOW_SIZE] = {0x0};
 
+	/* build the records */
+	if (!fu_srec_firmware_ensure_records(FU_SREC_FIRMWARE(firmware), error))
+		return FALSE;
+	records = fu_srec_firmware_get_records(FU_SREC_FIRMWARE(firmware));
+
 	/* copy shadow EEPROM */
 	for (guint i = 0; i < records->len; i++) {
 		FuSrecFirmwareRecord *rcd = g_ptr_array_index(records, i);
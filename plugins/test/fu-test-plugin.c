@@ -11,6 +11,7 @@
 
 struct _FuTestPlugin {
 	FuPlugin parent_instance;
+	guint security_attrs_cnt;
 };
 
 G_DEFINE_TYPE(FuTestPlugin, fu_test_plugin, FU_TYPE_PLUGIN)
@@ -86,6 +87,7 @@ fu_test_plugin_modify_config(FuPlugin *plugin, const gchar *key, const gchar *va
 			       "RegistrationSupported",
 			       "RequestDelay",
 			       "RequestSupported",
+			       "SecurityAttrs",
 			       "VerifyDelay",
 			       "WriteDelay",
 			       "WriteSupported",
@@ -101,6 +103,25 @@ fu_test_plugin_modify_config(FuPlugin *plugin, const gchar *key, const gchar *va
 	return fu_plugin_set_config_value(plugin, key, value, error);
 }
 
+static void
+fu_test_plugin_add_security_attrs(FuPlugin *plugin, FuSecurityAttrs *attrs)
+{
+	FuTestPlugin *self = FU_TEST_PLUGIN(plugin);
+	g_autofree gchar *cnt = NULL;
+	g_autoptr(FwupdSecurityAttr) attr = NULL;
+
+	if (!fu_plugin_get_config_value_boolean(plugin, "SecurityAttrs"))
+		return;
+
+	/* record how many times this has been called */
+	cnt = g_strdup_printf("%u", ++self->security_attrs_cnt);
+	attr = fu_plugin_security_attr_new(plugin, FWUPD_SECURITY_ATTR_ID_SPI_BIOSWE);
+	fwupd_security_attr_add_metadata(attr, "Count", cnt);
+	fwupd_security_attr_add_flag(attr, FWUPD_SECURITY_ATTR_FLAG_SUCCESS);
+	fwupd_security_attr_set_result(attr, FWUPD_SECURITY_ATTR_RESULT_ENABLED);
+	fu_security_attrs_append(attrs, attr);
+}
+
 static void
 fu_test_plugin_device_registered(FuPlugin *plugin, FuDevice *device)
 {
@@ -402,6 +423,7 @@ fu_test_plugin_constructed(GObject *obj)
 	fu_plugin_set_config_default(plugin, "RegistrationSupported", "false");
 	fu_plugin_set_config_default(plugin, "RequestDelay", "10"); /* ms */
 	fu_plugin_set_config_default(plugin, "RequestSupported", "false");
+	fu_plugin_set_config_default(plugin, "SecurityAttrs", "false");
 	fu_plugin_set_config_default(plugin, "VerifyDelay", "0");
 	fu_plugin_set_config_default(plugin, "WriteDelay", "0");
 	fu_plugin_set_config_default(plugin, "WriteSupported", "true");
@@ -434,5 +456,6 @@ fu_test_plugin_class_init(FuTestPluginClass *klass)
 	plugin_class->attach = fu_test_plugin_attach;
 	plugin_class->coldplug = fu_test_plugin_coldplug;
 	plugin_class->device_registered = fu_test_plugin_device_registered;
+	plugin_class->add_security_attrs = fu_test_plugin_add_security_attrs;
 	plugin_class->modify_config = fu_test_plugin_modify_config;
 }
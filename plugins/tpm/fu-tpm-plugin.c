@@ -456,6 +456,7 @@ fu_tpm_plugin_coldplug(FuPlugin *plugin, FuProgress *progress, GError **error)
 static void
 fu_tpm_plugin_init(FuTpmPlugin *self)
 {
+	fu_plugin_set_security_attrs_depends(FU_PLUGIN(self), FU_SECURITY_ATTRS_DEPENDS_DEVICES);
 }
 
 static void
@@ -10,6 +10,7 @@
 
 #include "fu-context-private.h"
 #include "fu-efi-signature-private.h"
+#include "fu-uefi-dbx-common.h"
 #include "fu-uefi-dbx-device.h"
 #include "fu-uefi-device-private.h"
 
@@ -114,6 +115,96 @@ fu_efi_image_func(void)
 	}
 }
 
+static void
+fu_uefi_dbx_authenticode_cache_func(void)
+{
+	const gchar *checksum_bootmgr =
+	    "fd26aad248cc1e21e0c6b453212b2b309f7e221047bf22500ed0f8ce30bd1610";
+	const gchar *checksum_fake =
+	    "1111111111111111111111111111111111111111111111111111111111111111";
+	g_autofree gchar *csum1 = NULL;
+	g_autofree gchar *csum2 = NULL;
+	g_autofree gchar *csum3 = NULL;
+	g_autofree gchar *csum4 = NULL;
+	g_autofree gchar *csum5 = NULL;
+	g_autofree gchar *fn = NULL;
+	g_autofree gchar *key = NULL;
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GKeyFile) cache = g_key_file_new();
+
+	fn = g_test_build_filename(G_TEST_DIST, "tests", "bootmgr.efi", NULL);
+	if (!g_file_test(fn, G_FILE_TEST_EXISTS)) {
+		g_test_skip("failed to find file bootmgr.efi");
+		return;
+	}
+
+	/* not in the cache */
+	csum1 = fu_uefi_dbx_get_authenticode_hash(cache, fn, &error);
+	g_assert_no_error(error);
+	g_assert_cmpstr(csum1, ==, checksum_bootmgr);
+	key = g_key_file_get_string(cache, fn, "Key", &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(key);
+
+	/* file is unchanged, so the PE file is not parsed again */
+	g_key_file_set_string(cache, fn, "Checksum", checksum_fake);
+	csum2 = fu_uefi_dbx_get_authenticode_hash(cache, fn, &error);
+	g_assert_no_error(error);
+	g_assert_cmpstr(csum2, ==, checksum_fake);
+
+	/* cached checksum cannot be decoded */
+	g_key_file_set_string(cache, fn, "Checksum", "ZZZZ");
+	csum3 = fu_uefi_dbx_get_authenticode_hash(cache, fn, &error);
+	g_assert_no_error(error);
+	g_assert_cmpstr(csum3, ==, checksum_bootmgr);
+
+	/* cached checksum is the wrong size */
+	g_key_file_set_string(cache, fn, "Checksum", "deadbeef");
+	csum4 = fu_uefi_dbx_get_authenticode_hash(cache, fn, &error);
+	g_assert_no_error(error);
+	g_assert_cmpstr(csum4, ==, checksum_bootmgr);
+
+	/* file has changed */
+	g_key_file_set_string(cache, fn, "Checksum", checksum_fake);
+	g_key_file_set_string(cache, fn, "Key", "0:0:0.000000:0.000000");
+	csum5 = fu_uefi_dbx_get_authenticode_hash(cache, fn, &error);
+	g_assert_no_error(error);
+	g_assert_cmpstr(csum5, ==, checksum_bootmgr);
+}
+
+static void
+fu_uefi_dbx_checksums_func(void)
+{
+	g_autoptr(FuEfiSignature) sig = fu_efi_signature_new(FU_EFI_SIGNATURE_KIND_SHA256);
+	g_autoptr(FuEfiSignature) sig_empty = fu_efi_signature_new(FU_EFI_SIGNATURE_KIND_SHA256);
+	g_autoptr(FuFirmware) siglist = fu_efi_signature_list_new();
+	g_autoptr(GBytes) csum1 = NULL;
+	g_autoptr(GBytes) csum2 = NULL;
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GHashTable) checksums = NULL;
+
+	csum1 =
+	    fu_bytes_from_string("fd26aad248cc1e21e0c6b453212b2b309f7e221047bf22500ed0f8ce30bd1610",
+				 &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(csum1);
+	fu_firmware_set_bytes(FU_FIRMWARE(sig), csum1);
+
+	/* a signature with no data is ignored, and does not hide the signatures after it */
+	fu_firmware_add_image(siglist, FU_FIRMWARE(sig_empty), NULL);
+	fu_firmware_add_image(siglist, FU_FIRMWARE(sig), NULL);
+
+	checksums = fu_uefi_dbx_signature_list_get_checksums(FU_EFI_SIGNATURE_LIST(siglist));
+	g_assert_nonnull(checksums);
+	g_assert_cmpint(g_hash_table_size(checksums), ==, 1);
+	g_assert_true(g_hash_table_contains(checksums, csum1));
+	csum2 =
+	    fu_bytes_from_string("6e0f01e7018c90a1e3d24908956fbeffd29a620c6c5f3ffa3feb2f2802ed4448",
+				 &error);
+	g_assert_no_error(error);
+	g_assert_false(g_hash_table_contains(checksums, csum2));
+}
+
 static void
 fu_uefi_dbx_not_present_func(void)
 {
@@ -174,6 +265,8 @@ main(int argc, char **argv)
 	g_test_init(&argc, &argv, NULL);
 	g_test_add_func("/uefi-dbx/image", fu_efi_image_func);
 	g_test_add_func("/uefi-dbx/zero", fu_uefi_dbx_zero_func);
+	g_test_add_func("/uefi-dbx/authenticode-cache", fu_uefi_dbx_authenticode_cache_func);
+	g_test_add_func("/uefi-dbx/checksums", fu_uefi_dbx_checksums_func);
 	g_test_add_func("/uefi-dbx/not-present", fu_uefi_dbx_not_present_func);
 	return g_test_run();
 }
@@ -39,38 +39,150 @@ fu_uefi_dbx_get_efi_arch(void)
 	return NULL;
 }
 
+/* cheap to query; a new inode number after remounting VFAT just means it is hashed again */
 static gchar *
-fu_uefi_dbx_get_authenticode_hash(const gchar *fn, GError **error)
+fu_uefi_dbx_authenticode_cache_key(GFile *file, GError **error)
 {
+	g_autoptr(GFileInfo) info = NULL;
+
+	info = g_file_query_info(file,
+				 G_FILE_ATTRIBUTE_UNIX_INODE "," G_FILE_ATTRIBUTE_STANDARD_SIZE
+				 "," G_FILE_ATTRIBUTE_TIME_MODIFIED
+				 "," G_FILE_ATTRIBUTE_TIME_MODIFIED_USEC
+				 "," G_FILE_ATTRIBUTE_TIME_CHANGED
+				 "," G_FILE_ATTRIBUTE_TIME_CHANGED_USEC,
+				 G_FILE_QUERY_INFO_NONE,
+				 NULL,
+				 error);
+	if (info == NULL)
+		return NULL;
+	return g_strdup_printf(
+	    "%" G_GUINT64_FORMAT ":%" G_GUINT64_FORMAT ":%" G_GUINT64_FORMAT
+	    ".%06u:%" G_GUINT64_FORMAT ".%06u",
+	    g_file_info_get_attribute_uint64(info, G_FILE_ATTRIBUTE_UNIX_INODE),
+	    g_file_info_get_attribute_uint64(info, G_FILE_ATTRIBUTE_STANDARD_SIZE),
+	    g_file_info_get_attribute_uint64(info, G_FILE_ATTRIBUTE_TIME_MODIFIED),
+	    g_file_info_get_attribute_uint32(info, G_FILE_ATTRIBUTE_TIME_MODIFIED_USEC),
+	    g_file_info_get_attribute_uint64(info, G_FILE_ATTRIBUTE_TIME_CHANGED),
+	    g_file_info_get_attribute_uint32(info, G_FILE_ATTRIBUTE_TIME_CHANGED_USEC));
+}
+
+/* the cached value is only used if it is a valid SHA-256 checksum */
+static gchar *
+fu_uefi_dbx_authenticode_cache_lookup(GKeyFile *cache, const gchar *fn, const gchar *key)
+{
+	g_autofree gchar *checksum = NULL;
+	g_autofree gchar *key_cached = NULL;
+	g_autoptr(GBytes) csum = NULL;
+	g_autoptr(GError) error_local = NULL;
+
+	key_cached = g_key_file_get_string(cache, fn, "Key", NULL);
+	if (g_strcmp0(key, key_cached) != 0)
+		return NULL;
+	checksum = g_key_file_get_string(cache, fn, "Checksum", NULL);
+	if (checksum == NULL)
+		return NULL;
+	csum = fu_bytes_from_string(checksum, &error_local);
+	if (csum == NULL) {
+		g_debug("ignoring cached checksum for %s: %s", fn, error_local->message);
+		return NULL;
+	}
+	if (g_bytes_get_size(csum) != 32) {
+		g_debug("ignoring cached checksum for %s: invalid size 0x%x",
+			fn,
+			(guint)g_bytes_get_size(csum));
+		return NULL;
+	}
+	return g_steal_pointer(&checksum);
+}
+
+/* only parses the PE file if the inode, size, mtime or ctime changed since it was cached */
+gchar *
+fu_uefi_dbx_get_authenticode_hash(GKeyFile *cache, const gchar *fn, GError **error)
+{
+	g_autofree gchar *checksum = NULL;
+	g_autofree gchar *key = NULL;
 	g_autoptr(FuFirmware) firmware = fu_pefile_firmware_new();
 	g_autoptr(GFile) file = g_file_new_for_path(fn);
+
+	if (cache != NULL) {
+		key = fu_uefi_dbx_authenticode_cache_key(file, error);
+		if (key == NULL)
+			return NULL;
+		checksum = fu_uefi_dbx_authenticode_cache_lookup(cache, fn, key);
+		if (checksum != NULL)
+			return g_steal_pointer(&checksum);
+	}
+
 	if (!fu_firmware_parse_file(firmware, file, FU_FIRMWARE_PARSE_FLAG_NONE, error))
 		return NULL;
-	return fu_firmware_get_checksum(firmware, G_CHECKSUM_SHA256, error);
+	checksum = fu_firmware_get_checksum(firmware, G_CHECKSUM_SHA256, error);
+	if (checksum == NULL)
+		return NULL;
+	if (cache != NULL) {
+		g_key_file_set_string(cache, fn, "Key", key);
+		g_key_file_set_string(cache, fn, "Checksum", checksum);
+	}
+	return g_steal_pointer(&checksum);
+}
+
+/* the binary SHA-256 checksums of every signature, much faster than _get_image_by_checksum() */
+GHashTable *
+fu_uefi_dbx_signature_list_get_checksums(FuEfiSignatureList *siglist)
+{
+	g_autoptr(GHashTable) checksums =
+	    g_hash_table_new_full(g_bytes_hash, g_bytes_equal, (GDestroyNotify)g_bytes_unref, NULL);
+	g_autoptr(GPtrArray) sigs = fu_firmware_get_images(FU_FIRMWARE(siglist));
+
+	for (guint i = 0; i < sigs->len; i++) {
+		FuEfiSignature *sig = g_ptr_array_index(sigs, i);
+		g_autoptr(GBytes) csum = NULL;
+		g_autoptr(GError) error_local = NULL;
+
+		/* this is literally a hash, so avoid the round-trip to a hex string */
+		if (fu_efi_signature_get_kind(sig) == FU_EFI_SIGNATURE_KIND_SHA256) {
+			csum = fu_firmware_get_bytes(FU_FIRMWARE(sig), &error_local);
+		} else {
+			g_autofree gchar *checksum = fu_firmware_get_checksum(FU_FIRMWARE(sig),
+									      G_CHECKSUM_SHA256,
+									      &error_local);
+			if (checksum != NULL)
+				csum = fu_bytes_from_string(checksum, &error_local);
+		}
+
+		/* a signature that cannot be hashed can never match */
+		if (csum == NULL) {
+			g_debug("ignoring signature %u: %s", i, error_local->message);
+			continue;
+		}
+		g_hash_table_add(checksums, g_steal_pointer(&csum));
+	}
+	return g_steal_pointer(&checksums);
 }
 
 static gboolean
-fu_uefi_dbx_signature_list_validate_filename(FuContext *ctx,
-					     FuEfiSignatureList *siglist,
+fu_uefi_dbx_signature_list_validate_filename(GHashTable *checksums,
+					     GKeyFile *cache,
 					     const gchar *fn,
-					     FuFirmwareParseFlags flags,
 					     GError **error)
 {
 	g_autofree gchar *checksum = NULL;
-	g_autoptr(FuFirmware) img = NULL;
+	g_autoptr(GBytes) csum = NULL;
 	g_autoptr(GError) error_local = NULL;
 
 	/* get checksum of file */
-	checksum = fu_uefi_dbx_get_authenticode_hash(fn, &error_local);
+	checksum = fu_uefi_dbx_get_authenticode_hash(cache, fn, &error_local);
 	if (checksum == NULL) {
 		g_debug("failed to get checksum for %s: %s", fn, error_local->message);
 		return TRUE;
 	}
+	csum = fu_bytes_from_string(checksum, error);
+	if (csum == NULL)
+		return FALSE;
 
 	/* authenticode signature is present in dbx! */
 	g_debug("fn=%s, checksum=%s", fn, checksum);
-	img = fu_firmware_get_image_by_checksum(FU_FIRMWARE(siglist), checksum, NULL);
-	if (img != NULL) {
+	if (g_hash_table_contains(checksums, csum)) {
 		g_set_error(error,
 			    FWUPD_ERROR,
 			    FWUPD_ERROR_NEEDS_USER_ACTION,
@@ -84,12 +196,49 @@ fu_uefi_dbx_signature_list_validate_filename(FuContext *ctx,
 	return TRUE;
 }
 
+static void
+fu_uefi_dbx_authenticode_cache_save(GKeyFile *cache,
+				    const gchar *filename,
+				    const gchar *data_old,
+				    GPtrArray *files)
+{
+	g_auto(GStrv) groups = g_key_file_get_groups(cache, NULL);
+	g_autofree gchar *data = NULL;
+	g_autoptr(GError) error_local = NULL;
+
+	/* forget about files no longer in the ESP */
+	for (guint i = 0; groups[i] != NULL; i++) {
+		gboolean found = FALSE;
+		for (guint j = 0; j < files->len; j++) {
+			FuFirmware *firmware = g_ptr_array_index(files, j);
+			if (g_strcmp0(groups[i], fu_firmware_get_filename(firmware)) == 0) {
+				found = TRUE;
+				break;
+			}
+		}
+		if (!found)
+			g_key_file_remove_group(cache, groups[i], NULL);
+	}
+
+	/* nothing was added or removed */
+	data = g_key_file_to_data(cache, NULL, NULL);
+	if (g_strcmp0(data, data_old) == 0)
+		return;
+	if (!fu_path_mkdir_parent(filename, &error_local) ||
+	    !g_file_set_contents(filename, data, -1, &error_local))
+		g_debug("failed to save %s: %s", filename, error_local->message);
+}
+
 gboolean
 fu_uefi_dbx_signature_list_validate(FuContext *ctx,
 				    FuEfiSignatureList *siglist,
 				    FuFirmwareParseFlags flags,
 				    GError **error)
 {
+	g_autofree gchar *cache_data = NULL;
+	g_autofree gchar *cache_fn = NULL;
+	g_autoptr(GHashTable) checksums = NULL;
+	g_autoptr(GKeyFile) cache = g_key_file_new();
 	g_autoptr(GPtrArray) files = NULL;
 	g_autoptr(GError) error_local = NULL;
 
@@ -104,15 +253,31 @@ fu_uefi_dbx_signature_list_validate(FuContext *ctx,
 		g_propagate_error(error, g_steal_pointer(&error_local));
 		return FALSE;
 	}
+	checksums = fu_uefi_dbx_signature_list_get_checksums(siglist);
+
+	/* unchanged binaries do not need to be hashed again */
+	cache_fn = fu_context_build_filename(ctx,
+					     NULL,
+					     FU_PATH_KIND_CACHEDIR_PKG,
+					     "uefi-dbx",
+					     "authenticode.ini",
+					     NULL);
+	if (cache_fn != NULL && g_file_test(cache_fn, G_FILE_TEST_EXISTS)) {
+		g_autoptr(GError) error_cache = NULL;
+		if (!g_key_file_load_from_file(cache, cache_fn, G_KEY_FILE_NONE, &error_cache))
+			g_debug("ignoring %s: %s", cache_fn, error_cache->message);
+	}
+	cache_data = g_key_file_to_data(cache, NULL, NULL);
 	for (guint i = 0; i < files->len; i++) {
 		FuFirmware *firmware = g_ptr_array_index(files, i);
 		if (!fu_uefi_dbx_signature_list_validate_filename(
-			ctx,
-			siglist,
+			checksums,
+			cache,
 			fu_firmware_get_filename(firmware),
-			flags,
 			error))
 			return FALSE;
 	}
+	if (cache_fn != NULL)
+		fu_uefi_dbx_authenticode_cache_save(cache, cache_fn, cache_data, files);
 	return TRUE;
 }
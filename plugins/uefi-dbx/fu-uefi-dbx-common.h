@@ -10,6 +10,11 @@
 
 const gchar *
 fu_uefi_dbx_get_efi_arch(void);
+gchar *
+fu_uefi_dbx_get_authenticode_hash(GKeyFile *cache, const gchar *fn, GError **error)
+    G_GNUC_NON_NULL(2);
+GHashTable *
+fu_uefi_dbx_signature_list_get_checksums(FuEfiSignatureList *siglist) G_GNUC_NON_NULL(1);
 gboolean
 fu_uefi_dbx_signature_list_validate(FuContext *ctx,
 				    FuEfiSignatureList *siglist,
@@ -59,6 +59,7 @@ static void
 fu_uefi_esrt_plugin_init(FuUefiEsrtPlugin *self)
 {
 	fu_plugin_add_rule(FU_PLUGIN(self), FU_PLUGIN_RULE_BETTER_THAN, "bios");
+	fu_plugin_set_security_attrs_depends(FU_PLUGIN(self), FU_SECURITY_ATTRS_DEPENDS_NONE);
 }
 
 static void
@@ -235,7 +235,12 @@ fu_vli_usbhub_msp430_device_write_firmware(FuDevice *device,
 					   GError **error)
 {
 	FuDevice *proxy;
-	GPtrArray *records = fu_ihex_firmware_get_records(FU_IHEX_FIRMWARE(firmware));
+	GPtrArray *records;
+
+	/* build the records */
+	if (!fu_ihex_firmware_ensure_records(FU_IHEX_FIRMWARE(firmware), error))
+		return FALSE;
+	records = fu_ihex_firmware_get_records(FU_IHEX_FIRMWARE(firmware));
 
 	/* open device */
 	proxy = fu_device_get_proxy(device, error);
@@ -85,8 +85,11 @@ fu_wacom_usb_module_sub_cpu_parse_chunks(FuSrecFirmware *srec_firmware,
 {
 	g_autoptr(GPtrArray) chunks = g_ptr_array_new_with_free_func(g_free);
 	guint record_num = 0;
-	GPtrArray *records = fu_srec_firmware_get_records(srec_firmware);
+	GPtrArray *records;
 
+	if (!fu_srec_firmware_ensure_records(srec_firmware, error))
+		return NULL;
+	records = fu_srec_firmware_get_records(srec_firmware);
 	*data_len = 0;
 	while (record_num < records->len) {
 		g_autofree FuChunk *chunk =
@@ -0,0 +1,167 @@
+/*
+ * Copyright 2026 Richard Hughes <richard@hughsie.com>
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ */
+
+#include "config.h"
+
+#include <string.h>
+
+#include "fu-coldplug-cache.h"
+#include "fu-context-private.h"
+
+static FuDevice *
+fu_coldplug_cache_test_device_new(FuContext *ctx, const gchar *sysfs_path, const gchar *physical_id)
+{
+	gboolean ret;
+	g_autoptr(FuUdevDevice) device = fu_udev_device_new(ctx, sysfs_path);
+	g_autoptr(GError) error = NULL;
+
+	fu_udev_device_set_subsystem(device, "nvme");
+	fu_udev_device_set_devtype(device, "nvme");
+	ret = fu_device_probe(FU_DEVICE(device), &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	fu_device_set_physical_id(FU_DEVICE(device), physical_id);
+	fu_device_set_vid(FU_DEVICE(device), 0x273F);
+	fu_device_set_pid(FU_DEVICE(device), 0x1004);
+	fu_device_add_private_flag(FU_DEVICE(device), FU_DEVICE_PRIVATE_FLAG_COLDPLUG_CACHE);
+	return FU_DEVICE(g_steal_pointer(&device));
+}
+
+static void
+fu_coldplug_cache_test_set_attr(const gchar *sysfs_path, const gchar *attr, const gchar *value)
+{
+	gboolean ret;
+	g_autofree gchar *fn = g_build_filename(sysfs_path, attr, NULL);
+	g_autoptr(GBytes) blob = g_bytes_new(value, strlen(value));
+	g_autoptr(GError) error = NULL;
+
+	ret = fu_bytes_set_contents(fn, blob, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+}
+
+static void
+fu_coldplug_cache_func(void)
+{
+	gboolean ret;
+	g_autofree gchar *fn = NULL;
+	g_autofree gchar *sysfs_path = NULL;
+	g_autofree gchar *sysfs_path2 = NULL;
+	g_autofree gchar *sysfs_path_usb = NULL;
+	g_autoptr(FuColdplugCache) cache1 = fu_coldplug_cache_new();
+	g_autoptr(FuColdplugCache) cache2 = fu_coldplug_cache_new();
+	g_autoptr(FuContext) ctx = fu_context_new_full(FU_CONTEXT_FLAG_NO_QUIRKS);
+	g_autoptr(FuDevice) device1 = NULL;
+	g_autoptr(FuDevice) device2 = NULL;
+	g_autoptr(FuDevice) device3 = NULL;
+	g_autoptr(FuDevice) device4 = NULL;
+	g_autoptr(FuDevice) device5 = fu_device_new(ctx);
+	g_autoptr(FuDevice) device6 = NULL;
+	g_autoptr(FuDevice) device7 = NULL;
+	g_autoptr(FuTemporaryDirectory) tmpdir = NULL;
+	g_autoptr(GError) error = NULL;
+
+	tmpdir = fu_temporary_directory_new("coldplug-cache", &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(tmpdir);
+	fn = fu_temporary_directory_build(tmpdir, "coldplug.json", NULL);
+	sysfs_path = fu_temporary_directory_build(tmpdir, "nvme1", NULL);
+	fu_coldplug_cache_test_set_attr(sysfs_path, "firmware_rev", "1.2.3\n");
+	device1 = fu_coldplug_cache_test_device_new(ctx, sysfs_path, "PCI_SLOT_NAME=0000:00:1b.0");
+	device2 = fu_coldplug_cache_test_device_new(ctx, sysfs_path, "PCI_SLOT_NAME=0000:00:1b.0");
+	device3 = fu_coldplug_cache_test_device_new(ctx, sysfs_path, "PCI_SLOT_NAME=0000:00:1c.0");
+
+	/* set up as if by the plugin */
+	fu_device_set_id(device1, "dummy");
+	fu_device_set_version_format(device1, FWUPD_VERSION_FORMAT_TRIPLET);
+	fu_device_set_version(device1, "1.2.3");
+	fu_device_add_flag(device1, FWUPD_DEVICE_FLAG_UPDATABLE);
+	fu_device_add_instance_id(device1, "NVME\\VEN_273F&DEV_1004");
+	fu_device_convert_instance_ids(device1);
+
+	/* no file is not an error */
+	ret = fu_coldplug_cache_load(cache1, fn, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	g_assert_cmpint(fu_coldplug_cache_get_size(cache1), ==, 0);
+	fu_coldplug_cache_add_device(cache1, device1, "test");
+	g_assert_cmpint(fu_coldplug_cache_get_size(cache1), ==, 1);
+
+	/* the version of this device can only be read from the hardware */
+	fu_device_set_backend_id(device5, "usb:01:00:06");
+	fu_coldplug_cache_add_device(cache1, device5, "test");
+	g_assert_cmpint(fu_coldplug_cache_get_size(cache1), ==, 1);
+
+	/* the plugin did not opt in */
+	sysfs_path2 = fu_temporary_directory_build(tmpdir, "nvme2", NULL);
+	fu_coldplug_cache_test_set_attr(sysfs_path2, "firmware_rev", "1.2.3\n");
+	device6 = fu_coldplug_cache_test_device_new(ctx, sysfs_path2, "PCI_SLOT_NAME=0000:00:1d.0");
+	fu_device_remove_private_flag(device6, FU_DEVICE_PRIVATE_FLAG_COLDPLUG_CACHE);
+	fu_coldplug_cache_add_device(cache1, device6, "test");
+	g_assert_cmpint(fu_coldplug_cache_get_size(cache1), ==, 1);
+
+	/* a USB device also needs the version in sysfs */
+	sysfs_path_usb = fu_temporary_directory_build(tmpdir, "usb1", NULL);
+	fu_coldplug_cache_test_set_attr(sysfs_path_usb, "serial", "ABC123\n");
+	device7 = g_object_new(FU_TYPE_USB_DEVICE,
+			       "context",
+			       ctx,
+			       "backend-id",
+			       sysfs_path_usb,
+			       NULL);
+	fu_device_add_private_flag(device7, FU_DEVICE_PRIVATE_FLAG_COLDPLUG_CACHE);
+	fu_coldplug_cache_add_device(cache1, device7, "test");
+	g_assert_cmpint(fu_coldplug_cache_get_size(cache1), ==, 1);
+	ret = fu_coldplug_cache_save(cache1, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+
+	/* restart */
+	ret = fu_coldplug_cache_load(cache2, fn, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	g_assert_cmpint(fu_coldplug_cache_get_size(cache2), ==, 1);
+
+	/* wrong plugin */
+	g_assert_false(fu_coldplug_cache_restore_device(cache2, device2, "dfu"));
+	g_assert_cmpint(fu_coldplug_cache_get_size(cache2), ==, 0);
+
+	/* same device */
+	ret = fu_coldplug_cache_load(cache2, fn, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	g_assert_true(fu_coldplug_cache_restore_device(cache2, device2, "test"));
+	g_assert_cmpstr(fu_device_get_id(device2), ==, fu_device_get_id(device1));
+	g_assert_cmpstr(fu_device_get_version(device2), ==, "1.2.3");
+	g_assert_true(fu_device_has_flag(device2, FWUPD_DEVICE_FLAG_UPDATABLE));
+	g_assert_true(fu_device_has_guid(device2, "NVME\\VEN_273F&DEV_1004"));
+
+	/* different device on the same backend ID */
+	ret = fu_coldplug_cache_load(cache2, fn, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	g_assert_false(fu_coldplug_cache_restore_device(cache2, device3, "test"));
+	g_assert_cmpint(fu_coldplug_cache_get_size(cache2), ==, 0);
+	g_assert_null(fu_device_get_version(device3));
+
+	/* firmware updated without fwupd */
+	fu_coldplug_cache_test_set_attr(sysfs_path, "firmware_rev", "1.2.4\n");
+	device4 = fu_coldplug_cache_test_device_new(ctx, sysfs_path, "PCI_SLOT_NAME=0000:00:1b.0");
+	ret = fu_coldplug_cache_load(cache2, fn, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	g_assert_false(fu_coldplug_cache_restore_device(cache2, device4, "test"));
+	g_assert_cmpint(fu_coldplug_cache_get_size(cache2), ==, 0);
+	g_assert_null(fu_device_get_version(device4));
+}
+
+int
+main(int argc, char **argv)
+{
+	g_test_init(&argc, &argv, NULL);
+	g_test_add_func("/fwupd/coldplug-cache", fu_coldplug_cache_func);
+	return g_test_run();
+}
@@ -0,0 +1,382 @@
+/*
+ * Copyright 2026 Richard Hughes <richard@hughsie.com>
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ */
+
+#define G_LOG_DOMAIN "FuColdplugCache"
+
+#include "config.h"
+
+#include "fu-coldplug-cache.h"
+#include "fu-device-private.h"
+
+struct _FuColdplugCache {
+	GObject parent_instance;
+	gchar *filename;
+	GHashTable *entries; /* backend-id : FuColdplugCacheEntry */
+};
+
+typedef struct {
+	gchar *fingerprint;
+	FwupdJsonObject *json_obj;
+	gboolean seen; /* restored or added since load */
+} FuColdplugCacheEntry;
+
+G_DEFINE_TYPE(FuColdplugCache, fu_coldplug_cache, G_TYPE_OBJECT)
+
+static void
+fu_coldplug_cache_entry_free(FuColdplugCacheEntry *entry)
+{
+	g_free(entry->fingerprint);
+	if (entry->json_obj != NULL)
+		fwupd_json_object_unref(entry->json_obj);
+	g_free(entry);
+}
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC(FuColdplugCacheEntry, fu_coldplug_cache_entry_free)
+
+/* the firmware version of a restored device is never read from the hardware, so only devices
+ * that also export it in sysfs can be cached */
+static gboolean
+fu_coldplug_cache_append_udev_attrs(GString *str, FuUdevDevice *device)
+{
+	gboolean has_version = FALSE;
+	const gchar *attrs[] = {
+	    "vendor",
+	    "device",
+	    "model",
+	    "serial",
+	    "idVendor",
+	    "idProduct",
+	};
+	const gchar *attrs_version[] = {
+	    "bcdDevice",
+	    "revision",
+	    "version",
+	    "firmware_rev",
+	    "firmware_version",
+	    "fw_version",
+	    "fwrev",
+	    "nvm_version",
+	    "vbios_version",
+	};
+	g_autoptr(FuDevice) device_usb = NULL;
+
+	for (guint i = 0; i < G_N_ELEMENTS(attrs); i++) {
+		g_autofree gchar *value =
+		    fu_udev_device_read_sysfs(device,
+					      attrs[i],
+					      FU_UDEV_DEVICE_ATTR_READ_TIMEOUT_DEFAULT,
+					      NULL);
+		g_string_append_printf(str, "|%s", value != NULL ? value : "");
+	}
+	for (guint i = 0; i < G_N_ELEMENTS(attrs_version); i++) {
+		g_autofree gchar *value =
+		    fu_udev_device_read_sysfs(device,
+					      attrs_version[i],
+					      FU_UDEV_DEVICE_ATTR_READ_TIMEOUT_DEFAULT,
+					      NULL);
+		if (value != NULL)
+			has_version = TRUE;
+		g_string_append_printf(str, "|%s", value != NULL ? value : "");
+	}
+
+	/* e.g. a hidraw device, where the USB device is updated */
+	device_usb = fu_device_get_backend_parent_with_subsystem(FU_DEVICE(device),
+								 "usb:usb_device",
+								 NULL);
+	if (device_usb != NULL && FU_IS_UDEV_DEVICE(device_usb)) {
+		g_autofree gchar *value =
+		    fu_udev_device_read_sysfs(FU_UDEV_DEVICE(device_usb),
+					      "bcdDevice",
+					      FU_UDEV_DEVICE_ATTR_READ_TIMEOUT_DEFAULT,
+					      NULL);
+		if (value != NULL)
+			has_version = TRUE;
+		g_string_append_printf(str, "|%s", value != NULL ? value : "");
+	}
+	return has_version;
+}
+
+/* only attributes that can be read without opening the device, or %NULL if not cachable */
+static gchar *
+fu_coldplug_cache_build_fingerprint(FuColdplugCache *self,
+				    FuDevice *device,
+				    const gchar *plugin_name)
+{
+	g_autoptr(GString) str = g_string_new(VERSION);
+
+	g_string_append_printf(str,
+			       "|%s|%s|%s|%s|%04x:%04x",
+			       plugin_name,
+			       G_OBJECT_TYPE_NAME(device),
+			       fu_device_get_backend_id(device),
+			       fu_device_get_physical_id(device) != NULL
+				   ? fu_device_get_physical_id(device)
+				   : "",
+			       fu_device_get_vid(device),
+			       fu_device_get_pid(device));
+	if (!FU_IS_UDEV_DEVICE(device))
+		return NULL;
+	if (FU_IS_USB_DEVICE(device)) {
+		g_string_append_printf(str,
+				       "|%04x",
+				       fu_usb_device_get_release(FU_USB_DEVICE(device)));
+	}
+	if (!fu_coldplug_cache_append_udev_attrs(str, FU_UDEV_DEVICE(device)))
+		return NULL;
+	return g_compute_checksum_for_string(G_CHECKSUM_SHA256, str->str, str->len);
+}
+
+void
+fu_coldplug_cache_add_device(FuColdplugCache *self, FuDevice *device, const gchar *plugin_name)
+{
+	const gchar *backend_id = fu_device_get_backend_id(device);
+	g_autoptr(FuColdplugCacheEntry) entry = g_new0(FuColdplugCacheEntry, 1);
+
+	g_return_if_fail(FU_IS_COLDPLUG_CACHE(self));
+	g_return_if_fail(FU_IS_DEVICE(device));
+	g_return_if_fail(plugin_name != NULL);
+
+	if (backend_id == NULL)
+		return;
+	if (fu_device_has_flag(device, FWUPD_DEVICE_FLAG_EMULATED))
+		return;
+	if (!fu_device_has_private_flag(device, FU_DEVICE_PRIVATE_FLAG_COLDPLUG_CACHE))
+		return;
+
+	/* these cannot be restored without talking to the hardware */
+	if (fu_device_get_children(device)->len > 0 ||
+	    fu_device_get_parent_internal(device) != NULL ||
+	    fu_device_get_proxy_internal(device) != NULL)
+		return;
+
+	entry->fingerprint = fu_coldplug_cache_build_fingerprint(self, device, plugin_name);
+	if (entry->fingerprint == NULL) {
+		g_debug("not caching %s as the version is not in sysfs", backend_id);
+		return;
+	}
+	entry->json_obj = fwupd_json_object_new();
+	entry->seen = TRUE;
+	fwupd_codec_to_json(FWUPD_CODEC(device), entry->json_obj, FWUPD_CODEC_FLAG_TRUSTED);
+	g_hash_table_insert(self->entries, g_strdup(backend_id), g_steal_pointer(&entry));
+}
+
+gboolean
+fu_coldplug_cache_restore_device(FuColdplugCache *self, FuDevice *device, const gchar *plugin_name)
+{
+	const gchar *backend_id = fu_device_get_backend_id(device);
+	FuColdplugCacheEntry *entry;
+	g_autofree gchar *fingerprint = NULL;
+	g_autoptr(GError) error_local = NULL;
+
+	g_return_val_if_fail(FU_IS_COLDPLUG_CACHE(self), FALSE);
+	g_return_val_if_fail(FU_IS_DEVICE(device), FALSE);
+	g_return_val_if_fail(plugin_name != NULL, FALSE);
+
+	if (backend_id == NULL)
+		return FALSE;
+	entry = g_hash_table_lookup(self->entries, backend_id);
+	if (entry == NULL)
+		return FALSE;
+
+	/* the fingerprint needs the probed VID, PID and physical ID */
+	if (!fu_device_probe(device, &error_local)) {
+		g_debug("not restoring %s: %s", backend_id, error_local->message);
+		g_hash_table_remove(self->entries, backend_id);
+		return FALSE;
+	}
+	if (!fu_device_has_private_flag(device, FU_DEVICE_PRIVATE_FLAG_COLDPLUG_CACHE)) {
+		g_debug("not restoring %s as no longer opted in", backend_id);
+		g_hash_table_remove(self->entries, backend_id);
+		return FALSE;
+	}
+	fingerprint = fu_coldplug_cache_build_fingerprint(self, device, plugin_name);
+	if (fingerprint == NULL || g_strcmp0(fingerprint, entry->fingerprint) != 0) {
+		g_debug("not restoring %s as fingerprint changed", backend_id);
+		g_hash_table_remove(self->entries, backend_id);
+		return FALSE;
+	}
+	if (!fwupd_codec_from_json(FWUPD_CODEC(device), entry->json_obj, &error_local)) {
+		g_debug("not restoring %s: %s", backend_id, error_local->message);
+		g_hash_table_remove(self->entries, backend_id);
+		return FALSE;
+	}
+
+	/* success */
+	g_debug("restored %s from cache", backend_id);
+	entry->seen = TRUE;
+	return TRUE;
+}
+
+void
+fu_coldplug_cache_clear(FuColdplugCache *self)
+{
+	g_return_if_fail(FU_IS_COLDPLUG_CACHE(self));
+	g_hash_table_remove_all(self->entries);
+}
+
+guint
+fu_coldplug_cache_get_size(FuColdplugCache *self)
+{
+	g_return_val_if_fail(FU_IS_COLDPLUG_CACHE(self), G_MAXUINT);
+	return g_hash_table_size(self->entries);
+}
+
+static gboolean
+fu_coldplug_cache_load_entry(FuColdplugCache *self, FwupdJsonObject *json_obj, GError **error)
+{
+	const gchar *backend_id;
+	const gchar *fingerprint;
+	g_autoptr(FuColdplugCacheEntry) entry = g_new0(FuColdplugCacheEntry, 1);
+
+	backend_id = fwupd_json_object_get_string(json_obj, "BackendId", error);
+	if (backend_id == NULL)
+		return FALSE;
+	fingerprint = fwupd_json_object_get_string(json_obj, "Fingerprint", error);
+	if (fingerprint == NULL)
+		return FALSE;
+	entry->json_obj = fwupd_json_object_get_object(json_obj, "Device", error);
+	if (entry->json_obj == NULL)
+		return FALSE;
+	entry->fingerprint = g_strdup(fingerprint);
+	g_hash_table_insert(self->entries, g_strdup(backend_id), g_steal_pointer(&entry));
+	return TRUE;
+}
+
+gboolean
+fu_coldplug_cache_load(FuColdplugCache *self, const gchar *filename, GError **error)
+{
+	const gchar *version;
+	g_autoptr(FwupdJsonArray) json_arr = NULL;
+	g_autoptr(FwupdJsonNode) json_node = NULL;
+	g_autoptr(FwupdJsonObject) json_obj = NULL;
+	g_autoptr(FwupdJsonParser) json_parser = fwupd_json_parser_new();
+	g_autoptr(GBytes) blob = NULL;
+
+	g_return_val_if_fail(FU_IS_COLDPLUG_CACHE(self), FALSE);
+	g_return_val_if_fail(filename != NULL, FALSE);
+	g_return_val_if_fail(error == NULL || *error == NULL, FALSE);
+
+	/* always save back to the same file */
+	g_free(self->filename);
+	self->filename = g_strdup(filename);
+	g_hash_table_remove_all(self->entries);
+	if (!g_file_test(filename, G_FILE_TEST_EXISTS))
+		return TRUE;
+
+	/* set appropriate limits */
+	fwupd_json_parser_set_max_depth(json_parser, 10);
+	fwupd_json_parser_set_max_items(json_parser, 100000);
+	fwupd_json_parser_set_max_quoted(json_parser, 10000);
+
+	/* parse */
+	blob = fu_bytes_get_contents(filename, error);
+	if (blob == NULL)
+		return FALSE;
+	json_node = fwupd_json_parser_load_from_bytes(json_parser,
+						      blob,
+						      FWUPD_JSON_LOAD_FLAG_TRUSTED,
+						      error);
+	if (json_node == NULL)
+		return FALSE;
+	json_obj = fwupd_json_node_get_object(json_node, error);
+	if (json_obj == NULL)
+		return FALSE;
+
+	/* any plugin may have changed how the device is set up */
+	version = fwupd_json_object_get_string(json_obj, "Version", NULL);
+	if (g_strcmp0(version, VERSION) != 0) {
+		g_debug("ignoring cache from version %s", version != NULL ? version : "unknown");
+		return TRUE;
+	}
+	json_arr = fwupd_json_object_get_array(json_obj, "Devices", error);
+	if (json_arr == NULL)
+		return FALSE;
+	for (guint i = 0; i < fwupd_json_array_get_size(json_arr); i++) {
+		g_autoptr(FwupdJsonObject) json_obj_tmp = NULL;
+		json_obj_tmp = fwupd_json_array_get_object(json_arr, i, error);
+		if (json_obj_tmp == NULL)
+			return FALSE;
+		if (!fu_coldplug_cache_load_entry(self, json_obj_tmp, error)) {
+			g_hash_table_remove_all(self->entries);
+			return FALSE;
+		}
+	}
+
+	/* success */
+	return TRUE;
+}
+
+gboolean
+fu_coldplug_cache_save(FuColdplugCache *self, GError **error)
+{
+	GHashTableIter iter;
+	gpointer key;
+	gpointer value;
+	g_autoptr(FwupdJsonArray) json_arr = fwupd_json_array_new();
+	g_autoptr(FwupdJsonObject) json_obj = fwupd_json_object_new();
+	g_autoptr(GBytes) blob = NULL;
+
+	g_return_val_if_fail(FU_IS_COLDPLUG_CACHE(self), FALSE);
+	g_return_val_if_fail(error == NULL || *error == NULL, FALSE);
+
+	if (self->filename == NULL) {
+		g_set_error_literal(error,
+				    FWUPD_ERROR,
+				    FWUPD_ERROR_NOT_SUPPORTED,
+				    "no filename set");
+		return FALSE;
+	}
+
+	fwupd_json_object_add_string(json_obj, "Version", VERSION);
+	g_hash_table_iter_init(&iter, self->entries);
+	while (g_hash_table_iter_next(&iter, &key, &value)) {
+		FuColdplugCacheEntry *entry = (FuColdplugCacheEntry *)value;
+		g_autoptr(FwupdJsonObject) json_obj_tmp = NULL;
+		if (!entry->seen)
+			continue;
+		json_obj_tmp = fwupd_json_object_new();
+		fwupd_json_object_add_string(json_obj_tmp, "BackendId", (const gchar *)key);
+		fwupd_json_object_add_string(json_obj_tmp, "Fingerprint", entry->fingerprint);
+		fwupd_json_object_add_object(json_obj_tmp, "Device", entry->json_obj);
+		fwupd_json_array_add_object(json_arr, json_obj_tmp);
+	}
+	fwupd_json_object_add_array(json_obj, "Devices", json_arr);
+	blob = fwupd_json_object_to_bytes(json_obj, FWUPD_JSON_EXPORT_FLAG_TRAILING_NEWLINE);
+	return fu_bytes_set_contents(self->filename, blob, error);
+}
+
+static void
+fu_coldplug_cache_init(FuColdplugCache *self)
+{
+	self->entries = g_hash_table_new_full(g_str_hash,
+					      g_str_equal,
+					      g_free,
+					      (GDestroyNotify)fu_coldplug_cache_entry_free);
+}
+
+static void
+fu_coldplug_cache_finalize(GObject *obj)
+{
+	FuColdplugCache *self = FU_COLDPLUG_CACHE(obj);
+
+	g_free(self->filename);
+	g_hash_table_unref(self->entries);
+
+	G_OBJECT_CLASS(fu_coldplug_cache_parent_class)->finalize(obj);
+}
+
+static void
+fu_coldplug_cache_class_init(FuColdplugCacheClass *klass)
+{
+	GObjectClass *object_class = G_OBJECT_CLASS(klass);
+	object_class->finalize = fu_coldplug_cache_finalize;
+}
+
+FuColdplugCache *
+fu_coldplug_cache_new(void)
+{
+	return FU_COLDPLUG_CACHE(g_object_new(FU_TYPE_COLDPLUG_CACHE, NULL));
+}
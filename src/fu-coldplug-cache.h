@@ -0,0 +1,30 @@
+/*
+ * Copyright 2026 Richard Hughes <richard@hughsie.com>
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ */
+
+#pragma once
+
+#include <fwupdplugin.h>
+
+#define FU_TYPE_COLDPLUG_CACHE (fu_coldplug_cache_get_type())
+G_DECLARE_FINAL_TYPE(FuColdplugCache, fu_coldplug_cache, FU, COLDPLUG_CACHE, GObject)
+
+FuColdplugCache *
+fu_coldplug_cache_new(void);
+gboolean
+fu_coldplug_cache_load(FuColdplugCache *self, const gchar *filename, GError **error)
+    G_GNUC_NON_NULL(1, 2);
+gboolean
+fu_coldplug_cache_save(FuColdplugCache *self, GError **error) G_GNUC_NON_NULL(1);
+void
+fu_coldplug_cache_add_device(FuColdplugCache *self, FuDevice *device, const gchar *plugin_name)
+    G_GNUC_NON_NULL(1, 2, 3);
+gboolean
+fu_coldplug_cache_restore_device(FuColdplugCache *self, FuDevice *device, const gchar *plugin_name)
+    G_GNUC_NON_NULL(1, 2, 3);
+void
+fu_coldplug_cache_clear(FuColdplugCache *self) G_GNUC_NON_NULL(1);
+guint
+fu_coldplug_cache_get_size(FuColdplugCache *self) G_GNUC_NON_NULL(1);
@@ -25,6 +25,7 @@ typedef struct {
 	gboolean update_in_progress;
 	gboolean pending_stop;
 	guint process_quit_id;
+	gchar *profile_trace;
 } FuDaemonPrivate;
 
 G_DEFINE_TYPE_WITH_PRIVATE(FuDaemon, fu_daemon, G_TYPE_OBJECT)
@@ -48,6 +49,17 @@ fu_daemon_set_update_in_progress(FuDaemon *self, gboolean update_in_progress)
 	priv->update_in_progress = update_in_progress;
 }
 
+void
+fu_daemon_set_profile_trace(FuDaemon *self, const gchar *profile_trace)
+{
+	FuDaemonPrivate *priv = GET_PRIVATE(self);
+	g_return_if_fail(FU_IS_DAEMON(self));
+	if (g_strcmp0(priv->profile_trace, profile_trace) == 0)
+		return;
+	g_free(priv->profile_trace);
+	priv->profile_trace = g_strdup(profile_trace);
+}
+
 gboolean
 fu_daemon_get_pending_stop(FuDaemon *self)
 {
@@ -149,6 +161,7 @@ gboolean
 fu_daemon_setup(FuDaemon *self, const gchar *socket_address, GError **error)
 {
 	FuDaemonClass *klass = FU_DAEMON_GET_CLASS(self);
+	FuDaemonPrivate *priv = GET_PRIVATE(self);
 	FuEngine *engine = fu_daemon_get_engine(self);
 	FuContext *ctx = fu_engine_get_context(engine);
 	guint timer_max_ms;
@@ -159,6 +172,10 @@ fu_daemon_setup(FuDaemon *self, const gchar *socket_address, GError **error)
 	g_return_val_if_fail(FU_IS_ENGINE(engine), FALSE);
 	g_return_val_if_fail(error == NULL || *error == NULL, FALSE);
 
+	/* record the whole startup */
+	if (priv->profile_trace != NULL)
+		fu_progress_set_profile(progress, TRUE);
+
 	/* check that the process manager is preventing access to dangerous system calls */
 	if (!fu_daemon_check_syscall_filtering(error))
 		return FALSE;
@@ -184,6 +201,11 @@ fu_daemon_setup(FuDaemon *self, const gchar *socket_address, GError **error)
 		if (str != NULL)
 			g_print("\n%s\n", str);
 	}
+	if (priv->profile_trace != NULL) {
+		g_autoptr(GError) error_trace = NULL;
+		if (!fu_progress_save_trace(progress, priv->profile_trace, &error_trace))
+			g_warning("failed to save trace: %s", error_trace->message);
+	}
 
 	/* success */
 	return TRUE;
@@ -272,6 +294,7 @@ fu_daemon_finalize(GObject *obj)
 		g_source_remove(priv->process_quit_id);
 	if (priv->engine != NULL)
 		g_object_unref(priv->engine);
+	g_free(priv->profile_trace);
 
 	G_OBJECT_CLASS(fu_daemon_parent_class)->finalize(obj);
 }
@@ -42,3 +42,5 @@ void
 fu_daemon_set_update_in_progress(FuDaemon *self, gboolean update_in_progress) G_GNUC_NON_NULL(1);
 gboolean
 fu_daemon_get_pending_stop(FuDaemon *self) G_GNUC_NON_NULL(1);
+void
+fu_daemon_set_profile_trace(FuDaemon *self, const gchar *profile_trace) G_GNUC_NON_NULL(1);
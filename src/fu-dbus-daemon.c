@@ -1592,6 +1592,30 @@ fu_dbus_daemon_method_get_remotes(FuDbusDaemon *self,
 				  g_steal_pointer(&helper));
 }
 
+/* used by the *Filtered methods */
+static void
+fu_dbus_daemon_parse_filter_options(GVariant *parameters,
+				    guint64 *since,
+				    guint *offset,
+				    guint *limit)
+{
+	GVariant *prop_value;
+	const gchar *prop_key;
+	g_autoptr(GVariantIter) iter = NULL;
+
+	g_variant_get(parameters, "(a{sv})", &iter);
+	while (g_variant_iter_next(iter, "{&sv}", &prop_key, &prop_value)) {
+		g_debug("got option %s", prop_key);
+		if (g_strcmp0(prop_key, "since") == 0)
+			*since = fwupd_variant_get_uint64(prop_value);
+		if (g_strcmp0(prop_key, "offset") == 0)
+			*offset = fwupd_variant_get_uint32(prop_value);
+		if (g_strcmp0(prop_key, "limit") == 0)
+			*limit = fwupd_variant_get_uint32(prop_value);
+		g_variant_unref(prop_value);
+	}
+}
+
 static void
 fu_dbus_daemon_method_get_history(FuDbusDaemon *self,
 				  GVariant *parameters,
@@ -1600,10 +1624,15 @@ fu_dbus_daemon_method_get_history(FuDbusDaemon *self,
 {
 	FuEngine *engine = fu_daemon_get_engine(FU_DAEMON(self));
 	GVariant *val;
+	guint64 since = 0;
+	guint offset = 0;
+	guint limit = 0;
 	g_autoptr(GError) error = NULL;
 	g_autoptr(GPtrArray) devices = NULL;
 
-	devices = fu_engine_get_history(engine, &error);
+	if (g_variant_is_of_type(parameters, G_VARIANT_TYPE("(a{sv})")))
+		fu_dbus_daemon_parse_filter_options(parameters, &since, &offset, &limit);
+	devices = fu_engine_get_history(engine, since, offset, limit, &error);
 	if (devices == NULL) {
 		fu_dbus_daemon_method_invocation_return_gerror(invocation, error);
 		return;
@@ -1643,12 +1672,17 @@ fu_dbus_daemon_method_get_host_security_events(FuDbusDaemon *self,
 {
 #ifdef HAVE_HSI
 	FuEngine *engine = fu_daemon_get_engine(FU_DAEMON(self));
+	guint64 since = 0;
+	guint offset = 0;
 	guint limit = 0;
 	g_autoptr(FuSecurityAttrs) attrs = NULL;
 	g_autoptr(GError) error = NULL;
 
-	g_variant_get(parameters, "(u)", &limit);
-	attrs = fu_engine_get_host_security_events(engine, limit, &error);
+	if (g_variant_is_of_type(parameters, G_VARIANT_TYPE("(a{sv})")))
+		fu_dbus_daemon_parse_filter_options(parameters, &since, &offset, &limit);
+	else
+		g_variant_get(parameters, "(u)", &limit);
+	attrs = fu_engine_get_host_security_events(engine, since, offset, limit, &error);
 	if (attrs == NULL) {
 		fu_dbus_daemon_method_invocation_return_gerror(invocation, error);
 		return;
@@ -2804,8 +2838,10 @@ fu_dbus_daemon_method_call(GDBusConnection *connection,
 	    {"GetUpgrades", fu_dbus_daemon_method_get_upgrades},
 	    {"GetRemotes", fu_dbus_daemon_method_get_remotes},
 	    {"GetHistory", fu_dbus_daemon_method_get_history},
+	    {"GetHistoryFiltered", fu_dbus_daemon_method_get_history},
 	    {"GetHostSecurityAttrs", fu_dbus_daemon_method_get_host_security_attrs},
 	    {"GetHostSecurityEvents", fu_dbus_daemon_method_get_host_security_events},
+	    {"GetHostSecurityEventsFiltered", fu_dbus_daemon_method_get_host_security_events},
 	    {"ClearResults", fu_dbus_daemon_method_clear_results},
 	    {"EmulationLoad", fu_dbus_daemon_method_emulation_load},
 	    {"EmulationSave", fu_dbus_daemon_method_emulation_save},
@@ -3176,7 +3212,8 @@ fu_dbus_daemon_setup(FuDaemon *daemon,
 
 	/* progress */
 	fu_progress_set_id(progress, G_STRLOC);
-	fu_progress_set_profile(progress, g_log_get_debug_enabled());
+	if (g_log_get_debug_enabled())
+		fu_progress_set_profile(progress, TRUE);
 	fu_progress_add_step(progress, FWUPD_STATUS_LOADING, 99, "load-engine");
 	fu_progress_add_step(progress, FWUPD_STATUS_LOADING, 1, "load-introspection");
 	fu_progress_add_step(progress, FWUPD_STATUS_LOADING, 1, "load-authority");
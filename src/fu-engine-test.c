@@ -1797,7 +1797,7 @@ fu_engine_history_convert_version_func(void)
 	g_assert_true(ret);
 
 	/* do not overwrite the history-saved 1.2.4 with the release-provided 0x01020004 */
-	devices = fu_engine_get_history(engine, &error);
+	devices = fu_engine_get_history(engine, 0, 0, 0, &error);
 	g_assert_no_error(error);
 	g_assert_nonnull(devices);
 	g_assert_cmpint(devices->len, ==, 1);
@@ -3535,6 +3535,120 @@ fu_engine_report_metadata_func(void)
 	}
 }
 
+static void
+fu_engine_plugin_defer_startup_func(void)
+{
+	gboolean ret;
+	FuPlugin *plugin_mtd;
+	FuPlugin *plugin_upower;
+	g_autoptr(FuContext) ctx = fu_context_new();
+	g_autoptr(FuEngine) engine = fu_engine_new(ctx);
+	g_autoptr(FuProgress) progress = fu_progress_new(G_STRLOC);
+	g_autoptr(GError) error = NULL;
+
+	fu_engine_add_plugin_filter(engine, "mtd");
+	fu_engine_add_plugin_filter(engine, "upower");
+	ret = fu_engine_load(engine,
+			     FU_ENGINE_LOAD_FLAG_BUILTIN_PLUGINS | FU_ENGINE_LOAD_FLAG_READONLY |
+				 FU_ENGINE_LOAD_FLAG_NO_CACHE,
+			     progress,
+			     &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	plugin_mtd = fu_engine_get_plugin_by_name(engine, "mtd", NULL);
+	plugin_upower = fu_engine_get_plugin_by_name(engine, "upower", NULL);
+	if (plugin_mtd == NULL || plugin_upower == NULL) {
+		g_test_skip("no mtd or upower plugin");
+		return;
+	}
+
+	/* started when the first MTD device is added */
+	g_assert_true(fu_plugin_runner_can_defer_startup(plugin_mtd));
+
+	/* only has ->startup(), and is never given a backend device */
+	g_assert_false(fu_plugin_runner_can_defer_startup(plugin_upower));
+}
+
+#ifdef HAVE_HSI
+static guint64
+fu_engine_security_attrs_cache_get_count(FuEngine *engine)
+{
+	gboolean ret;
+	guint64 cnt = 0;
+	g_autoptr(FuSecurityAttrs) attrs = fu_engine_get_host_security_attrs(engine);
+	g_autoptr(FwupdSecurityAttr) attr = NULL;
+	g_autoptr(GError) error = NULL;
+
+	attr = fu_security_attrs_get_by_appstream_id(attrs,
+						     FWUPD_SECURITY_ATTR_ID_SPI_BIOSWE,
+						     &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(attr);
+	ret = fu_strtoull(fwupd_security_attr_get_metadata(attr, "Count"),
+			  &cnt,
+			  0,
+			  G_MAXUINT64,
+			  FU_INTEGER_BASE_10,
+			  &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	return cnt;
+}
+
+static void
+fu_engine_security_attrs_cache_func(void)
+{
+	gboolean ret;
+	guint64 cnt;
+	g_autoptr(FuContext) ctx = fu_context_new_full(FU_CONTEXT_FLAG_NO_QUIRKS);
+	g_autoptr(FuDevice) device = fu_device_new(ctx);
+	g_autoptr(FuEngine) engine = fu_engine_new(ctx);
+	g_autoptr(FuPlugin) plugin = fu_plugin_new_from_gtype(fu_test_plugin_get_type(), ctx);
+	g_autoptr(FuProgress) progress = fu_progress_new(G_STRLOC);
+	g_autoptr(FuTemporaryDirectory) tmpdir = NULL;
+	g_autoptr(GError) error = NULL;
+	g_autoptr(XbSilo) silo_empty = xb_silo_new();
+
+	/* set up test harness */
+	tmpdir = fu_temporary_directory_new("engine-security-attrs-cache", &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(tmpdir);
+	fu_context_set_tmpdir(ctx, FU_PATH_KIND_LOCALSTATEDIR_PKG, tmpdir);
+
+	/* no metadata in daemon */
+	fu_engine_set_silo(engine, silo_empty);
+
+	/* only depends on the devices */
+	ret = fu_plugin_set_config_value(plugin, "SecurityAttrs", "true", &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	fu_plugin_set_security_attrs_depends(plugin, FU_SECURITY_ATTRS_DEPENDS_DEVICES);
+	fu_engine_add_plugin(engine, plugin);
+	ret = fu_engine_load(engine,
+			     FU_ENGINE_LOAD_FLAG_NO_CACHE | FU_ENGINE_LOAD_FLAG_ALLOW_TEST_PLUGIN,
+			     progress,
+			     &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+
+	/* computed once */
+	cnt = fu_engine_security_attrs_cache_get_count(engine);
+	g_assert_cmpint(cnt, >, 0);
+	g_assert_cmpint(fu_engine_security_attrs_cache_get_count(engine), ==, cnt);
+
+	/* kernel change recomputes the attrs, but the plugin result is cached */
+	fu_context_security_changed(ctx);
+	g_assert_cmpint(fu_engine_security_attrs_cache_get_count(engine), ==, cnt);
+
+	/* a device change invalidates the plugin */
+	fu_device_set_id(device, "security-attrs-cache");
+	fu_device_add_instance_id(device, "security-attrs-cache-GUID");
+	fu_engine_add_device(engine, device);
+	g_assert_cmpint(fu_engine_security_attrs_cache_get_count(engine), ==, cnt + 1);
+	g_assert_cmpint(fu_engine_security_attrs_cache_get_count(engine), ==, cnt + 1);
+}
+#endif
+
 int
 main(int argc, char **argv)
 {
@@ -3583,5 +3697,9 @@ main(int argc, char **argv)
 	g_test_add_func("/fwupd/engine/plugin/composite-multistep",
 			fu_engine_plugin_composite_multistep_func);
 	g_test_add_func("/fwupd/engine/write-bios-attrs", fu_engine_modify_bios_settings_func);
+	g_test_add_func("/fwupd/engine/plugin-defer-startup", fu_engine_plugin_defer_startup_func);
+#ifdef HAVE_HSI
+	g_test_add_func("/fwupd/engine/security-attrs-cache", fu_engine_security_attrs_cache_func);
+#endif
 	return g_test_run();
 }
@@ -7,7 +7,11 @@
 #include "config.h"
 
 #include "fu-context-private.h"
+#include "fu-engine-struct.h"
 #include "fu-engine.h"
+#ifdef HAVE_UDEV
+#include "fu-udev-backend.h"
+#endif
 
 static void
 fu_test_engine_udev_hidraw(void)
@@ -250,6 +254,132 @@ fu_test_engine_udev_nvme(void)
 	g_assert_cmpstr(fu_device_get_logical_id(device), ==, NULL);
 }
 
+static FuEngine *
+fu_test_engine_udev_coldplug_cache_engine_new(FuTemporaryDirectory *tmpdir)
+{
+	gboolean ret;
+	g_autofree gchar *testdatadir = g_test_build_filename(G_TEST_DIST, "tests", NULL);
+	g_autofree gchar *testdatadir_quirks = NULL;
+	g_autofree gchar *testdatadir_sysfs = NULL;
+	g_autoptr(FuContext) ctx = fu_context_new();
+	g_autoptr(FuEngine) engine = fu_engine_new(ctx);
+	g_autoptr(FuProgress) progress = fu_progress_new(G_STRLOC);
+	g_autoptr(GError) error = NULL;
+
+	/* set up test harness, with the cache enabled in the mutable config */
+	testdatadir_quirks = g_test_build_filename(G_TEST_DIST, "tests", "quirks.d", NULL);
+	testdatadir_sysfs = g_test_build_filename(G_TEST_DIST, "tests", "sys", NULL);
+	fu_context_set_path(ctx, FU_PATH_KIND_SYSCONFDIR_PKG, testdatadir);
+	fu_context_set_path(ctx, FU_PATH_KIND_DATADIR_QUIRKS, testdatadir_quirks);
+	fu_context_set_path(ctx, FU_PATH_KIND_SYSFSDIR, testdatadir_sysfs);
+	fu_context_set_tmpdir(ctx, FU_PATH_KIND_LOCALCONFDIR_PKG, tmpdir);
+	fu_context_set_tmpdir(ctx, FU_PATH_KIND_LOCALSTATEDIR_PKG, tmpdir);
+	fu_context_set_tmpdir(ctx, FU_PATH_KIND_CACHEDIR_PKG, tmpdir);
+
+	/* not read-only, as the cache is only written by the daemon */
+	fu_engine_add_plugin_filter(engine, "nvme");
+	ret = fu_engine_load(engine,
+			     FU_ENGINE_LOAD_FLAG_COLDPLUG | FU_ENGINE_LOAD_FLAG_BUILTIN_PLUGINS |
+				 FU_ENGINE_LOAD_FLAG_NO_CACHE,
+			     progress,
+			     &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	return g_steal_pointer(&engine);
+}
+
+static void
+fu_test_engine_udev_coldplug_cache(void)
+{
+	gboolean ret;
+	const gchar *conf = "[fwupd]\nColdplugCache=true\n";
+	const gchar *device_id = "4c263c95f596030b430d65dc934f6722bcee5720";
+	g_autofree gchar *fn = NULL;
+	g_autofree gchar *fn_conf = NULL;
+	g_autoptr(FuContext) ctx = fu_context_new();
+	g_autoptr(FuDevice) device1 = NULL;
+	g_autoptr(FuDevice) device2 = NULL;
+	g_autoptr(FuEngine) engine1 = NULL;
+	g_autoptr(FuEngine) engine2 = NULL;
+	g_autoptr(FuTemporaryDirectory) tmpdir = NULL;
+	g_autoptr(FwupdJsonArray) json_arr = NULL;
+	g_autoptr(FwupdJsonNode) json_node = NULL;
+	g_autoptr(FwupdJsonObject) json_obj = NULL;
+	g_autoptr(FwupdJsonObject) json_obj_device = NULL;
+	g_autoptr(FwupdJsonObject) json_obj_entry = NULL;
+	g_autoptr(FwupdJsonParser) json_parser = fwupd_json_parser_new();
+	g_autoptr(GBytes) blob = NULL;
+	g_autoptr(GBytes) blob_conf = NULL;
+	g_autoptr(GBytes) blob_new = NULL;
+	g_autoptr(GError) error = NULL;
+
+	/* non-linux */
+	if (!fu_context_has_backend(ctx, "udev")) {
+		g_test_skip("no Udev backend");
+		return;
+	}
+
+	/* enable the cache */
+	tmpdir = fu_temporary_directory_new("engine-udev-coldplug-cache", &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(tmpdir);
+	fn_conf = fu_temporary_directory_build(tmpdir, "fwupd.conf", NULL);
+	blob_conf = g_bytes_new_static(conf, strlen(conf));
+	ret = fu_bytes_set_contents(fn_conf, blob_conf, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+
+	/* first start opens the device */
+	engine1 = fu_test_engine_udev_coldplug_cache_engine_new(tmpdir);
+	if (fu_engine_get_plugin_by_name(engine1, "nvme", &error) == NULL) {
+		g_test_skip(error->message);
+		return;
+	}
+	device1 = fu_engine_get_device(engine1, device_id, &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(device1);
+	g_clear_object(&engine1);
+
+	/* the device was saved, so change something only ->setup() would set */
+	fn = fu_temporary_directory_build(tmpdir, "coldplug.json", NULL);
+	blob = fu_bytes_get_contents(fn, &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(blob);
+	json_node = fwupd_json_parser_load_from_bytes(json_parser,
+						      blob,
+						      FWUPD_JSON_LOAD_FLAG_NONE,
+						      &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(json_node);
+	json_obj = fwupd_json_node_get_object(json_node, &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(json_obj);
+	json_arr = fwupd_json_object_get_array(json_obj, "Devices", &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(json_arr);
+	g_assert_cmpint(fwupd_json_array_get_size(json_arr), ==, 1);
+	json_obj_entry = fwupd_json_array_get_object(json_arr, 0, &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(json_obj_entry);
+	json_obj_device = fwupd_json_object_get_object(json_obj_entry, "Device", &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(json_obj_device);
+	fwupd_json_object_add_string(json_obj_device, "Name", "Restored From Cache");
+	blob_new = fwupd_json_object_to_bytes(json_obj, FWUPD_JSON_EXPORT_FLAG_NONE);
+	ret = fu_bytes_set_contents(fn, blob_new, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+
+	/* second start restores the device without setting it up */
+	engine2 = fu_test_engine_udev_coldplug_cache_engine_new(tmpdir);
+	device2 = fu_engine_get_device(engine2, device_id, &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(device2);
+	g_assert_cmpstr(fu_device_get_name(device2), ==, "Restored From Cache");
+	g_assert_cmpstr(fu_device_get_plugin(device2), ==, "nvme");
+	g_assert_cmpstr(fu_device_get_physical_id(device2), ==, "PCI_SLOT_NAME=0000:00:1b.0");
+}
+
 static void
 fu_test_engine_udev_serio(void)
 {
@@ -311,6 +441,108 @@ fu_test_engine_udev_serio(void)
 						FU_DEVICE_INSTANCE_FLAG_VISIBLE));
 }
 
+#ifdef HAVE_UDEV
+static GBytes *
+fu_test_engine_udev_uevent_new(const gchar *action, const gchar *devpath, const gchar *subsystem)
+{
+	g_autoptr(GByteArray) buf = g_byte_array_new();
+	g_autoptr(GString) props = g_string_new(NULL);
+
+	g_string_append_printf(props, "ACTION=%s", action);
+	g_string_append_c(props, '\0');
+	g_string_append_printf(props, "DEVPATH=%s", devpath);
+	g_string_append_c(props, '\0');
+	g_string_append_printf(props, "SUBSYSTEM=%s", subsystem);
+	g_string_append_c(props, '\0');
+#ifdef HAVE_UDEV_HOTPLUG
+	{
+		g_autoptr(FuStructUdevMonitorNetlinkHeader) st_hdr =
+		    fu_struct_udev_monitor_netlink_header_new();
+		fu_struct_udev_monitor_netlink_header_set_header_size(st_hdr, st_hdr->buf->len);
+		fu_struct_udev_monitor_netlink_header_set_properties_off(st_hdr, st_hdr->buf->len);
+		fu_struct_udev_monitor_netlink_header_set_properties_len(st_hdr, props->len);
+		g_byte_array_append(buf, st_hdr->buf->data, st_hdr->buf->len);
+	}
+#else
+	g_byte_array_append(buf, (const guint8 *)action, strlen(action));
+	fu_byte_array_append_uint8(buf, '@');
+	g_byte_array_append(buf, (const guint8 *)devpath, strlen(devpath) + 1);
+#endif
+	g_byte_array_append(buf, (const guint8 *)props->str, props->len);
+	return g_bytes_new(buf->data, buf->len);
+}
+
+static void
+fu_test_engine_udev_uevent_added_cb(FuBackend *backend, FuDevice *device, gpointer user_data)
+{
+	GPtrArray *added = (GPtrArray *)user_data;
+	g_ptr_array_add(added, g_strdup(fu_device_get_backend_id(device)));
+}
+#endif
+
+static void
+fu_test_engine_udev_uevents(void)
+{
+#ifdef HAVE_UDEV
+	gboolean ret;
+	const gchar *devpath_parent = "/devices/pci0000_00/0000_00_1b.0";
+	const gchar *devpath_child = "/devices/pci0000_00/0000_00_1b.0/0000_02_00.0";
+	g_autofree gchar *str = NULL;
+	g_autofree gchar *testdatadir_sysfs = NULL;
+	g_autoptr(FuContext) ctx = fu_context_new();
+	g_autoptr(FuBackend) backend = NULL;
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GPtrArray) added = g_ptr_array_new_with_free_func(g_free);
+	g_autoptr(GPtrArray) uevents =
+	    g_ptr_array_new_with_free_func((GDestroyNotify)g_bytes_unref);
+
+	/* set up test harness */
+	testdatadir_sysfs = g_test_build_filename(G_TEST_DIST, "tests", "sys", NULL);
+	fu_context_set_path(ctx, FU_PATH_KIND_SYSFSDIR, testdatadir_sysfs);
+	backend = fu_udev_backend_new(ctx);
+	g_signal_connect(backend,
+			 "device-added",
+			 G_CALLBACK(fu_test_engine_udev_uevent_added_cb),
+			 added);
+
+	/* a dock being attached: the child shows up first, along with lots of devices that
+	 * disappear again before they are ready */
+	g_ptr_array_add(uevents, fu_test_engine_udev_uevent_new("add", devpath_child, "pci"));
+	g_ptr_array_add(uevents, fu_test_engine_udev_uevent_new("add", devpath_parent, "pci"));
+	g_ptr_array_add(uevents, fu_test_engine_udev_uevent_new("change", devpath_parent, "pci"));
+	for (guint i = 0; i < 100; i++) {
+		g_autofree gchar *devpath = g_strdup_printf("/devices/dock/usb%u", i);
+		g_ptr_array_add(uevents, fu_test_engine_udev_uevent_new("add", devpath, "usb"));
+		g_ptr_array_add(uevents, fu_test_engine_udev_uevent_new("change", devpath, "usb"));
+		g_ptr_array_add(uevents, fu_test_engine_udev_uevent_new("remove", devpath, "usb"));
+	}
+
+	/* replay */
+	for (guint i = 0; i < uevents->len; i++) {
+		GBytes *blob = g_ptr_array_index(uevents, i);
+		ret = fu_udev_backend_add_uevent(FU_UDEV_BACKEND(backend), blob, &error);
+		g_assert_no_error(error);
+		g_assert_true(ret);
+	}
+	str = fwupd_codec_to_string(FWUPD_CODEC(backend));
+	g_debug("%s", str);
+
+	/* the parent change is folded into its add, and each USB device cancels out */
+	g_assert_cmpint(fu_udev_backend_get_uevents_pending(FU_UDEV_BACKEND(backend)), ==, 2);
+	g_assert_cmpint(fu_udev_backend_get_uevents_dropped(FU_UDEV_BACKEND(backend)), ==, 301);
+	g_assert_cmpint(added->len, ==, 0);
+	fu_udev_backend_flush_uevents(FU_UDEV_BACKEND(backend));
+	g_assert_cmpint(fu_udev_backend_get_uevents_pending(FU_UDEV_BACKEND(backend)), ==, 0);
+
+	/* only the PCI devices were added, and parent first */
+	g_assert_cmpint(added->len, ==, 2);
+	g_assert_true(g_str_has_suffix(g_ptr_array_index(added, 0), devpath_parent));
+	g_assert_true(g_str_has_suffix(g_ptr_array_index(added, 1), devpath_child));
+#else
+	g_test_skip("no Udev backend");
+#endif
+}
+
 int
 main(int argc, char **argv)
 {
@@ -321,6 +553,8 @@ main(int argc, char **argv)
 	g_test_add_func("/fwupd/engine/udev/usb", fu_test_engine_udev_usb);
 	g_test_add_func("/fwupd/engine/udev/serio", fu_test_engine_udev_serio);
 	g_test_add_func("/fwupd/engine/udev/nvme", fu_test_engine_udev_nvme);
+	g_test_add_func("/fwupd/engine/udev/coldplug-cache", fu_test_engine_udev_coldplug_cache);
 	g_test_add_func("/fwupd/engine/udev/v4l", fu_test_engine_udev_v4l);
+	g_test_add_func("/fwupd/engine/udev/uevents", fu_test_engine_udev_uevents);
 	return g_test_run();
 }
@@ -41,6 +41,7 @@
 #include "fu-bios-setting.h"
 #include "fu-bios-settings-private.h"
 #include "fu-config-private.h"
+#include "fu-coldplug-cache.h"
 #include "fu-context-private.h"
 #include "fu-device-list.h"
 #include "fu-device-private.h"
@@ -82,6 +83,8 @@
 
 #define FU_ENGINE_UPDATE_MOTD_DELAY 5 /* s */
 
+#define FU_ENGINE_COLDPLUG_CACHE_SAVE_DELAY 30 /* s */
+
 #define FU_ENGINE_MAX_METADATA_SIZE  (32 * FU_MB)
 #define FU_ENGINE_MAX_SIGNATURE_SIZE (1 * FU_MB)
 
@@ -92,9 +95,13 @@ fu_engine_finalize(GObject *obj);
 static void
 fu_engine_ensure_security_attrs(FuEngine *self);
 static void
+fu_engine_invalidate_security_attrs(FuEngine *self, FuSecurityAttrsDepends depends);
+static void
 fu_engine_md_refresh_device(FuEngine *self, FuDevice *device);
 static void
 fu_engine_metadata_changed(FuEngine *self);
+static void
+fu_engine_coldplug_cache_invalidate(FuEngine *self);
 
 struct _FuEngine {
 	GObject parent_instance;
@@ -104,6 +111,7 @@ struct _FuEngine {
 	gboolean host_emulation;
 	FuHistory *history;
 	FuIdle *idle;
+	FuColdplugCache *coldplug_cache;
 	XbSilo *silo;
 	XbQuery *query_component_by_guid;
 	XbQuery *query_container_checksum1; /* container checksum -> release */
@@ -119,11 +127,15 @@ struct _FuEngine {
 	gchar *host_machine_id;
 	FuJcatContext *jcat_context;
 	FuSecurityAttrs *host_security_attrs;
+	FuSecurityAttrsDepends host_security_invalid;
+	GHashTable *host_security_plugins; /* (element-type utf-8 GPtrArray) */
+	GPtrArray *host_security_devices;  /* (nullable) (element-type FwupdSecurityAttr) */
 	GPtrArray *local_monitors; /* (element-type GFileMonitor) */
 	GMainLoop *acquiesce_loop;
 	guint acquiesce_id;
 	guint acquiesce_delay;
 	guint update_motd_id;
+	guint coldplug_cache_save_id;
 	FuEngineEmulatorPhase emulator_phase;
 	guint emulator_write_cnt;
 	guint emulator_composite_cnt;
@@ -227,7 +239,7 @@ fu_engine_emit_device_changed_safe(FuEngine *self, FuDevice *device)
 		return;
 
 	/* invalidate host security attributes */
-	fu_security_attrs_remove_all(self->host_security_attrs);
+	fu_engine_invalidate_security_attrs(self, FU_SECURITY_ATTRS_DEPENDS_DEVICES);
 	g_signal_emit(self, signals[SIGNAL_DEVICE_CHANGED], 0, device);
 }
 
@@ -667,6 +679,7 @@ fu_engine_device_added_cb(FuDeviceList *device_list, FuDevice *device, FuEngine
 	fu_engine_ensure_device_system_inhibit(self, device);
 	fu_engine_ensure_device_maybe_remove_affects_fde(self, device);
 	fu_engine_acquiesce_reset(self);
+	fu_engine_invalidate_security_attrs(self, FU_SECURITY_ATTRS_DEPENDS_DEVICES);
 	g_signal_emit(self, signals[SIGNAL_DEVICE_ADDED], 0, device);
 }
 
@@ -685,6 +698,7 @@ fu_engine_device_removed_cb(FuDeviceList *device_list, FuDevice *device, FuEngin
 {
 	fu_engine_device_runner_device_removed(self, device);
 	fu_engine_acquiesce_reset(self);
+	fu_engine_invalidate_security_attrs(self, FU_SECURITY_ATTRS_DEPENDS_DEVICES);
 	g_signal_handlers_disconnect_by_data(device, self);
 	g_signal_emit(self, signals[SIGNAL_DEVICE_REMOVED], 0, device);
 }
@@ -4026,10 +4040,15 @@ fu_engine_install_blob(FuEngine *self,
 	fu_progress_add_step(progress, FWUPD_STATUS_DEVICE_BUSY, 1, "prepare");
 	fu_progress_add_step(progress, FWUPD_STATUS_DEVICE_WRITE, 98, NULL);
 	fu_progress_add_step(progress, FWUPD_STATUS_DEVICE_BUSY, 1, "cleanup");
+	fu_progress_add_trace_arg(progress, "DeviceId", fu_device_get_id(device));
+	fu_progress_add_trace_arg(progress, "Plugin", fu_device_get_plugin(device));
 
 	/* mark this as modified even if we actually fail to do the update */
 	fu_device_set_modified_usec(device, g_get_real_time());
 
+	/* the device may not come back with the same version, or even the same GUIDs */
+	fu_engine_coldplug_cache_invalidate(self);
+
 	/* signal to all the plugins the update is about to happen */
 	device_id = g_strdup(fu_device_get_id(device));
 	fu_engine_set_emulator_phase(self, FU_ENGINE_EMULATOR_PHASE_PREPARE);
@@ -4738,7 +4757,7 @@ fu_engine_metadata_changed(FuEngine *self)
 	fu_engine_md_refresh_devices(self);
 
 	/* invalidate host security attributes */
-	fu_security_attrs_remove_all(self->host_security_attrs);
+	fu_engine_invalidate_security_attrs(self, FU_SECURITY_ATTRS_DEPENDS_METADATA);
 
 	/* make the UI update */
 	fu_engine_emit_changed(self);
@@ -5025,7 +5044,7 @@ fu_engine_update_metadata_bytes(FuEngine *self,
 	fu_engine_md_refresh_devices(self);
 
 	/* invalidate host security attributes */
-	fu_security_attrs_remove_all(self->host_security_attrs);
+	fu_engine_invalidate_security_attrs(self, FU_SECURITY_ATTRS_DEPENDS_METADATA);
 
 	/* make the UI update */
 	fu_engine_emit_changed(self);
@@ -5109,7 +5128,8 @@ fu_engine_update_metadata(FuEngine *self,
 FuCabinet *
 fu_engine_build_cabinet_from_stream(FuEngine *self, GInputStream *stream, GError **error)
 {
-	FuFirmwareParseFlags flags = FU_FIRMWARE_PARSE_FLAG_CACHE_STREAM;
+	FuFirmwareParseFlags flags =
+	    FU_FIRMWARE_PARSE_FLAG_CACHE_STREAM | FU_FIRMWARE_PARSE_FLAG_LAZY;
 	g_autoptr(FuCabinet) cabinet = fu_cabinet_new();
 
 	g_return_val_if_fail(FU_IS_ENGINE(self), NULL);
@@ -5615,6 +5635,9 @@ fu_engine_fixup_history_device(FuEngine *self, FuDevice *device, GError **error)
 /**
  * fu_engine_get_history:
  * @self: a #FuEngine
+ * @since: UNIX timestamp of the oldest modification to return, or 0 for no limit
+ * @offset: number of more recently modified devices to skip
+ * @limit: maximum number of devices to return, or 0 for no limit
  * @error: (nullable): optional return location for an error
  *
  * Gets the list of history.
@@ -5622,24 +5645,21 @@ fu_engine_fixup_history_device(FuEngine *self, FuDevice *device, GError **error)
  * Returns: (transfer container) (element-type FwupdDevice): results
  **/
 GPtrArray *
-fu_engine_get_history(FuEngine *self, GError **error)
+fu_engine_get_history(FuEngine *self, guint64 since, guint offset, guint limit, GError **error)
 {
-	g_autoptr(GPtrArray) devices_all = NULL;
-	g_autoptr(GPtrArray) devices =
-	    g_ptr_array_new_with_free_func((GDestroyNotify)g_object_unref);
+	g_autoptr(GPtrArray) devices = NULL;
 
 	g_return_val_if_fail(FU_IS_ENGINE(self), NULL);
 	g_return_val_if_fail(error == NULL || *error == NULL, NULL);
 
-	devices_all = fu_history_get_devices(self->history, error);
-	if (devices_all == NULL)
+	devices = fu_history_get_devices_filtered(self->history,
+						  since,
+						  offset,
+						  limit,
+						  FWUPD_DEVICE_FLAG_EMULATED,
+						  error);
+	if (devices == NULL)
 		return NULL;
-	for (guint i = 0; i < devices_all->len; i++) {
-		FuDevice *dev = g_ptr_array_index(devices_all, i);
-		if (fu_device_has_flag(dev, FWUPD_DEVICE_FLAG_EMULATED))
-			continue;
-		g_ptr_array_add(devices, g_object_ref(dev));
-	}
 	if (devices->len == 0) {
 		g_set_error_literal(error, FWUPD_ERROR, FWUPD_ERROR_NOTHING_TO_DO, "No history");
 		return NULL;
@@ -6566,24 +6586,46 @@ fu_engine_get_results(FuEngine *self, const gchar *device_id, GError **error)
 	return g_object_ref(FWUPD_DEVICE(device));
 }
 
+static gboolean
+fu_engine_plugin_startup(FuEngine *self, FuPlugin *plugin, FuProgress *progress, GError **error)
+{
+	g_autoptr(GError) error_local = NULL;
+	if (!fu_plugin_runner_startup(plugin, progress, &error_local)) {
+		fu_plugin_add_flag(plugin, FWUPD_PLUGIN_FLAG_DISABLED);
+		if (g_error_matches(error_local, FWUPD_ERROR, FWUPD_ERROR_NOT_SUPPORTED))
+			fu_plugin_add_flag(plugin, FWUPD_PLUGIN_FLAG_NO_HARDWARE);
+		g_info("disabling plugin because: %s", error_local->message);
+		g_propagate_error(error, g_steal_pointer(&error_local));
+		return FALSE;
+	}
+	return TRUE;
+}
+
 static void
 fu_engine_plugins_startup(FuEngine *self, FuProgress *progress)
 {
 	GPtrArray *plugins = fu_plugin_list_get_all(self->plugin_list);
+	g_autoptr(GString) str = g_string_new(NULL);
+
 	fu_progress_set_id(progress, G_STRLOC);
 	fu_progress_set_steps(progress, plugins->len);
 	for (guint i = 0; i < plugins->len; i++) {
-		g_autoptr(GError) error = NULL;
 		FuPlugin *plugin = g_ptr_array_index(plugins, i);
-		if (!fu_plugin_runner_startup(plugin, fu_progress_get_child(progress), &error)) {
-			fu_plugin_add_flag(plugin, FWUPD_PLUGIN_FLAG_DISABLED);
-			if (g_error_matches(error, FWUPD_ERROR, FWUPD_ERROR_NOT_SUPPORTED))
-				fu_plugin_add_flag(plugin, FWUPD_PLUGIN_FLAG_NO_HARDWARE);
-			g_info("disabling plugin because: %s", error->message);
-			fu_progress_add_flag(progress, FU_PROGRESS_FLAG_CHILD_FINISHED);
+
+		/* only started when a backend device is added */
+		if (fu_plugin_runner_can_defer_startup(plugin)) {
+			g_string_append_printf(str, "%s, ", fu_plugin_get_name(plugin));
+			fu_progress_step_done(progress);
+			continue;
 		}
+		if (!fu_engine_plugin_startup(self, plugin, fu_progress_get_child(progress), NULL))
+			fu_progress_add_flag(progress, FU_PROGRESS_FLAG_CHILD_FINISHED);
 		fu_progress_step_done(progress);
 	}
+	if (str->len > 2) {
+		g_string_truncate(str, str->len - 2);
+		g_info("deferring startup of plugins: %s", str->str);
+	}
 }
 
 static void
@@ -6667,11 +6709,112 @@ fu_engine_plugin_device_register_cb(FuPlugin *plugin, FuDevice *device, gpointer
 	fu_engine_plugin_device_register(self, device);
 }
 
+static gboolean
+fu_engine_coldplug_cache_enabled(FuEngine *self)
+{
+	if (!fu_context_get_config_bool(self->ctx, "ColdplugCache"))
+		return FALSE;
+	if (fu_context_has_flag(self->ctx, FU_CONTEXT_FLAG_SAVE_EVENTS))
+		return FALSE;
+	return (self->load_flags & FU_ENGINE_LOAD_FLAG_READONLY) == 0;
+}
+
+static void
+fu_engine_coldplug_cache_save(FuEngine *self)
+{
+	g_autoptr(GError) error_local = NULL;
+	if (self->coldplug_cache_save_id != 0) {
+		g_source_remove(self->coldplug_cache_save_id);
+		self->coldplug_cache_save_id = 0;
+	}
+	if (!fu_engine_coldplug_cache_enabled(self))
+		return;
+	if (!fu_coldplug_cache_save(self->coldplug_cache, &error_local))
+		g_info("failed to save coldplug cache: %s", error_local->message);
+}
+
+static gboolean
+fu_engine_coldplug_cache_save_timeout_cb(gpointer user_data)
+{
+	FuEngine *self = FU_ENGINE(user_data);
+	self->coldplug_cache_save_id = 0;
+	fu_engine_coldplug_cache_save(self);
+	return G_SOURCE_REMOVE;
+}
+
+/* a dock may add dozens of devices, so only write the file once they have all arrived */
+static void
+fu_engine_coldplug_cache_save_reset(FuEngine *self)
+{
+	if (self->coldplug_cache_save_id != 0)
+		g_source_remove(self->coldplug_cache_save_id);
+	self->coldplug_cache_save_id =
+	    g_timeout_add_seconds(FU_ENGINE_COLDPLUG_CACHE_SAVE_DELAY,
+				  fu_engine_coldplug_cache_save_timeout_cb,
+				  self);
+}
+
+static void
+fu_engine_coldplug_cache_invalidate(FuEngine *self)
+{
+	if (fu_coldplug_cache_get_size(self->coldplug_cache) == 0)
+		return;
+	fu_coldplug_cache_clear(self->coldplug_cache);
+	fu_engine_coldplug_cache_save(self);
+}
+
+static void
+fu_engine_coldplug_cache_load(FuEngine *self)
+{
+	g_autofree gchar *fn = NULL;
+	g_autoptr(GError) error_local = NULL;
+
+	if (!fu_engine_coldplug_cache_enabled(self))
+		return;
+	fn = fu_context_build_filename(self->ctx,
+				       &error_local,
+				       FU_PATH_KIND_CACHEDIR_PKG,
+				       "coldplug.json",
+				       NULL);
+	if (fn == NULL) {
+		g_info("ignoring coldplug cache: %s", error_local->message);
+		return;
+	}
+	if (!fu_coldplug_cache_load(self->coldplug_cache, fn, &error_local)) {
+		g_info("failed to load coldplug cache: %s", error_local->message);
+		return;
+	}
+	g_debug("loaded %u devices from coldplug cache",
+		fu_coldplug_cache_get_size(self->coldplug_cache));
+}
+
+static gboolean
+fu_engine_plugin_device_restore_cb(FuPlugin *plugin, FuDevice *device, FuEngine *self)
+{
+	/* only when starting the daemon, not when hotplugging */
+	if (!fu_engine_coldplug_cache_enabled(self))
+		return FALSE;
+	if (self->load_flags & FU_ENGINE_LOAD_FLAG_READY)
+		return FALSE;
+	return fu_coldplug_cache_restore_device(self->coldplug_cache,
+						device,
+						fu_plugin_get_name(plugin));
+}
+
 static void
 fu_engine_plugin_device_added_cb(FuPlugin *plugin, FuDevice *device, gpointer user_data)
 {
 	FuEngine *self = FU_ENGINE(user_data);
 
+	/* save the device as set up by the plugin */
+	if (fu_engine_coldplug_cache_enabled(self)) {
+		fu_coldplug_cache_add_device(self->coldplug_cache,
+					     device,
+					     fu_plugin_get_name(plugin));
+		if (self->load_flags & FU_ENGINE_LOAD_FLAG_READY)
+			fu_engine_coldplug_cache_save_reset(self);
+	}
+
 	/* plugin has prio and device not already set from quirk */
 	if (fu_plugin_get_priority(plugin) > 0 && fu_device_get_priority(device) == 0) {
 		g_info("auto-setting %s priority to %u",
@@ -7094,7 +7237,7 @@ fu_engine_context_security_changed_cb(FuContext *ctx, gpointer user_data)
 	FuEngine *self = FU_ENGINE(user_data);
 
 	/* invalidate host security attributes */
-	fu_security_attrs_remove_all(self->host_security_attrs);
+	fu_engine_invalidate_security_attrs(self, FU_SECURITY_ATTRS_DEPENDS_KERNEL);
 
 	/* make UI refresh */
 	fu_engine_emit_changed(self);
@@ -7347,35 +7490,13 @@ fu_engine_get_host_security_id(FuEngine *self, const gchar *fwupd_version)
 static gboolean
 fu_engine_record_security_attrs(FuEngine *self, GError **error)
 {
-	g_autoptr(GPtrArray) attrs_array = NULL;
 	g_autofree gchar *host_security_id = fu_engine_get_host_security_id(self, NULL);
-	g_autofree gchar *json = NULL;
 
-	/* convert attrs to json string */
-	json = fwupd_codec_to_json_string(FWUPD_CODEC(self->host_security_attrs),
-					  FWUPD_CODEC_FLAG_NONE,
-					  error);
-	if (json == NULL) {
-		g_prefix_error_literal(error, "cannot convert current attrs to string: ");
-		return FALSE;
-	}
-
-	/* check that we did not store this already last boot */
-	attrs_array = fu_history_get_security_attrs(self->history, 1, error);
-	if (attrs_array == NULL) {
-		g_prefix_error_literal(error, "failed to get historical attr: ");
-		return FALSE;
-	}
-	if (attrs_array->len > 0) {
-		FuSecurityAttrs *attrs_tmp = g_ptr_array_index(attrs_array, 0);
-		if (fu_security_attrs_equal(attrs_tmp, self->host_security_attrs)) {
-			g_info("skipping writing HSI attrs to database as unchanged");
-			return TRUE;
-		}
-	}
-
-	/* write new values */
-	if (!fu_history_add_security_attribute(self->history, json, host_security_id, error)) {
+	/* this does nothing if unchanged since the last entry */
+	if (!fu_history_add_security_attribute(self->history,
+					       self->host_security_attrs,
+					       host_security_id,
+					       error)) {
 		g_prefix_error_literal(error, "failed to write to DB: ");
 		return FALSE;
 	}
@@ -7725,6 +7846,45 @@ fu_engine_load_host_emulation(FuEngine *self, const gchar *fn, GError **error)
 	return TRUE;
 }
 
+static void
+fu_engine_invalidate_security_attrs(FuEngine *self, FuSecurityAttrsDepends depends)
+{
+	self->host_security_invalid |= depends;
+	fu_security_attrs_remove_all(self->host_security_attrs);
+}
+
+#ifdef HAVE_HSI
+static guint
+fu_engine_security_attrs_get_size(FuEngine *self)
+{
+	g_autoptr(GPtrArray) attrs = fu_security_attrs_get_all_mutable(self->host_security_attrs);
+	return attrs->len;
+}
+
+/* copy so that depsolving the host attributes does not modify the cached versions */
+static GPtrArray *
+fu_engine_security_attrs_copy_from(FuEngine *self, guint idx)
+{
+	g_autoptr(GPtrArray) attrs = fu_security_attrs_get_all_mutable(self->host_security_attrs);
+	GPtrArray *attrs_copy = g_ptr_array_new_with_free_func((GDestroyNotify)g_object_unref);
+	for (guint i = idx; i < attrs->len; i++) {
+		FwupdSecurityAttr *attr = g_ptr_array_index(attrs, i);
+		g_ptr_array_add(attrs_copy, fwupd_security_attr_copy(attr));
+	}
+	return attrs_copy;
+}
+
+static void
+fu_engine_security_attrs_append_cached(FuEngine *self, GPtrArray *attrs)
+{
+	for (guint i = 0; i < attrs->len; i++) {
+		FwupdSecurityAttr *attr = g_ptr_array_index(attrs, i);
+		g_autoptr(FwupdSecurityAttr) attr_copy = fwupd_security_attr_copy(attr);
+		fu_security_attrs_append(self->host_security_attrs, attr_copy);
+	}
+}
+#endif
+
 static void
 fu_engine_ensure_security_attrs(FuEngine *self)
 {
@@ -7743,16 +7903,45 @@ fu_engine_ensure_security_attrs(FuEngine *self)
 	fu_engine_ensure_security_attrs_tainted(self);
 
 	/* call into devices */
-	for (guint i = 0; i < devices->len; i++) {
-		FuDevice *device = g_ptr_array_index(devices, i);
-		fu_device_add_security_attrs(device, self->host_security_attrs);
+	if (self->host_security_devices == NULL ||
+	    (self->host_security_invalid &
+	     (FU_SECURITY_ATTRS_DEPENDS_DEVICES | FU_SECURITY_ATTRS_DEPENDS_METADATA)) > 0) {
+		guint idx = fu_engine_security_attrs_get_size(self);
+		for (guint i = 0; i < devices->len; i++) {
+			FuDevice *device = g_ptr_array_index(devices, i);
+			fu_device_add_security_attrs(device, self->host_security_attrs);
+		}
+		if (self->host_security_devices != NULL)
+			g_ptr_array_unref(self->host_security_devices);
+		self->host_security_devices = fu_engine_security_attrs_copy_from(self, idx);
+	} else {
+		fu_engine_security_attrs_append_cached(self, self->host_security_devices);
 	}
 
-	/* call into plugins */
+	/* call into plugins, but only the ones with changed inputs */
 	for (guint j = 0; j < plugins->len; j++) {
 		FuPlugin *plugin_tmp = g_ptr_array_index(plugins, j);
+		const gchar *name = fu_plugin_get_name(plugin_tmp);
+		GPtrArray *attrs_cached = g_hash_table_lookup(self->host_security_plugins, name);
+		guint idx;
+
+		if (attrs_cached != NULL && (fu_plugin_get_security_attrs_depends(plugin_tmp) &
+					     self->host_security_invalid) == 0) {
+			fu_engine_security_attrs_append_cached(self, attrs_cached);
+			continue;
+		}
+		idx = fu_engine_security_attrs_get_size(self);
 		fu_plugin_runner_add_security_attrs(plugin_tmp, self->host_security_attrs);
+		if (fu_plugin_get_security_attrs_elapsed(plugin_tmp) > 0) {
+			g_debug("add_security_attrs(%s) took %.1fms",
+				name,
+				fu_plugin_get_security_attrs_elapsed(plugin_tmp));
+		}
+		g_hash_table_insert(self->host_security_plugins,
+				    g_strdup(name),
+				    fu_engine_security_attrs_copy_from(self, idx));
 	}
+	self->host_security_invalid = FU_SECURITY_ATTRS_DEPENDS_NONE;
 
 	/* sanity check */
 	vals = fu_security_attrs_get_all(self->host_security_attrs, NULL);
@@ -7789,14 +7978,19 @@ fu_engine_get_host_security_attrs(FuEngine *self)
 }
 
 FuSecurityAttrs *
-fu_engine_get_host_security_events(FuEngine *self, guint limit, GError **error)
+fu_engine_get_host_security_events(FuEngine *self,
+				   guint64 since,
+				   guint offset,
+				   guint limit,
+				   GError **error)
 {
 	g_autoptr(FuSecurityAttrs) events = fu_security_attrs_new();
 	g_autoptr(GPtrArray) attrs_array = NULL;
 
 	g_return_val_if_fail(FU_IS_ENGINE(self), NULL);
 
-	attrs_array = fu_history_get_security_attrs(self->history, limit, error);
+	attrs_array =
+	    fu_history_get_security_attrs_filtered(self->history, since, offset, limit, error);
 	if (attrs_array == NULL)
 		return NULL;
 	for (guint i = 1; i < attrs_array->len; i++) {
@@ -8003,6 +8197,10 @@ fu_engine_plugins_init(FuEngine *self, FuProgress *progress, GError **error)
 				 "check-supported",
 				 G_CALLBACK(fu_engine_plugin_check_supported_cb),
 				 self);
+		g_signal_connect(FU_PLUGIN(plugin),
+				 "device-restore",
+				 G_CALLBACK(fu_engine_plugin_device_restore_cb),
+				 self);
 		g_signal_connect(FU_PLUGIN(plugin),
 				 "rules-changed",
 				 G_CALLBACK(fu_engine_plugin_rules_changed_cb),
@@ -8136,6 +8334,9 @@ fu_engine_backend_device_removed_cb(FuBackend *backend, FuDevice *device, FuEngi
 	/* debug */
 	g_debug("%s removed %s", fu_backend_get_name(backend), fu_device_get_backend_id(device));
 
+	/* plugins such as pci-bcr and iommu use backend devices for security attributes */
+	fu_engine_invalidate_security_attrs(self, FU_SECURITY_ATTRS_DEPENDS_DEVICES);
+
 	/* go through each device and remove any that match */
 	devices = fu_device_list_get_active(self->device_list);
 	for (guint i = 0; i < devices->len; i++) {
@@ -8176,6 +8377,13 @@ fu_engine_backend_device_added_run_plugin(FuEngine *self,
 	if (plugin == NULL)
 		return FALSE;
 
+	/* the startup may have been deferred until now */
+	if (!fu_plugin_has_flag(plugin, FWUPD_PLUGIN_FLAG_DISABLED)) {
+		g_autoptr(FuProgress) progress_startup = fu_progress_new(G_STRLOC);
+		if (!fu_engine_plugin_startup(self, plugin, progress_startup, error))
+			return FALSE;
+	}
+
 	/* run the ->probe() then ->setup() vfuncs */
 	if (!fu_plugin_runner_backend_device_added(plugin, device, progress, error)) {
 #ifdef SUPPORTED_BUILD
@@ -8296,6 +8504,9 @@ fu_engine_backend_device_added(FuEngine *self, FuDevice *device, FuProgress *pro
 	/* can be specified using a quirk */
 	fu_engine_backend_device_added_run_plugins(self, device, fu_progress_get_child(progress));
 	fu_progress_step_done(progress);
+
+	/* plugins such as pci-bcr and iommu use backend devices for security attributes */
+	fu_engine_invalidate_security_attrs(self, FU_SECURITY_ATTRS_DEPENDS_DEVICES);
 }
 
 static void
@@ -9100,6 +9311,7 @@ fu_engine_load(FuEngine *self, FuEngineLoadFlags flags, FuProgress *progress, GE
 	/* add devices */
 	if (flags & FU_ENGINE_LOAD_FLAG_COLDPLUG) {
 		fu_engine_ensure_context_flag_save_events(self);
+		fu_engine_coldplug_cache_load(self);
 		fu_engine_plugins_startup(self, fu_progress_get_child(progress));
 		fu_progress_step_done(progress);
 		fu_engine_plugins_coldplug(self, fu_progress_get_child(progress));
@@ -9125,6 +9337,10 @@ fu_engine_load(FuEngine *self, FuEngineLoadFlags flags, FuProgress *progress, GE
 	/* rerun <requires> checks against the full device tree */
 	fu_engine_ensure_devices_supported(self);
 
+	/* only keep the devices that are still present */
+	if (flags & FU_ENGINE_LOAD_FLAG_COLDPLUG)
+		fu_engine_coldplug_cache_save(self);
+
 	/* dump plugin information to the console */
 	if (g_log_get_debug_enabled()) {
 		g_autoptr(GString) str = g_string_new(NULL);
@@ -9420,6 +9636,7 @@ fu_engine_constructed(GObject *obj)
 	/* defaults changed here will also be reflected in the fwupd.conf man page */
 	fu_config_set_default(config, "fwupd", "ApprovedFirmware", NULL);
 	fu_config_set_default(config, "fwupd", "ArchiveSizeMax", archive_size_max_default);
+	fu_config_set_default(config, "fwupd", "ColdplugCache", "false");
 	fu_config_set_default(config, "fwupd", "DisabledDevices", NULL);
 	fu_config_set_default(config, "fwupd", "DisabledPlugins", "");
 	fu_config_set_default(config, "fwupd", "EnumerateAllDevices", "false");
@@ -9584,9 +9801,15 @@ fu_engine_init(FuEngine *self)
 {
 	self->device_list = fu_device_list_new();
 	self->idle = fu_idle_new();
+	self->coldplug_cache = fu_coldplug_cache_new();
 	self->plugin_list = fu_plugin_list_new();
 	self->plugin_filter = g_ptr_array_new_with_free_func(g_free);
 	self->host_security_attrs = fu_security_attrs_new();
+	self->host_security_plugins =
+	    g_hash_table_new_full(g_str_hash,
+				  g_str_equal,
+				  g_free,
+				  (GDestroyNotify)g_ptr_array_unref);
 	self->local_monitors = g_ptr_array_new_with_free_func((GDestroyNotify)g_object_unref);
 	self->search_queries = g_ptr_array_new_with_free_func((GDestroyNotify)g_object_unref);
 	self->acquiesce_loop = g_main_loop_new(NULL, FALSE);
@@ -9630,6 +9853,8 @@ fu_engine_finalize(GObject *obj)
 		g_source_remove(self->acquiesce_id);
 	if (self->update_motd_id != 0)
 		g_source_remove(self->update_motd_id);
+	if (self->coldplug_cache_save_id != 0)
+		g_source_remove(self->coldplug_cache_save_id);
 	if (self->emulation != NULL)
 		g_object_unref(self->emulation);
 #ifdef HAVE_PASSIM
@@ -9640,7 +9865,11 @@ fu_engine_finalize(GObject *obj)
 
 	g_free(self->host_machine_id);
 	g_object_unref(self->host_security_attrs);
+	g_hash_table_unref(self->host_security_plugins);
+	if (self->host_security_devices != NULL)
+		g_ptr_array_unref(self->host_security_devices);
 	g_object_unref(self->idle);
+	g_object_unref(self->coldplug_cache);
 	g_object_unref(self->remote_list);
 	g_object_unref(self->history);
 	g_object_unref(self->device_list);
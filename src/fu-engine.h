@@ -63,7 +63,8 @@ GPtrArray *
 fu_engine_get_devices_by_composite_id(FuEngine *self, const gchar *composite_id, GError **error)
     G_GNUC_NON_NULL(1, 2);
 GPtrArray *
-fu_engine_get_history(FuEngine *self, GError **error) G_GNUC_NON_NULL(1);
+fu_engine_get_history(FuEngine *self, guint64 since, guint offset, guint limit, GError **error)
+    G_GNUC_NON_NULL(1);
 FwupdRemote *
 fu_engine_get_remote_by_id(FuEngine *self, const gchar *remote_id, GError **error)
     G_GNUC_NON_NULL(1, 2);
@@ -91,7 +92,11 @@ fu_engine_get_results(FuEngine *self, const gchar *device_id, GError **error) G_
 FuSecurityAttrs *
 fu_engine_get_host_security_attrs(FuEngine *self) G_GNUC_NON_NULL(1);
 FuSecurityAttrs *
-fu_engine_get_host_security_events(FuEngine *self, guint limit, GError **error) G_GNUC_NON_NULL(1);
+fu_engine_get_host_security_events(FuEngine *self,
+				   guint64 since,
+				   guint offset,
+				   guint limit,
+				   GError **error) G_GNUC_NON_NULL(1);
 GHashTable *
 fu_engine_get_report_metadata(FuEngine *self, GError **error) G_GNUC_NON_NULL(1);
 gboolean
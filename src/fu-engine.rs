@@ -71,7 +71,7 @@ enum FuEngineCapabilityFlags {
     IdRequirementGlob = 1 << 0,
 }
 
-#[derive(ParseBytes, Default)]
+#[derive(New, ParseBytes, Default)]
 #[repr(C, packed)]
 struct FuStructUdevMonitorNetlinkHeader {
     prefix: [char; 8] == "libudev",
@@ -0,0 +1,12 @@
+/*
+ * Copyright 2026 Richard Hughes <richard@hughsie.com>
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ */
+
+#pragma once
+
+#include "fu-history.h"
+
+guint
+fu_history_get_statement_count(FuHistory *self) G_GNUC_NON_NULL(1);
@@ -6,8 +6,11 @@
 
 #include "config.h"
 
+#include <sqlite3.h>
+
 #include "fu-context-private.h"
-#include "fu-history.h"
+#include "fu-history-private.h"
+#include "fu-security-attrs-private.h"
 
 static void
 fu_history_func(void)
@@ -300,6 +303,456 @@ fu_history_migrate_v2_func(void)
 	g_assert_cmpstr(fu_device_get_id(device), ==, "2ba16d10df45823dd4494ff10a0bfccfef512c9d");
 }
 
+static void
+fu_history_filtered_func(void)
+{
+	g_autoptr(FuContext) ctx = fu_context_new_full(FU_CONTEXT_FLAG_NO_QUIRKS);
+	g_autoptr(FuHistory) history = fu_history_new(ctx);
+	g_autoptr(FuRelease) release = fu_release_new();
+	g_autoptr(FuTemporaryDirectory) tmpdir = NULL;
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GPtrArray) devices = NULL;
+
+	/* set up test harness */
+	tmpdir = fu_temporary_directory_new("history-filtered", &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(tmpdir);
+	fu_context_set_tmpdir(ctx, FU_PATH_KIND_LOCALSTATEDIR_PKG, tmpdir);
+
+	/* modified at 1000, 2000 and 3000, with the last one emulated */
+	for (guint i = 1; i <= 3; i++) {
+		gboolean ret;
+		g_autoptr(FuDevice) device = fu_device_new(ctx);
+		g_autofree gchar *id = g_strdup_printf("device%u", i);
+
+		fu_device_set_id(device, id);
+		fu_device_set_modified_usec(device, i * 1000 * G_USEC_PER_SEC);
+		if (i == 3)
+			fu_device_add_flag(device, FWUPD_DEVICE_FLAG_EMULATED);
+		ret = fu_history_add_device(history, device, release, &error);
+		g_assert_no_error(error);
+		g_assert_true(ret);
+	}
+
+	/* newest first, but returned oldest first */
+	devices = fu_history_get_devices_filtered(history, 0, 0, 2, FWUPD_DEVICE_FLAG_NONE, &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(devices);
+	g_assert_cmpint(devices->len, ==, 2);
+	g_assert_cmpint(fu_device_get_modified_usec(g_ptr_array_index(devices, 0)),
+			==,
+			2000 * G_USEC_PER_SEC);
+	g_assert_cmpint(fu_device_get_modified_usec(g_ptr_array_index(devices, 1)),
+			==,
+			3000 * G_USEC_PER_SEC);
+	g_clear_pointer(&devices, g_ptr_array_unref);
+
+	/* offset */
+	devices = fu_history_get_devices_filtered(history, 0, 2, 0, FWUPD_DEVICE_FLAG_NONE, &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(devices);
+	g_assert_cmpint(devices->len, ==, 1);
+	g_assert_cmpint(fu_device_get_modified_usec(g_ptr_array_index(devices, 0)),
+			==,
+			1000 * G_USEC_PER_SEC);
+	g_clear_pointer(&devices, g_ptr_array_unref);
+
+	/* since, without emulated devices */
+	devices = fu_history_get_devices_filtered(history,
+						  1500,
+						  0,
+						  0,
+						  FWUPD_DEVICE_FLAG_EMULATED,
+						  &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(devices);
+	g_assert_cmpint(devices->len, ==, 1);
+	g_assert_cmpint(fu_device_get_modified_usec(g_ptr_array_index(devices, 0)),
+			==,
+			2000 * G_USEC_PER_SEC);
+}
+
+static void
+fu_history_security_attrs_func(void)
+{
+	gboolean ret;
+	gint rc;
+	sqlite3 *db = NULL;
+	sqlite3_stmt *stmt = NULL;
+	FuSecurityAttrs *attrs_tmp;
+	g_autoptr(FuContext) ctx = fu_context_new_full(FU_CONTEXT_FLAG_NO_QUIRKS);
+	g_autoptr(FuHistory) history = fu_history_new(ctx);
+	g_autoptr(FuSecurityAttrs) attrs = fu_security_attrs_new();
+	g_autoptr(FuTemporaryDirectory) tmpdir = NULL;
+	g_autoptr(FwupdSecurityAttr) attr1 =
+	    fwupd_security_attr_new(FWUPD_SECURITY_ATTR_ID_SPI_BIOSWE);
+	g_autoptr(FwupdSecurityAttr) attr2 =
+	    fwupd_security_attr_new(FWUPD_SECURITY_ATTR_ID_SPI_BLE);
+	g_autoptr(FwupdSecurityAttr) attr3 =
+	    fwupd_security_attr_new(FWUPD_SECURITY_ATTR_ID_SPI_SMM_BWP);
+	g_autoptr(FwupdSecurityAttr) attr_tmp = NULL;
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GPtrArray) attrs_array = NULL;
+	g_autoptr(GPtrArray) items = NULL;
+	g_autofree gchar *history_fn = NULL;
+
+	/* set up test harness */
+	tmpdir = fu_temporary_directory_new("history-security-attrs", &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(tmpdir);
+	fu_context_set_tmpdir(ctx, FU_PATH_KIND_LOCALSTATEDIR_PKG, tmpdir);
+
+	/* full */
+	fwupd_security_attr_set_plugin(attr1, "test");
+	fwupd_security_attr_set_result(attr1, FWUPD_SECURITY_ATTR_RESULT_NOT_ENABLED);
+	fu_security_attrs_append(attrs, attr1);
+	fwupd_security_attr_set_plugin(attr2, "test");
+	fwupd_security_attr_set_result(attr2, FWUPD_SECURITY_ATTR_RESULT_ENABLED);
+	fu_security_attrs_append(attrs, attr2);
+	fwupd_security_attr_set_plugin(attr3, "test");
+	fwupd_security_attr_set_result(attr3, FWUPD_SECURITY_ATTR_RESULT_ENABLED);
+	fu_security_attrs_append(attrs, attr3);
+	ret = fu_history_add_security_attribute(history, attrs, "HSI:0", &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+
+	/* changed */
+	fwupd_security_attr_set_result(attr1, FWUPD_SECURITY_ATTR_RESULT_ENABLED);
+	ret = fu_history_add_security_attribute(history, attrs, "HSI:1", &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+
+	/* removed */
+	fu_security_attrs_remove_all(attrs);
+	fu_security_attrs_append(attrs, attr1);
+	fu_security_attrs_append(attrs, attr3);
+	ret = fu_history_add_security_attribute(history, attrs, "HSI:1", &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+
+	/* unchanged, so not written */
+	ret = fu_history_add_security_attribute(history, attrs, "HSI:1", &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+
+	/* rebuilt from the deltas */
+	attrs_array = fu_history_get_security_attrs(history, 0, &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(attrs_array);
+	g_assert_cmpint(attrs_array->len, ==, 3);
+	attrs_tmp = g_ptr_array_index(attrs_array, 0);
+	items = fu_security_attrs_get_all(attrs_tmp, NULL);
+	g_assert_cmpint(items->len, ==, 2);
+	g_clear_pointer(&items, g_ptr_array_unref);
+	attrs_tmp = g_ptr_array_index(attrs_array, 2);
+	items = fu_security_attrs_get_all(attrs_tmp, NULL);
+	g_assert_cmpint(items->len, ==, 3);
+	attr_tmp = fu_security_attrs_get_by_appstream_id(attrs_tmp,
+							 FWUPD_SECURITY_ATTR_ID_SPI_BIOSWE,
+							 &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(attr_tmp);
+	g_assert_cmpint(fwupd_security_attr_get_result(attr_tmp),
+			==,
+			FWUPD_SECURITY_ATTR_RESULT_NOT_ENABLED);
+	g_clear_object(&attr_tmp);
+	g_clear_pointer(&attrs_array, g_ptr_array_unref);
+
+	/* offset */
+	attrs_array = fu_history_get_security_attrs_filtered(history, 0, 1, 1, &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(attrs_array);
+	g_assert_cmpint(attrs_array->len, ==, 1);
+	attr_tmp = fu_security_attrs_get_by_appstream_id(g_ptr_array_index(attrs_array, 0),
+							 FWUPD_SECURITY_ATTR_ID_SPI_BIOSWE,
+							 &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(attr_tmp);
+	g_assert_cmpint(fwupd_security_attr_get_result(attr_tmp),
+			==,
+			FWUPD_SECURITY_ATTR_RESULT_ENABLED);
+	g_clear_pointer(&attrs_array, g_ptr_array_unref);
+
+	/* since the year 2100 */
+	attrs_array = fu_history_get_security_attrs_filtered(history, 4102444800, 0, 0, &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(attrs_array);
+	g_assert_cmpint(attrs_array->len, ==, 0);
+
+	/* only the first entry was stored in full */
+	history_fn = fu_context_build_filename(ctx,
+					       &error,
+					       FU_PATH_KIND_LOCALSTATEDIR_PKG,
+					       "pending.db",
+					       NULL);
+	g_assert_no_error(error);
+	g_assert_nonnull(history_fn);
+	rc = sqlite3_open(history_fn, &db);
+	g_assert_cmpint(rc, ==, SQLITE_OK);
+	rc = sqlite3_prepare_v2(db,
+				"SELECT COUNT(*) FROM hsi_history WHERE hsi_delta = 1;",
+				-1,
+				&stmt,
+				NULL);
+	g_assert_cmpint(rc, ==, SQLITE_OK);
+	rc = sqlite3_step(stmt);
+	g_assert_cmpint(rc, ==, SQLITE_ROW);
+	g_assert_cmpint(sqlite3_column_int(stmt, 0), ==, 2);
+	sqlite3_finalize(stmt);
+	sqlite3_close(db);
+}
+
+static void
+fu_history_security_attrs_unchanged_func(void)
+{
+	gboolean ret;
+	g_autoptr(FuContext) ctx = fu_context_new_full(FU_CONTEXT_FLAG_NO_QUIRKS);
+	g_autoptr(FuHistory) history = fu_history_new(ctx);
+	g_autoptr(FuSecurityAttrs) attrs = fu_security_attrs_new();
+	g_autoptr(FuTemporaryDirectory) tmpdir = NULL;
+	g_autoptr(FwupdSecurityAttr) attr =
+	    fwupd_security_attr_new(FWUPD_SECURITY_ATTR_ID_SPI_BIOSWE);
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GPtrArray) attrs_array = NULL;
+
+	/* set up test harness */
+	tmpdir = fu_temporary_directory_new("history-security-attrs-unchanged", &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(tmpdir);
+	fu_context_set_tmpdir(ctx, FU_PATH_KIND_LOCALSTATEDIR_PKG, tmpdir);
+	fwupd_security_attr_set_plugin(attr, "test");
+	fu_security_attrs_append(attrs, attr);
+
+	/* longer than the maximum delta chain, so the next entry would be a full snapshot */
+	for (guint i = 0; i < 40; i++) {
+		fwupd_security_attr_set_result(attr,
+					       i % 2 == 0 ? FWUPD_SECURITY_ATTR_RESULT_ENABLED
+							  : FWUPD_SECURITY_ATTR_RESULT_NOT_ENABLED);
+		ret = fu_history_add_security_attribute(history, attrs, "HSI:1", &error);
+		g_assert_no_error(error);
+		g_assert_true(ret);
+	}
+	attrs_array = fu_history_get_security_attrs(history, 0, &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(attrs_array);
+	g_assert_cmpint(attrs_array->len, ==, 40);
+	g_clear_pointer(&attrs_array, g_ptr_array_unref);
+
+	/* unchanged, so not written */
+	ret = fu_history_add_security_attribute(history, attrs, "HSI:1", &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	attrs_array = fu_history_get_security_attrs(history, 0, &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(attrs_array);
+	g_assert_cmpint(attrs_array->len, ==, 40);
+}
+
+static void
+fu_history_wal_func(void)
+{
+	gboolean ret;
+	gint rc;
+	guint stmt_cnt = 0;
+	sqlite3 *db = NULL;
+	sqlite3_stmt *stmt = NULL;
+	g_autoptr(FuContext) ctx = fu_context_new_full(FU_CONTEXT_FLAG_NO_QUIRKS);
+	g_autoptr(FuDevice) device = fu_device_new(ctx);
+	g_autoptr(FuHistory) history = NULL;
+	g_autoptr(FuRelease) release = fu_release_new();
+	g_autoptr(FuSecurityAttrs) attrs = fu_security_attrs_new();
+	g_autoptr(FuTemporaryDirectory) tmpdir = NULL;
+	g_autoptr(FwupdSecurityAttr) attr =
+	    fwupd_security_attr_new(FWUPD_SECURITY_ATTR_ID_SPI_BIOSWE);
+	g_autoptr(GError) error = NULL;
+	g_autofree gchar *history_fn = NULL;
+	g_autofree gchar *history_wal_fn = NULL;
+
+	/* set up test harness */
+	tmpdir = fu_temporary_directory_new("history-wal", &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(tmpdir);
+	fu_context_set_tmpdir(ctx, FU_PATH_KIND_LOCALSTATEDIR_PKG, tmpdir);
+	history_fn = fu_context_build_filename(ctx,
+					       &error,
+					       FU_PATH_KIND_LOCALSTATEDIR_PKG,
+					       "pending.db",
+					       NULL);
+	g_assert_no_error(error);
+	g_assert_nonnull(history_fn);
+	history = fu_history_new(ctx);
+	fu_device_set_id(device, "wal");
+	fwupd_security_attr_set_plugin(attr, "test");
+	fu_security_attrs_append(attrs, attr);
+
+	/* the same statements are reused each time */
+	for (guint i = 0; i < 5; i++) {
+		g_autoptr(GPtrArray) devices = NULL;
+		g_autoptr(GPtrArray) attrs_array = NULL;
+
+		ret = fu_history_add_device(history, device, release, &error);
+		g_assert_no_error(error);
+		g_assert_true(ret);
+		devices = fu_history_get_devices(history, &error);
+		g_assert_no_error(error);
+		g_assert_nonnull(devices);
+		g_assert_cmpint(devices->len, ==, 1);
+		fwupd_security_attr_set_result(attr,
+					       i % 2 == 0 ? FWUPD_SECURITY_ATTR_RESULT_ENABLED
+							  : FWUPD_SECURITY_ATTR_RESULT_NOT_ENABLED);
+		ret = fu_history_add_security_attribute(history, attrs, "1", &error);
+		g_assert_no_error(error);
+		g_assert_true(ret);
+		attrs_array = fu_history_get_security_attrs(history, 1, &error);
+		g_assert_no_error(error);
+		g_assert_nonnull(attrs_array);
+		g_assert_cmpint(attrs_array->len, ==, 1);
+		if (i == 0) {
+			stmt_cnt = fu_history_get_statement_count(history);
+			g_assert_cmpint(stmt_cnt, >, 0);
+			continue;
+		}
+		g_assert_cmpint(fu_history_get_statement_count(history), ==, stmt_cnt);
+	}
+
+	/* write-ahead logging is enabled */
+	history_wal_fn = g_strdup_printf("%s-wal", history_fn);
+	g_assert_true(g_file_test(history_wal_fn, G_FILE_TEST_EXISTS));
+	rc = sqlite3_open(history_fn, &db);
+	g_assert_cmpint(rc, ==, SQLITE_OK);
+	rc = sqlite3_prepare_v2(db, "PRAGMA journal_mode;", -1, &stmt, NULL);
+	g_assert_cmpint(rc, ==, SQLITE_OK);
+	rc = sqlite3_step(stmt);
+	g_assert_cmpint(rc, ==, SQLITE_ROW);
+	g_assert_cmpstr((const gchar *)sqlite3_column_text(stmt, 0), ==, "wal");
+	sqlite3_finalize(stmt);
+
+	/* the cached statements are reset, so do not hold a read snapshot open */
+	rc = sqlite3_prepare_v2(db, "PRAGMA wal_checkpoint(TRUNCATE);", -1, &stmt, NULL);
+	g_assert_cmpint(rc, ==, SQLITE_OK);
+	rc = sqlite3_step(stmt);
+	g_assert_cmpint(rc, ==, SQLITE_ROW);
+	g_assert_cmpint(sqlite3_column_int(stmt, 0), ==, 0);
+	sqlite3_finalize(stmt);
+	sqlite3_close(db);
+}
+
+#define FU_HISTORY_BENCHMARK_ROWS 10000
+
+static void
+fu_history_benchmark_func(void)
+{
+	gboolean ret;
+	gint rc;
+	sqlite3 *db = NULL;
+	sqlite3_stmt *stmt = NULL;
+	g_autoptr(FuContext) ctx = fu_context_new_full(FU_CONTEXT_FLAG_NO_QUIRKS);
+	g_autoptr(FuDevice) device = fu_device_new(ctx);
+	g_autoptr(FuHistory) history = NULL;
+	g_autoptr(FuRelease) release = fu_release_new();
+	g_autoptr(FuSecurityAttrs) attrs = fu_security_attrs_new();
+	g_autoptr(FuTemporaryDirectory) tmpdir = NULL;
+	g_autoptr(FwupdSecurityAttr) attr1 =
+	    fwupd_security_attr_new(FWUPD_SECURITY_ATTR_ID_SPI_BIOSWE);
+	g_autoptr(FwupdSecurityAttr) attr2 =
+	    fwupd_security_attr_new(FWUPD_SECURITY_ATTR_ID_SPI_BLE);
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GPtrArray) devices = NULL;
+	g_autoptr(GPtrArray) attrs_array = NULL;
+	g_autoptr(GTimer) timer = g_timer_new();
+	g_autofree gchar *history_fn = NULL;
+	g_autofree gchar *json = NULL;
+
+	/* set up test harness */
+	tmpdir = fu_temporary_directory_new("history-benchmark", &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(tmpdir);
+	fu_context_set_tmpdir(ctx, FU_PATH_KIND_LOCALSTATEDIR_PKG, tmpdir);
+	history_fn = fu_context_build_filename(ctx,
+					       &error,
+					       FU_PATH_KIND_LOCALSTATEDIR_PKG,
+					       "pending.db",
+					       NULL);
+	g_assert_no_error(error);
+	g_assert_nonnull(history_fn);
+
+	/* create the database */
+	history = fu_history_new(ctx);
+	fu_device_set_id(device, "benchmark");
+	ret = fu_history_add_device(history, device, release, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	fwupd_security_attr_set_plugin(attr1, "test");
+	fwupd_security_attr_set_result(attr1, FWUPD_SECURITY_ATTR_RESULT_NOT_ENABLED);
+	fu_security_attrs_append(attrs, attr1);
+	fwupd_security_attr_set_plugin(attr2, "test");
+	fwupd_security_attr_set_result(attr2, FWUPD_SECURITY_ATTR_RESULT_ENABLED);
+	fu_security_attrs_append(attrs, attr2);
+	json = fwupd_codec_to_json_string(FWUPD_CODEC(attrs), FWUPD_CODEC_FLAG_NONE, &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(json);
+
+	/* populate using a second connection, as the public API commits every row */
+	rc = sqlite3_open(history_fn, &db);
+	g_assert_cmpint(rc, ==, SQLITE_OK);
+	rc = sqlite3_exec(db,
+			  "WITH RECURSIVE cnt(x) AS "
+			  "(SELECT 1 UNION ALL SELECT x + 1 FROM cnt WHERE x < 10000) "
+			  "INSERT INTO history (device_id, display_name, plugin, device_modified) "
+			  "SELECT printf('%040d', x), 'Benchmark', 'test', x FROM cnt;",
+			  NULL,
+			  NULL,
+			  NULL);
+	g_assert_cmpint(rc, ==, SQLITE_OK);
+	rc = sqlite3_prepare_v2(db,
+				"WITH RECURSIVE cnt(x) AS "
+				"(SELECT 1 UNION ALL SELECT x + 1 FROM cnt WHERE x < 10000) "
+				"INSERT INTO hsi_history (timestamp, hsi_details, hsi_score) "
+				"SELECT datetime('2020-01-01', '+' || x || ' minutes'), ?1, '1' "
+				"FROM cnt;",
+				-1,
+				&stmt,
+				NULL);
+	g_assert_cmpint(rc, ==, SQLITE_OK);
+	sqlite3_bind_text(stmt, 1, json, -1, SQLITE_STATIC);
+	rc = sqlite3_step(stmt);
+	g_assert_cmpint(rc, ==, SQLITE_DONE);
+	sqlite3_finalize(stmt);
+	sqlite3_close(db);
+
+	/* GetHistory */
+	g_timer_start(timer);
+	for (guint i = 0; i < 10; i++) {
+		g_clear_pointer(&devices, g_ptr_array_unref);
+		devices = fu_history_get_devices(history, &error);
+		g_assert_no_error(error);
+		g_assert_nonnull(devices);
+	}
+	g_assert_cmpint(devices->len, ==, FU_HISTORY_BENCHMARK_ROWS + 1);
+	g_test_message("GetHistory with %u rows: %.1fms",
+		       devices->len,
+		       g_timer_elapsed(timer, NULL) * 100.f);
+
+	/* HSI recording, as done by the engine on each recompute */
+	g_timer_start(timer);
+	for (guint i = 0; i < 100; i++) {
+		g_clear_pointer(&attrs_array, g_ptr_array_unref);
+		attrs_array = fu_history_get_security_attrs(history, 1, &error);
+		g_assert_no_error(error);
+		g_assert_nonnull(attrs_array);
+		g_assert_cmpint(attrs_array->len, ==, 1);
+		fwupd_security_attr_set_result(attr1,
+					       i % 2 == 0 ? FWUPD_SECURITY_ATTR_RESULT_ENABLED
+							  : FWUPD_SECURITY_ATTR_RESULT_NOT_ENABLED);
+		ret = fu_history_add_security_attribute(history, attrs, "1", &error);
+		g_assert_no_error(error);
+		g_assert_true(ret);
+	}
+	g_test_message("HSI recording with %u rows: %.2fms",
+		       (guint)FU_HISTORY_BENCHMARK_ROWS,
+		       g_timer_elapsed(timer, NULL) * 10.f);
+}
+
 int
 main(int argc, char **argv)
 {
@@ -309,5 +762,12 @@ main(int argc, char **argv)
 	g_test_add_func("/fwupd/history/modify", fu_history_modify_func);
 	g_test_add_func("/fwupd/history/migrate-v1", fu_history_migrate_v1_func);
 	g_test_add_func("/fwupd/history/migrate-v2", fu_history_migrate_v2_func);
+	g_test_add_func("/fwupd/history/filtered", fu_history_filtered_func);
+	g_test_add_func("/fwupd/history/security-attrs", fu_history_security_attrs_func);
+	g_test_add_func("/fwupd/history/security-attrs/unchanged",
+			fu_history_security_attrs_unchanged_func);
+	g_test_add_func("/fwupd/history/wal", fu_history_wal_func);
+	if (g_test_slow())
+		g_test_add_func("/fwupd/history/benchmark", fu_history_benchmark_func);
 	return g_test_run();
 }
@@ -12,7 +12,7 @@
 #include <sqlite3.h>
 
 #include "fu-device-private.h"
-#include "fu-history.h"
+#include "fu-history-private.h"
 #include "fu-release.h"
 #include "fu-security-attrs-private.h"
 
@@ -31,8 +31,12 @@
  * v12	add install_duration to history
  * v13	add release_flags to history
  * v14	create table emulation_tag
+ * v15	add indexes, and hsi_delta and hsi_removed to hsi_history
  */
-#define FU_HISTORY_CURRENT_SCHEMA_VERSION 14
+#define FU_HISTORY_CURRENT_SCHEMA_VERSION 15
+
+/* write the complete set of HSI attributes after this many deltas */
+#define FU_HISTORY_HSI_DELTA_MAX 32
 
 static void
 fu_history_finalize(GObject *object);
@@ -41,6 +45,7 @@ struct _FuHistory {
 	GObject parent_instance;
 	FuContext *ctx;
 	sqlite3 *db;
+	GHashTable *stmts; /* (element-type utf8 sqlite3_stmt) keyed by static SQL */
 };
 
 G_DEFINE_TYPE(FuHistory, fu_history, G_TYPE_OBJECT)
@@ -163,6 +168,32 @@ fu_history_device_from_stmt(sqlite3_stmt *stmt)
 	return device;
 }
 
+/* returns a borrowed statement that is compiled once and then reused until the db is closed */
+static sqlite3_stmt *
+fu_history_prepare(FuHistory *self, const gchar *sql, GError **error)
+{
+	gint rc;
+	sqlite3_stmt *stmt = g_hash_table_lookup(self->stmts, sql);
+
+	/* reuse */
+	if (stmt != NULL) {
+		sqlite3_reset(stmt);
+		sqlite3_clear_bindings(stmt);
+		return stmt;
+	}
+	rc = sqlite3_prepare_v3(self->db, sql, -1, SQLITE_PREPARE_PERSISTENT, &stmt, NULL);
+	if (rc != SQLITE_OK) {
+		g_set_error(error,
+			    FWUPD_ERROR,
+			    FWUPD_ERROR_INTERNAL,
+			    "failed to prepare SQL: %s",
+			    sqlite3_errmsg(self->db));
+		return NULL;
+	}
+	g_hash_table_insert(self->stmts, (gpointer)sql, stmt);
+	return stmt;
+}
+
 static gboolean
 fu_history_stmt_exec(FuHistory *self, sqlite3_stmt *stmt, GPtrArray *array, GError **error)
 {
@@ -181,6 +212,25 @@ fu_history_stmt_exec(FuHistory *self, sqlite3_stmt *stmt, GPtrArray *array, GErr
 			    FWUPD_ERROR_WRITE,
 			    "failed to execute prepared statement: %s",
 			    sqlite3_errmsg(self->db));
+		sqlite3_reset(stmt);
+		return FALSE;
+	}
+
+	/* cached statements must not hold the read snapshot open */
+	sqlite3_reset(stmt);
+	return TRUE;
+}
+
+static gboolean
+fu_history_exec(FuHistory *self, const gchar *sql, GError **error)
+{
+	if (sqlite3_exec(self->db, sql, NULL, NULL, NULL) != SQLITE_OK) {
+		g_set_error(error,
+			    FWUPD_ERROR,
+			    FWUPD_ERROR_WRITE,
+			    "failed to execute %s: %s",
+			    sql,
+			    sqlite3_errmsg(self->db));
 		return FALSE;
 	}
 	return TRUE;
@@ -225,9 +275,14 @@ fu_history_create_database(FuHistory *self, GError **error)
 			  "CREATE TABLE IF NOT EXISTS hsi_history ("
 			  "timestamp TIMESTAMP DEFAULT CURRENT_TIMESTAMP,"
 			  "hsi_details TEXT DEFAULT NULL,"
-			  "hsi_score TEXT DEFAULT NULL);"
+			  "hsi_score TEXT DEFAULT NULL,"
+			  "hsi_delta INTEGER DEFAULT 0,"
+			  "hsi_removed TEXT DEFAULT NULL);"
 			  "CREATE TABLE emulation_tag (device_id TEXT);"
 			  "CREATE UNIQUE INDEX idx_device_id ON emulation_tag (device_id);"
+			  "CREATE INDEX idx_history_device_id ON history (device_id);"
+			  "CREATE INDEX idx_history_device_modified ON history (device_modified);"
+			  "CREATE INDEX idx_hsi_history_timestamp ON hsi_history (timestamp);"
 			  "COMMIT;",
 			  NULL,
 			  NULL,
@@ -469,6 +524,33 @@ fu_history_migrate_database_v12(FuHistory *self, GError **error)
 	return TRUE;
 }
 
+static gboolean
+fu_history_migrate_database_v13(FuHistory *self, GError **error)
+{
+	gint rc;
+	rc = sqlite3_exec(
+	    self->db,
+	    "BEGIN TRANSACTION;"
+	    "ALTER TABLE hsi_history ADD COLUMN hsi_delta INTEGER DEFAULT 0;"
+	    "ALTER TABLE hsi_history ADD COLUMN hsi_removed TEXT DEFAULT NULL;"
+	    "CREATE INDEX IF NOT EXISTS idx_history_device_id ON history (device_id);"
+	    "CREATE INDEX IF NOT EXISTS idx_history_device_modified ON history (device_modified);"
+	    "CREATE INDEX IF NOT EXISTS idx_hsi_history_timestamp ON hsi_history (timestamp);"
+	    "COMMIT;",
+	    NULL,
+	    NULL,
+	    NULL);
+	if (rc != SQLITE_OK) {
+		g_set_error(error,
+			    FWUPD_ERROR,
+			    FWUPD_ERROR_INTERNAL,
+			    "Failed to alter database: %s",
+			    sqlite3_errmsg(self->db));
+		return FALSE;
+	}
+	return TRUE;
+}
+
 /* returns 0 if database is not initialized */
 static guint
 fu_history_get_schema_version(FuHistory *self)
@@ -554,6 +636,10 @@ fu_history_create_or_migrate(FuHistory *self, guint schema_ver, GError **error)
 	case 13:
 		if (!fu_history_migrate_database_v12(self, error))
 			return FALSE;
+	/* fall through */
+	case 14:
+		if (!fu_history_migrate_database_v13(self, error))
+			return FALSE;
 		/* no longer fall through */
 		break;
 	default:
@@ -581,6 +667,7 @@ static gboolean
 fu_history_open(FuHistory *self, const gchar *filename, GError **error)
 {
 	gint rc;
+	sqlite3_stmt *stmt = NULL;
 	g_debug("trying to open database '%s'", filename);
 	rc = sqlite3_open(filename, &self->db);
 	if (rc != SQLITE_OK) {
@@ -595,6 +682,25 @@ fu_history_open(FuHistory *self, const gchar *filename, GError **error)
 
 	/* turn off the lookaside cache */
 	sqlite3_db_config(self->db, SQLITE_DBCONFIG_LOOKASIDE, NULL, 0, 0);
+
+	/* readers do not block the writer, and a commit appends to the log rather than
+	 * rewriting pages -- this is not possible on some filesystems, so is not fatal */
+	rc = sqlite3_prepare_v2(self->db, "PRAGMA journal_mode=WAL;", -1, &stmt, NULL);
+	if (rc != SQLITE_OK) {
+		g_debug("failed to enable write-ahead logging: %s", sqlite3_errmsg(self->db));
+		return TRUE;
+	}
+
+	/* the pragma returns the mode actually in use, rather than failing */
+	rc = sqlite3_step(stmt);
+	if (rc != SQLITE_ROW) {
+		g_debug("failed to enable write-ahead logging: %s", sqlite3_errmsg(self->db));
+	} else {
+		const gchar *mode = (const gchar *)sqlite3_column_text(stmt, 0);
+		if (g_strcmp0(mode, "wal") != 0)
+			g_debug("write-ahead logging not available, journal mode is %s", mode);
+	}
+	sqlite3_finalize(stmt);
 	return TRUE;
 }
 
@@ -643,6 +749,7 @@ fu_history_load(FuHistory *self, GError **error)
 	/* create initial up-to-date database, or migrate */
 	g_debug("got schema version of %u", schema_ver);
 	if (schema_ver != FU_HISTORY_CURRENT_SCHEMA_VERSION) {
+		const gchar *suffixes[] = {"-wal", "-shm", NULL};
 		g_autoptr(GError) error_migrate = NULL;
 		if (!fu_history_create_or_migrate(self, schema_ver, &error_migrate)) {
 			/* this is fatal to the daemon, so delete the database
@@ -650,6 +757,7 @@ fu_history_load(FuHistory *self, GError **error)
 			g_warning("failed to migrate %s database: %s",
 				  filename,
 				  error_migrate->message);
+			g_hash_table_remove_all(self->stmts);
 			sqlite3_close(self->db);
 			self->db = NULL;
 			if (g_unlink(filename) != 0) {
@@ -660,6 +768,12 @@ fu_history_load(FuHistory *self, GError **error)
 					    filename);
 				return FALSE;
 			}
+			for (guint i = 0; suffixes[i] != NULL; i++) {
+				g_autofree gchar *fn_tmp =
+				    g_strdup_printf("%s%s", filename, suffixes[i]);
+				if (g_file_test(fn_tmp, G_FILE_TEST_EXISTS))
+					g_unlink(fn_tmp);
+			}
 			if (!fu_history_open(self, filename, error))
 				return FALSE;
 			return fu_history_create_database(self, error);
@@ -709,9 +823,8 @@ fu_history_get_device_flags_filtered(FuDevice *device)
 gboolean
 fu_history_modify_device(FuHistory *self, FuDevice *device, GError **error)
 {
-	gint rc;
 	g_autofree gchar *id_display = fu_device_get_id_display(device);
-	g_autoptr(sqlite3_stmt) stmt = NULL;
+	sqlite3_stmt *stmt;
 
 	g_return_val_if_fail(FU_IS_HISTORY(self), FALSE);
 	g_return_val_if_fail(FU_IS_DEVICE(device), FALSE);
@@ -722,24 +835,18 @@ fu_history_modify_device(FuHistory *self, FuDevice *device, GError **error)
 
 	/* overwrite entry if it exists */
 	g_debug("modifying device %s", id_display);
-	rc = sqlite3_prepare_v2(self->db,
-				"UPDATE history SET "
-				"update_state = ?1, "
-				"update_error = ?2, "
-				"checksum_device = ?6, "
-				"device_modified = ?7, "
-				"install_duration = ?8, "
-				"flags = ?3 "
-				"WHERE device_id = ?4;",
-				-1,
-				&stmt,
-				NULL);
-	if (rc != SQLITE_OK) {
-		g_set_error(error,
-			    FWUPD_ERROR,
-			    FWUPD_ERROR_INTERNAL,
-			    "Failed to prepare SQL to update history: %s",
-			    sqlite3_errmsg(self->db));
+	stmt = fu_history_prepare(self,
+				  "UPDATE history SET "
+				  "update_state = ?1, "
+				  "update_error = ?2, "
+				  "checksum_device = ?6, "
+				  "device_modified = ?7, "
+				  "install_duration = ?8, "
+				  "flags = ?3 "
+				  "WHERE device_id = ?4;",
+				  error);
+	if (stmt == NULL) {
+		g_prefix_error_literal(error, "failed to update history: ");
 		return FALSE;
 	}
 
@@ -789,10 +896,9 @@ fu_history_modify_device_release(FuHistory *self,
 				 FuRelease *release,
 				 GError **error)
 {
-	gint rc;
 	g_autofree gchar *id_display = fu_device_get_id_display(device);
 	g_autofree gchar *metadata = NULL;
-	g_autoptr(sqlite3_stmt) stmt = NULL;
+	sqlite3_stmt *stmt;
 
 	g_return_val_if_fail(FU_IS_HISTORY(self), FALSE);
 	g_return_val_if_fail(FU_IS_DEVICE(device), FALSE);
@@ -806,24 +912,18 @@ fu_history_modify_device_release(FuHistory *self,
 
 	/* overwrite entry if it exists */
 	g_debug("modifying device %s", id_display);
-	rc = sqlite3_prepare_v2(self->db,
-				"UPDATE history SET "
-				"update_state = ?1, "
-				"update_error = ?2, "
-				"checksum_device = ?6, "
-				"device_modified = ?7, "
-				"metadata = ?8, "
-				"flags = ?3 "
-				"WHERE device_id = ?4;",
-				-1,
-				&stmt,
-				NULL);
-	if (rc != SQLITE_OK) {
-		g_set_error(error,
-			    FWUPD_ERROR,
-			    FWUPD_ERROR_INTERNAL,
-			    "Failed to prepare SQL to update history: %s",
-			    sqlite3_errmsg(self->db));
+	stmt = fu_history_prepare(self,
+				  "UPDATE history SET "
+				  "update_state = ?1, "
+				  "update_error = ?2, "
+				  "checksum_device = ?6, "
+				  "device_modified = ?7, "
+				  "metadata = ?8, "
+				  "flags = ?3 "
+				  "WHERE device_id = ?4;",
+				  error);
+	if (stmt == NULL) {
+		g_prefix_error_literal(error, "failed to update history: ");
 		return FALSE;
 	}
 
@@ -844,39 +944,17 @@ fu_history_modify_device_release(FuHistory *self,
 	return fu_history_stmt_exec(self, stmt, NULL, error);
 }
 
-/**
- * fu_history_add_device:
- * @self: a #FuHistory
- * @device: a device
- * @release: a #FuRelease
- * @error: (nullable): optional return location for an error
- *
- * Adds a device to the history database
- *
- * Returns: @TRUE if successful, @FALSE for failure
- *
- * Since: 1.0.4
- **/
-gboolean
-fu_history_add_device(FuHistory *self, FuDevice *device, FuRelease *release, GError **error)
+static gboolean
+fu_history_add_device_internal(FuHistory *self,
+			       FuDevice *device,
+			       FuRelease *release,
+			       GError **error)
 {
 	const gchar *checksum_device;
 	const gchar *checksum = NULL;
-	gint rc;
 	g_autofree gchar *id_display = fu_device_get_id_display(device);
 	g_autofree gchar *metadata = NULL;
-	g_autoptr(sqlite3_stmt) stmt = NULL;
-
-	g_return_val_if_fail(FU_IS_HISTORY(self), FALSE);
-	g_return_val_if_fail(FU_IS_DEVICE(device), FALSE);
-	g_return_val_if_fail(FU_IS_RELEASE(release), FALSE);
-
-	/* lazy load */
-	if (!fu_history_load(self, error))
-		return FALSE;
-
-	/* make tests easier */
-	fu_device_convert_instance_ids(device);
+	sqlite3_stmt *stmt;
 
 	/* ensure all old device(s) with this ID are removed */
 	if (!fu_history_remove_device(self, device, error))
@@ -890,39 +968,33 @@ fu_history_add_device(FuHistory *self, FuDevice *device, FuRelease *release, GEr
 	metadata = fu_history_convert_hash_to_string(fu_release_get_metadata(release));
 
 	/* add */
-	rc = sqlite3_prepare_v2(self->db,
-				"INSERT INTO history (device_id,"
-				"update_state,"
-				"update_error,"
-				"flags,"
-				"filename,"
-				"checksum,"
-				"display_name,"
-				"plugin,"
-				"guid_default,"
-				"metadata,"
-				"device_created,"
-				"device_modified,"
-				"version_old,"
-				"version_new,"
-				"checksum_device,"
-				"protocol,"
-				"release_id,"
-				"appstream_id,"
-				"version_format,"
-				"install_duration,"
-				"release_flags) "
-				"VALUES (?1,?2,?3,?4,?5,?6,?7,?8,?9,?10,"
-				"?11,?12,?13,?14,?15,?16,?17,?18,?19,?20,?21)",
-				-1,
-				&stmt,
-				NULL);
-	if (rc != SQLITE_OK) {
-		g_set_error(error,
-			    FWUPD_ERROR,
-			    FWUPD_ERROR_INTERNAL,
-			    "Failed to prepare SQL to insert history: %s",
-			    sqlite3_errmsg(self->db));
+	stmt = fu_history_prepare(self,
+				  "INSERT INTO history (device_id,"
+				  "update_state,"
+				  "update_error,"
+				  "flags,"
+				  "filename,"
+				  "checksum,"
+				  "display_name,"
+				  "plugin,"
+				  "guid_default,"
+				  "metadata,"
+				  "device_created,"
+				  "device_modified,"
+				  "version_old,"
+				  "version_new,"
+				  "checksum_device,"
+				  "protocol,"
+				  "release_id,"
+				  "appstream_id,"
+				  "version_format,"
+				  "install_duration,"
+				  "release_flags) "
+				  "VALUES (?1,?2,?3,?4,?5,?6,?7,?8,?9,?10,"
+				  "?11,?12,?13,?14,?15,?16,?17,?18,?19,?20,?21)",
+				  error);
+	if (stmt == NULL) {
+		g_prefix_error_literal(error, "failed to insert history: ");
 		return FALSE;
 	}
 	sqlite3_bind_text(stmt, 1, fu_device_get_id(device), -1, SQLITE_STATIC);
@@ -949,6 +1021,47 @@ fu_history_add_device(FuHistory *self, FuDevice *device, FuRelease *release, GEr
 	return fu_history_stmt_exec(self, stmt, NULL, error);
 }
 
+/**
+ * fu_history_add_device:
+ * @self: a #FuHistory
+ * @device: a device
+ * @release: a #FuRelease
+ * @error: (nullable): optional return location for an error
+ *
+ * Adds a device to the history database
+ *
+ * Returns: @TRUE if successful, @FALSE for failure
+ *
+ * Since: 1.0.4
+ **/
+gboolean
+fu_history_add_device(FuHistory *self, FuDevice *device, FuRelease *release, GError **error)
+{
+	g_return_val_if_fail(FU_IS_HISTORY(self), FALSE);
+	g_return_val_if_fail(FU_IS_DEVICE(device), FALSE);
+	g_return_val_if_fail(FU_IS_RELEASE(release), FALSE);
+
+	/* lazy load */
+	if (!fu_history_load(self, error))
+		return FALSE;
+
+	/* make tests easier */
+	fu_device_convert_instance_ids(device);
+
+	/* remove and insert as one transaction, so there is only one commit */
+	if (!fu_history_exec(self, "SAVEPOINT add_device;", error))
+		return FALSE;
+	if (!fu_history_add_device_internal(self, device, release, error)) {
+		sqlite3_exec(self->db,
+			     "ROLLBACK TO add_device; RELEASE add_device;",
+			     NULL,
+			     NULL,
+			     NULL);
+		return FALSE;
+	}
+	return fu_history_exec(self, "RELEASE add_device;", error);
+}
+
 /**
  * fu_history_remove_all:
  * @self: a #FuHistory
@@ -1001,9 +1114,8 @@ fu_history_remove_all(FuHistory *self, GError **error)
 gboolean
 fu_history_remove_device(FuHistory *self, FuDevice *device, GError **error)
 {
-	gint rc;
 	g_autofree gchar *id_display = fu_device_get_id_display(device);
-	g_autoptr(sqlite3_stmt) stmt = NULL;
+	sqlite3_stmt *stmt;
 
 	g_return_val_if_fail(FU_IS_HISTORY(self), FALSE);
 	g_return_val_if_fail(FU_IS_DEVICE(device), FALSE);
@@ -1013,17 +1125,9 @@ fu_history_remove_device(FuHistory *self, FuDevice *device, GError **error)
 		return FALSE;
 
 	g_debug("remove device %s", id_display);
-	rc = sqlite3_prepare_v2(self->db,
-				"DELETE FROM history WHERE device_id = ?1;",
-				-1,
-				&stmt,
-				NULL);
-	if (rc != SQLITE_OK) {
-		g_set_error(error,
-			    FWUPD_ERROR,
-			    FWUPD_ERROR_INTERNAL,
-			    "Failed to prepare SQL to delete history: %s",
-			    sqlite3_errmsg(self->db));
+	stmt = fu_history_prepare(self, "DELETE FROM history WHERE device_id = ?1;", error);
+	if (stmt == NULL) {
+		g_prefix_error_literal(error, "failed to delete history: ");
 		return FALSE;
 	}
 	sqlite3_bind_text(stmt, 1, fu_device_get_id(device), -1, SQLITE_STATIC);
@@ -1045,9 +1149,8 @@ fu_history_remove_device(FuHistory *self, FuDevice *device, GError **error)
 FuDevice *
 fu_history_get_device_by_id(FuHistory *self, const gchar *device_id, GError **error)
 {
-	gint rc;
 	g_autoptr(GPtrArray) array_tmp = NULL;
-	g_autoptr(sqlite3_stmt) stmt = NULL;
+	sqlite3_stmt *stmt;
 
 	g_return_val_if_fail(FU_IS_HISTORY(self), NULL);
 	g_return_val_if_fail(device_id != NULL, NULL);
@@ -1057,39 +1160,33 @@ fu_history_get_device_by_id(FuHistory *self, const gchar *device_id, GError **er
 		return NULL;
 
 	/* get all the devices */
-	rc = sqlite3_prepare_v2(self->db,
-				"SELECT device_id, "
-				"checksum, "
-				"plugin, "
-				"device_created, "
-				"device_modified, "
-				"display_name, "
-				"filename, "
-				"flags, "
-				"metadata, "
-				"guid_default, "
-				"update_state, "
-				"update_error, "
-				"version_new, "
-				"version_old, "
-				"checksum_device, "
-				"protocol, "
-				"release_id, "
-				"appstream_id, "
-				"version_format, "
-				"install_duration, "
-				"release_flags FROM history WHERE "
-				"device_id = ?1 ORDER BY device_created DESC "
-				"LIMIT 1",
-				-1,
-				&stmt,
-				NULL);
-	if (rc != SQLITE_OK) {
-		g_set_error(error,
-			    FWUPD_ERROR,
-			    FWUPD_ERROR_INTERNAL,
-			    "Failed to prepare SQL to get history: %s",
-			    sqlite3_errmsg(self->db));
+	stmt = fu_history_prepare(self,
+				  "SELECT device_id, "
+				  "checksum, "
+				  "plugin, "
+				  "device_created, "
+				  "device_modified, "
+				  "display_name, "
+				  "filename, "
+				  "flags, "
+				  "metadata, "
+				  "guid_default, "
+				  "update_state, "
+				  "update_error, "
+				  "version_new, "
+				  "version_old, "
+				  "checksum_device, "
+				  "protocol, "
+				  "release_id, "
+				  "appstream_id, "
+				  "version_format, "
+				  "install_duration, "
+				  "release_flags FROM history WHERE "
+				  "device_id = ?1 ORDER BY device_created DESC "
+				  "LIMIT 1",
+				  error);
+	if (stmt == NULL) {
+		g_prefix_error_literal(error, "failed to get history: ");
 		return NULL;
 	}
 	sqlite3_bind_text(stmt, 1, device_id, -1, SQLITE_STATIC);
@@ -1104,22 +1201,31 @@ fu_history_get_device_by_id(FuHistory *self, const gchar *device_id, GError **er
 }
 
 /**
- * fu_history_get_devices:
+ * fu_history_get_devices_filtered:
  * @self: a #FuHistory
+ * @since: UNIX timestamp of the oldest modification to return, or 0 for no limit
+ * @offset: number of more recently modified devices to skip
+ * @limit: maximum number of devices to return, or 0 for no limit
+ * @flags_exclude: device flags to ignore, e.g. %FWUPD_DEVICE_FLAG_EMULATED
  * @error: (nullable): optional return location for an error
  *
- * Gets the devices in the history database.
+ * Gets the devices in the history database, counting @offset and @limit from the most recently
+ * modified device. The results are always returned oldest first.
  *
  * Returns: (element-type #FuDevice) (transfer container): devices
  *
- * Since: 1.0.4
+ * Since: 2.1.6
  **/
 GPtrArray *
-fu_history_get_devices(FuHistory *self, GError **error)
+fu_history_get_devices_filtered(FuHistory *self,
+				guint64 since,
+				guint offset,
+				guint limit,
+				FwupdDeviceFlags flags_exclude,
+				GError **error)
 {
 	g_autoptr(GPtrArray) array = g_ptr_array_new_with_free_func((GDestroyNotify)g_object_unref);
-	g_autoptr(sqlite3_stmt) stmt = NULL;
-	gint rc;
+	sqlite3_stmt *stmt;
 
 	g_return_val_if_fail(FU_IS_HISTORY(self), NULL);
 
@@ -1130,45 +1236,62 @@ fu_history_get_devices(FuHistory *self, GError **error)
 	}
 
 	/* get all the devices */
-	rc = sqlite3_prepare_v2(self->db,
-				"SELECT device_id, "
-				"checksum, "
-				"plugin, "
-				"device_created, "
-				"device_modified, "
-				"display_name, "
-				"filename, "
-				"flags, "
-				"metadata, "
-				"guid_default, "
-				"update_state, "
-				"update_error, "
-				"version_new, "
-				"version_old, "
-				"checksum_device, "
-				"protocol, "
-				"release_id, "
-				"appstream_id, "
-				"version_format, "
-				"install_duration, "
-				"release_flags FROM history "
-				"ORDER BY device_modified ASC;",
-				-1,
-				&stmt,
-				NULL);
-	if (rc != SQLITE_OK) {
-		g_set_error(error,
-			    FWUPD_ERROR,
-			    FWUPD_ERROR_INTERNAL,
-			    "Failed to prepare SQL to get history: %s",
-			    sqlite3_errmsg(self->db));
+	stmt = fu_history_prepare(self,
+				  "SELECT * FROM (SELECT device_id, "
+				  "checksum, "
+				  "plugin, "
+				  "device_created, "
+				  "device_modified, "
+				  "display_name, "
+				  "filename, "
+				  "flags, "
+				  "metadata, "
+				  "guid_default, "
+				  "update_state, "
+				  "update_error, "
+				  "version_new, "
+				  "version_old, "
+				  "checksum_device, "
+				  "protocol, "
+				  "release_id, "
+				  "appstream_id, "
+				  "version_format, "
+				  "install_duration, "
+				  "release_flags FROM history "
+				  "WHERE device_modified >= ?1 AND (flags & ?2) = 0 "
+				  "ORDER BY device_modified DESC LIMIT ?3 OFFSET ?4) "
+				  "ORDER BY device_modified ASC;",
+				  error);
+	if (stmt == NULL) {
+		g_prefix_error_literal(error, "failed to get history: ");
 		return NULL;
 	}
+	sqlite3_bind_int64(stmt, 1, since);
+	sqlite3_bind_int64(stmt, 2, flags_exclude);
+	sqlite3_bind_int64(stmt, 3, limit > 0 ? (gint64)limit : -1);
+	sqlite3_bind_int64(stmt, 4, offset);
 	if (!fu_history_stmt_exec(self, stmt, array, error))
 		return NULL;
 	return g_steal_pointer(&array);
 }
 
+/**
+ * fu_history_get_devices:
+ * @self: a #FuHistory
+ * @error: (nullable): optional return location for an error
+ *
+ * Gets the devices in the history database.
+ *
+ * Returns: (element-type #FuDevice) (transfer container): devices
+ *
+ * Since: 1.0.4
+ **/
+GPtrArray *
+fu_history_get_devices(FuHistory *self, GError **error)
+{
+	return fu_history_get_devices_filtered(self, 0, 0, 0, FWUPD_DEVICE_FLAG_NONE, error);
+}
+
 /**
  * fu_history_get_approved_firmware:
  * @self: a #FuHistory
@@ -1304,61 +1427,225 @@ fu_history_add_approved_firmware(FuHistory *self, const gchar *checksum, GError
 	return fu_history_stmt_exec(self, stmt, NULL, error);
 }
 
-gboolean
-fu_history_add_security_attribute(FuHistory *self,
-				  const gchar *security_attr_json,
-				  const gchar *hsi_score,
-				  GError **error)
+/* plugins can add the same AppStream ID, so include the plugin name */
+static gchar *
+fu_history_security_attr_get_key(FwupdSecurityAttr *attr)
 {
-	gint rc;
-	g_autoptr(sqlite3_stmt) stmt = NULL;
+	const gchar *plugin = fwupd_security_attr_get_plugin(attr);
+	return g_strdup_printf("%s:%s",
+			       plugin != NULL ? plugin : "",
+			       fwupd_security_attr_get_appstream_id(attr));
+}
 
-	g_return_val_if_fail(FU_IS_HISTORY(self), FALSE);
+/* as it would be read back, ignoring the created timestamp as that is stored for the row */
+static gchar *
+fu_history_security_attr_to_string(FwupdSecurityAttr *attr, GError **error)
+{
+	g_autofree gchar *json = NULL;
+	g_autoptr(FwupdSecurityAttr) attr_tmp = fwupd_security_attr_new(NULL);
 
-	/* lazy load */
-	if (!fu_history_load(self, error))
+	json = fwupd_codec_to_json_string(FWUPD_CODEC(attr), FWUPD_CODEC_FLAG_NONE, error);
+	if (json == NULL)
+		return NULL;
+	if (!fwupd_codec_from_json_string(FWUPD_CODEC(attr_tmp), json, error))
+		return NULL;
+	fwupd_security_attr_set_created(attr_tmp, 0);
+	return fwupd_codec_to_json_string(FWUPD_CODEC(attr_tmp), FWUPD_CODEC_FLAG_NONE, error);
+}
+
+static gboolean
+fu_history_security_attrs_find(GPtrArray *attrs, const gchar *key, guint *idx)
+{
+	for (guint i = 0; i < attrs->len; i++) {
+		FwupdSecurityAttr *attr = g_ptr_array_index(attrs, i);
+		g_autofree gchar *key_tmp = fu_history_security_attr_get_key(attr);
+		if (g_strcmp0(key, key_tmp) == 0) {
+			if (idx != NULL)
+				*idx = i;
+			return TRUE;
+		}
+	}
+	return FALSE;
+}
+
+/* applies one stored row on top of the attrs of the row before it */
+static gboolean
+fu_history_security_attrs_apply(GPtrArray *attrs,
+				const gchar *json,
+				const gchar *removed,
+				gboolean is_delta,
+				GError **error)
+{
+	g_autoptr(FuSecurityAttrs) attrs_tmp = fu_security_attrs_new();
+	g_autoptr(GPtrArray) items = NULL;
+
+	if (!fwupd_codec_from_json_string(FWUPD_CODEC(attrs_tmp), json, error))
 		return FALSE;
+	items = fu_security_attrs_get_all(attrs_tmp, NULL);
 
-	/* remove entries */
-	rc = sqlite3_prepare_v2(self->db,
-				"INSERT INTO hsi_history (hsi_details, hsi_score)"
-				"VALUES (?1, ?2)",
-				-1,
-				&stmt,
-				NULL);
-	if (rc != SQLITE_OK) {
+	/* a full snapshot */
+	if (!is_delta) {
+		g_ptr_array_set_size(attrs, 0);
+		for (guint i = 0; i < items->len; i++)
+			g_ptr_array_add(attrs, g_object_ref(g_ptr_array_index(items, i)));
+		return TRUE;
+	}
+
+	/* removed, then added or changed */
+	if (removed != NULL) {
+		g_auto(GStrv) keys = g_strsplit(removed, ";", -1);
+		for (guint i = 0; keys[i] != NULL; i++) {
+			guint idx = 0;
+			if (fu_history_security_attrs_find(attrs, keys[i], &idx))
+				g_ptr_array_remove_index(attrs, idx);
+		}
+	}
+	for (guint i = 0; i < items->len; i++) {
+		FwupdSecurityAttr *attr = g_ptr_array_index(items, i);
+		guint idx = 0;
+		g_autofree gchar *key = fu_history_security_attr_get_key(attr);
+
+		if (fu_history_security_attrs_find(attrs, key, &idx)) {
+			g_object_unref(g_ptr_array_index(attrs, idx));
+			attrs->pdata[idx] = g_object_ref(attr);
+		} else {
+			g_ptr_array_add(attrs, g_object_ref(attr));
+		}
+	}
+	return TRUE;
+}
+
+static FuSecurityAttrs *
+fu_history_security_attrs_snapshot(GPtrArray *attrs, const gchar *timestamp)
+{
+	FuSecurityAttrs *attrs_new = fu_security_attrs_new();
+	g_autoptr(GTimeZone) tz_utc = g_time_zone_new_utc();
+	g_autoptr(GDateTime) created_dt = g_date_time_new_from_iso8601(timestamp, tz_utc);
+
+	for (guint i = 0; i < attrs->len; i++) {
+		FwupdSecurityAttr *attr = g_ptr_array_index(attrs, i);
+		g_autoptr(FwupdSecurityAttr) attr_copy = fwupd_security_attr_copy(attr);
+		if (created_dt != NULL)
+			fwupd_security_attr_set_created(attr_copy, g_date_time_to_unix(created_dt));
+		fu_security_attrs_append_internal(attrs_new, attr_copy);
+	}
+	return attrs_new;
+}
+
+/* replays the last full snapshot at or before @rowid, and every delta after it */
+static gboolean
+fu_history_load_security_attrs_chain(FuHistory *self,
+				     gint64 rowid,
+				     GHashTable *snapshots,
+				     GError **error)
+{
+	gint rc;
+	sqlite3_stmt *stmt;
+	g_autoptr(GPtrArray) attrs = g_ptr_array_new_with_free_func((GDestroyNotify)g_object_unref);
+
+	stmt = fu_history_prepare(self,
+				  "SELECT rowid, timestamp, hsi_details, hsi_delta, hsi_removed "
+				  "FROM hsi_history WHERE rowid <= ?1 AND rowid >= "
+				  "(SELECT IFNULL(MAX(rowid), 0) FROM hsi_history "
+				  "WHERE rowid <= ?1 AND hsi_delta = 0) "
+				  "ORDER BY rowid ASC;",
+				  error);
+	if (stmt == NULL) {
+		g_prefix_error_literal(error, "failed to get security attrs: ");
+		return FALSE;
+	}
+	sqlite3_bind_int64(stmt, 1, rowid);
+	while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+		gint64 rowid_tmp = sqlite3_column_int64(stmt, 0);
+		const gchar *timestamp = (const gchar *)sqlite3_column_text(stmt, 1);
+		const gchar *json = (const gchar *)sqlite3_column_text(stmt, 2);
+		const gchar *removed = (const gchar *)sqlite3_column_text(stmt, 4);
+
+		if (timestamp == NULL || json == NULL)
+			continue;
+		if (!fu_history_security_attrs_apply(attrs,
+						     json,
+						     removed,
+						     sqlite3_column_int(stmt, 3) != 0,
+						     error)) {
+			sqlite3_reset(stmt);
+			return FALSE;
+		}
+		g_hash_table_insert(snapshots,
+				    g_memdup2(&rowid_tmp, sizeof(rowid_tmp)),
+				    fu_history_security_attrs_snapshot(attrs, timestamp));
+	}
+	if (rc != SQLITE_DONE) {
 		g_set_error(error,
 			    FWUPD_ERROR,
-			    FWUPD_ERROR_INTERNAL,
-			    "Failed to prepare SQL to write security attribute: %s",
+			    FWUPD_ERROR_WRITE,
+			    "failed to execute prepared statement: %s",
 			    sqlite3_errmsg(self->db));
+		sqlite3_reset(stmt);
 		return FALSE;
 	}
-	sqlite3_bind_text(stmt, 1, security_attr_json, -1, SQLITE_STATIC);
-	sqlite3_bind_text(stmt, 2, hsi_score, -1, SQLITE_STATIC);
-	return fu_history_stmt_exec(self, stmt, NULL, error);
+	sqlite3_reset(stmt);
+	return TRUE;
+}
+
+/* the number of deltas written since the last full snapshot */
+static gboolean
+fu_history_get_security_attrs_chain_length(FuHistory *self, guint *chain_len, GError **error)
+{
+	sqlite3_stmt *stmt;
+
+	stmt = fu_history_prepare(self,
+				  "SELECT COUNT(*) FROM hsi_history WHERE rowid > "
+				  "(SELECT IFNULL(MAX(rowid), 0) FROM hsi_history "
+				  "WHERE hsi_delta = 0);",
+				  error);
+	if (stmt == NULL) {
+		g_prefix_error_literal(error, "failed to count security attrs: ");
+		return FALSE;
+	}
+	if (sqlite3_step(stmt) != SQLITE_ROW) {
+		g_set_error(error,
+			    FWUPD_ERROR,
+			    FWUPD_ERROR_READ,
+			    "failed to execute prepared statement: %s",
+			    sqlite3_errmsg(self->db));
+		sqlite3_reset(stmt);
+		return FALSE;
+	}
+	*chain_len = sqlite3_column_int(stmt, 0);
+	sqlite3_reset(stmt);
+	return TRUE;
 }
 
 /**
- * fu_history_get_security_attrs:
+ * fu_history_get_security_attrs_filtered:
  * @self: a #FuHistory
+ * @since: UNIX timestamp of the oldest entry to return, or 0 for no limit
+ * @offset: number of newer entries to skip
  * @limit: maximum number of attributes to return, or 0 for no limit
  * @error: (nullable): optional return location for an error
  *
- * Gets the security attributes in the history database.
+ * Gets the security attributes in the history database, newest first.
  * Attributes with the same stores JSON data will be deduplicated as required.
  *
  * Returns: (element-type #FuSecurityAttrs) (transfer container): attrs
  *
- * Since: 1.7.1
+ * Since: 2.1.6
  **/
 GPtrArray *
-fu_history_get_security_attrs(FuHistory *self, guint limit, GError **error)
+fu_history_get_security_attrs_filtered(FuHistory *self,
+				       guint64 since,
+				       guint offset,
+				       guint limit,
+				       GError **error)
 {
 	gint rc;
 	guint old_hash = 0;
+	guint skipped = 0;
+	sqlite3_stmt *stmt;
 	g_autoptr(GPtrArray) array = g_ptr_array_new_with_free_func((GDestroyNotify)g_object_unref);
-	g_autoptr(sqlite3_stmt) stmt = NULL;
+	g_autoptr(GHashTable) snapshots =
+	    g_hash_table_new_full(g_int64_hash, g_int64_equal, g_free, g_object_unref);
 
 	g_return_val_if_fail(FU_IS_HISTORY(self), NULL);
 
@@ -1368,61 +1655,86 @@ fu_history_get_security_attrs(FuHistory *self, guint limit, GError **error)
 			return NULL;
 	}
 
-	/* get all the devices */
-	rc = sqlite3_prepare_v2(self->db,
-				"SELECT timestamp, hsi_details FROM hsi_history "
-				"ORDER BY timestamp DESC;",
-				-1,
-				&stmt,
-				NULL);
-	if (rc != SQLITE_OK) {
-		g_set_error(error,
-			    FWUPD_ERROR,
-			    FWUPD_ERROR_INTERNAL,
-			    "Failed to prepare SQL to get security attrs: %s",
-			    sqlite3_errmsg(self->db));
+	/* get all the snapshots */
+	stmt = fu_history_prepare(self,
+				  "SELECT rowid, timestamp, hsi_details, hsi_delta "
+				  "FROM hsi_history "
+				  "WHERE timestamp >= datetime(?1, 'unixepoch') "
+				  "ORDER BY rowid DESC;",
+				  error);
+	if (stmt == NULL) {
+		g_prefix_error_literal(error, "failed to get security attrs: ");
 		return NULL;
 	}
+	sqlite3_bind_int64(stmt, 1, since);
 	while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+		gint64 rowid = sqlite3_column_int64(stmt, 0);
 		const gchar *json;
-		guint hash;
 		const gchar *timestamp;
-		g_autoptr(FuSecurityAttrs) attrs = fu_security_attrs_new();
-		g_autoptr(GDateTime) created_dt = NULL;
-		g_autoptr(GTimeZone) tz_utc = g_time_zone_new_utc();
+		g_autoptr(FuSecurityAttrs) attrs = NULL;
 
 		/* old */
-		timestamp = (const gchar *)sqlite3_column_text(stmt, 0);
+		timestamp = (const gchar *)sqlite3_column_text(stmt, 1);
 		if (timestamp == NULL)
 			continue;
 
 		/* device_id */
-		json = (const gchar *)sqlite3_column_text(stmt, 1);
+		json = (const gchar *)sqlite3_column_text(stmt, 2);
 		if (json == NULL)
 			continue;
 
-		/* do not create dups */
-		hash = g_str_hash(json);
-		if (hash == old_hash) {
-			g_debug("skipping %s as unchanged", timestamp);
-			continue;
+		/* do not create dups -- deltas are only written when something changed */
+		if (sqlite3_column_int(stmt, 3) == 0) {
+			guint hash = g_str_hash(json);
+			if (hash == old_hash) {
+				g_debug("skipping %s as unchanged", timestamp);
+				continue;
+			}
+			old_hash = hash;
+		} else {
+			old_hash = 0;
 		}
-		old_hash = hash;
 
-		/* parse JSON */
-		g_debug("parsing %s", timestamp);
-		if (!fwupd_codec_from_json_string(FWUPD_CODEC(attrs), json, error))
-			return NULL;
+		/* paginate */
+		if (skipped < offset) {
+			skipped++;
+			continue;
+		}
 
-		/* parse timestamp */
-		created_dt = g_date_time_new_from_iso8601(timestamp, tz_utc);
-		if (created_dt != NULL) {
-			guint64 created_unix = g_date_time_to_unix(created_dt);
-			g_autoptr(GPtrArray) attr_array = fu_security_attrs_get_all(attrs, NULL);
-			for (guint i = 0; i < attr_array->len; i++) {
-				FwupdSecurityAttr *attr = g_ptr_array_index(attr_array, i);
-				fwupd_security_attr_set_created(attr, created_unix);
+		/* replay the deltas, which also caches all the older rows in the same chain */
+		if (sqlite3_column_int(stmt, 3) != 0) {
+			FuSecurityAttrs *attrs_tmp = g_hash_table_lookup(snapshots, &rowid);
+			if (attrs_tmp == NULL) {
+				if (!fu_history_load_security_attrs_chain(self,
+									  rowid,
+									  snapshots,
+									  error)) {
+					sqlite3_reset(stmt);
+					return NULL;
+				}
+				attrs_tmp = g_hash_table_lookup(snapshots, &rowid);
 			}
+			if (attrs_tmp == NULL) {
+				g_set_error(error,
+					    FWUPD_ERROR,
+					    FWUPD_ERROR_INVALID_DATA,
+					    "no security attrs for %s",
+					    timestamp);
+				sqlite3_reset(stmt);
+				return NULL;
+			}
+			attrs = g_object_ref(attrs_tmp);
+		} else {
+			g_autoptr(GPtrArray) items =
+			    g_ptr_array_new_with_free_func((GDestroyNotify)g_object_unref);
+
+			/* parse JSON */
+			g_debug("parsing %s", timestamp);
+			if (!fu_history_security_attrs_apply(items, json, NULL, FALSE, error)) {
+				sqlite3_reset(stmt);
+				return NULL;
+			}
+			attrs = fu_history_security_attrs_snapshot(items, timestamp);
 		}
 
 		/* success */
@@ -1438,11 +1750,159 @@ fu_history_get_security_attrs(FuHistory *self, guint limit, GError **error)
 			    FWUPD_ERROR_WRITE,
 			    "failed to execute prepared statement: %s",
 			    sqlite3_errmsg(self->db));
+		sqlite3_reset(stmt);
 		return NULL;
 	}
+	sqlite3_reset(stmt);
 	return g_steal_pointer(&array);
 }
 
+/**
+ * fu_history_get_security_attrs:
+ * @self: a #FuHistory
+ * @limit: maximum number of attributes to return, or 0 for no limit
+ * @error: (nullable): optional return location for an error
+ *
+ * Gets the security attributes in the history database.
+ * Attributes with the same stores JSON data will be deduplicated as required.
+ *
+ * Returns: (element-type #FuSecurityAttrs) (transfer container): attrs
+ *
+ * Since: 1.7.1
+ **/
+GPtrArray *
+fu_history_get_security_attrs(FuHistory *self, guint limit, GError **error)
+{
+	return fu_history_get_security_attrs_filtered(self, 0, 0, limit, error);
+}
+
+/**
+ * fu_history_add_security_attribute:
+ * @self: a #FuHistory
+ * @attrs: a #FuSecurityAttrs
+ * @hsi_score: the HSI string, e.g. `HSI:1`
+ * @error: (nullable): optional return location for an error
+ *
+ * Adds the security attributes to the history database.
+ *
+ * Only the attributes that differ from the previous entry are stored, with the complete set
+ * written periodically so that reading back only has to replay a few entries.
+ *
+ * Returns: @TRUE if successful, @FALSE for failure
+ *
+ * Since: 1.7.1
+ **/
+gboolean
+fu_history_add_security_attribute(FuHistory *self,
+				  FuSecurityAttrs *attrs,
+				  const gchar *hsi_score,
+				  GError **error)
+{
+	gboolean is_delta = FALSE;
+	guint chain_len = 0;
+	sqlite3_stmt *stmt;
+	g_autofree gchar *json = NULL;
+	g_autofree gchar *removed = NULL;
+	g_autoptr(GPtrArray) attrs_prev = NULL;
+
+	g_return_val_if_fail(FU_IS_HISTORY(self), FALSE);
+	g_return_val_if_fail(FU_IS_SECURITY_ATTRS(attrs), FALSE);
+
+	/* lazy load */
+	if (!fu_history_load(self, error))
+		return FALSE;
+
+	/* store only the differences to the previous entry where possible */
+	attrs_prev = fu_history_get_security_attrs(self, 1, error);
+	if (attrs_prev == NULL)
+		return FALSE;
+	if (!fu_history_get_security_attrs_chain_length(self, &chain_len, error))
+		return FALSE;
+	if (attrs_prev->len > 0) {
+		g_autoptr(FuSecurityAttrs) attrs_delta = fu_security_attrs_new();
+		g_autoptr(GHashTable) hash_prev = g_hash_table_new_full(g_str_hash,
+									g_str_equal,
+									g_free,
+									g_free);
+		g_autoptr(GList) keys_removed = NULL;
+		g_autoptr(GPtrArray) items = fu_security_attrs_get_all(attrs, NULL);
+		g_autoptr(GPtrArray) items_delta = NULL;
+		g_autoptr(GPtrArray) items_prev =
+		    fu_security_attrs_get_all(g_ptr_array_index(attrs_prev, 0), NULL);
+		g_autoptr(GString) str = g_string_new(NULL);
+
+		for (guint i = 0; i < items_prev->len; i++) {
+			FwupdSecurityAttr *attr = g_ptr_array_index(items_prev, i);
+			gchar *json_tmp = fu_history_security_attr_to_string(attr, error);
+			if (json_tmp == NULL)
+				return FALSE;
+			g_hash_table_insert(hash_prev,
+					    fu_history_security_attr_get_key(attr),
+					    json_tmp);
+		}
+		for (guint i = 0; i < items->len; i++) {
+			FwupdSecurityAttr *attr = g_ptr_array_index(items, i);
+			g_autofree gchar *key = fu_history_security_attr_get_key(attr);
+			g_autofree gchar *json_tmp =
+			    fu_history_security_attr_to_string(attr, error);
+			if (json_tmp == NULL)
+				return FALSE;
+			if (g_strcmp0(g_hash_table_lookup(hash_prev, key), json_tmp) != 0)
+				fu_security_attrs_append_internal(attrs_delta, attr);
+			g_hash_table_remove(hash_prev, key);
+		}
+
+		/* anything left over has been removed */
+		keys_removed = g_list_sort(g_hash_table_get_keys(hash_prev),
+					   (GCompareFunc)g_strcmp0);
+		for (GList *l = keys_removed; l != NULL; l = l->next) {
+			if (str->len > 0)
+				g_string_append(str, ";");
+			g_string_append(str, (const gchar *)l->data);
+		}
+
+		/* nothing to do */
+		items_delta = fu_security_attrs_get_all(attrs_delta, NULL);
+		if (items_delta->len == 0 && str->len == 0) {
+			g_debug("no security attribute changes to record");
+			return TRUE;
+		}
+
+		/* only worth it if smaller than the full set */
+		if (items_delta->len < items->len && chain_len < FU_HISTORY_HSI_DELTA_MAX) {
+			json = fwupd_codec_to_json_string(FWUPD_CODEC(attrs_delta),
+							  FWUPD_CODEC_FLAG_NONE,
+							  error);
+			if (json == NULL)
+				return FALSE;
+			if (str->len > 0)
+				removed = g_string_free(g_steal_pointer(&str), FALSE);
+			is_delta = TRUE;
+		}
+	}
+	if (json == NULL) {
+		json = fwupd_codec_to_json_string(FWUPD_CODEC(attrs), FWUPD_CODEC_FLAG_NONE, error);
+		if (json == NULL)
+			return FALSE;
+	}
+
+	/* add entry */
+	stmt = fu_history_prepare(self,
+				  "INSERT INTO hsi_history "
+				  "(hsi_details, hsi_score, hsi_delta, hsi_removed) "
+				  "VALUES (?1, ?2, ?3, ?4)",
+				  error);
+	if (stmt == NULL) {
+		g_prefix_error_literal(error, "failed to write security attribute: ");
+		return FALSE;
+	}
+	sqlite3_bind_text(stmt, 1, json, -1, SQLITE_STATIC);
+	sqlite3_bind_text(stmt, 2, hsi_score, -1, SQLITE_STATIC);
+	sqlite3_bind_int(stmt, 3, is_delta);
+	sqlite3_bind_text(stmt, 4, removed, -1, SQLITE_STATIC);
+	return fu_history_stmt_exec(self, stmt, NULL, error);
+}
+
 /**
  * fu_history_has_emulation_tag:
  * @self: a #FuHistory
@@ -1634,15 +2094,34 @@ fu_history_class_init(FuHistoryClass *klass)
 	object_class->dispose = fu_history_dispose;
 }
 
+/* private: the number of statements that have been compiled and not yet finalized */
+guint
+fu_history_get_statement_count(FuHistory *self)
+{
+	guint cnt = 0;
+	g_return_val_if_fail(FU_IS_HISTORY(self), G_MAXUINT);
+	if (self->db == NULL)
+		return 0;
+	for (sqlite3_stmt *stmt = sqlite3_next_stmt(self->db, NULL); stmt != NULL;
+	     stmt = sqlite3_next_stmt(self->db, stmt))
+		cnt++;
+	return cnt;
+}
+
 static void
 fu_history_init(FuHistory *self)
 {
+	self->stmts = g_hash_table_new_full(g_str_hash,
+					    g_str_equal,
+					    NULL,
+					    (GDestroyNotify)sqlite3_finalize);
 }
 
 static void
 fu_history_finalize(GObject *object)
 {
 	FuHistory *self = FU_HISTORY(object);
+	g_hash_table_unref(self->stmts);
 	if (self->db != NULL)
 		sqlite3_close(self->db);
 	G_OBJECT_CLASS(fu_history_parent_class)->finalize(object);
@@ -35,6 +35,13 @@ fu_history_get_device_by_id(FuHistory *self, const gchar *device_id, GError **er
     G_GNUC_NON_NULL(1, 2);
 GPtrArray *
 fu_history_get_devices(FuHistory *self, GError **error) G_GNUC_NON_NULL(1);
+GPtrArray *
+fu_history_get_devices_filtered(FuHistory *self,
+				guint64 since,
+				guint offset,
+				guint limit,
+				FwupdDeviceFlags flags_exclude,
+				GError **error) G_GNUC_NON_NULL(1);
 
 gboolean
 fu_history_clear_approved_firmware(FuHistory *self, GError **error) G_GNUC_NON_NULL(1);
@@ -45,11 +52,17 @@ GPtrArray *
 fu_history_get_approved_firmware(FuHistory *self, GError **error) G_GNUC_NON_NULL(1);
 gboolean
 fu_history_add_security_attribute(FuHistory *self,
-				  const gchar *security_attr_json,
+				  FuSecurityAttrs *attrs,
 				  const gchar *hsi_score,
 				  GError **error) G_GNUC_NON_NULL(1, 2, 3);
 GPtrArray *
 fu_history_get_security_attrs(FuHistory *self, guint limit, GError **error) G_GNUC_NON_NULL(1);
+GPtrArray *
+fu_history_get_security_attrs_filtered(FuHistory *self,
+				       guint64 since,
+				       guint offset,
+				       guint limit,
+				       GError **error) G_GNUC_NON_NULL(1);
 
 gboolean
 fu_history_add_emulation_tag(FuHistory *self, const gchar *device_id, GError **error)
@@ -25,6 +25,9 @@ struct _FuJcatContext {
 	GObject parent_instance;
 	GPtrArray *engines;
 	GPtrArray *public_keys;
+	GPtrArray *public_keys_paths;
+	gchar *public_keys_mtimes; /* nullable */
+	guint public_keys_generation;
 	gchar *keyring_path;
 	guint32 blob_kinds;
 };
@@ -38,6 +41,8 @@ fu_jcat_context_finalize(GObject *obj)
 	g_free(self->keyring_path);
 	g_ptr_array_unref(self->engines);
 	g_ptr_array_unref(self->public_keys);
+	g_ptr_array_unref(self->public_keys_paths);
+	g_free(self->public_keys_mtimes);
 	G_OBJECT_CLASS(fu_jcat_context_parent_class)->finalize(obj);
 }
 
@@ -54,6 +59,7 @@ fu_jcat_context_init(FuJcatContext *self)
 	self->keyring_path = g_build_filename(g_get_user_data_dir(), PACKAGE_NAME, NULL);
 	self->engines = g_ptr_array_new_with_free_func((GDestroyNotify)g_object_unref);
 	self->public_keys = g_ptr_array_new_with_free_func(g_free);
+	self->public_keys_paths = g_ptr_array_new_with_free_func(g_free);
 
 	g_ptr_array_add(self->engines, fu_jcat_sha256_engine_new(self));
 	g_ptr_array_add(self->engines, fu_jcat_sha512_engine_new(self));
@@ -65,6 +71,52 @@ fu_jcat_context_init(FuJcatContext *self)
 #endif
 }
 
+static void
+fu_jcat_context_add_public_keys_from_path(FuJcatContext *self, const gchar *path)
+{
+	const gchar *fn_tmp;
+	g_autoptr(GDir) dir = NULL;
+	g_autoptr(GError) error_local = NULL;
+
+	/* search all the public key files */
+	dir = g_dir_open(path, 0, &error_local);
+	if (dir == NULL) {
+		g_debug("failed to open public keys directory %s: %s", path, error_local->message);
+		return;
+	}
+	while ((fn_tmp = g_dir_read_name(dir)) != NULL)
+		g_ptr_array_add(self->public_keys, g_build_filename(path, fn_tmp, NULL));
+}
+
+/* any file added, removed or renamed in the directory changes the mtime */
+static gchar *
+fu_jcat_context_get_public_keys_mtimes(FuJcatContext *self)
+{
+	g_autoptr(GString) str = g_string_new(NULL);
+	for (guint i = 0; i < self->public_keys_paths->len; i++) {
+		const gchar *path = g_ptr_array_index(self->public_keys_paths, i);
+		g_autoptr(GFile) file = g_file_new_for_path(path);
+		g_autoptr(GFileInfo) info = NULL;
+
+		info = g_file_query_info(file,
+					 G_FILE_ATTRIBUTE_TIME_MODIFIED
+					 "," G_FILE_ATTRIBUTE_TIME_MODIFIED_USEC,
+					 G_FILE_QUERY_INFO_NONE,
+					 NULL,
+					 NULL);
+		if (info == NULL) {
+			g_string_append(str, "0.000000;");
+			continue;
+		}
+		g_string_append_printf(
+		    str,
+		    "%" G_GUINT64_FORMAT ".%06u;",
+		    g_file_info_get_attribute_uint64(info, G_FILE_ATTRIBUTE_TIME_MODIFIED),
+		    g_file_info_get_attribute_uint32(info, G_FILE_ATTRIBUTE_TIME_MODIFIED_USEC));
+	}
+	return g_string_free(g_steal_pointer(&str), FALSE);
+}
+
 /**
  * fu_jcat_context_add_public_keys:
  * @self: #FuJcatContext
@@ -75,21 +127,37 @@ fu_jcat_context_init(FuJcatContext *self)
 void
 fu_jcat_context_add_public_keys(FuJcatContext *self, const gchar *path)
 {
-	const gchar *fn_tmp;
-	g_autoptr(GDir) dir = NULL;
-	g_autoptr(GError) error_local = NULL;
-
 	g_return_if_fail(FU_IS_JCAT_CONTEXT(self));
 	g_return_if_fail(path != NULL);
 
-	/* search all the public key files */
-	dir = g_dir_open(path, 0, &error_local);
-	if (dir == NULL) {
-		g_debug("failed to open public keys directory %s: %s", path, error_local->message);
-		return;
+	g_ptr_array_add(self->public_keys_paths, g_strdup(path));
+	g_free(self->public_keys_mtimes);
+	self->public_keys_mtimes = fu_jcat_context_get_public_keys_mtimes(self);
+	fu_jcat_context_add_public_keys_from_path(self, path);
+	self->public_keys_generation++;
+}
+
+/* private: changes when any public keys directory is modified */
+guint
+fu_jcat_context_get_public_keys_generation(FuJcatContext *self)
+{
+	g_autofree gchar *mtimes = NULL;
+
+	g_return_val_if_fail(FU_IS_JCAT_CONTEXT(self), 0);
+
+	mtimes = fu_jcat_context_get_public_keys_mtimes(self);
+	if (g_strcmp0(mtimes, self->public_keys_mtimes) != 0) {
+		g_debug("public keys changed, reloading");
+		g_ptr_array_set_size(self->public_keys, 0);
+		for (guint i = 0; i < self->public_keys_paths->len; i++) {
+			const gchar *path = g_ptr_array_index(self->public_keys_paths, i);
+			fu_jcat_context_add_public_keys_from_path(self, path);
+		}
+		g_free(self->public_keys_mtimes);
+		self->public_keys_mtimes = g_steal_pointer(&mtimes);
+		self->public_keys_generation++;
 	}
-	while ((fn_tmp = g_dir_read_name(dir)) != NULL)
-		g_ptr_array_add(self->public_keys, g_build_filename(path, fn_tmp, NULL));
+	return self->public_keys_generation;
 }
 
 /* private */
@@ -50,3 +50,5 @@ void
 fu_jcat_context_allow_blob_kind(FuJcatContext *self, FwupdJcatBlobKind kind) G_GNUC_NON_NULL(1);
 GPtrArray *
 fu_jcat_context_get_public_keys(FuJcatContext *self) G_GNUC_NON_NULL(1);
+guint
+fu_jcat_context_get_public_keys_generation(FuJcatContext *self) G_GNUC_NON_NULL(1);
@@ -14,8 +14,23 @@ typedef struct {
 	FwupdJcatBlobKind kind;
 	FwupdJcatBlobMethod method;
 	gboolean done_setup;
+	guint public_keys_generation;
+	GPtrArray *public_keys_raw; /* element-type GBytes */
+	GHashTable *results;	    /* key -> FuJcatEngineResultItem */
+	GQueue results_keys;	    /* oldest first */
 } FuJcatEnginePrivate;
 
+/* the FuJcatResult is not stored as it holds a reference to the engine */
+typedef struct {
+	gint64 timestamp;
+	gchar *authority;
+	gint64 ctime;
+} FuJcatEngineResultItem;
+
+/* the same payload is often verified several times when updating metadata or installing */
+#define FU_JCAT_ENGINE_RESULTS_MAX	   32
+#define FU_JCAT_ENGINE_RESULTS_MAX_AGE_SEC 600
+
 static void
 fu_jcat_engine_codec_iface_init(FwupdCodecInterface *iface);
 
@@ -43,24 +58,98 @@ fu_jcat_engine_add_string(FwupdCodec *codec, guint idt, GString *str)
 				  fwupd_jcat_blob_method_to_string(priv->method));
 }
 
+static void
+fu_jcat_engine_result_item_free(FuJcatEngineResultItem *item)
+{
+	g_free(item->authority);
+	g_free(item);
+}
+
+/* the trusted keys have changed, so all the previous results are invalid */
+static void
+fu_jcat_engine_reset(FuJcatEngine *self)
+{
+	FuJcatEngineClass *klass = FU_JCAT_ENGINE_GET_CLASS(self);
+	FuJcatEnginePrivate *priv = GET_PRIVATE(self);
+
+	g_hash_table_remove_all(priv->results);
+	g_queue_clear_full(&priv->results_keys, g_free);
+	if (klass->reset != NULL)
+		klass->reset(self);
+	priv->done_setup = FALSE;
+}
+
+static gchar *
+fu_jcat_engine_build_result_key(GBytes *blob, GBytes *blob_signature, FuJcatVerifyFlags flags)
+{
+	g_autofree gchar *csum = g_compute_checksum_for_bytes(G_CHECKSUM_SHA256, blob);
+	g_autofree gchar *csum_sig = g_compute_checksum_for_bytes(G_CHECKSUM_SHA256, blob_signature);
+	return g_strdup_printf("%s:%s:%x", csum, csum_sig, (guint)flags);
+}
+
+static FuJcatResult *
+fu_jcat_engine_get_result(FuJcatEngine *self, const gchar *key)
+{
+	FuJcatEnginePrivate *priv = GET_PRIVATE(self);
+	FuJcatEngineResultItem *item = g_hash_table_lookup(priv->results, key);
+	if (item == NULL)
+		return NULL;
+	if (g_get_monotonic_time() - item->ctime >
+	    (gint64)FU_JCAT_ENGINE_RESULTS_MAX_AGE_SEC * G_USEC_PER_SEC)
+		return NULL;
+	return FU_JCAT_RESULT(g_object_new(FU_TYPE_JCAT_RESULT,
+					   "engine",
+					   self,
+					   "timestamp",
+					   item->timestamp,
+					   "authority",
+					   item->authority,
+					   NULL));
+}
+
+static void
+fu_jcat_engine_add_result(FuJcatEngine *self, const gchar *key, FuJcatResult *result)
+{
+	FuJcatEnginePrivate *priv = GET_PRIVATE(self);
+	FuJcatEngineResultItem *item = g_new0(FuJcatEngineResultItem, 1);
+
+	/* drop the oldest */
+	if (!g_hash_table_contains(priv->results, key)) {
+		if (g_queue_get_length(&priv->results_keys) >= FU_JCAT_ENGINE_RESULTS_MAX) {
+			g_autofree gchar *key_old = g_queue_pop_head(&priv->results_keys);
+			g_hash_table_remove(priv->results, key_old);
+		}
+		g_queue_push_tail(&priv->results_keys, g_strdup(key));
+	}
+	item->timestamp = fu_jcat_result_get_timestamp(result);
+	item->authority = g_strdup(fu_jcat_result_get_authority(result));
+	item->ctime = g_get_monotonic_time();
+	g_hash_table_insert(priv->results, g_strdup(key), item);
+}
+
 static gboolean
 fu_jcat_engine_setup(FuJcatEngine *self, GError **error)
 {
 	FuJcatEngineClass *klass = FU_JCAT_ENGINE_GET_CLASS(self);
 	FuJcatEnginePrivate *priv = GET_PRIVATE(self);
+	guint generation;
 
 	g_return_val_if_fail(FU_IS_JCAT_ENGINE(self), FALSE);
 
-	/* already done */
-	if (priv->done_setup)
-		return TRUE;
-
 	/* sanity check */
 	if (priv->context == NULL) {
 		g_set_error_literal(error, FWUPD_ERROR, FWUPD_ERROR_INTERNAL, "no context");
 		return FALSE;
 	}
 
+	/* already done, and the keyring has not changed */
+	generation = fu_jcat_context_get_public_keys_generation(priv->context);
+	if (priv->done_setup) {
+		if (generation == priv->public_keys_generation)
+			return TRUE;
+		fu_jcat_engine_reset(self);
+	}
+
 	/* optional */
 	if (klass->setup != NULL) {
 		if (!klass->setup(self, error))
@@ -75,8 +164,17 @@ fu_jcat_engine_setup(FuJcatEngine *self, GError **error)
 		}
 	}
 
+	if (klass->add_public_key_raw != NULL) {
+		for (guint i = 0; i < priv->public_keys_raw->len; i++) {
+			GBytes *blob = g_ptr_array_index(priv->public_keys_raw, i);
+			if (!klass->add_public_key_raw(self, blob, error))
+				return FALSE;
+		}
+	}
+
 	/* success */
 	priv->done_setup = TRUE;
+	priv->public_keys_generation = generation;
 	return TRUE;
 }
 
@@ -100,6 +198,9 @@ fu_jcat_engine_pubkey_verify(FuJcatEngine *self,
 			     GError **error)
 {
 	FuJcatEngineClass *klass = FU_JCAT_ENGINE_GET_CLASS(self);
+	g_autofree gchar *key = NULL;
+	g_autoptr(FuJcatResult) result = NULL;
+
 	g_return_val_if_fail(FU_IS_JCAT_ENGINE(self), NULL);
 	g_return_val_if_fail(blob != NULL, NULL);
 	g_return_val_if_fail(blob_signature != NULL, NULL);
@@ -112,7 +213,17 @@ fu_jcat_engine_pubkey_verify(FuJcatEngine *self,
 	}
 	if (!fu_jcat_engine_setup(self, error))
 		return NULL;
-	return klass->pubkey_verify(self, blob, blob_signature, flags, error);
+
+	/* already verified */
+	key = fu_jcat_engine_build_result_key(blob, blob_signature, flags);
+	result = fu_jcat_engine_get_result(self, key);
+	if (result != NULL)
+		return g_steal_pointer(&result);
+	result = klass->pubkey_verify(self, blob, blob_signature, flags, error);
+	if (result == NULL)
+		return NULL;
+	fu_jcat_engine_add_result(self, key, result);
+	return g_steal_pointer(&result);
 }
 
 /**
@@ -231,6 +342,7 @@ gboolean
 fu_jcat_engine_add_public_key_raw(FuJcatEngine *self, GBytes *blob, GError **error)
 {
 	FuJcatEngineClass *klass = FU_JCAT_ENGINE_GET_CLASS(self);
+	FuJcatEnginePrivate *priv = GET_PRIVATE(self);
 	g_return_val_if_fail(FU_IS_JCAT_ENGINE(self), FALSE);
 	g_return_val_if_fail(blob != NULL, FALSE);
 	if (klass->add_public_key_raw == NULL) {
@@ -242,7 +354,12 @@ fu_jcat_engine_add_public_key_raw(FuJcatEngine *self, GBytes *blob, GError **err
 	}
 	if (!fu_jcat_engine_setup(self, error))
 		return FALSE;
-	return klass->add_public_key_raw(self, blob, error);
+	if (!klass->add_public_key_raw(self, blob, error))
+		return FALSE;
+
+	/* added again if the keyring changes */
+	g_ptr_array_add(priv->public_keys_raw, g_bytes_ref(blob));
+	return TRUE;
 }
 
 /**
@@ -298,6 +415,11 @@ fu_jcat_engine_get_keyring_path(FuJcatEngine *self)
 static void
 fu_jcat_engine_finalize(GObject *object)
 {
+	FuJcatEngine *self = FU_JCAT_ENGINE(object);
+	FuJcatEnginePrivate *priv = GET_PRIVATE(self);
+	g_queue_clear_full(&priv->results_keys, g_free);
+	g_hash_table_unref(priv->results);
+	g_ptr_array_unref(priv->public_keys_raw);
 	G_OBJECT_CLASS(fu_jcat_engine_parent_class)->finalize(object);
 }
 
@@ -391,4 +513,11 @@ fu_jcat_engine_class_init(FuJcatEngineClass *klass)
 static void
 fu_jcat_engine_init(FuJcatEngine *self)
 {
+	FuJcatEnginePrivate *priv = GET_PRIVATE(self);
+	priv->public_keys_raw = g_ptr_array_new_with_free_func((GDestroyNotify)g_bytes_unref);
+	priv->results = g_hash_table_new_full(g_str_hash,
+					      g_str_equal,
+					      g_free,
+					      (GDestroyNotify)fu_jcat_engine_result_item_free);
+	g_queue_init(&priv->results_keys);
 }
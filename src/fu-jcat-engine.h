@@ -39,6 +39,7 @@ struct _FuJcatEngineClass {
 				    FuJcatSignFlags flags,
 				    GError **error);
 	gboolean (*add_public_key_raw)(FuJcatEngine *self, GBytes *blob, GError **error);
+	void (*reset)(FuJcatEngine *self);
 };
 
 FwupdJcatBlobKind
@@ -18,10 +18,26 @@
 struct _FuJcatGnutlsPkcs7Engine {
 	FuJcatEngine parent_instance;
 	GPtrArray *pubkeys_crts; /* element-type gnutls_x509_crt_t */
+	gnutls_x509_trust_list_t tl;
+	gnutls_x509_trust_list_t tl_pq;
 };
 
 G_DEFINE_TYPE(FuJcatGnutlsPkcs7Engine, fu_jcat_gnutls_pkcs7_engine, FU_TYPE_JCAT_ENGINE)
 
+static void
+fu_jcat_gnutls_pkcs7_engine_clear_trust_lists(FuJcatGnutlsPkcs7Engine *self)
+{
+	/* the certificates are owned by pubkeys_crts */
+	if (self->tl != NULL) {
+		gnutls_x509_trust_list_deinit(self->tl, 0);
+		self->tl = NULL;
+	}
+	if (self->tl_pq != NULL) {
+		gnutls_x509_trust_list_deinit(self->tl_pq, 0);
+		self->tl_pq = NULL;
+	}
+}
+
 static gboolean
 fu_jcat_gnutls_pkcs7_engine_add_pubkey_blob_fmt(FuJcatGnutlsPkcs7Engine *self,
 						GBytes *blob,
@@ -51,6 +67,7 @@ fu_jcat_gnutls_pkcs7_engine_add_pubkey_blob_fmt(FuJcatGnutlsPkcs7Engine *self,
 		return FALSE;
 	}
 	g_ptr_array_add(self->pubkeys_crts, g_steal_pointer(&crt));
+	fu_jcat_gnutls_pkcs7_engine_clear_trust_lists(self);
 	return TRUE;
 }
 
@@ -154,6 +171,44 @@ fu_jcat_gnutls_pkcs7_engine_build_trust_list_only_pq(FuJcatGnutlsPkcs7Engine *se
 }
 #endif
 
+/* only built once for all the signatures, until the keyring changes */
+static gnutls_x509_trust_list_t
+fu_jcat_gnutls_pkcs7_engine_ensure_trust_list(FuJcatGnutlsPkcs7Engine *self,
+					      FuJcatVerifyFlags flags,
+					      GError **error)
+{
+	if (flags & FU_JCAT_VERIFY_FLAG_ONLY_PQ) {
+#ifdef HAVE_GNUTLS_PQC
+		if (self->tl_pq == NULL) {
+			g_auto(gnutls_x509_trust_list_t) tl =
+			    fu_jcat_gnutls_pkcs7_engine_build_trust_list_only_pq(self, error);
+			if (tl == NULL)
+				return NULL;
+			if (!fu_jcat_gnutls_ensure_trust_list_valid(tl, error))
+				return NULL;
+			self->tl_pq = g_steal_pointer(&tl);
+		}
+		return self->tl_pq;
+#else
+		g_set_error_literal(error,
+				    FWUPD_ERROR,
+				    FWUPD_ERROR_NOT_SUPPORTED,
+				    "GnuTLS too old for PQC support");
+		return NULL;
+#endif
+	}
+	if (self->tl == NULL) {
+		g_auto(gnutls_x509_trust_list_t) tl =
+		    fu_jcat_gnutls_pkcs7_engine_build_trust_list(self, error);
+		if (tl == NULL)
+			return NULL;
+		if (!fu_jcat_gnutls_ensure_trust_list_valid(tl, error))
+			return NULL;
+		self->tl = g_steal_pointer(&tl);
+	}
+	return self->tl;
+}
+
 /* verifies a detached signature just like:
  *  `certtool --p7-verify --load-certificate client.pem --infile=test.p7b` */
 static FuJcatResult *
@@ -224,26 +279,9 @@ fu_jcat_gnutls_pkcs7_engine_verify(FuJcatEngine *engine,
 		if (crt != NULL) {
 			rc = gnutls_pkcs7_verify_direct(pkcs7, crt, i, &datum, verify_flags);
 		} else {
-			g_auto(gnutls_x509_trust_list_t) tl = NULL;
-			if (flags & FU_JCAT_VERIFY_FLAG_ONLY_PQ) {
-#ifdef HAVE_GNUTLS_PQC
-				tl = fu_jcat_gnutls_pkcs7_engine_build_trust_list_only_pq(self,
-											  error);
-				if (tl == NULL)
-					return NULL;
-#else
-				g_set_error_literal(error,
-						    FWUPD_ERROR,
-						    FWUPD_ERROR_NOT_SUPPORTED,
-						    "GnuTLS too old for PQC support");
-				return NULL;
-#endif
-			} else {
-				tl = fu_jcat_gnutls_pkcs7_engine_build_trust_list(self, error);
-				if (tl == NULL)
-					return NULL;
-			}
-			if (!fu_jcat_gnutls_ensure_trust_list_valid(tl, error))
+			gnutls_x509_trust_list_t tl =
+			    fu_jcat_gnutls_pkcs7_engine_ensure_trust_list(self, flags, error);
+			if (tl == NULL)
 				return NULL;
 			rc = gnutls_pkcs7_verify(pkcs7,
 						 tl,
@@ -506,10 +544,19 @@ fu_jcat_gnutls_pkcs7_engine_self_sign(FuJcatEngine *engine,
 	return fu_jcat_gnutls_pkcs7_engine_pubkey_sign(engine, blob, cert, privkey, flags, error);
 }
 
+static void
+fu_jcat_gnutls_pkcs7_engine_reset(FuJcatEngine *engine)
+{
+	FuJcatGnutlsPkcs7Engine *self = FU_JCAT_GNUTLS_PKCS7_ENGINE(engine);
+	fu_jcat_gnutls_pkcs7_engine_clear_trust_lists(self);
+	g_ptr_array_set_size(self->pubkeys_crts, 0);
+}
+
 static void
 fu_jcat_gnutls_pkcs7_engine_finalize(GObject *object)
 {
 	FuJcatGnutlsPkcs7Engine *self = FU_JCAT_GNUTLS_PKCS7_ENGINE(object);
+	fu_jcat_gnutls_pkcs7_engine_clear_trust_lists(self);
 	g_ptr_array_unref(self->pubkeys_crts);
 	G_OBJECT_CLASS(fu_jcat_gnutls_pkcs7_engine_parent_class)->finalize(object);
 }
@@ -525,6 +572,7 @@ fu_jcat_gnutls_pkcs7_engine_class_init(FuJcatGnutlsPkcs7EngineClass *klass)
 	engine_class->pubkey_sign = fu_jcat_gnutls_pkcs7_engine_pubkey_sign;
 	engine_class->self_verify = fu_jcat_gnutls_pkcs7_engine_self_verify;
 	engine_class->self_sign = fu_jcat_gnutls_pkcs7_engine_self_sign;
+	engine_class->reset = fu_jcat_gnutls_pkcs7_engine_reset;
 	object_class->finalize = fu_jcat_gnutls_pkcs7_engine_finalize;
 }
 
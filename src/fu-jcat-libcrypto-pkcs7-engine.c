@@ -556,6 +556,13 @@ fu_jcat_libcrypto_pkcs7_engine_self_sign(FuJcatEngine *engine,
 							  error);
 }
 
+static void
+fu_jcat_libcrypto_pkcs7_engine_reset(FuJcatEngine *engine)
+{
+	FuJcatLibcryptoPkcs7Engine *self = FU_JCAT_LIBCRYPTO_PKCS7_ENGINE(engine);
+	g_clear_pointer(&self->trust_store, X509_STORE_free);
+}
+
 static void
 fu_jcat_libcrypto_pkcs7_engine_finalize(GObject *object)
 {
@@ -578,6 +585,7 @@ fu_jcat_libcrypto_pkcs7_engine_class_init(FuJcatLibcryptoPkcs7EngineClass *klass
 	engine_class->pubkey_sign = fu_jcat_libcrypto_pkcs7_engine_pubkey_sign;
 	engine_class->self_verify = fu_jcat_libcrypto_pkcs7_engine_self_verify;
 	engine_class->self_sign = fu_jcat_libcrypto_pkcs7_engine_self_sign;
+	engine_class->reset = fu_jcat_libcrypto_pkcs7_engine_reset;
 	object_class->finalize = fu_jcat_libcrypto_pkcs7_engine_finalize;
 }
 
@@ -7,6 +7,8 @@
 
 #include "config.h"
 
+#include <glib/gstdio.h>
+
 #include "fwupd-jcat-blob.h"
 #include "fwupd-jcat-file.h"
 #include "fwupd-jcat-item.h"
@@ -242,6 +244,89 @@ fwupd_jcat_pkcs7_engine_func(gconstpointer test_data)
 	g_clear_error(&error);
 }
 
+static void
+fwupd_jcat_pkcs7_engine_keyring_changed_func(gconstpointer test_data)
+{
+	gboolean ret;
+	g_autofree gchar *fn_ca = NULL;
+	g_autofree gchar *fn_ca_copy = NULL;
+	g_autofree gchar *fn_fwbin = NULL;
+	g_autofree gchar *fn_sig = NULL;
+	g_autoptr(FuJcatContext) context = fu_jcat_context_new();
+	g_autoptr(FuJcatEngine) engine = NULL;
+	g_autoptr(FuJcatResult) result1 = NULL;
+	g_autoptr(FuJcatResult) result2 = NULL;
+	g_autoptr(FuJcatResult) result3 = NULL;
+	g_autoptr(FuTemporaryDirectory) tmpdir = NULL;
+	g_autoptr(GBytes) data_ca = NULL;
+	g_autoptr(GBytes) data_fwbin = NULL;
+	g_autoptr(GBytes) data_sig = NULL;
+	g_autoptr(GError) error = NULL;
+
+	/* only trust the LVFS CA */
+	tmpdir = fu_temporary_directory_new("pkcs7-engine-keyring-changed", &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(tmpdir);
+	fn_ca = g_test_build_filename(G_TEST_DIST, "tests", "pki", "LVFS-CA.pem", NULL);
+	data_ca = fu_bytes_get_contents(fn_ca, &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(data_ca);
+	fn_ca_copy = fu_temporary_directory_build(tmpdir, "LVFS-CA.pem", NULL);
+	ret = fu_bytes_set_contents(fn_ca_copy, data_ca, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	fu_jcat_context_add_public_keys(context, fu_temporary_directory_get_path(tmpdir));
+	fu_jcat_context_allow_blob_kind(context, FWUPD_JCAT_BLOB_KIND_PKCS7);
+	if (test_data == NULL) {
+		engine = fu_jcat_context_get_engine(context, FWUPD_JCAT_BLOB_KIND_PKCS7, &error);
+	} else {
+		engine = ((FuJcatEngineNewFunc)test_data)(context);
+	}
+	g_assert_no_error(error);
+	g_assert_nonnull(engine);
+
+	fn_fwbin = g_test_build_filename(G_TEST_DIST, "tests", "colorhug", "firmware.bin", NULL);
+	data_fwbin = fu_bytes_get_contents(fn_fwbin, &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(data_fwbin);
+	fn_sig = g_test_build_filename(G_TEST_DIST, "tests", "colorhug", "firmware.bin.p7b", NULL);
+	data_sig = fu_bytes_get_contents(fn_sig, &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(data_sig);
+	result1 = fu_jcat_engine_pubkey_verify(engine,
+					       data_fwbin,
+					       data_sig,
+					       FU_JCAT_VERIFY_FLAG_DISABLE_TIME_CHECKS,
+					       &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(result1);
+
+	/* same payload, signature and flags */
+	result2 = fu_jcat_engine_pubkey_verify(engine,
+					       data_fwbin,
+					       data_sig,
+					       FU_JCAT_VERIFY_FLAG_DISABLE_TIME_CHECKS,
+					       &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(result2);
+	g_assert_cmpint(fu_jcat_result_get_timestamp(result2),
+			==,
+			fu_jcat_result_get_timestamp(result1));
+	g_assert_cmpstr(fu_jcat_result_get_authority(result2),
+			==,
+			fu_jcat_result_get_authority(result1));
+
+	/* the CA is no longer trusted, so neither the trust list nor the result can be reused */
+	g_assert_cmpint(g_unlink(fn_ca_copy), ==, 0);
+	result3 = fu_jcat_engine_pubkey_verify(engine,
+					       data_fwbin,
+					       data_sig,
+					       FU_JCAT_VERIFY_FLAG_DISABLE_TIME_CHECKS,
+					       &error);
+	g_assert_nonnull(error);
+	g_assert_null(result3);
+}
+
 static void
 fwupd_jcat_pkcs7_engine_self_signed_func(gconstpointer test_data)
 {
@@ -715,6 +800,9 @@ main(int argc, char **argv)
 	g_test_add_data_func("/jcat/engine/pkcs7/self-signed",
 			     NULL,
 			     fwupd_jcat_pkcs7_engine_self_signed_func);
+	g_test_add_data_func("/jcat/engine/pkcs7/keyring-changed",
+			     NULL,
+			     fwupd_jcat_pkcs7_engine_keyring_changed_func);
 #ifdef HAVE_LIBCRYPTO
 	g_test_add_data_func("/jcat/engine/pkcs7/openssl",
 			     &fu_jcat_libcrypto_pkcs7_engine_new,
@@ -722,6 +810,9 @@ main(int argc, char **argv)
 	g_test_add_data_func("/jcat/engine/pkcs7/self-signed/openssl",
 			     &fu_jcat_libcrypto_pkcs7_engine_new,
 			     fwupd_jcat_pkcs7_engine_self_signed_func);
+	g_test_add_data_func("/jcat/engine/pkcs7/keyring-changed/openssl",
+			     &fu_jcat_libcrypto_pkcs7_engine_new,
+			     fwupd_jcat_pkcs7_engine_keyring_changed_func);
 #endif
 #ifdef HAVE_GNUTLS
 	g_test_add_data_func("/jcat/engine/pkcs7/gnutls",
@@ -79,6 +79,7 @@ main(int argc, char *argv[])
 {
 	gboolean immediate_exit = FALSE;
 	gboolean timed_exit = FALSE;
+	g_autofree gchar *profile_trace = NULL;
 	const gchar *socket_filename = g_getenv("FWUPD_DBUS_SOCKET");
 	const GOptionEntry options[] = {
 	    {"timed-exit",
@@ -97,6 +98,15 @@ main(int argc, char *argv[])
 	     /* TRANSLATORS: exit straight away, used for automatic profiling */
 	     N_("Exit after the engine has loaded"),
 	     NULL},
+	    {"profile-trace",
+	     '\0',
+	     0,
+	     G_OPTION_ARG_FILENAME,
+	     &profile_trace,
+	     /* TRANSLATORS: save startup timings, used for user profiling */
+	     N_("Save the startup step timings to a Chrome trace file"),
+	     /* TRANSLATORS: command argument: uppercase, spaces->dashes */
+	     N_("FILENAME")},
 	    {NULL}};
 	g_autofree gchar *socket_address = NULL;
 	g_autoptr(GError) error = NULL;
@@ -147,6 +157,8 @@ main(int argc, char *argv[])
 	}
 
 	/* set up the daemon, which includes coldplugging devices */
+	if (profile_trace != NULL)
+		fu_daemon_set_profile_trace(daemon, profile_trace);
 	if (!fu_daemon_setup(daemon, socket_address, &error)) {
 		g_printerr("Failed to load daemon: %s\n", error->message);
 		return EXIT_FAILURE;
@@ -76,6 +76,8 @@ struct FuUtil {
 	gboolean cleanup_blob;
 	gboolean enable_json_state;
 	gboolean interactive;
+	gboolean profile;
+	gchar *profile_trace;
 	gchar *destdir;
 	FwupdInstallFlags flags;
 	FuFirmwareParseFlags parse_flags;
@@ -369,6 +371,7 @@ static void
 fu_util_private_free(FuUtil *self)
 {
 	g_free(self->destdir);
+	g_free(self->profile_trace);
 	if (self->current_device != NULL)
 		g_object_unref(self->current_device);
 	if (self->ctx != NULL)
@@ -3295,7 +3298,9 @@ fu_util_firmware_parse(FuUtil *self, gchar **values, GError **error)
 {
 	FuContext *ctx = fu_engine_get_context(self->engine);
 	GType gtype;
+	gboolean ret;
 	g_autoptr(FuFirmware) firmware = NULL;
+	g_autoptr(FuFirmwareProfiler) profiler = NULL;
 	g_autoptr(GInputStream) stream = NULL;
 	g_autofree gchar *firmware_type = NULL;
 	g_autofree gchar *str = NULL;
@@ -3387,26 +3392,44 @@ fu_util_firmware_parse(FuUtil *self, gchar **values, GError **error)
 	/* match the behavior of the daemon as we're printing the children */
 	self->parse_flags |= FU_FIRMWARE_PARSE_FLAG_CACHE_STREAM;
 
+	/* record where the time is spent */
+	if (self->profile) {
+		profiler = fu_firmware_profiler_new();
+		fu_firmware_profiler_push_thread_default(profiler);
+	}
+
 	/* does firmware specify an internal size */
 	firmware = g_object_new(gtype, NULL);
 	if (fu_firmware_has_flag(firmware, FU_FIRMWARE_FLAG_ALLOW_LINEAR)) {
 		g_autoptr(FuFirmware) firmware_linear = fu_linear_firmware_new(gtype);
 		g_autoptr(GPtrArray) imgs = NULL;
-		if (!fu_firmware_parse_stream(firmware_linear,
-					      stream,
-					      0x0,
-					      self->parse_flags,
-					      error))
-			return FALSE;
-		imgs = fu_firmware_get_images(firmware_linear);
-		if (imgs->len == 1) {
-			g_set_object(&firmware, g_ptr_array_index(imgs, 0));
-		} else {
-			g_set_object(&firmware, firmware_linear);
+		ret = fu_firmware_parse_stream(firmware_linear,
+					       stream,
+					       0x0,
+					       self->parse_flags,
+					       error);
+		if (ret) {
+			imgs = fu_firmware_get_images(firmware_linear);
+			if (imgs->len == 1) {
+				g_set_object(&firmware, g_ptr_array_index(imgs, 0));
+			} else {
+				g_set_object(&firmware, firmware_linear);
+			}
 		}
 	} else {
-		if (!fu_firmware_parse_stream(firmware, stream, 0x0, self->parse_flags, error))
-			return FALSE;
+		ret = fu_firmware_parse_stream(firmware, stream, 0x0, self->parse_flags, error);
+	}
+	if (profiler != NULL)
+		fu_firmware_profiler_pop_thread_default(profiler);
+	if (!ret)
+		return FALSE;
+
+	/* not for human consumption */
+	if (profiler != NULL) {
+		g_autoptr(FwupdJsonObject) json_obj = fwupd_json_object_new();
+		fu_firmware_profiler_add_json(profiler, json_obj);
+		fu_util_print_json_object(self->console, json_obj);
+		return TRUE;
 	}
 
 	str = fu_firmware_to_string(firmware);
@@ -3985,7 +4008,7 @@ fu_util_get_history(FuUtil *self, gchar **values, GError **error)
 		return FALSE;
 
 	/* get all devices from the history database */
-	devices = fu_engine_get_history(self->engine, error);
+	devices = fu_engine_get_history(self->engine, 0, 0, 0, error);
 	if (devices == NULL)
 		return FALSE;
 
@@ -4349,7 +4372,7 @@ fu_util_security(FuUtil *self, gchar **values, GError **error)
 	fu_console_print_literal(self->console, str);
 
 	/* print the "when" */
-	events = fu_engine_get_host_security_events(self->engine, 10, error);
+	events = fu_engine_get_host_security_events(self->engine, 0, 0, 10, error);
 	if (events == NULL)
 		return FALSE;
 	events_array = fu_security_attrs_get_all(events, fwupd_version);
@@ -6279,6 +6302,7 @@ main(int argc, char *argv[])
 	gboolean allow_reinstall = FALSE;
 	gboolean force = FALSE;
 	gboolean no_search = FALSE;
+	gboolean parallel = FALSE;
 	gboolean ret;
 	gboolean version = FALSE;
 	gboolean ignore_checksum = FALSE;
@@ -6376,6 +6400,14 @@ main(int argc, char *argv[])
 	     /* TRANSLATORS: command line option */
 	     N_("Do not search the firmware when parsing"),
 	     NULL},
+	    {"parallel",
+	     '\0',
+	     0,
+	     G_OPTION_ARG_NONE,
+	     &parallel,
+	     /* TRANSLATORS: command line option */
+	     N_("Parse independent firmware images at the same time"),
+	     NULL},
 	    {"no-safety-check",
 	     '\0',
 	     0,
@@ -6497,6 +6529,23 @@ main(int argc, char *argv[])
 	     /* TRANSLATORS: command line option */
 	     N_("Output in JSON format (disables all interactive prompts)"),
 	     NULL},
+	    {"profile",
+	     '\0',
+	     0,
+	     G_OPTION_ARG_NONE,
+	     &self->profile,
+	     /* TRANSLATORS: command line option */
+	     N_("Show a machine-readable profile of the firmware parser"),
+	     NULL},
+	    {"profile-trace",
+	     '\0',
+	     0,
+	     G_OPTION_ARG_FILENAME,
+	     &self->profile_trace,
+	     /* TRANSLATORS: command line option, the trace can be loaded into a flame graph viewer */
+	     N_("Save the step timings to a Chrome trace file"),
+	     /* TRANSLATORS: command argument: uppercase, spaces->dashes */
+	     N_("FILENAME")},
 	    {"destdir",
 	     '\0',
 	     0,
@@ -7181,7 +7230,8 @@ main(int argc, char *argv[])
 				 error->message);
 		return EXIT_FAILURE;
 	}
-	fu_progress_set_profile(self->progress, g_log_get_debug_enabled());
+	fu_progress_set_profile(self->progress,
+				g_log_get_debug_enabled() || self->profile_trace != NULL);
 
 	/* allow disabling SSL strict mode for broken corporate proxies */
 	if (self->disable_ssl_strict) {
@@ -7249,6 +7299,8 @@ main(int argc, char *argv[])
 		self->flags |= FWUPD_INSTALL_FLAG_FORCE;
 	if (no_search)
 		self->parse_flags |= FU_FIRMWARE_PARSE_FLAG_NO_SEARCH;
+	if (parallel)
+		self->parse_flags |= FU_FIRMWARE_PARSE_FLAG_PARALLEL;
 	if (ignore_checksum)
 		self->parse_flags |= FU_FIRMWARE_PARSE_FLAG_IGNORE_CHECKSUM;
 	if (ignore_vid_pid)
@@ -7307,6 +7359,13 @@ main(int argc, char *argv[])
 
 	/* run the specified command */
 	ret = fu_util_cmd_array_run(cmd_array, self, argv[1], (gchar **)&argv[2], &error);
+
+	/* save the trace even on failure, as that is when it is most useful */
+	if (self->profile_trace != NULL) {
+		g_autoptr(GError) error_trace = NULL;
+		if (!fu_progress_save_trace(self->progress, self->profile_trace, &error_trace))
+			g_warning("failed to save trace: %s", error_trace->message);
+	}
 	if (!ret) {
 #ifdef SUPPORTED_BUILD
 		/* sanity check */
@@ -28,6 +28,11 @@ struct _FuUdevBackend {
 	GPtrArray *dpaux_devices;   /* of FuDpauxDevice */
 	guint dpaux_devices_rescan_id;
 	gboolean done_coldplug;
+	GPtrArray *uevents; /* of FuUdevBackendUevent */
+	guint uevents_flush_id;
+	gint64 uevents_first_usec;
+	guint uevents_received;
+	guint uevents_dropped;
 };
 
 typedef struct {
@@ -35,12 +40,30 @@ typedef struct {
 	GError *error;
 } FuUdevBackendColdplugCacheItem;
 
+typedef struct {
+	FuUdevAction action;
+	gchar *sysfspath;
+	GPtrArray *props; /* of GStrv, the other KEY=VALUE pairs */
+	guint idx;	  /* arrival order */
+} FuUdevBackendUevent;
+
 G_DEFINE_TYPE(FuUdevBackend, fu_udev_backend, FU_TYPE_BACKEND)
 
 #define FU_UDEV_BACKEND_DPAUX_RESCAN_DELAY 5 /* s */
 
 #define FU_UDEV_BACKEND_SOCKET_RCV_SIZE (8 * FU_MB)
 
+#define FU_UDEV_BACKEND_UEVENT_DEBOUNCE_DELAY 50  /* ms */
+#define FU_UDEV_BACKEND_UEVENT_DEBOUNCE_MAX   500 /* ms */
+
+static void
+fu_udev_backend_uevent_free(FuUdevBackendUevent *uevent)
+{
+	g_free(uevent->sysfspath);
+	g_ptr_array_unref(uevent->props);
+	g_free(uevent);
+}
+
 static void
 fu_udev_backend_coldplug_cache_item_free(FuUdevBackendColdplugCacheItem *item)
 {
@@ -78,6 +101,9 @@ fu_udev_backend_to_string(FuBackend *backend, guint idt, GString *str)
 {
 	FuUdevBackend *self = FU_UDEV_BACKEND(backend);
 	fwupd_codec_string_append_bool(str, idt, "DoneColdplug", self->done_coldplug);
+	fwupd_codec_string_append_int(str, idt, "UeventsPending", self->uevents->len);
+	fwupd_codec_string_append_int(str, idt, "UeventsReceived", self->uevents_received);
+	fwupd_codec_string_append_int(str, idt, "UeventsDropped", self->uevents_dropped);
 }
 
 static void
@@ -447,35 +473,42 @@ fu_udev_backend_devnode_wait_cb(FuDevice *device, gpointer user_data, GError **e
 #endif
 
 /* if enabled, systemd takes the kernel event, runs the udev rules (which might
- * rename devices) and then re-broadcasts on the udev netlink socket */
-static gboolean
-fu_udev_backend_netlink_parse_blob(FuUdevBackend *self, GBytes *blob, GError **error)
+ * rename devices) and then re-broadcasts on the udev netlink socket -- this is the only time
+ * the blob is parsed, and the properties are kept until the uevent is dispatched */
+static FuUdevBackendUevent *
+fu_udev_backend_uevent_parse(FuUdevBackend *self, GBytes *blob, GError **error)
 {
 	FuContext *ctx = fu_backend_get_context(FU_BACKEND(self));
 	FuUdevAction action = FU_UDEV_ACTION_UNKNOWN;
+	FuUdevBackendUevent *uevent;
 	const gchar *sysfsdir;
+	g_autofree gchar *devpath = NULL;
+	g_autoptr(GPtrArray) props = g_ptr_array_new_with_free_func((GDestroyNotify)g_strfreev);
 #ifdef HAVE_UDEV_HOTPLUG
 	const guint8 *buf;
 	gsize bufsz = 0;
 	g_autoptr(FuStructUdevMonitorNetlinkHeader) st_hdr = NULL;
-	g_autoptr(FuUdevDevice) device_donor = NULL;
 	g_autoptr(GBytes) blob_payload = NULL;
+#else
+	g_auto(GStrv) split = NULL;
+#endif
 
 	sysfsdir = fu_context_get_path(ctx, FU_PATH_KIND_SYSFSDIR, error);
 	if (sysfsdir == NULL)
-		return FALSE;
+		return NULL;
 
+#ifdef HAVE_UDEV_HOTPLUG
 	/* parse the buffer */
 	st_hdr = fu_struct_udev_monitor_netlink_header_parse_bytes(blob, 0x0, error);
 	if (st_hdr == NULL)
-		return FALSE;
+		return NULL;
 	blob_payload =
 	    fu_bytes_new_offset(blob,
 				fu_struct_udev_monitor_netlink_header_get_properties_off(st_hdr),
 				fu_struct_udev_monitor_netlink_header_get_properties_len(st_hdr),
 				error);
 	if (blob_payload == NULL)
-		return FALSE;
+		return NULL;
 
 	/* split into lines */
 	buf = g_bytes_get_data(blob_payload, &bufsz);
@@ -485,12 +518,11 @@ fu_udev_backend_netlink_parse_blob(FuUdevBackend *self, GBytes *blob, GError **e
 
 		kvstr = fu_memstrsafe(buf, bufsz, i, bufsz - i, error);
 		if (kvstr == NULL)
-			return FALSE;
+			return NULL;
+		i += strlen(kvstr);
 		kv = g_strsplit(kvstr, "=", 2);
-		if (g_strv_length(kv) != 2) {
-			i += strlen(kvstr);
+		if (g_strv_length(kv) != 2)
 			continue;
-		}
 		if (g_strcmp0(kv[0], "ACTION") == 0) {
 			action = fu_udev_action_from_string(kv[1]);
 			if (action == FU_UDEV_ACTION_UNKNOWN) {
@@ -499,79 +531,100 @@ fu_udev_backend_netlink_parse_blob(FuUdevBackend *self, GBytes *blob, GError **e
 					    FWUPD_ERROR_INVALID_DATA,
 					    "unknown action %s",
 					    kv[1]);
-				return FALSE;
+				return NULL;
 			}
-
-			/* we do not care about these */
-			if (action == FU_UDEV_ACTION_BIND || action == FU_UDEV_ACTION_UNBIND)
-				return TRUE;
 		} else if (g_strcmp0(kv[0], "DEVPATH") == 0) {
-			g_autofree gchar *sysfspath = g_build_filename(sysfsdir, kv[1], NULL);
-
-			/* something changed */
-			if (action == FU_UDEV_ACTION_CHANGE) {
-				FuDevice *device_tmp =
-				    fu_backend_lookup_by_id(FU_BACKEND(self), sysfspath);
-				if (device_tmp == NULL)
-					return TRUE;
-				if (g_strcmp0(
-					fu_udev_device_get_subsystem(FU_UDEV_DEVICE(device_tmp)),
-					"drm") == 0)
-					fu_udev_backend_rescan_dpaux_devices(self);
-				g_set_object(&device_donor, FU_UDEV_DEVICE(device_tmp));
-			}
+			if (devpath == NULL)
+				devpath = g_strdup(kv[1]);
+		} else {
+			g_ptr_array_add(props, g_steal_pointer(&kv));
+		}
+	}
+#else
+	split = fu_strsplit_bytes(blob, "@", 2);
+	if (g_strv_length(split) != 2) {
+		g_set_error_literal(error,
+				    FWUPD_ERROR,
+				    FWUPD_ERROR_INVALID_DATA,
+				    "invalid uevent format");
+		return NULL;
+	}
+	action = fu_udev_action_from_string(split[0]);
+	devpath = g_strdup(split[1]);
+#endif
 
-			/* something got removed */
-			if (action == FU_UDEV_ACTION_REMOVE) {
-				fu_udev_backend_remove_device(self, sysfspath);
-				return TRUE;
-			}
+	/* we do not care about these */
+	if (action == FU_UDEV_ACTION_BIND || action == FU_UDEV_ACTION_UNBIND) {
+		g_set_error_literal(error,
+				    FWUPD_ERROR,
+				    FWUPD_ERROR_NOT_SUPPORTED,
+				    "ignoring bind action");
+		return NULL;
+	}
+	if (action == FU_UDEV_ACTION_UNKNOWN) {
+		g_set_error_literal(error, FWUPD_ERROR, FWUPD_ERROR_INVALID_DATA, "unknown action");
+		return NULL;
+	}
+	if (devpath == NULL) {
+		g_set_error_literal(error, FWUPD_ERROR, FWUPD_ERROR_INVALID_DATA, "no DEVPATH");
+		return NULL;
+	}
 
-			/* something got added */
-			if (action == FU_UDEV_ACTION_ADD) {
-				if (device_donor != NULL) {
-					g_set_error_literal(error,
-							    FWUPD_ERROR,
-							    FWUPD_ERROR_INVALID_DATA,
-							    "already have a donor device");
-					return FALSE;
-				}
-				device_donor = fu_udev_device_new(ctx, sysfspath);
-			}
-		} else if (g_strcmp0(kv[0], "SUBSYSTEM") == 0 && device_donor != NULL) {
-			fu_udev_device_set_subsystem(device_donor, kv[1]);
-		} else if (g_strcmp0(kv[0], "DEVTYPE") == 0 && device_donor != NULL) {
-			fu_udev_device_set_devtype(device_donor, kv[1]);
-		} else if (device_donor != NULL) {
-			fu_udev_device_add_property(device_donor, kv[0], kv[1]);
-		}
+	/* success */
+	uevent = g_new0(FuUdevBackendUevent, 1);
+	uevent->action = action;
+	uevent->sysfspath = g_build_filename(sysfsdir, devpath, NULL);
+	uevent->props = g_steal_pointer(&props);
+	uevent->idx = self->uevents_received++;
+	return uevent;
+}
 
-		/* next! */
-		i += strlen(kvstr);
+#ifdef HAVE_UDEV_HOTPLUG
+static void
+fu_udev_backend_uevent_set_props(FuUdevBackendUevent *uevent, FuUdevDevice *device)
+{
+	for (guint i = 0; i < uevent->props->len; i++) {
+		gchar **kv = g_ptr_array_index(uevent->props, i);
+		if (g_strcmp0(kv[0], "SUBSYSTEM") == 0)
+			fu_udev_device_set_subsystem(device, kv[1]);
+		else if (g_strcmp0(kv[0], "DEVTYPE") == 0)
+			fu_udev_device_set_devtype(device, kv[1]);
+		else
+			fu_udev_device_add_property(device, kv[0], kv[1]);
+	}
+}
+#endif
+
+static gboolean
+fu_udev_backend_uevent_dispatch(FuUdevBackend *self, FuUdevBackendUevent *uevent, GError **error)
+{
+#ifdef HAVE_UDEV_HOTPLUG
+	FuContext *ctx = fu_backend_get_context(FU_BACKEND(self));
+
+	/* something changed */
+	if (uevent->action == FU_UDEV_ACTION_CHANGE) {
+		FuDevice *device_tmp = fu_backend_lookup_by_id(FU_BACKEND(self), uevent->sysfspath);
+		if (device_tmp == NULL)
+			return TRUE;
+		if (g_strcmp0(fu_udev_device_get_subsystem(FU_UDEV_DEVICE(device_tmp)), "drm") == 0)
+			fu_udev_backend_rescan_dpaux_devices(self);
+		fu_udev_backend_uevent_set_props(uevent, FU_UDEV_DEVICE(device_tmp));
+		fu_backend_device_changed(FU_BACKEND(self), device_tmp);
+		return TRUE;
 	}
 
-	/* notify the engine */
-	if (action == FU_UDEV_ACTION_CHANGE) {
-		if (device_donor == NULL) {
-			g_set_error_literal(error,
-					    FWUPD_ERROR,
-					    FWUPD_ERROR_NOT_FOUND,
-					    "no device to change");
-			return FALSE;
-		}
-		fu_backend_device_changed(FU_BACKEND(self), FU_DEVICE(device_donor));
+	/* something got removed */
+	if (uevent->action == FU_UDEV_ACTION_REMOVE) {
+		fu_udev_backend_remove_device(self, uevent->sysfspath);
+		return TRUE;
 	}
 
 	/* now create the actual device from the donor */
-	if (action == FU_UDEV_ACTION_ADD) {
+	if (uevent->action == FU_UDEV_ACTION_ADD) {
 		g_autoptr(FuUdevDevice) device_actual = NULL;
-		if (device_donor == NULL) {
-			g_set_error_literal(error,
-					    FWUPD_ERROR,
-					    FWUPD_ERROR_INVALID_DATA,
-					    "no new device to add");
-			return FALSE;
-		}
+		g_autoptr(FuUdevDevice) device_donor = fu_udev_device_new(ctx, uevent->sysfspath);
+
+		fu_udev_backend_uevent_set_props(uevent, device_donor);
 		device_actual =
 		    FU_UDEV_DEVICE(fu_udev_backend_create_device_for_donor(FU_BACKEND(self),
 									   FU_DEVICE(device_donor),
@@ -583,24 +636,9 @@ fu_udev_backend_netlink_parse_blob(FuUdevBackend *self, GBytes *blob, GError **e
 		fu_udev_backend_device_add_from_device(self, device_actual);
 	}
 #else
-	g_auto(GStrv) split = fu_strsplit_bytes(blob, "@", 2);
-
-	if (g_strv_length(split) != 2) {
-		g_set_error_literal(error,
-				    FWUPD_ERROR,
-				    FWUPD_ERROR_INVALID_DATA,
-				    "invalid uevent format");
-		return FALSE;
-	}
-	sysfsdir = fu_context_get_path(ctx, FU_PATH_KIND_SYSFSDIR, error);
-	if (sysfsdir == NULL)
-		return FALSE;
-
-	action = fu_udev_action_from_string(split[0]);
-	if (action == FU_UDEV_ACTION_ADD) {
-		g_autofree gchar *sysfspath = g_build_filename(sysfsdir, split[1], NULL);
+	if (uevent->action == FU_UDEV_ACTION_ADD) {
 		g_autoptr(FuUdevDevice) device =
-		    fu_udev_backend_create_device(self, sysfspath, error);
+		    fu_udev_backend_create_device(self, uevent->sysfspath, error);
 		if (device == NULL)
 			return FALSE;
 		if (!fu_device_retry_full(FU_DEVICE(device),
@@ -611,12 +649,10 @@ fu_udev_backend_netlink_parse_blob(FuUdevBackend *self, GBytes *blob, GError **e
 					  error))
 			return FALSE;
 		fu_udev_backend_device_add_from_device(self, device);
-	} else if (action == FU_UDEV_ACTION_REMOVE) {
-		g_autofree gchar *sysfspath = g_build_filename(sysfsdir, split[1], NULL);
-		fu_udev_backend_remove_device(self, sysfspath);
-	} else if (action == FU_UDEV_ACTION_CHANGE) {
-		g_autofree gchar *sysfspath = g_build_filename(sysfsdir, split[1], NULL);
-		FuDevice *device_tmp = fu_backend_lookup_by_id(FU_BACKEND(self), sysfspath);
+	} else if (uevent->action == FU_UDEV_ACTION_REMOVE) {
+		fu_udev_backend_remove_device(self, uevent->sysfspath);
+	} else if (uevent->action == FU_UDEV_ACTION_CHANGE) {
+		FuDevice *device_tmp = fu_backend_lookup_by_id(FU_BACKEND(self), uevent->sysfspath);
 		if (device_tmp == NULL) {
 			g_set_error_literal(error,
 					    FWUPD_ERROR,
@@ -632,6 +668,200 @@ fu_udev_backend_netlink_parse_blob(FuUdevBackend *self, GBytes *blob, GError **e
 	return TRUE;
 }
 
+static guint
+fu_udev_backend_uevents_find_last(FuUdevBackend *self, const gchar *sysfspath)
+{
+	for (guint i = self->uevents->len; i > 0; i--) {
+		FuUdevBackendUevent *uevent = g_ptr_array_index(self->uevents, i - 1);
+		if (g_strcmp0(uevent->sysfspath, sysfspath) == 0)
+			return i - 1;
+	}
+	return G_MAXUINT;
+}
+
+static guint
+fu_udev_backend_uevent_get_depth(FuUdevBackendUevent *uevent)
+{
+	guint depth = 0;
+	for (guint i = 0; uevent->sysfspath[i] != '\0'; i++) {
+		if (uevent->sysfspath[i] == '/')
+			depth++;
+	}
+	return depth;
+}
+
+static gint
+fu_udev_backend_uevent_sort_cb(gconstpointer a, gconstpointer b)
+{
+	FuUdevBackendUevent *uevent1 = *((FuUdevBackendUevent **)a);
+	FuUdevBackendUevent *uevent2 = *((FuUdevBackendUevent **)b);
+	const FuUdevAction order[] = {FU_UDEV_ACTION_REMOVE,
+				      FU_UDEV_ACTION_ADD,
+				      FU_UDEV_ACTION_CHANGE};
+	guint depth1 = fu_udev_backend_uevent_get_depth(uevent1);
+	guint depth2 = fu_udev_backend_uevent_get_depth(uevent2);
+	guint phase1 = 0;
+	guint phase2 = 0;
+
+	/* removals first so that a replugged device is removed and then added */
+	for (guint i = 0; i < G_N_ELEMENTS(order); i++) {
+		if (uevent1->action == order[i])
+			phase1 = i;
+		if (uevent2->action == order[i])
+			phase2 = i;
+	}
+	if (phase1 != phase2)
+		return phase1 < phase2 ? -1 : 1;
+
+	/* children are removed before the parent, and parents are added before the children */
+	if (depth1 != depth2) {
+		if (uevent1->action == FU_UDEV_ACTION_REMOVE)
+			return depth1 > depth2 ? -1 : 1;
+		return depth1 < depth2 ? -1 : 1;
+	}
+
+	/* otherwise keep the arrival order */
+	if (uevent1->idx < uevent2->idx)
+		return -1;
+	if (uevent1->idx > uevent2->idx)
+		return 1;
+	return 0;
+}
+
+/* for the self tests */
+guint
+fu_udev_backend_get_uevents_pending(FuUdevBackend *self)
+{
+	g_return_val_if_fail(FU_IS_UDEV_BACKEND(self), G_MAXUINT);
+	return self->uevents->len;
+}
+
+/* for the self tests */
+guint
+fu_udev_backend_get_uevents_dropped(FuUdevBackend *self)
+{
+	g_return_val_if_fail(FU_IS_UDEV_BACKEND(self), G_MAXUINT);
+	return self->uevents_dropped;
+}
+
+/* dispatch all the pending uevents, parents first */
+void
+fu_udev_backend_flush_uevents(FuUdevBackend *self)
+{
+	g_autoptr(GPtrArray) uevents = NULL;
+
+	g_return_if_fail(FU_IS_UDEV_BACKEND(self));
+
+	if (self->uevents_flush_id != 0) {
+		g_source_remove(self->uevents_flush_id);
+		self->uevents_flush_id = 0;
+	}
+	if (self->uevents->len == 0)
+		return;
+
+	/* dispatching may cause more uevents to be queued */
+	uevents = g_steal_pointer(&self->uevents);
+	self->uevents =
+	    g_ptr_array_new_with_free_func((GDestroyNotify)fu_udev_backend_uevent_free);
+	g_ptr_array_sort(uevents, fu_udev_backend_uevent_sort_cb);
+	for (guint i = 0; i < uevents->len; i++) {
+		FuUdevBackendUevent *uevent = g_ptr_array_index(uevents, i);
+		g_autoptr(GError) error_local = NULL;
+		if (!fu_udev_backend_uevent_dispatch(self, uevent, &error_local)) {
+			if (g_error_matches(error_local, FWUPD_ERROR, FWUPD_ERROR_NOT_SUPPORTED) ||
+			    g_error_matches(error_local, FWUPD_ERROR, FWUPD_ERROR_NOT_FOUND)) {
+				g_debug("ignoring uevent: %s", error_local->message);
+				continue;
+			}
+			g_warning("ignoring uevent: %s", error_local->message);
+		}
+	}
+	g_debug("dispatched %u uevents, stable after %.1fms",
+		uevents->len,
+		(g_get_monotonic_time() - self->uevents_first_usec) / 1000.f);
+}
+
+static gboolean
+fu_udev_backend_uevents_flush_cb(gpointer user_data)
+{
+	FuUdevBackend *self = FU_UDEV_BACKEND(user_data);
+	self->uevents_flush_id = 0;
+	fu_udev_backend_flush_uevents(self);
+	return G_SOURCE_REMOVE;
+}
+
+/* queue a uevent to be dispatched after a short delay, coalescing it with any pending uevents
+ * for the same device */
+gboolean
+fu_udev_backend_add_uevent(FuUdevBackend *self, GBytes *blob, GError **error)
+{
+	FuUdevBackendUevent *uevent;
+	guint idx;
+	gint64 now = g_get_monotonic_time();
+
+	g_return_val_if_fail(FU_IS_UDEV_BACKEND(self), FALSE);
+	g_return_val_if_fail(blob != NULL, FALSE);
+	g_return_val_if_fail(error == NULL || *error == NULL, FALSE);
+
+	uevent = fu_udev_backend_uevent_parse(self, blob, error);
+	if (uevent == NULL)
+		return FALSE;
+	if (self->uevents->len == 0)
+		self->uevents_first_usec = now;
+
+	/* coalesce with the last pending uevent for the same device */
+	idx = fu_udev_backend_uevents_find_last(self, uevent->sysfspath);
+	if (idx != G_MAXUINT) {
+		FuUdevBackendUevent *uevent_old = g_ptr_array_index(self->uevents, idx);
+
+		/* the device is going to be probed when it is added anyway */
+		if (uevent_old->action == FU_UDEV_ACTION_ADD &&
+		    uevent->action == FU_UDEV_ACTION_CHANGE) {
+			self->uevents_dropped++;
+			fu_udev_backend_uevent_free(uevent);
+			return TRUE;
+		}
+
+		/* only the last change matters, and removal supersedes it */
+		if (uevent_old->action == FU_UDEV_ACTION_CHANGE &&
+		    (uevent->action == FU_UDEV_ACTION_CHANGE ||
+		     uevent->action == FU_UDEV_ACTION_REMOVE)) {
+			self->uevents_dropped++;
+			g_ptr_array_remove_index(self->uevents, idx);
+		} else if (uevent_old->action == FU_UDEV_ACTION_ADD &&
+			   uevent->action == FU_UDEV_ACTION_REMOVE) {
+			/* the device appeared and disappeared again, so there is nothing to do
+			 * unless it was already known before it was added */
+			self->uevents_dropped++;
+			g_ptr_array_remove_index(self->uevents, idx);
+			if (fu_udev_backend_uevents_find_last(self, uevent->sysfspath) !=
+				G_MAXUINT ||
+			    fu_backend_lookup_by_id(FU_BACKEND(self), uevent->sysfspath) == NULL) {
+				self->uevents_dropped++;
+				fu_udev_backend_uevent_free(uevent);
+				return TRUE;
+			}
+		}
+	}
+	g_ptr_array_add(self->uevents, uevent);
+
+	/* debounce, but do not wait forever if the events keep coming */
+	if (self->uevents_flush_id != 0) {
+		g_source_remove(self->uevents_flush_id);
+		self->uevents_flush_id = 0;
+	}
+	if ((now - self->uevents_first_usec) / 1000 >= FU_UDEV_BACKEND_UEVENT_DEBOUNCE_MAX) {
+		fu_udev_backend_flush_uevents(self);
+		return TRUE;
+	}
+	self->uevents_flush_id = g_timeout_add(FU_UDEV_BACKEND_UEVENT_DEBOUNCE_DELAY,
+					       fu_udev_backend_uevents_flush_cb,
+					       self);
+
+	/* success */
+	return TRUE;
+}
+
 static gboolean
 fu_udev_backend_netlink_cb(gint fd, GIOCondition condition, gpointer user_data)
 {
@@ -671,7 +901,7 @@ fu_udev_backend_netlink_cb(gint fd, GIOCondition condition, gpointer user_data)
 	}
 
 	blob = g_bytes_new(buf, len);
-	if (!fu_udev_backend_netlink_parse_blob(self, blob, &error_local)) {
+	if (!fu_udev_backend_add_uevent(self, blob, &error_local)) {
 		if (g_error_matches(error_local, FWUPD_ERROR, FWUPD_ERROR_NOT_SUPPORTED) ||
 		    g_error_matches(error_local, FWUPD_ERROR, FWUPD_ERROR_NOT_FOUND)) {
 			g_debug("ignoring netlink message: %s", error_local->message);
@@ -912,11 +1142,14 @@ fu_udev_backend_finalize(GObject *object)
 	FuUdevBackend *self = FU_UDEV_BACKEND(object);
 	if (self->dpaux_devices_rescan_id != 0)
 		g_source_remove(self->dpaux_devices_rescan_id);
+	if (self->uevents_flush_id != 0)
+		g_source_remove(self->uevents_flush_id);
 	if (self->netlink_fd > 0)
 		g_close(self->netlink_fd, NULL);
 	g_hash_table_unref(self->map_paths);
 	g_hash_table_unref(self->coldplug_cache);
 	g_ptr_array_unref(self->dpaux_devices);
+	g_ptr_array_unref(self->uevents);
 	G_OBJECT_CLASS(fu_udev_backend_parent_class)->finalize(object);
 }
 
@@ -930,6 +1163,7 @@ fu_udev_backend_init(FuUdevBackend *self)
 				  g_free,
 				  (GDestroyNotify)fu_udev_backend_coldplug_cache_item_free);
 	self->dpaux_devices = g_ptr_array_new_with_free_func((GDestroyNotify)g_object_unref);
+	self->uevents = g_ptr_array_new_with_free_func((GDestroyNotify)fu_udev_backend_uevent_free);
 }
 
 static void
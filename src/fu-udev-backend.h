@@ -13,3 +13,11 @@ G_DECLARE_FINAL_TYPE(FuUdevBackend, fu_udev_backend, FU, UDEV_BACKEND, FuBackend
 
 FuBackend *
 fu_udev_backend_new(FuContext *ctx) G_GNUC_NON_NULL(1);
+gboolean
+fu_udev_backend_add_uevent(FuUdevBackend *self, GBytes *blob, GError **error) G_GNUC_NON_NULL(1, 2);
+void
+fu_udev_backend_flush_uevents(FuUdevBackend *self) G_GNUC_NON_NULL(1);
+guint
+fu_udev_backend_get_uevents_pending(FuUdevBackend *self) G_GNUC_NON_NULL(1);
+guint
+fu_udev_backend_get_uevents_dropped(FuUdevBackend *self) G_GNUC_NON_NULL(1);
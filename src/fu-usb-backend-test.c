@@ -236,6 +236,121 @@ fu_usb_backend_invalid_func(void)
 	g_assert_false(fu_device_has_icon(device_tmp, "computer"));
 }
 
+static gchar *
+fu_usb_backend_bulk_transfer_event_id(guint8 endpoint, GByteArray *buf)
+{
+	g_autofree gchar *data_base64 = fu_base64_encode(buf->data, buf->len);
+	return g_strdup_printf("BulkTransfer:"
+			       "Endpoint=0x%02x,"
+			       "Data=%s,"
+			       "Length=0x%x",
+			       endpoint,
+			       data_base64,
+			       buf->len);
+}
+
+static void
+fu_usb_backend_bulk_transfer_queue_func(void)
+{
+	gboolean ret;
+	FuDeviceEvent *event;
+	g_autofree gchar *event_id = NULL;
+	g_autoptr(FuContext) ctx = fu_context_new_full(FU_CONTEXT_FLAG_NO_QUIRKS);
+	g_autoptr(FuDevice) device = g_object_new(FU_TYPE_USB_DEVICE, "context", ctx, NULL);
+	g_autoptr(FuProgress) progress = fu_progress_new(G_STRLOC);
+	g_autoptr(GByteArray) buf_in = g_byte_array_new();
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GPtrArray) bufs =
+	    g_ptr_array_new_with_free_func((GDestroyNotify)g_byte_array_unref);
+	g_autoptr(GPtrArray) bufs_in =
+	    g_ptr_array_new_with_free_func((GDestroyNotify)g_byte_array_unref);
+
+	/* a firmware download, as recorded by the synchronous API */
+	fu_device_add_flag(device, FWUPD_DEVICE_FLAG_EMULATED);
+	fu_device_add_private_flag(device, FU_DEVICE_PRIVATE_FLAG_STRICT_EMULATION_ORDER);
+	for (guint i = 0; i < 256; i++) {
+		g_autofree gchar *event_id_tmp = NULL;
+		g_autoptr(GByteArray) buf = g_byte_array_new();
+
+		fu_byte_array_set_size(buf, 0x4000, i);
+		event_id_tmp = fu_usb_backend_bulk_transfer_event_id(0x01, buf);
+		event = fu_device_save_event(device, event_id_tmp);
+		fu_device_event_set_data(event, "Data", buf->data, buf->len);
+		g_ptr_array_add(bufs, g_steal_pointer(&buf));
+	}
+
+	/* replay in order, with the requests being submitted ahead of completion */
+	ret = fu_usb_device_bulk_transfer_queue(FU_USB_DEVICE(device),
+						0x01,
+						bufs,
+						4,
+						1000,
+						progress,
+						&error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	g_assert_cmpint(fu_progress_get_percentage(progress), ==, 100);
+
+	/* a short read truncates the buffer */
+	fu_byte_array_set_size(buf_in, 0x40, 0x0);
+	event_id = fu_usb_backend_bulk_transfer_event_id(0x81, buf_in);
+	event = fu_device_save_event(device, event_id);
+	fu_device_event_set_data(event, "Data", (const guint8 *)"OK", 2);
+	g_ptr_array_add(bufs_in, g_byte_array_ref(buf_in));
+	ret = fu_usb_device_bulk_transfer_queue(FU_USB_DEVICE(device),
+						0x81,
+						bufs_in,
+						4,
+						1000,
+						NULL,
+						&error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	g_assert_cmpint(buf_in->len, ==, 2);
+	g_assert_cmpint(buf_in->data[0], ==, 'O');
+}
+
+static void
+fu_usb_backend_bulk_transfer_queue_error_func(void)
+{
+	gboolean ret;
+	g_autoptr(FuContext) ctx = fu_context_new_full(FU_CONTEXT_FLAG_NO_QUIRKS);
+	g_autoptr(FuDevice) device = g_object_new(FU_TYPE_USB_DEVICE, "context", ctx, NULL);
+	g_autoptr(FuProgress) progress = fu_progress_new(G_STRLOC);
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GPtrArray) bufs =
+	    g_ptr_array_new_with_free_func((GDestroyNotify)g_byte_array_unref);
+
+	/* the sixth request times out, and the next three were already submitted */
+	fu_device_add_flag(device, FWUPD_DEVICE_FLAG_EMULATED);
+	for (guint i = 0; i < 10; i++) {
+		FuDeviceEvent *event;
+		g_autofree gchar *event_id = NULL;
+		g_autoptr(GByteArray) buf = g_byte_array_new();
+
+		fu_byte_array_set_size(buf, 0x40, i);
+		event_id = fu_usb_backend_bulk_transfer_event_id(0x01, buf);
+		event = fu_device_save_event(device, event_id);
+		if (i == 5)
+			fu_device_event_set_i64(event, "Error", -7); /* LIBUSB_ERROR_TIMEOUT */
+		else
+			fu_device_event_set_data(event, "Data", buf->data, buf->len);
+		g_ptr_array_add(bufs, g_steal_pointer(&buf));
+	}
+	ret = fu_usb_device_bulk_transfer_queue(FU_USB_DEVICE(device),
+						0x01,
+						bufs,
+						4,
+						1000,
+						progress,
+						&error);
+	g_assert_error(error, FWUPD_ERROR, FWUPD_ERROR_TIMED_OUT);
+	g_assert_false(ret);
+
+	/* only the requests before the failure were completed */
+	g_assert_cmpint(fu_progress_get_percentage(progress), ==, 50);
+}
+
 int
 main(int argc, char **argv)
 {
@@ -243,5 +358,9 @@ main(int argc, char **argv)
 	g_test_init(&argc, &argv, NULL);
 	g_test_add_func("/fwupd/usb-backend", fu_usb_backend_func);
 	g_test_add_func("/fwupd/usb-backend/invalid", fu_usb_backend_invalid_func);
+	g_test_add_func("/fwupd/usb-backend/bulk-transfer-queue",
+			fu_usb_backend_bulk_transfer_queue_func);
+	g_test_add_func("/fwupd/usb-backend/bulk-transfer-queue/error",
+			fu_usb_backend_bulk_transfer_queue_error_func);
 	return g_test_run();
 }